@@ -0,0 +1,25 @@
+#include "AllocCounter.h"
+
+#include <atomic>
+
+// Interposes the glibc allocator, which also catches strdup and operator new
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t n, size_t size);
+
+static std::atomic<size_t> allocations(0);
+
+void *malloc(size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  return __libc_malloc(size);
+}
+
+void *calloc(size_t n, size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  return __libc_calloc(n, size);
+}
+}
+
+size_t allocationCount() {
+  return allocations.load(std::memory_order_relaxed);
+}
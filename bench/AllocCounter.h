@@ -0,0 +1,10 @@
+#ifndef ALLOCCOUNTER_H_
+#define ALLOCCOUNTER_H_
+
+#include <cstddef>
+
+/// Number of calls to malloc and calloc since the program started, link
+/// with AllocCounter.cpp to count them
+size_t allocationCount();
+
+#endif /* !ALLOCCOUNTER_H_ */
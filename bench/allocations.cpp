@@ -0,0 +1,85 @@
+#include "AllocCounter.h"
+#include "Interpreter.h"
+#include "Lexer.h"
+#include "Parser.h"
+#include "Util.h"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+// Heap allocations per function call and calls per second while
+// evaluating the functions of examples/fib.ls on both engines.
+//
+// usage: bench_allocations [examples dir]
+
+namespace {
+
+struct Call {
+  const char *code;
+  /// Number of calls of user defined functions made by code
+  long calls;
+};
+
+/// Calls made by (fib n), fib is called fib(n + 1) * 2 - 1 times
+long fibCalls(int n) {
+  long a = 0, b = 1;
+  for (int i = 0; i <= n; i++) {
+    const auto next = a + b;
+    a = b;
+    b = next;
+  }
+  return a * 2 - 1;
+}
+
+AST::List read(const std::string &code) {
+  Lexer l(code.c_str());
+  Parser p(l);
+  return p.read();
+}
+
+void run(Interpreter::Engine engine, const AST::List &definitions,
+         const Call &call) {
+  Interpreter interpreter(engine);
+  for (const auto &e : definitions) {
+    interpreter.eval(e);
+  }
+  const auto program = read(call.code);
+  // compile before counting
+  interpreter.eval(program.front());
+
+  const auto before = allocationCount();
+  const auto start = std::chrono::steady_clock::now();
+  interpreter.eval(program.front());
+  const std::chrono::duration<double> seconds =
+      std::chrono::steady_clock::now() - start;
+  const auto allocations = allocationCount() - before;
+  printf("%-6s %-12s %12zu %14.2f %10.1f %14.0f\n",
+         Interpreter::engineToCString(engine), call.code, allocations,
+         static_cast<double>(allocations) / call.calls,
+         seconds.count() * 1000, call.calls / seconds.count());
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const std::string examples = argc > 1 ? argv[1] : EXAMPLES_DIR;
+  const auto fibFile = util::readFile(examples + "/fib.ls");
+  // only the definitions of fib, fib-iter and fib2
+  const auto definitions = read(fibFile.substr(0, fibFile.find("(fib2 20)")));
+
+  const Call calls[] = {
+      {"(fib 20)", fibCalls(20)},
+      {"(fib 25)", fibCalls(25)},
+      {"(fib2 20)", 22},
+  };
+  printf("%-6s %-12s %12s %14s %10s %14s\n", "engine", "call", "allocations",
+         "allocs/call", "ms", "calls/s");
+  for (const auto engine :
+       {Interpreter::Engine::TREE, Interpreter::Engine::BYTECODE}) {
+    for (const auto &call : calls) {
+      run(engine, definitions, call);
+    }
+  }
+  return 0;
+}
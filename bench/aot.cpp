@@ -0,0 +1,96 @@
+#include "Interpreter.h"
+#include "Lexer.h"
+#include "Parser.h"
+#include "Util.h"
+#include "fib_aot.h"
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <string>
+
+// Time of examples/fib.ls evaluated by the engines, each run reading and
+// parsing the script, and by the C++ lispc translated it to at build time.
+// Then the time of single calls once the functions are defined.
+//
+// usage: bench_aot [examples dir]
+
+namespace {
+
+double time(const std::function<void()> &fn) {
+  const auto start = std::chrono::steady_clock::now();
+  fn();
+  const std::chrono::duration<double, std::milli> ms =
+      std::chrono::steady_clock::now() - start;
+  return ms.count();
+}
+
+AST::List read(const std::string &code) {
+  Lexer l(code.c_str());
+  Parser p(l);
+  return p.read();
+}
+
+void runScript(Interpreter::Engine engine, bool jit,
+               const std::string &file) {
+  Interpreter interpreter(engine);
+  if (jit)
+    interpreter.enableJit();
+  for (const auto &form : read(util::readFile(file))) {
+    interpreter.eval(form);
+  }
+}
+
+double call(Interpreter::Engine engine, bool jit, const std::string &file,
+            const char *code) {
+  Interpreter interpreter(engine);
+  if (jit)
+    interpreter.enableJit();
+  for (const auto &form : read(util::readFile(file))) {
+    interpreter.eval(form);
+  }
+  const auto program = read(code);
+  // compiled by the jit before it is timed
+  interpreter.eval(program.front());
+  return time([&] { interpreter.eval(program.front()); });
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const std::string examples = argc > 1 ? argv[1] : EXAMPLES_DIR;
+  const auto file = examples + "/fib.ls";
+  const int runs = 100;
+
+  printf("%-10s %14s\n", "fib.ls", "ms per run");
+  printf("%-10s %14.3f\n", "tree", time([&] {
+           for (int i = 0; i < runs; i++)
+             runScript(Interpreter::Engine::TREE, false, file);
+         }) / runs);
+  printf("%-10s %14.3f\n", "vm", time([&] {
+           for (int i = 0; i < runs; i++)
+             runScript(Interpreter::Engine::BYTECODE, false, file);
+         }) / runs);
+  printf("%-10s %14.3f\n", "aot", time([] {
+           for (int i = 0; i < runs; i++)
+             fib_aot::run();
+         }) / runs);
+
+  printf("\n%-16s %10s %10s %10s %10s\n", "call", "tree ms", "vm ms",
+         "jit ms", "aot ms");
+  const char *fib25 = "(fib 25)";
+  printf("%-16s %10.3f %10.3f %10.3f %10.3f\n", fib25,
+         call(Interpreter::Engine::TREE, false, file, fib25),
+         call(Interpreter::Engine::BYTECODE, false, file, fib25),
+         call(Interpreter::Engine::BYTECODE, true, file, fib25), time([] {
+           fib_aot::fib(Value::integer(25));
+         }));
+  const char *iter = "(fib2 40)";
+  printf("%-16s %10.3f %10.3f %10.3f %10.3f\n", iter,
+         call(Interpreter::Engine::TREE, false, file, iter),
+         call(Interpreter::Engine::BYTECODE, false, file, iter),
+         call(Interpreter::Engine::BYTECODE, true, file, iter), time([] {
+           fib_aot::fib2(Value::integer(40));
+         }));
+  return 0;
+}
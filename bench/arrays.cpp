@@ -0,0 +1,108 @@
+#include "Interpreter.h"
+#include "Lexer.h"
+#include "Parser.h"
+#include "Simd.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <vector>
+
+// Elementwise arithmetic on arrays of ten thousand elements, in the cache,
+// and of a million, evaluated by the interpreter with the scalar and the
+// AVX2 loops, against a C++ loop over vectors the compiler is free to
+// vectorize. The interpreter also allocates the result array and checks
+// the operands.
+//
+// usage: bench_arrays
+
+namespace {
+
+const int REPEAT = 20;
+
+/// Best time of REPEAT calls of fn
+double time(const std::function<void()> &fn) {
+  double best = 1e30;
+  for (int i = 0; i < REPEAT; i++) {
+    const auto start = std::chrono::steady_clock::now();
+    fn();
+    const std::chrono::duration<double, std::milli> ms =
+        std::chrono::steady_clock::now() - start;
+    best = std::min(best, ms.count());
+  }
+  return best;
+}
+
+template <typename T> double loop(size_t size, const char *op) {
+  std::vector<T> a(size, 3), b(size, 4), res(size);
+  const bool add = '+' == op[0];
+  const auto ms = time([&] {
+    if (add) {
+      for (size_t i = 0; i < size; i++)
+        res[i] = a[i] + b[i];
+    } else {
+      for (size_t i = 0; i < size; i++)
+        res[i] = a[i] * T(2);
+    }
+  });
+  // keep the loop
+  if (res[size / 2] == T(42))
+    printf(" ");
+  return ms;
+}
+
+std::shared_ptr<AST> filled(TypedArray::Element element, size_t size,
+                            double value) {
+  TypedArray array(element, size);
+  for (size_t i = 0; i < size; i++) {
+    if (TypedArray::Element::INT == element)
+      array.ints()[i] = value;
+    else
+      array.floats()[i] = value;
+  }
+  return std::make_shared<ASTArray>(std::move(array));
+}
+
+double interpret(TypedArray::Element element, size_t size,
+                 const char *code) {
+  Interpreter interpreter;
+  const auto globals = interpreter.environment();
+  globals->setEntry(SymbolTable::intern("a"), filled(element, size, 3));
+  globals->setEntry(SymbolTable::intern("b"), filled(element, size, 4));
+  Lexer l(code);
+  Parser p(l);
+  const auto program = p.read();
+  return time([&] { interpreter.eval(program.front()); });
+}
+
+} // namespace
+
+int main() {
+  const auto best = simd::isa();
+  printf("%-8s %-8s %-10s %10s %10s %10s %10s\n", "elements", "type",
+         "form", "C++ ms", "scalar ms", "avx2 ms", "avx2/C++");
+  struct Case {
+    TypedArray::Element element;
+    const char *code;
+  };
+  for (const size_t size : {10000, 1000000}) {
+    for (const auto &c : {Case{TypedArray::Element::INT, "(+ a b)"},
+                          Case{TypedArray::Element::FLOAT, "(+ a b)"},
+                          Case{TypedArray::Element::FLOAT, "(* a 2.0)"}}) {
+      const bool ints = TypedArray::Element::INT == c.element;
+      const auto native = ints ? loop<int64_t>(size, c.code + 1)
+                               : loop<double>(size, c.code + 1);
+      simd::setIsa(simd::Isa::SCALAR);
+      const auto scalar = interpret(c.element, size, c.code);
+      double avx2 = 0;
+      if (simd::setIsa(simd::Isa::AVX2))
+        avx2 = interpret(c.element, size, c.code);
+      printf("%-8zu %-8s %-10s %10.3f %10.3f %10.3f %10.2f\n", size,
+             ints ? "int" : "float", c.code, native, scalar, avx2,
+             avx2 / native);
+    }
+  }
+  simd::setIsa(best);
+  return 0;
+}
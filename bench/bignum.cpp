@@ -0,0 +1,92 @@
+#include "BigInt.h"
+#include "Interpreter.h"
+#include "Lexer.h"
+#include "Parser.h"
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <string>
+
+// Both paths of the integer arithmetic: calls that stay on fixnums, the
+// common case, calls whose results are promoted to bignums, and the
+// multiplication of bignums by the schoolbook and Karatsuba algorithms.
+//
+// usage: bench_bignum
+
+namespace {
+
+double time(const std::function<void()> &fn) {
+  const auto start = std::chrono::steady_clock::now();
+  fn();
+  const std::chrono::duration<double, std::milli> ms =
+      std::chrono::steady_clock::now() - start;
+  return ms.count();
+}
+
+const char *DEFINITIONS =
+    "(define (fib x) (if (< x 2) x (+ (fib (- x 1)) (fib (- x 2)))))"
+    "(define (sum n acc) (if (= n 0) acc (sum (- n 1) (+ acc n))))"
+    "(define (fib-iter a b count) (if (= count 0) b "
+    "(fib-iter (+ a b) a (- count 1))))"
+    "(define (fac n) (if (= n 0) 1 (* n (fac (- n 1)))))";
+
+double call(Interpreter::Engine engine, bool jit, const char *code) {
+  Interpreter interpreter(engine);
+  if (jit)
+    interpreter.enableJit();
+  Lexer l(DEFINITIONS);
+  Parser p(l);
+  for (const auto &form : p.read()) {
+    interpreter.eval(form);
+  }
+  Lexer cl(code);
+  Parser cp(cl);
+  const auto program = cp.read();
+  interpreter.eval(program.front());
+  return time([&] { interpreter.eval(program.front()); });
+}
+
+BigInt random(std::mt19937_64 &rng, size_t limbs) {
+  std::string digits;
+  // about 9.63 decimal digits per limb
+  for (size_t i = 0; i < limbs * 963 / 100; i++) {
+    digits += static_cast<char>('1' + rng() % 9);
+  }
+  return BigInt::fromString(digits.c_str());
+}
+
+} // namespace
+
+int main() {
+  printf("%-22s %10s %10s %10s\n", "call", "tree ms", "vm ms", "jit ms");
+  for (const auto code : {"(fib 25)", "(sum 1000000 0)", "(fib-iter 1 0 90)",
+                          "(fib-iter 1 0 10000)", "(fac 1000)"}) {
+    printf("%-22s %10.3f %10.3f %10.3f\n", code,
+           call(Interpreter::Engine::TREE, false, code),
+           call(Interpreter::Engine::BYTECODE, false, code),
+           call(Interpreter::Engine::BYTECODE, true, code));
+  }
+
+  printf("\n%-10s %14s %14s\n", "limbs", "schoolbook ms", "karatsuba ms");
+  std::mt19937_64 rng(1);
+  for (const size_t limbs : {16, 32, 64, 128, 256, 512, 1024, 4096}) {
+    const auto a = random(rng, limbs);
+    const auto b = random(rng, limbs);
+    const int reps = limbs < 512 ? 1000 : limbs < 4096 ? 20 : 2;
+    BigInt x;
+    BigInt y;
+    const auto schoolbook = time([&] {
+      for (int i = 0; i < reps; i++)
+        x = BigInt::multiplySchoolbook(a, b);
+    });
+    const auto karatsuba = time([&] {
+      for (int i = 0; i < reps; i++)
+        y = a * b;
+    });
+    printf("%-10zu %14.4f %14.4f%s\n", limbs, schoolbook / reps,
+           karatsuba / reps, x == y ? "" : "  MISMATCH");
+  }
+  return 0;
+}
@@ -0,0 +1,103 @@
+#include "Interpreter.h"
+#include "Lexer.h"
+#include "Parser.h"
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Cost of each builtin on both engines. An expression is evaluated once
+// per iteration of a tail recursive loop, the time of the loop evaluating
+// only its argument is subtracted. Best of five runs.
+//
+// usage: bench_builtins [iterations]
+
+namespace {
+
+struct Case {
+  const char *name;
+  const char *expr;
+};
+
+double run(Interpreter::Engine engine, const char *expr, int iterations) {
+  const auto code = std::string("(define (bench n x) (if (= n 0) x "
+                                "(bench (- n 1) ") +
+                    expr + ")))(bench " + std::to_string(iterations) + " 0)";
+  Lexer l(code.c_str());
+  Parser p(l);
+  const auto program = p.read();
+  Interpreter interpreter(engine);
+  interpreter.eval(program[0]);
+  double best = 0;
+  for (int i = 0; i < 5; i++) {
+    const auto start = std::chrono::steady_clock::now();
+    interpreter.eval(program[1]);
+    const std::chrono::duration<double, std::milli> ms =
+        std::chrono::steady_clock::now() - start;
+    if (0 == i || ms.count() < best)
+      best = ms.count();
+  }
+  return best;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const int iterations = argc > 1 ? std::stoi(argv[1]) : 1000000;
+  const std::vector<Case> cases{
+      {"+", "(+ n 1)"},
+      {"+ (3 args)", "(+ n 1 2)"},
+      {"-", "(- n 1)"},
+      {"*", "(* n 3)"},
+      {"/", "(/ n 3)"},
+      {"%", "(% n 3)"},
+      {"=", "(= n 1)"},
+      {"= (strings)", "(= \"a\" \"b\")"},
+      {">", "(> n 1)"},
+      {">=", "(>= n 1)"},
+      {"<", "(< n 1)"},
+      {"<= (3 args)", "(<= 1 n 3)"},
+      {"<=", "(<= n 1)"},
+      {"if", "(if n 1 2)"},
+      {"define", "(define x 1)"},
+      {"list", "(list 1 2 3)"},
+      {"head", "(head (list 1 2 3))"},
+      {"tail", "(tail (list 1 2 3))"},
+      {"join", "(join (list 1 2) (list 3))"},
+      {"eval", "(eval (list + 1 2))"},
+      {"pprint", "(pprint 1)"},
+  };
+
+  // pprint writes to stdout
+  std::ostringstream sink;
+  const auto out = std::cout.rdbuf(sink.rdbuf());
+  const auto engines = {Interpreter::Engine::TREE,
+                        Interpreter::Engine::BYTECODE};
+  std::vector<double> baseline;
+  for (const auto engine : engines) {
+    baseline.push_back(run(engine, "n", iterations));
+  }
+  std::vector<std::vector<double>> results;
+  for (const auto &c : cases) {
+    std::vector<double> row;
+    for (const auto engine : engines) {
+      row.push_back(run(engine, c.expr, iterations));
+    }
+    results.push_back(row);
+  }
+  std::cout.rdbuf(out);
+
+  printf("%d iterations, loop %.0f ms (tree) %.0f ms (vm)\n", iterations,
+         baseline[0], baseline[1]);
+  printf("%-12s %-28s %10s %10s\n", "builtin", "expression", "tree ns",
+         "vm ns");
+  for (size_t i = 0; i < cases.size(); i++) {
+    printf("%-12s %-28s %10.1f %10.1f\n", cases[i].name, cases[i].expr,
+           1e6 * (results[i][0] - baseline[0]) / iterations,
+           1e6 * (results[i][1] - baseline[1]) / iterations);
+  }
+  return 0;
+}
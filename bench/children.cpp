@@ -0,0 +1,77 @@
+#include "AllocCounter.h"
+#include "Lexer.h"
+#include "Parser.h"
+#include "StopWatch.h"
+#include "Util.h"
+
+#include <cstdio>
+#include <string>
+
+// Cost of visiting every node of the examples through the children view
+// against copying the child list, as AST::children() did before it
+// returned a reference.
+//
+// usage: bench_children [examples dir]
+
+namespace {
+
+const int REPEAT = 2000;
+
+struct Count {
+  size_t nodes = 0;
+  /// Reference count increments and decrements made by the copies
+  size_t refcounts = 0;
+};
+
+void walkView(const std::shared_ptr<AST> &node, Count &count) {
+  count.nodes++;
+  for (const auto &child : node->children()) {
+    walkView(child, count);
+  }
+}
+
+void walkCopy(const std::shared_ptr<AST> &node, Count &count) {
+  count.nodes++;
+  const AST::List children = node->children();
+  count.refcounts += 2 * children.size();
+  for (const auto &child : children) {
+    walkCopy(child, count);
+  }
+}
+
+template <class Walk>
+void run(const char *what, const AST::List &program, Walk walk) {
+  Count count;
+  const auto before = allocationCount();
+  StopWatch watch;
+  for (int i = 0; i < REPEAT; i++) {
+    for (const auto &e : program) {
+      walk(e, count);
+    }
+  }
+  const auto ms = watch.elapsed();
+  const auto allocations = allocationCount() - before;
+  printf("%-6s %10zu %14.2f %14.2f %10.1f\n", what, count.nodes,
+         static_cast<double>(allocations) / count.nodes,
+         static_cast<double>(count.refcounts) / count.nodes,
+         1e6 * ms / count.nodes);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const std::string examples = argc > 1 ? argv[1] : EXAMPLES_DIR;
+  std::string code;
+  for (const auto name : {"/fib.ls", "/pascal.ls", "/arithmetic.sl"}) {
+    code += util::readFile(examples + name);
+  }
+  Lexer l(code.c_str());
+  Parser p(l);
+  const auto program = p.read();
+
+  printf("%-6s %10s %14s %14s %10s\n", "walk", "nodes", "allocs/node",
+         "refcounts/node", "ns/node");
+  run("copy", program, walkCopy);
+  run("view", program, walkView);
+  return 0;
+}
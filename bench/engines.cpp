@@ -0,0 +1,71 @@
+#include "Interpreter.h"
+#include "Lexer.h"
+#include "Parser.h"
+#include "StopWatch.h"
+#include "Util.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Runs the same programs on the tree walker and on the bytecode VM
+//
+// usage: bench_engines [examples dir]
+
+struct Workload {
+  std::string name;
+  std::string code;
+  int repeat;
+};
+
+// Returns the elapsed ms, hitRate is set to the call cache hit rate
+static int run(Interpreter::Engine engine, const Workload &workload,
+               double &hitRate) {
+  Lexer l(workload.code.c_str());
+  Parser p(l);
+  const auto program = p.read();
+  StopWatch watch;
+  for (int i = 0; i < workload.repeat; i++) {
+    Interpreter interpreter(engine);
+    for (const auto &e : program) {
+      interpreter.eval(e);
+    }
+    hitRate = interpreter.callCacheStats().hitRate();
+  }
+  return watch.elapsed();
+}
+
+int main(int argc, char *argv[]) {
+  const std::string examples = argc > 1 ? argv[1] : EXAMPLES_DIR;
+  const std::string fib = "(define (fib x)"
+                          "  (if (< x 2) x (+ (fib (- x 1)) (fib (- x 2)))))";
+  const auto pascalFile = util::readFile(examples + "/pascal.ls");
+  // only the definitions of and, or and pascal
+  const auto pascal = pascalFile.substr(0, pascalFile.find("(pascal 0"));
+  const std::string loop = "(define (loop n acc)"
+                           "  (if (= n 0) acc (loop (- n 1) (+ acc 1))))";
+  const std::string deep = "(define (deep n)"
+                           "  (if (= n 0) 0 (+ 1 (deep (- n 1)))))";
+
+  const std::vector<Workload> workloads{
+      {"fib.ls", util::readFile(examples + "/fib.ls"), 20},
+      {"pascal.ls", pascalFile, 200},
+      {"arithmetic.sl", util::readFile(examples + "/arithmetic.sl"), 20000},
+      {"(fib 22)", fib + "(fib 22)", 1},
+      {"(pascal 14 7)", pascal + "(pascal 14 7)", 1},
+      {"(loop 100000 0)", loop + "(loop 100000 0)", 10},
+      {"(deep 2000)", deep + "(deep 2000)", 100},
+  };
+
+  printf("%-16s %10s %10s %8s %9s %9s\n", "workload", "tree ms", "vm ms",
+         "speedup", "tree hits", "vm hits");
+  for (const auto &workload : workloads) {
+    double treeHits, vmHits;
+    const auto tree = run(Interpreter::Engine::TREE, workload, treeHits);
+    const auto vm = run(Interpreter::Engine::BYTECODE, workload, vmHits);
+    printf("%-16s %10d %10d %7.2fx %8.1f%% %8.1f%%\n", workload.name.c_str(),
+           tree, vm, vm > 0 ? static_cast<double>(tree) / vm : 0.0,
+           100 * treeHits, 100 * vmHits);
+  }
+  return 0;
+}
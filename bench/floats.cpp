@@ -0,0 +1,102 @@
+#include "AllocCounter.h"
+#include "Interpreter.h"
+#include "Lexer.h"
+#include "Parser.h"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+// An escape time kernel over a 32x32 grid of the Mandelbrot set, in floats
+// and in fixed point fixnums scaled by 4096, on both engines. Reports the
+// time and the heap allocations per iteration of escape, which makes 13
+// arithmetic operations and comparisons. Floats are stored unboxed and
+// should allocate no more than fixnums.
+//
+// usage: bench_floats
+
+namespace {
+
+const char *FLOATS = R"(
+(define (escape cr ci zr zi n)
+  (if (= n 0)
+      0
+    (if (> (+ (* zr zr) (* zi zi)) 4.0)
+        n
+      (escape cr ci
+              (+ (- (* zr zr) (* zi zi)) cr)
+              (+ (* 2.0 (* zr zi)) ci)
+              (- n 1)))))
+(define (row cr ci k acc)
+  (if (= k 0)
+      acc
+    (row (+ cr 0.09375) ci (- k 1) (+ acc (escape cr ci 0.0 0.0 64)))))
+(define (grid ci k acc)
+  (if (= k 0)
+      acc
+    (grid (+ ci 0.09375) (- k 1) (+ acc (row -2.0 ci 32 0)))))
+)";
+
+const char *FIXED = R"(
+(define (escape cr ci zr zi n)
+  (if (= n 0)
+      0
+    (if (> (+ (/ (* zr zr) 4096) (/ (* zi zi) 4096)) 16384)
+        n
+      (escape cr ci
+              (+ (- (/ (* zr zr) 4096) (/ (* zi zi) 4096)) cr)
+              (+ (/ (* 2 (* zr zi)) 4096) ci)
+              (- n 1)))))
+(define (row cr ci k acc)
+  (if (= k 0)
+      acc
+    (row (+ cr 384) ci (- k 1) (+ acc (escape cr ci 0 0 64)))))
+(define (grid ci k acc)
+  (if (= k 0)
+      acc
+    (grid (+ ci 384) (- k 1) (+ acc (row -8192 ci 32 0)))))
+)";
+
+AST::List read(const std::string &code) {
+  Lexer l(code.c_str());
+  Parser p(l);
+  return p.read();
+}
+
+void run(Interpreter::Engine engine, const char *name, const char *code,
+         const char *call) {
+  Interpreter interpreter(engine);
+  for (const auto &e : read(code)) {
+    interpreter.eval(e);
+  }
+  const auto program = read(call);
+  // compile before counting
+  const auto res = interpreter.eval(program.front());
+  // escape returns the iterations left when the point escapes
+  const auto left = std::static_pointer_cast<ASTInt>(res)->data();
+  const auto iterations = 64 * 32 * 32 - left;
+
+  const auto before = allocationCount();
+  const auto start = std::chrono::steady_clock::now();
+  interpreter.eval(program.front());
+  const std::chrono::duration<double, std::milli> ms =
+      std::chrono::steady_clock::now() - start;
+  const auto allocations = allocationCount() - before;
+  printf("%-6s %-6s %10lld %10.2f %12zu %10.3f\n",
+         Interpreter::engineToCString(engine), name,
+         static_cast<long long>(iterations), ms.count(), allocations,
+         static_cast<double>(allocations) / iterations);
+}
+
+} // namespace
+
+int main() {
+  printf("%-6s %-6s %10s %10s %12s %10s\n", "engine", "kernel",
+         "iterations", "ms", "allocations", "per iter");
+  for (const auto engine :
+       {Interpreter::Engine::TREE, Interpreter::Engine::BYTECODE}) {
+    run(engine, "float", FLOATS, "(grid -1.5 32 0)");
+    run(engine, "fixed", FIXED, "(grid -6144 32 0)");
+  }
+  return 0;
+}
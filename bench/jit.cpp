@@ -0,0 +1,65 @@
+#include "Interpreter.h"
+#include "Lexer.h"
+#include "Parser.h"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+// Time of integer functions on both engines, without and with the Jit.
+// A warm-up call compiles the functions before the timed call.
+
+namespace {
+
+struct Case {
+  const char *fun;
+  const char *call;
+};
+
+double run(Interpreter::Engine engine, bool jit, const Case &c) {
+  const auto code = std::string(c.fun) + c.call;
+  Lexer l(code.c_str());
+  Parser p(l);
+  const auto program = p.read();
+  Interpreter interpreter(engine);
+  if (jit)
+    interpreter.enableJit();
+  for (size_t i = 0; i + 1 < program.size(); i++) {
+    interpreter.eval(program[i]);
+  }
+  interpreter.eval(program.back());
+  const auto start = std::chrono::steady_clock::now();
+  interpreter.eval(program.back());
+  const std::chrono::duration<double, std::milli> ms =
+      std::chrono::steady_clock::now() - start;
+  return ms.count();
+}
+
+} // namespace
+
+int main() {
+  if (!Jit::supported())
+    printf("no jit on this platform, the jit columns are interpreted\n");
+  const Case cases[] = {
+      {"(define (fib x) (if (< x 2) x (+ (fib (- x 1)) (fib (- x 2)))))",
+       "(fib 25)"},
+      {"(define (loop n acc) (if (= n 0) acc (loop (- n 1) (+ acc n))))",
+       "(loop 1000000 0)"},
+      {"(define (gcd a b) (if (= b 0) a (gcd b (% a b))))"
+       "(define (sum n acc) (if (= n 0) acc (sum (- n 1) (+ acc (gcd n 360)))))",
+       "(sum 100000 0)"},
+  };
+
+  printf("%-18s %12s %12s %12s %12s\n", "call", "tree ms", "tree jit",
+         "vm ms", "vm jit");
+  for (const auto &c : cases) {
+    printf("%-18s", c.call);
+    for (const auto engine :
+         {Interpreter::Engine::TREE, Interpreter::Engine::BYTECODE}) {
+      printf(" %12.3f", run(engine, false, c));
+      printf(" %12.3f", run(engine, true, c));
+    }
+    printf("\n");
+  }
+  return 0;
+}
@@ -0,0 +1,66 @@
+#include "Interpreter.h"
+#include "Lexer.h"
+#include "Parser.h"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+// Building a list an element at a time, appending with join and
+// prepending with cons, up to a million elements on both engines. Lists
+// share their structure, so each step takes time logarithmic in the
+// length of the list instead of copying it, the time per element should
+// grow slowly with the length. Also walks the list built with rest.
+//
+// usage: bench_lists
+
+namespace {
+
+const char *CODE = R"(
+(define (append n acc)
+  (if (= n 0) acc (append (- n 1) (join acc (list 1)))))
+(define (prepend n acc)
+  (if (= n 0) acc (prepend (- n 1) (cons n acc))))
+(define (walk xs n)
+  (if xs (walk (rest xs) (+ n 1)) n))
+)";
+
+AST::List read(const std::string &code) {
+  Lexer l(code.c_str());
+  Parser p(l);
+  return p.read();
+}
+
+double run(Interpreter &interpreter, const std::string &call) {
+  const auto program = read(call);
+  const auto start = std::chrono::steady_clock::now();
+  interpreter.eval(program.front());
+  const std::chrono::duration<double, std::milli> ms =
+      std::chrono::steady_clock::now() - start;
+  return ms.count();
+}
+
+} // namespace
+
+int main() {
+  printf("%-6s %-8s %10s %10s %10s %10s %10s\n", "engine", "elements",
+         "join ms", "cons ms", "rest ms", "ns/join", "ns/cons");
+  for (const auto engine :
+       {Interpreter::Engine::TREE, Interpreter::Engine::BYTECODE}) {
+    Interpreter interpreter(engine);
+    for (const auto &e : read(CODE)) {
+      interpreter.eval(e);
+    }
+    for (const int n : {1000, 10000, 100000, 1000000}) {
+      const auto count = std::to_string(n);
+      const auto join = run(interpreter, "(append " + count + " (list))");
+      const auto cons = run(interpreter, "(prepend " + count + " (list))");
+      const auto rest =
+          run(interpreter, "(walk (prepend " + count + " (list)) 0)") - cons;
+      printf("%-6s %-8d %10.1f %10.1f %10.1f %10.0f %10.0f\n",
+             Interpreter::engineToCString(engine), n, join, cons, rest,
+             join * 1e6 / n, cons * 1e6 / n);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,89 @@
+#include "Interpreter.h"
+#include "Lexer.h"
+#include "Parser.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+// Dictionaries of 1e3 to 1e6 fixnum keys as association lists, lists of
+// (key value) lists searched from the front, against persistent maps built
+// by hash-set and transient maps filled in place, and the time to make the
+// filled map persistent. Reports the time to build each and the time per
+// lookup, the lists are searched fewer times as they grow.
+//
+// usage: bench_maps
+
+namespace {
+
+const char *CODE = R"(
+(define (alist n acc)
+  (if (= n 0) acc (alist (- n 1) (cons (cons n (cons n (list))) acc))))
+(define (assoc xs k)
+  (if (= (head (head xs)) k) (tail (head xs)) (assoc (rest xs) k)))
+(define (find-all xs i n acc)
+  (if (= i 0) acc
+    (find-all xs (- i 1) n (+ acc (assoc xs (+ 1 (% (* i 104729) n)))))))
+(define (persistent-map n acc)
+  (if (= n 0) acc (persistent-map (- n 1) (hash-set acc n n))))
+(define (fill n acc)
+  (if (= n 0) acc (fill (- n 1) (hash-set acc n n))))
+(define (get-all m i n acc)
+  (if (= i 0) acc
+    (get-all m (- i 1) n (+ acc (hash-get m (+ 1 (% (* i 104729) n)))))))
+)";
+
+AST::List read(const std::string &code) {
+  Lexer l(code.c_str());
+  Parser p(l);
+  return p.read();
+}
+
+/// Evaluate call and keep its value in the global named name
+double run(Interpreter &interpreter, const std::string &call,
+           const char *name = nullptr) {
+  const auto program = read(call);
+  const auto start = std::chrono::steady_clock::now();
+  const auto res = interpreter.eval(program.front());
+  const std::chrono::duration<double, std::milli> ms =
+      std::chrono::steady_clock::now() - start;
+  if (name)
+    interpreter.environment()->setEntry(SymbolTable::intern(name), res);
+  return ms.count();
+}
+
+} // namespace
+
+int main() {
+  Interpreter interpreter;
+  for (const auto &e : read(CODE)) {
+    interpreter.eval(e);
+  }
+  printf("%-8s %10s %10s %10s %10s %12s %10s %10s\n", "entries", "alist ms",
+         "hash ms", "fill ms", "persist ms", "alist ns/get", "hash ns/get",
+         "fill ns/get");
+  for (const int n : {1000, 10000, 100000, 1000000}) {
+    const auto count = std::to_string(n);
+    const auto alist = run(interpreter, "(alist " + count + " (list))", "xs");
+    const auto hash =
+        run(interpreter, "(persistent-map " + count + " (hash))", "m");
+    const auto transient =
+        run(interpreter, "(fill " + count + " (transient (hash)))", "t");
+    const auto persistent = run(interpreter, "(persistent t)");
+    const int searches = std::max(10, 1000000 / n);
+    const int lookups = 100000;
+    const auto find = run(interpreter, "(find-all xs " +
+                                           std::to_string(searches) + " " +
+                                           count + " 0)");
+    const auto get = run(interpreter, "(get-all m " + std::to_string(lookups) +
+                                          " " + count + " 0)");
+    const auto getTransient =
+        run(interpreter,
+            "(get-all t " + std::to_string(lookups) + " " + count + " 0)");
+    printf("%-8d %10.1f %10.1f %10.1f %10.1f %12.0f %10.0f %10.0f\n", n,
+           alist, hash, transient, persistent, find * 1e6 / searches,
+           get * 1e6 / lookups, getTransient * 1e6 / lookups);
+  }
+  return 0;
+}
@@ -0,0 +1,67 @@
+#include "Interpreter.h"
+#include "Lexer.h"
+#include "Parser.h"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+// Time of exponential recursions defined by define and by define-memo on
+// both engines. Each run starts with an empty memo. The plain definitions
+// are skipped for the large arguments.
+
+namespace {
+
+struct Case {
+  const char *name;
+  const char *fun;
+  const char *call;
+  bool plain;
+};
+
+double run(Interpreter::Engine engine, const std::string &define,
+           const Case &c) {
+  const auto code = "(" + define + " " + c.fun + ")" + c.call;
+  Lexer l(code.c_str());
+  Parser p(l);
+  const auto program = p.read();
+  Interpreter interpreter(engine);
+  interpreter.eval(program[0]);
+  const auto start = std::chrono::steady_clock::now();
+  interpreter.eval(program[1]);
+  const std::chrono::duration<double, std::milli> ms =
+      std::chrono::steady_clock::now() - start;
+  return ms.count();
+}
+
+} // namespace
+
+int main() {
+  const char *fib = "(fib x) (if (< x 2) x (+ (fib (- x 1)) (fib (- x 2))))";
+  const char *pascal =
+      "(pascal row col) (if (< col 0) 0 (if (< row 0) 0 (if (= row 0) 1 "
+      "(if (= col 0) 1 (+ (pascal (- row 1) col) "
+      "(pascal (- row 1) (+ 1 col)))))))";
+  const Case cases[] = {
+      {"(fib 25)", fib, "(fib 25)", true},
+      {"(pascal 20 1)", pascal, "(pascal 20 1)", true},
+      {"(fib 40)", fib, "(fib 40)", false},
+      {"(pascal 25 1)", pascal, "(pascal 25 1)", false},
+  };
+
+  printf("%-14s %12s %12s %12s %12s\n", "call", "tree ms", "tree memo",
+         "vm ms", "vm memo");
+  for (const auto &c : cases) {
+    printf("%-14s", c.name);
+    for (const auto engine :
+         {Interpreter::Engine::TREE, Interpreter::Engine::BYTECODE}) {
+      if (c.plain)
+        printf(" %12.3f", run(engine, "define", c));
+      else
+        printf(" %12s", "-");
+      printf(" %12.3f", run(engine, "define-memo", c));
+    }
+    printf("\n");
+  }
+  return 0;
+}
@@ -0,0 +1,75 @@
+#include "Interpreter.h"
+#include "Lexer.h"
+#include "Optimizer.h"
+#include "Parser.h"
+#include "Util.h"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Evaluation time of programs as parsed and as rewritten by the Optimizer,
+// on both engines. The optimization itself is not timed.
+//
+// usage: bench_optimizer [examples dir]
+
+namespace {
+
+struct Workload {
+  std::string name;
+  std::string code;
+  int repeat;
+};
+
+double run(Interpreter::Engine engine, const AST::List &program,
+           int repeat) {
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < repeat; i++) {
+    Interpreter interpreter(engine);
+    for (const auto &e : program) {
+      interpreter.eval(e);
+    }
+  }
+  const std::chrono::duration<double, std::milli> ms =
+      std::chrono::steady_clock::now() - start;
+  return ms.count();
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const std::string examples = argc > 1 ? argv[1] : EXAMPLES_DIR;
+  // a generated config, constants used by a function called in a loop
+  const std::string config =
+      "(define width 640)(define height 480)(define scale 2)"
+      "(define (pixel n) (+ (% n width) (* scale (+ 1 2 (/ 10 3)))"
+      "  (if (> width height) (* width scale) (* height scale))))"
+      "(define (loop n acc) (if (= n 0) acc"
+      "  (loop (- n 1) (+ acc (pixel n)))))"
+      "(loop 100000 0)";
+  const std::vector<Workload> workloads{
+      {"arithmetic.sl", util::readFile(examples + "/arithmetic.sl"), 20000},
+      {"fib.ls", util::readFile(examples + "/fib.ls"), 20},
+      {"config", config, 1},
+  };
+
+  printf("%-14s %10s %10s %10s %10s %7s %7s %7s\n", "workload", "tree ms",
+         "tree opt", "vm ms", "vm opt", "folded", "pruned", "propag");
+  for (const auto &workload : workloads) {
+    Lexer l(workload.code.c_str());
+    Parser p(l);
+    const auto program = p.read();
+    Optimizer optimizer;
+    const auto optimized = optimizer.optimize(program);
+    printf("%-14s", workload.name.c_str());
+    for (const auto engine :
+         {Interpreter::Engine::TREE, Interpreter::Engine::BYTECODE}) {
+      printf(" %10.2f", run(engine, program, workload.repeat));
+      printf(" %10.2f", run(engine, optimized, workload.repeat));
+    }
+    const auto &stats = optimizer.stats();
+    printf(" %7zu %7zu %7zu\n", stats.folded, stats.pruned, stats.propagated);
+  }
+  return 0;
+}
@@ -0,0 +1,59 @@
+#include "Interpreter.h"
+#include "Lexer.h"
+#include "Parser.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+// Scaling of pmap and preduce with the number of threads: fib of 20 for
+// each of the elements of a list, and the sum of those, on 1, 2, 4 and 8
+// threads. The speedup can not exceed the number of cores, printed first.
+//
+// usage: bench_parallel [elements]
+
+namespace {
+
+const char *CODE = R"(
+(define (fib x) (if (< x 2) x (+ (fib (- x 1)) (fib (- x 2)))))
+(define (repeat x n acc) (if (= n 0) acc (repeat x (- n 1) (cons x acc))))
+)";
+
+AST::List read(const std::string &code) {
+  Lexer l(code.c_str());
+  Parser p(l);
+  return p.read();
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const int elements = argc > 1 ? atoi(argv[1]) : 256;
+  printf("%u cores, %d elements\n", std::thread::hardware_concurrency(),
+         elements);
+  printf("%-8s %10s %10s\n", "threads", "ms", "speedup");
+  const auto program = read("(preduce + 0 (pmap fib (repeat 20 " +
+                            std::to_string(elements) + " (list))))");
+  double serial = 0;
+  for (const unsigned threads : {1, 2, 4, 8}) {
+    Interpreter interpreter;
+    for (const auto &e : read(CODE)) {
+      interpreter.eval(e);
+    }
+    interpreter.setThreads(threads);
+    // the workers are started by the first call
+    interpreter.eval(read("(pmap fib (repeat 1 64 (list)))").front());
+    const auto start = std::chrono::steady_clock::now();
+    const auto res = interpreter.eval(program.front());
+    const std::chrono::duration<double, std::milli> ms =
+        std::chrono::steady_clock::now() - start;
+    if (std::static_pointer_cast<ASTInt>(res)->data() != 6765 * elements)
+      printf("wrong sum\n");
+    if (1 == threads)
+      serial = ms.count();
+    printf("%-8u %10.1f %10.2f\n", threads, ms.count(), serial / ms.count());
+  }
+  return 0;
+}
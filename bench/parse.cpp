@@ -0,0 +1,89 @@
+#include "AllocCounter.h"
+#include "Arena.h"
+#include "Lexer.h"
+#include "Parser.h"
+#include "StopWatch.h"
+
+#include <cstdio>
+#include <string>
+
+// Parse throughput of a large generated script, into separate nodes by
+// Parser::read and into an arena by Parser::readArena. The time includes
+// releasing the result.
+//
+// usage: bench_parse [MB]
+
+namespace {
+
+/// Definitions and calls in the style of a generated script
+std::string generate(size_t bytes) {
+  std::string code;
+  for (int i = 0; code.size() < bytes; i++) {
+    const auto n = std::to_string(i);
+    code += "(define (generated-" + n + " a b)\n"
+            "  (if (< a " + n + ")\n"
+            "      (+ a (* b " + n + ") (- " + n + " 1))\n"
+            "    (join (list a b \"value " + n + "\") (list true false))))\n"
+            "(generated-" + n + " " + n + " 42)\n";
+  }
+  return code;
+}
+
+struct Result {
+  int ms;
+  size_t allocations;
+  size_t nodes;
+};
+
+template <class Read> Result best(Read read) {
+  Result res{0, 0, 0};
+  for (int i = 0; i < 3; i++) {
+    const auto before = allocationCount();
+    StopWatch watch;
+    const auto nodes = read();
+    const auto ms = watch.elapsed();
+    if (0 == i || ms < res.ms)
+      res = Result{ms, allocationCount() - before, nodes};
+  }
+  return res;
+}
+
+void report(const char *what, const Result &res, double mb) {
+  printf("%-12s %8d %10.1f %14zu %12.2f\n", what, res.ms,
+         res.ms > 0 ? mb * 1000 / res.ms : 0.0, res.allocations,
+         static_cast<double>(res.allocations) / res.nodes);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const size_t megabytes = argc > 1 ? std::stoul(argv[1]) : 8;
+  const auto code = generate(megabytes << 20);
+  const auto mb = static_cast<double>(code.size()) / (1 << 20);
+
+  size_t arenaBytes = 0;
+  const auto tree = best([&code] {
+    Lexer l(code.c_str());
+    Parser p(l);
+    const auto program = p.read();
+    return program.size();
+  });
+  const auto arena = best([&code, &arenaBytes] {
+    Lexer l(code.c_str());
+    Parser p(l);
+    const auto arena = p.readArena();
+    arenaBytes = arena.bytes();
+    return arena.size();
+  });
+  // read returns the forms, both parsers make the same number of nodes
+  const auto forms = tree.nodes;
+  const auto nodes = arena.nodes;
+
+  printf("%.1f MB, %zu forms, %zu nodes, arena %.1f MB\n", mb, forms, nodes,
+         static_cast<double>(arenaBytes) / (1 << 20));
+  printf("%-12s %8s %10s %14s %12s\n", "parser", "ms", "MB/s", "allocations",
+         "allocs/node");
+  report("read", Result{tree.ms, tree.allocations, nodes}, mb);
+  report("readArena", arena, mb);
+  return 0;
+}
@@ -0,0 +1,110 @@
+#include "AllocCounter.h"
+#include "AST.h"
+#include "Printer.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+
+// Printing a list of 1e6 integers and a list of 1e6 forms (i "i" i.5),
+// into a string and to /dev/null, against the per node ostream and
+// toString path util::print took before Printer. Reports the throughput
+// and the heap allocations per element of each.
+//
+// usage: bench_printer
+
+namespace {
+
+const int N = 1000000;
+
+template <typename Fn> double timed(Fn fn) {
+  const auto start = std::chrono::steady_clock::now();
+  fn();
+  const std::chrono::duration<double, std::milli> ms =
+      std::chrono::steady_clock::now() - start;
+  return ms.count();
+}
+
+/// The way util::print wrote a list before Printer
+void printThroughOstream(std::ostream &out, const std::shared_ptr<AST> &node) {
+  if (AST::Type::SEXPR == node->type()) {
+    out << "(";
+    bool first = true;
+    for (const auto &child : node->children()) {
+      if (!first)
+        out << " ";
+      first = false;
+      printThroughOstream(out, child);
+    }
+    out << ")";
+    return;
+  }
+  out << node->toString();
+}
+
+void run(const char *name, const ASTList &list) {
+  std::string res;
+  const auto bytes = [&list] {
+    std::string out;
+    Printer(out).print(list);
+    return out.size();
+  }();
+
+  auto before = allocationCount();
+  res.reserve(bytes);
+  const auto stringMs = timed([&] { Printer(res).print(list); });
+  const auto stringAllocs = allocationCount() - before;
+
+  const int fd = open("/dev/null", O_WRONLY);
+  before = allocationCount();
+  const auto fdMs = timed([&] {
+    Printer printer(fd);
+    printer.print(list);
+  });
+  const auto fdAllocs = allocationCount() - before;
+  close(fd);
+
+  std::ofstream null("/dev/null");
+  before = allocationCount();
+  const auto ostreamMs = timed([&] {
+    null << "(list";
+    list.data().forEach([&null](const std::shared_ptr<AST> &element) {
+      null << " ";
+      printThroughOstream(null, element);
+    });
+    null << ")" << std::endl;
+  });
+  const auto ostreamAllocs = allocationCount() - before;
+
+  const auto row = [bytes](const char *sink, double ms, size_t allocs) {
+    printf("  %-10s %10.1f %10.1f %14.3f\n", sink, ms, bytes / 1e3 / ms,
+           static_cast<double>(allocs) / N);
+  };
+  printf("%s, %zu bytes\n", name, bytes);
+  printf("  %-10s %10s %10s %14s\n", "sink", "ms", "MB/s", "allocs/element");
+  row("string", stringMs, stringAllocs);
+  row("fd", fdMs, fdAllocs);
+  row("ostream", ostreamMs, ostreamAllocs);
+}
+
+} // namespace
+
+int main() {
+  PersistentList::Elements ints;
+  PersistentList::Elements forms;
+  for (int i = 0; i < N; i++) {
+    ints.push_back(std::make_shared<ASTInt>(i));
+    auto form = std::make_shared<ASTSexpr>();
+    form->addChild(std::make_shared<ASTInt>(i));
+    form->addChild(std::make_shared<ASTString>(std::to_string(i).c_str()));
+    form->addChild(std::make_shared<ASTFloat>(i + 0.5));
+    forms.push_back(std::move(form));
+  }
+  run("integers", ASTList(PersistentList(ints.begin(), ints.end())));
+  run("forms", ASTList(PersistentList(forms.begin(), forms.end())));
+  return 0;
+}
@@ -0,0 +1,74 @@
+#include "Interpreter.h"
+#include "Lexer.h"
+#include "Parser.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+// Scaling of spawn and sync with the number of threads: fib by spawning
+// the first of its two recursive calls, on 1, 2, 4 and 8 threads, next to
+// fib without spawn. The speedup can not exceed the number of cores,
+// printed first.
+//
+// usage: bench_spawn [n]
+
+namespace {
+
+const char *CODE = R"(
+(define (fib x) (if (< x 2) x (+ (fib (- x 1)) (fib (- x 2)))))
+(define (join2 a b) (+ (sync a) b))
+(define (pfib x) (if (< x 2) x (join2 (spawn (pfib (- x 1))) (pfib (- x 2)))))
+)";
+
+AST::List read(const std::string &code) {
+  Lexer l(code.c_str());
+  Parser p(l);
+  return p.read();
+}
+
+double run(Interpreter &interpreter, const std::string &code) {
+  const auto program = read(code);
+  const auto start = std::chrono::steady_clock::now();
+  interpreter.eval(program.front());
+  const std::chrono::duration<double, std::milli> ms =
+      std::chrono::steady_clock::now() - start;
+  return ms.count();
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const int n = argc > 1 ? atoi(argv[1]) : 30;
+  printf("%u cores, fib %d\n", std::thread::hardware_concurrency(), n);
+  printf("%-8s %10s %8s %10s %10s %8s %10s\n", "threads", "ms", "speedup",
+         "tasks", "inlined", "steals", "idle ms");
+  double serial = 0;
+  {
+    Interpreter interpreter;
+    for (const auto &e : read(CODE)) {
+      interpreter.eval(e);
+    }
+    serial = run(interpreter, "(fib " + std::to_string(n) + ")");
+    printf("%-8s %10.1f\n", "fib", serial);
+  }
+  for (const unsigned threads : {1, 2, 4, 8}) {
+    Interpreter interpreter;
+    for (const auto &e : read(CODE)) {
+      interpreter.eval(e);
+    }
+    interpreter.setThreads(threads);
+    const auto ms = run(interpreter, "(pfib " + std::to_string(n) + ")");
+    Scheduler::Stats stats;
+    if (interpreter.scheduler())
+      stats = interpreter.scheduler()->stats();
+    printf("%-8u %10.1f %8.2f %10llu %10llu %8llu %10.1f\n", threads, ms,
+           serial / ms, static_cast<unsigned long long>(stats.tasks),
+           static_cast<unsigned long long>(stats.inlined),
+           static_cast<unsigned long long>(stats.steals),
+           stats.idleSeconds * 1000);
+  }
+  return 0;
+}
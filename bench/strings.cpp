@@ -0,0 +1,74 @@
+#include "AllocCounter.h"
+#include "Interpreter.h"
+#include "Lexer.h"
+#include "Parser.h"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+// Building a 10 MB string by concat of pieces of 10, 100 and 1000 chars,
+// against appending the pieces to a std::string. Reports the throughput
+// and the heap allocations per concat. Ropes merge short pieces into
+// leaves of up to Rope::LEAF chars, so each concat copies at most a leaf
+// and the nodes on the path to it.
+//
+// usage: bench_strings
+
+namespace {
+
+const size_t TOTAL = 10 * 1000 * 1000;
+
+const char *CODE = R"(
+(define (build s n acc)
+  (if (= n 0) acc (build s (- n 1) (concat acc s))))
+)";
+
+AST::List read(const std::string &code) {
+  Lexer l(code.c_str());
+  Parser p(l);
+  return p.read();
+}
+
+double native(const std::string &piece, size_t count) {
+  const auto start = std::chrono::steady_clock::now();
+  std::string res;
+  for (size_t i = 0; i < count; i++) {
+    res += piece;
+  }
+  const std::chrono::duration<double, std::milli> ms =
+      std::chrono::steady_clock::now() - start;
+  if (res.size() != TOTAL)
+    printf("wrong size\n");
+  return ms.count();
+}
+
+} // namespace
+
+int main() {
+  Interpreter interpreter;
+  for (const auto &e : read(CODE)) {
+    interpreter.eval(e);
+  }
+  printf("%-6s %10s %10s %10s %10s %12s\n", "piece", "concats", "ms",
+         "MB/s", "C++ ms", "allocs/concat");
+  for (const size_t size : {10, 100, 1000}) {
+    const std::string piece(size, 'x');
+    const auto count = TOTAL / size;
+    const auto program = read("(string-length (build \"" + piece + "\" " +
+                              std::to_string(count) + " \"\"))");
+    const auto before = allocationCount();
+    const auto start = std::chrono::steady_clock::now();
+    const auto res = interpreter.eval(program.front());
+    const std::chrono::duration<double, std::milli> ms =
+        std::chrono::steady_clock::now() - start;
+    const auto allocations = allocationCount() - before;
+    if (static_cast<size_t>(std::static_pointer_cast<ASTInt>(res)->data()) !=
+        TOTAL)
+      printf("wrong size\n");
+    printf("%-6zu %10zu %10.1f %10.1f %10.1f %12.2f\n", size, count,
+           ms.count(), TOTAL / 1e3 / ms.count(), native(piece, count),
+           static_cast<double>(allocations) / count);
+  }
+  return 0;
+}
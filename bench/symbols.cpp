@@ -0,0 +1,140 @@
+#include "AllocCounter.h"
+#include "Environment.h"
+#include "Lexer.h"
+#include "Parser.h"
+#include "StopWatch.h"
+
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+// Lookup throughput of interned symbols against the strcmp keyed map the
+// Environment used before, and allocations made while parsing symbols.
+
+namespace {
+
+/// The Environment as it was before symbols were interned
+class StrEnvironment {
+public:
+  explicit StrEnvironment(const StrEnvironment *parent = nullptr)
+      : parent(parent) {}
+  ~StrEnvironment() {
+    for (const auto &e : env) {
+      free(const_cast<char *>(e.first));
+    }
+  }
+  void setEntry(const char *symbol, std::shared_ptr<AST> node) {
+    env[strdup(symbol)] = node;
+  }
+  std::shared_ptr<AST> operator[](const char *symbol) const {
+    const auto it = env.find(symbol);
+    if (it != env.end())
+      return it->second;
+    return parent ? (*parent)[symbol] : nullptr;
+  }
+
+private:
+  struct cmp_str {
+    bool operator()(char const *a, char const *b) const {
+      return std::strcmp(a, b) < 0;
+    }
+  };
+  std::map<const char *, std::shared_ptr<AST>, cmp_str> env;
+  const StrEnvironment *parent;
+};
+
+const int GLOBALS = 64;
+const int DEPTH = 30;
+const int LOOKUPS = 4000000;
+
+std::vector<std::string> globalNames() {
+  std::vector<std::string> names;
+  for (int i = 0; i < GLOBALS; i++) {
+    names.emplace_back("global-function-" + std::to_string(i));
+  }
+  return names;
+}
+
+void report(const char *what, int ms) {
+  printf("%-34s %8d ms %10.1f Mlookups/s\n", what, ms,
+         ms > 0 ? LOOKUPS / (ms * 1000.0) : 0.0);
+}
+
+void benchStrings(const std::vector<std::string> &names) {
+  auto value = std::make_shared<ASTInt>(1);
+  StrEnvironment globals;
+  for (const auto &name : names) {
+    globals.setEntry(name.c_str(), value);
+  }
+  std::vector<std::unique_ptr<StrEnvironment>> frames;
+  const StrEnvironment *scope = &globals;
+  for (int i = 0; i < DEPTH; i++) {
+    frames.emplace_back(new StrEnvironment(scope));
+    frames.back()->setEntry("x", value);
+    scope = frames.back().get();
+  }
+
+  // the parser hands out fresh copies of the names
+  std::vector<std::string> keys(names);
+  size_t found = 0;
+  StopWatch global;
+  for (int i = 0; i < LOOKUPS; i++) {
+    found += nullptr != globals[keys[i % GLOBALS].c_str()];
+  }
+  report("strcmp map, global", global.elapsed());
+  StopWatch deep;
+  for (int i = 0; i < LOOKUPS; i++) {
+    found += nullptr != (*scope)[keys[i % GLOBALS].c_str()];
+  }
+  report("strcmp map, global from depth 30", deep.elapsed());
+  if (found != 2 * LOOKUPS)
+    printf("lookup failed\n");
+}
+
+void benchSymbols(const std::vector<std::string> &names) {
+  auto value = std::make_shared<ASTInt>(1);
+  Environment globals;
+  std::vector<Symbol> keys;
+  for (const auto &name : names) {
+    keys.emplace_back(SymbolTable::intern(name.c_str()));
+    globals.setEntry(keys.back(), value);
+  }
+
+  // globals are a cell per symbol and frames do not chain, so a global is
+  // found the same way at any call depth
+  size_t found = 0;
+  StopWatch global;
+  for (int i = 0; i < LOOKUPS; i++) {
+    found += static_cast<bool>(globals[keys[i % GLOBALS]]);
+  }
+  report("interned, global", global.elapsed());
+  if (found != LOOKUPS)
+    printf("lookup failed\n");
+}
+
+void benchParse() {
+  std::string code;
+  for (int i = 0; i < 10000; i++) {
+    code += "(fib (- x 1) acc-" + std::to_string(i % 100) + ")\n";
+  }
+  const auto before = allocationCount();
+  Lexer l(code.c_str());
+  Parser p(l);
+  const auto program = p.read();
+  const auto allocations = allocationCount() - before;
+  printf("parse: %zu allocations for %zu forms, %.2f per form\n",
+         allocations, program.size(),
+         static_cast<double>(allocations) / program.size());
+}
+
+} // namespace
+
+int main() {
+  const auto names = globalNames();
+  benchStrings(names);
+  benchSymbols(names);
+  benchParse();
+  return 0;
+}
@@ -0,0 +1,87 @@
+#include "Interpreter.h"
+#include "Lexer.h"
+#include "Parser.h"
+#include "Util.h"
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <string>
+
+// Operand checks the type inference eliminates in the functions of the
+// examples, then the time of calls on the tree engine with and without it.
+//
+// usage: bench_types [examples dir]
+
+namespace {
+
+double time(const std::function<void()> &fn) {
+  const auto start = std::chrono::steady_clock::now();
+  fn();
+  const std::chrono::duration<double, std::milli> ms =
+      std::chrono::steady_clock::now() - start;
+  return ms.count();
+}
+
+AST::List read(const std::string &code) {
+  Lexer l(code.c_str());
+  Parser p(l);
+  return p.read();
+}
+
+void load(Interpreter &interpreter, const std::string &file) {
+  for (const auto &form : read(util::readFile(file))) {
+    try {
+      interpreter.eval(form);
+    } catch (const std::exception &) {
+      // some examples use forms the interpreter does not know
+    }
+  }
+}
+
+double call(bool inference, const std::string &file, const char *code) {
+  Interpreter interpreter;
+  interpreter.setTypeInference(inference);
+  load(interpreter, file);
+  const auto program = read(code);
+  interpreter.eval(program.front());
+  return time([&] {
+    for (int i = 0; i < 5; i++)
+      interpreter.eval(program.front());
+  }) / 5;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  const std::string examples = argc > 1 ? argv[1] : EXAMPLES_DIR;
+
+  printf("%-18s %10s %10s %10s %10s\n", "example", "functions", "typed",
+         "checks", "eliminated");
+  TypeInference::Stats total;
+  for (const char *name : {"add.ls", "arithmetic.sl", "fib.ls",
+                           "headAndTails.sl", "hi.ls", "pascal.ls"}) {
+    Interpreter interpreter;
+    load(interpreter, examples + "/" + name);
+    const auto &stats = interpreter.typeInferenceStats();
+    printf("%-18s %10zu %10zu %10zu %10zu\n", name, stats.functions,
+           stats.typed, stats.checks, stats.eliminated);
+    total.functions += stats.functions;
+    total.typed += stats.typed;
+    total.checks += stats.checks;
+    total.eliminated += stats.eliminated;
+  }
+  printf("%-18s %10zu %10zu %10zu %10zu\n", "total", total.functions,
+         total.typed, total.checks, total.eliminated);
+
+  printf("\n%-18s %10s %10s\n", "call", "typed ms", "checked ms");
+  const auto fib = examples + "/fib.ls";
+  const auto pascal = examples + "/pascal.ls";
+  for (const auto &c : {std::make_pair(&fib, "(fib 22)"),
+                        std::make_pair(&fib, "(fib2 40)"),
+                        std::make_pair(&pascal, "(pascal 16 8)")}) {
+    printf("%-18s %10.3f %10.3f\n", c.second, call(true, *c.first, c.second),
+           call(false, *c.first, c.second));
+  }
+  return 0;
+}
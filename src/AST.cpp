@@ -1,4 +1,7 @@
 #include "AST.h"
+#include "Printer.h"
+
+#include <string>
 
 const char *builtinToCString(Builtin op) {
   switch (op) {
@@ -14,6 +17,8 @@ const char *builtinToCString(Builtin op) {
     return "%";
   case Builtin::DEFINE:
     return "define";
+  case Builtin::DEFINE_MEMO:
+    return "define-memo";
   case Builtin::LIST:
     return "list";
   case Builtin::HEAD:
@@ -38,6 +43,56 @@ const char *builtinToCString(Builtin op) {
     return "<";
   case Builtin::LE:
     return "<=";
+  case Builtin::ARRAY:
+    return "array";
+  case Builtin::MAKE_ARRAY:
+    return "make-array";
+  case Builtin::ARRAY_GET:
+    return "array-get";
+  case Builtin::ARRAY_SLICE:
+    return "array-slice";
+  case Builtin::ARRAY_LENGTH:
+    return "array-length";
+  case Builtin::CONS:
+    return "cons";
+  case Builtin::REST:
+    return "rest";
+  case Builtin::CONCAT:
+    return "concat";
+  case Builtin::SUBSTRING:
+    return "substring";
+  case Builtin::STRING_LENGTH:
+    return "string-length";
+  case Builtin::STRING_TO_LIST:
+    return "string->list";
+  case Builtin::HASH:
+    return "hash";
+  case Builtin::HASH_GET:
+    return "hash-get";
+  case Builtin::HASH_SET:
+    return "hash-set";
+  case Builtin::HASH_REMOVE:
+    return "hash-remove";
+  case Builtin::HASH_SIZE:
+    return "hash-size";
+  case Builtin::HASH_KEYS:
+    return "hash-keys";
+  case Builtin::HASH_VALUES:
+    return "hash-values";
+  case Builtin::TRANSIENT:
+    return "transient";
+  case Builtin::PERSISTENT:
+    return "persistent";
+  case Builtin::PMAP:
+    return "pmap";
+  case Builtin::PFILTER:
+    return "pfilter";
+  case Builtin::PREDUCE:
+    return "preduce";
+  case Builtin::SPAWN:
+    return "spawn";
+  case Builtin::SYNC:
+    return "sync";
 
   case Builtin::UNKNOWN:
     return "UNKNOWN";
@@ -59,6 +114,8 @@ Builtin builtinFromCString(const char *str) {
     return Builtin::MOD;
   } else if (0 == strcmp("define", str)) {
     return Builtin::DEFINE;
+  } else if (0 == strcmp("define-memo", str)) {
+    return Builtin::DEFINE_MEMO;
   } else if (0 == strcmp("list", str)) {
     return Builtin::LIST;
   } else if (0 == strcmp("head", str)) {
@@ -83,7 +140,70 @@ Builtin builtinFromCString(const char *str) {
     return Builtin::LT;
   } else if (0 == strcmp("<=", str)) {
     return Builtin::LE;
+  } else if (0 == strcmp("array", str)) {
+    return Builtin::ARRAY;
+  } else if (0 == strcmp("make-array", str)) {
+    return Builtin::MAKE_ARRAY;
+  } else if (0 == strcmp("array-get", str)) {
+    return Builtin::ARRAY_GET;
+  } else if (0 == strcmp("array-slice", str)) {
+    return Builtin::ARRAY_SLICE;
+  } else if (0 == strcmp("array-length", str)) {
+    return Builtin::ARRAY_LENGTH;
+  } else if (0 == strcmp("cons", str)) {
+    return Builtin::CONS;
+  } else if (0 == strcmp("rest", str)) {
+    return Builtin::REST;
+  } else if (0 == strcmp("concat", str)) {
+    return Builtin::CONCAT;
+  } else if (0 == strcmp("substring", str)) {
+    return Builtin::SUBSTRING;
+  } else if (0 == strcmp("string-length", str)) {
+    return Builtin::STRING_LENGTH;
+  } else if (0 == strcmp("string->list", str)) {
+    return Builtin::STRING_TO_LIST;
+  } else if (0 == strcmp("hash", str)) {
+    return Builtin::HASH;
+  } else if (0 == strcmp("hash-get", str)) {
+    return Builtin::HASH_GET;
+  } else if (0 == strcmp("hash-set", str)) {
+    return Builtin::HASH_SET;
+  } else if (0 == strcmp("hash-remove", str)) {
+    return Builtin::HASH_REMOVE;
+  } else if (0 == strcmp("hash-size", str)) {
+    return Builtin::HASH_SIZE;
+  } else if (0 == strcmp("hash-keys", str)) {
+    return Builtin::HASH_KEYS;
+  } else if (0 == strcmp("hash-values", str)) {
+    return Builtin::HASH_VALUES;
+  } else if (0 == strcmp("transient", str)) {
+    return Builtin::TRANSIENT;
+  } else if (0 == strcmp("persistent", str)) {
+    return Builtin::PERSISTENT;
+  } else if (0 == strcmp("pmap", str)) {
+    return Builtin::PMAP;
+  } else if (0 == strcmp("pfilter", str)) {
+    return Builtin::PFILTER;
+  } else if (0 == strcmp("preduce", str)) {
+    return Builtin::PREDUCE;
+  } else if (0 == strcmp("spawn", str)) {
+    return Builtin::SPAWN;
+  } else if (0 == strcmp("sync", str)) {
+    return Builtin::SYNC;
   }
 
   return Builtin::UNKNOWN;
 }
+
+std::string AST::toString() const {
+  std::string res;
+  Printer(res).print(*this);
+  return res;
+}
+
+Builtin builtinFromSymbol(Symbol symbol) {
+  // the builtins are interned first, see SymbolTable
+  if (symbol < static_cast<Symbol>(Builtin::UNKNOWN))
+    return static_cast<Builtin>(symbol);
+  return Builtin::UNKNOWN;
+}
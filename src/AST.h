@@ -1,9 +1,24 @@
 #ifndef AST_H_
 #define AST_H_
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
 #include <memory>
 #include <string.h>
+#include <string>
+#include <utility>
 #include <vector>
 
+#include "BigInt.h"
+#include "HashMap.h"
+#include "PersistentList.h"
+#include "PersistentMap.h"
+#include "Rope.h"
+#include "Symbol.h"
+#include "TypedArray.h"
+
+class Task;
+
 enum class Builtin {
   ADD,
   SUB,
@@ -11,6 +26,7 @@ enum class Builtin {
   MUL,
   MOD,
   DEFINE,
+  DEFINE_MEMO,
   LIST,
   HEAD,
   TAIL,
@@ -23,18 +39,59 @@ enum class Builtin {
   GE,
   LT,
   LE,
+  ARRAY,
+  MAKE_ARRAY,
+  ARRAY_GET,
+  ARRAY_SLICE,
+  ARRAY_LENGTH,
+  CONS,
+  REST,
+  CONCAT,
+  SUBSTRING,
+  STRING_LENGTH,
+  STRING_TO_LIST,
+  HASH,
+  HASH_GET,
+  HASH_SET,
+  HASH_REMOVE,
+  HASH_SIZE,
+  HASH_KEYS,
+  HASH_VALUES,
+  TRANSIENT,
+  PERSISTENT,
+  PMAP,
+  PFILTER,
+  PREDUCE,
+  SPAWN,
+  SYNC,
   UNKNOWN,
   // TODO && || etc
 };
 
 const char *builtinToCString(Builtin op);
 Builtin builtinFromCString(const char *str);
+Builtin builtinFromSymbol(Symbol symbol);
 
 class AST {
 public:
   using List = std::vector<std::shared_ptr<AST>>;
   // TODO: move to Atom
-  enum class Type { SEXPR, SYMBOL, INTEGER, STRING, BOOLEAN, BUILTIN, FUN };
+  enum class Type {
+    SEXPR,
+    SYMBOL,
+    INTEGER,
+    BIGNUM,
+    FLOAT,
+    ARRAY,
+    LIST,
+    MAP,
+    TRANSIENT_MAP,
+    STRING,
+    BOOLEAN,
+    BUILTIN,
+    FUN,
+    FUTURE
+  };
 
   explicit AST(Type type) : type_(type) {}
   virtual ~AST(){};
@@ -42,9 +99,15 @@ public:
   Type type() const { return type_; };
   void setType(const Type &type) { type_ = type; };
 
-  void setChildren(List children) { children_ = children; }
-  void addChild(std::shared_ptr<AST> child) { children_.push_back(child); }
-  List children() { return children_; }
+  /// Building a node
+  /// @{
+  void setChildren(List children) { children_ = std::move(children); }
+  void addChild(std::shared_ptr<AST> child) {
+    children_.push_back(std::move(child));
+  }
+  /// @}
+  /// The children without copying, valid as long as the node is
+  const List &children() const { return children_; }
   std::shared_ptr<AST> head() const { return children_.front(); }
 
   std::shared_ptr<AST> &operator[](std::size_t idx) { return children_[idx]; }
@@ -60,6 +123,18 @@ public:
       return "SYMBOL";
     case Type::INTEGER:
       return "INTEGER";
+    case Type::BIGNUM:
+      return "BIGNUM";
+    case Type::FLOAT:
+      return "FLOAT";
+    case Type::ARRAY:
+      return "ARRAY";
+    case Type::LIST:
+      return "LIST";
+    case Type::MAP:
+      return "MAP";
+    case Type::TRANSIENT_MAP:
+      return "TRANSIENT_MAP";
     case Type::STRING:
       return "STRING";
     case Type::BOOLEAN:
@@ -68,16 +143,27 @@ public:
       return "BUILTIN";
     case Type::FUN:
       return "FUN";
+    case Type::FUTURE:
+      return "FUTURE";
     }
     return "WHAT HAVE YOU DONE";
   }
 
-  virtual const char *toString() { return TypeToCString(type()); }
+  /// The printed form, as Printer writes it
+  std::string toString() const;
 
   virtual bool isBuiltin(Builtin /* not used */) const { return false; }
 
+  /// Set by TypeInference on the nodes of function bodies whose types are
+  /// known in calls passing the entry check of the function
+  /// @{
+  bool proven() const { return proven_; }
+  void setProven(bool proven) { proven_ = proven; }
+  /// @}
+
 private:
   Type type_;
+  bool proven_ = false;
   List children_;
 };
 
@@ -96,54 +182,110 @@ protected:
   DataType data_;
 };
 
-// TODO: toString leaks
-class ASTInt : public ASTDataNode<int, AST::Type::INTEGER> {
+class ASTInt : public ASTDataNode<int64_t, AST::Type::INTEGER> {
 public:
-  explicit ASTInt(int data) : ASTDataNode(data){};
-  const char *toString() override {
-    char buf[1024];
-    snprintf(buf, 1024, "%d", data());
-    return strdup(buf);
+  explicit ASTInt(int64_t data) : ASTDataNode(data){};
+};
+
+/// An integer that does not fit in an ASTInt
+class ASTBignum : public ASTDataNode<BigInt, AST::Type::BIGNUM> {
+public:
+  explicit ASTBignum(BigInt data) : ASTDataNode(std::move(data)){};
+};
+
+class ASTFloat : public ASTDataNode<double, AST::Type::FLOAT> {
+public:
+  explicit ASTFloat(double data) : ASTDataNode(data){};
+  /// The shortest digits reading back as d, with a point or an exponent
+  /// so they are not read as an integer
+  static void format(double d, char (&buf)[32]) {
+    snprintf(buf, sizeof(buf), "%.15g", d);
+    if (strtod(buf, nullptr) != d)
+      snprintf(buf, sizeof(buf), "%.17g", d);
+    if (!strpbrk(buf, ".eni"))
+      strcat(buf, ".0");
   }
 };
 
+/// Printed as the form building it, (array 1 2 3)
+class ASTArray : public ASTDataNode<TypedArray, AST::Type::ARRAY> {
+public:
+  explicit ASTArray(TypedArray data) : ASTDataNode(std::move(data)){};
+};
+
+/// The value of list, join and cons, printed as (list a b c)
+class ASTList : public ASTDataNode<PersistentList, AST::Type::LIST> {
+public:
+  explicit ASTList(PersistentList data) : ASTDataNode(std::move(data)){};
+  PersistentList &list() { return data_; }
+};
+
+/// The value of hash, printed as (hash k v ...)
+class ASTMap : public ASTDataNode<PersistentMap, AST::Type::MAP> {
+public:
+  explicit ASTMap(PersistentMap data) : ASTDataNode(std::move(data)){};
+};
+
+/// The value of transient, changed in place by hash-set and hash-remove,
+/// printed as (transient (hash k v ...))
+class ASTTransientMap : public ASTDataNode<HashMap, AST::Type::TRANSIENT_MAP> {
+public:
+  explicit ASTTransientMap(HashMap data) : ASTDataNode(std::move(data)){};
+  HashMap &map() { return data_; }
+};
+
 class ASTBoolean : public ASTDataNode<bool, AST::Type::BOOLEAN> {
 public:
   explicit ASTBoolean(bool data) : ASTDataNode(data){};
-  const char *toString() override {
-    char buf[1024];
-    snprintf(buf, 1024, "%s", data() ? "true" : "false");
-    return strdup(buf);
-  }
 };
 
-class ASTSymbol : public ASTDataNode<const char *, AST::Type::SYMBOL> {
+class ASTSymbol : public ASTDataNode<Symbol, AST::Type::SYMBOL> {
 public:
-  explicit ASTSymbol(const char *data) : ASTDataNode(strdup(data)){};
-  virtual ~ASTSymbol() { free(const_cast<char *>(data_)); };
-  const char *toString() override {
-    char buf[1024];
-    snprintf(buf, 1024, "%s", data());
-    return strdup(buf);
+  /// Where a reference is found, resolved when its function is defined
+  enum class Scope { UNRESOLVED, ARGUMENT, GLOBAL };
+
+  explicit ASTSymbol(Symbol data) : ASTDataNode(data){};
+  explicit ASTSymbol(const char *name)
+      : ASTDataNode(SymbolTable::intern(name)){};
+  const char *name() const { return SymbolTable::name(data()); }
+
+  Scope scope() const { return scope_; }
+  /// Frame slot of an ARGUMENT
+  unsigned int slot() const { return slot_; }
+  void resolve(Scope scope, unsigned int slot = 0) {
+    scope_ = scope;
+    slot_ = slot;
   }
+
+  /// Inline cache of a call with this symbol as head. The function the
+  /// symbol was bound to, valid while the globals have the same version.
+  /// @{
+  const AST *cachedFunction(uint64_t version) const {
+    return version == cacheVersion ? cachedFun : nullptr;
+  }
+  void cacheFunction(const AST *fun, uint64_t version) {
+    cachedFun = fun;
+    cacheVersion = version;
+  }
+  /// @}
+
+private:
+  Scope scope_ = Scope::UNRESOLVED;
+  unsigned int slot_ = 0;
+  const AST *cachedFun = nullptr;
+  uint64_t cacheVersion = 0;
 };
 
-class ASTString : public ASTDataNode<const char *, AST::Type::STRING> {
+class ASTString : public ASTDataNode<Rope, AST::Type::STRING> {
 public:
-  explicit ASTString(const char *data) : ASTDataNode(strdup(data)){};
-  virtual ~ASTString() { free(const_cast<char *>(data_)); };
-  const char *toString() override {
-    char buf[1024];
-    snprintf(buf, 1024, "\"%s\"", data());
-    return strdup(buf);
-  }
+  explicit ASTString(const char *data) : ASTDataNode(Rope(data)){};
+  explicit ASTString(Rope data) : ASTDataNode(std::move(data)){};
 };
 
 class ASTBuiltin : public AST {
 public:
   explicit ASTBuiltin(Builtin op) : AST(Type::BUILTIN), op_(op) {}
   Builtin op() const { return op_; }
-  const char *toString() override { return builtinToCString(op()); }
   virtual bool isBuiltin(Builtin op) const override { return op == op_; }
 
 private:
@@ -157,4 +299,12 @@ public:
 private:
 };
 
+/// The value of spawn, the call it runs on the Scheduler, printed as
+/// <future>
+class ASTFuture : public ASTDataNode<std::shared_ptr<Task>, AST::Type::FUTURE> {
+public:
+  explicit ASTFuture(std::shared_ptr<Task> data)
+      : ASTDataNode(std::move(data)){};
+};
+
 #endif /* !AST_H_ */
@@ -0,0 +1,112 @@
+#include "Arena.h"
+
+#include <cassert>
+#include <cstring>
+
+NodeId Arena::add(const Node &node) {
+  nodes.push_back(node);
+  return nodes.size() - 1;
+}
+
+NodeId Arena::addInteger(int64_t integer) {
+  Node node{AST::Type::INTEGER, 0, {}};
+  node.integer = integer;
+  return add(node);
+}
+
+NodeId Arena::addFloat(double floating) {
+  Node node{AST::Type::FLOAT, 0, {}};
+  node.floating = floating;
+  return add(node);
+}
+
+NodeId Arena::addBoolean(bool boolean) {
+  Node node{AST::Type::BOOLEAN, 0, {}};
+  node.boolean = boolean;
+  return add(node);
+}
+
+NodeId Arena::addSymbol(Symbol symbol) {
+  Node node{AST::Type::SYMBOL, 0, {}};
+  node.symbol = symbol;
+  return add(node);
+}
+
+NodeId Arena::addBuiltin(Builtin op) {
+  Node node{AST::Type::BUILTIN, 0, {}};
+  node.op = op;
+  return add(node);
+}
+
+NodeId Arena::addBignum(const char *digits) {
+  const auto id = addString(digits);
+  nodes[id].type = AST::Type::BIGNUM;
+  return id;
+}
+
+NodeId Arena::addString(const char *string) {
+  Node node{AST::Type::STRING, 0, {}};
+  node.string = strings.size();
+  strings.insert(strings.end(), string, string + strlen(string) + 1);
+  return add(node);
+}
+
+NodeId Arena::addSexpr(const NodeId *ids, uint32_t size) {
+  Node node{AST::Type::SEXPR, size, {}};
+  node.children = children.size();
+  children.insert(children.end(), ids, ids + size);
+  return add(node);
+}
+
+size_t Arena::bytes() const {
+  return nodes.size() * sizeof(Node) + children.size() * sizeof(NodeId) +
+         strings.size() + roots_.size() * sizeof(NodeId);
+}
+
+std::shared_ptr<AST> Arena::toAST(NodeId id) const {
+  const auto &node = nodes[id];
+  switch (node.type) {
+  case AST::Type::INTEGER:
+    return std::make_shared<ASTInt>(node.integer);
+  case AST::Type::FLOAT:
+    return std::make_shared<ASTFloat>(node.floating);
+  case AST::Type::BIGNUM:
+    return std::make_shared<ASTBignum>(BigInt::fromString(string(id)));
+  case AST::Type::BOOLEAN:
+    return std::make_shared<ASTBoolean>(node.boolean);
+  case AST::Type::SYMBOL:
+    return std::make_shared<ASTSymbol>(node.symbol);
+  case AST::Type::BUILTIN:
+    return std::make_shared<ASTBuiltin>(node.op);
+  case AST::Type::STRING:
+    return std::make_shared<ASTString>(string(id));
+  case AST::Type::SEXPR: {
+    AST::List ls;
+    ls.reserve(node.size);
+    for (uint32_t i = 0; i < node.size; i++) {
+      ls.emplace_back(toAST(child(id, i)));
+    }
+    const auto ret = std::make_shared<ASTSexpr>();
+    ret->setChildren(std::move(ls));
+    return ret;
+  }
+  case AST::Type::ARRAY:
+  case AST::Type::LIST:
+  case AST::Type::MAP:
+  case AST::Type::TRANSIENT_MAP:
+  case AST::Type::FUN:
+  case AST::Type::FUTURE:
+    break;
+  }
+  assert(false && "the parser makes no functions or collections");
+  return nullptr;
+}
+
+AST::List Arena::toAST() const {
+  AST::List res;
+  res.reserve(roots_.size());
+  for (const auto root : roots_) {
+    res.emplace_back(toAST(root));
+  }
+  return res;
+}
@@ -0,0 +1,78 @@
+#ifndef ARENA_H_
+#define ARENA_H_
+#include "AST.h"
+#include "Symbol.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/// Index of a node in an Arena
+using NodeId = uint32_t;
+
+/// Compact tree made by Parser::readArena. The nodes are stored
+/// contiguously, the children of an expression are a range of 32-bit ids
+/// and the payload of a leaf is stored in its node. Everything is released
+/// at once with the arena.
+class Arena {
+public:
+  struct Node {
+    AST::Type type;
+    /// Number of children of a SEXPR
+    uint32_t size;
+    union {
+      int64_t integer;
+      double floating;
+      bool boolean;
+      Symbol symbol;
+      Builtin op;
+      /// Offset of a STRING, or the digits of a BIGNUM, in the string pool
+      uint32_t string;
+      /// Offset of the first child id of a SEXPR
+      uint32_t children;
+    };
+  };
+
+  NodeId addInteger(int64_t integer);
+  /// An integer too large for a node, stored as its digits
+  NodeId addBignum(const char *digits);
+  NodeId addFloat(double floating);
+  NodeId addBoolean(bool boolean);
+  NodeId addSymbol(Symbol symbol);
+  NodeId addBuiltin(Builtin op);
+  NodeId addString(const char *string);
+  /// Add a SEXPR, the children are copied
+  NodeId addSexpr(const NodeId *children, uint32_t size);
+  /// Add a top-level expression
+  void addRoot(NodeId id) { roots_.push_back(id); }
+
+  const Node &operator[](NodeId id) const { return nodes[id]; }
+  /// Child number idx of a SEXPR
+  NodeId child(NodeId id, uint32_t idx) const {
+    return children[nodes[id].children + idx];
+  }
+  /// The string of a STRING or the digits of a BIGNUM
+  /// The string of a STRING or the digits of a BIGNUM
+  const char *string(NodeId id) const { return &strings[nodes[id].string]; }
+  /// The top-level expressions in the order they were read
+  const std::vector<NodeId> &roots() const { return roots_; }
+  size_t size() const { return nodes.size(); }
+
+  /// Bytes used by nodes, child ids and strings
+  size_t bytes() const;
+
+  /// Build the node tree the Interpreter evaluates
+  std::shared_ptr<AST> toAST(NodeId id) const;
+  /// The top-level expressions as nodes
+  AST::List toAST() const;
+
+private:
+  NodeId add(const Node &node);
+
+  std::vector<Node> nodes;
+  std::vector<NodeId> children;
+  std::vector<char> strings;
+  std::vector<NodeId> roots_;
+};
+
+#endif /* !ARENA_H_ */
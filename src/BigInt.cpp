@@ -0,0 +1,376 @@
+#include "BigInt.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+
+namespace {
+
+using Limbs = std::vector<uint32_t>;
+
+const uint64_t BASE = uint64_t(1) << 32;
+/// Largest power of ten in a limb, the digits are converted in chunks
+const uint32_t DECIMAL_BASE = 1000000000;
+const unsigned int DECIMAL_DIGITS = 9;
+
+void trim(Limbs &xs) {
+  while (!xs.empty() && 0 == xs.back())
+    xs.pop_back();
+}
+
+/// Length of xs[0, n) without leading zero limbs
+size_t trimmed(const uint32_t *xs, size_t n) {
+  while (n && 0 == xs[n - 1])
+    n--;
+  return n;
+}
+
+int compareMagnitudes(const Limbs &a, const Limbs &b) {
+  if (a.size() != b.size())
+    return a.size() < b.size() ? -1 : 1;
+  for (size_t i = a.size(); i-- > 0;) {
+    if (a[i] != b[i])
+      return a[i] < b[i] ? -1 : 1;
+  }
+  return 0;
+}
+
+Limbs addMagnitudes(const uint32_t *a, size_t na, const uint32_t *b,
+                    size_t nb) {
+  if (na < nb) {
+    std::swap(a, b);
+    std::swap(na, nb);
+  }
+  Limbs res(na + 1);
+  uint64_t carry = 0;
+  for (size_t i = 0; i < na; i++) {
+    carry += uint64_t(a[i]) + (i < nb ? b[i] : 0);
+    res[i] = static_cast<uint32_t>(carry);
+    carry >>= 32;
+  }
+  res[na] = static_cast<uint32_t>(carry);
+  trim(res);
+  return res;
+}
+
+/// a -= b, the magnitude of a is not less than that of b
+void subtractMagnitude(Limbs &a, const Limbs &b) {
+  int64_t borrow = 0;
+  for (size_t i = 0; i < a.size(); i++) {
+    int64_t d = int64_t(a[i]) - borrow - (i < b.size() ? b[i] : 0);
+    borrow = d < 0;
+    a[i] = static_cast<uint32_t>(d + (borrow ? BASE : 0));
+    if (!borrow && i >= b.size())
+      break;
+  }
+  assert(!borrow);
+  trim(a);
+}
+
+/// acc += xs << (32 * shift), acc is large enough for the sum
+void addShifted(Limbs &acc, const Limbs &xs, size_t shift) {
+  uint64_t carry = 0;
+  size_t i = 0;
+  for (; i < xs.size(); i++) {
+    carry += uint64_t(acc[i + shift]) + xs[i];
+    acc[i + shift] = static_cast<uint32_t>(carry);
+    carry >>= 32;
+  }
+  for (i += shift; carry; i++) {
+    carry += acc[i];
+    acc[i] = static_cast<uint32_t>(carry);
+    carry >>= 32;
+  }
+}
+
+Limbs schoolbook(const uint32_t *a, size_t na, const uint32_t *b,
+                 size_t nb) {
+  Limbs res(na + nb);
+  for (size_t i = 0; i < na; i++) {
+    uint64_t carry = 0;
+    const uint64_t x = a[i];
+    for (size_t j = 0; j < nb; j++) {
+      carry += x * b[j] + res[i + j];
+      res[i + j] = static_cast<uint32_t>(carry);
+      carry >>= 32;
+    }
+    res[i + nb] = static_cast<uint32_t>(carry);
+  }
+  trim(res);
+  return res;
+}
+
+/// With a = a1 B^m + a0 and b = b1 B^m + b0, ab is
+/// a1b1 B^2m + ((a0 + a1)(b0 + b1) - a0b0 - a1b1) B^m + a0b0
+Limbs karatsuba(const uint32_t *a, size_t na, const uint32_t *b, size_t nb) {
+  if (na < nb) {
+    std::swap(a, b);
+    std::swap(na, nb);
+  }
+  if (nb < BigInt::KARATSUBA_THRESHOLD)
+    return schoolbook(a, na, b, nb);
+
+  const size_t m = (na + 1) / 2;
+  Limbs res(na + nb + 1);
+  if (nb <= m) {
+    // b is short, multiply the halves of a by it
+    addShifted(res, karatsuba(a, trimmed(a, m), b, nb), 0);
+    addShifted(res, karatsuba(a + m, na - m, b, nb), m);
+    trim(res);
+    return res;
+  }
+  const size_t na0 = trimmed(a, m);
+  const size_t nb0 = trimmed(b, m);
+  const auto z0 = karatsuba(a, na0, b, nb0);
+  const auto z2 = karatsuba(a + m, na - m, b + m, nb - m);
+  const auto sa = addMagnitudes(a, na0, a + m, na - m);
+  const auto sb = addMagnitudes(b, nb0, b + m, nb - m);
+  auto z1 = karatsuba(sa.data(), sa.size(), sb.data(), sb.size());
+  subtractMagnitude(z1, z0);
+  subtractMagnitude(z1, z2);
+  addShifted(res, z0, 0);
+  addShifted(res, z1, m);
+  addShifted(res, z2, 2 * m);
+  trim(res);
+  return res;
+}
+
+/// xs = xs * factor + addend
+void multiplyAdd(Limbs &xs, uint32_t factor, uint32_t addend) {
+  uint64_t carry = addend;
+  for (auto &x : xs) {
+    carry += uint64_t(x) * factor;
+    x = static_cast<uint32_t>(carry);
+    carry >>= 32;
+  }
+  if (carry)
+    xs.push_back(static_cast<uint32_t>(carry));
+}
+
+/// xs /= divisor, the remainder is returned
+uint32_t divideSmall(Limbs &xs, uint32_t divisor) {
+  uint64_t rem = 0;
+  for (size_t i = xs.size(); i-- > 0;) {
+    const uint64_t cur = (rem << 32) | xs[i];
+    xs[i] = static_cast<uint32_t>(cur / divisor);
+    rem = cur % divisor;
+  }
+  trim(xs);
+  return static_cast<uint32_t>(rem);
+}
+
+/// Knuth's algorithm D, u has at least as many limbs as v and v at least
+/// two
+void divideMagnitudes(const Limbs &u, const Limbs &v, Limbs &q, Limbs &r) {
+  const size_t n = v.size();
+  const size_t m = u.size();
+  // normalize so the top limb of the divisor has its high bit set
+  unsigned int s = 0;
+  while (!(v[n - 1] << s & 0x80000000u))
+    s++;
+  Limbs vn(n);
+  for (size_t i = n - 1; i > 0; i--)
+    vn[i] = (v[i] << s) | (s ? v[i - 1] >> (32 - s) : 0);
+  vn[0] = v[0] << s;
+  Limbs un(m + 1);
+  un[m] = s ? u[m - 1] >> (32 - s) : 0;
+  for (size_t i = m - 1; i > 0; i--)
+    un[i] = (u[i] << s) | (s ? u[i - 1] >> (32 - s) : 0);
+  un[0] = u[0] << s;
+
+  q.assign(m - n + 1, 0);
+  for (size_t j = m - n + 1; j-- > 0;) {
+    const uint64_t num = (uint64_t(un[j + n]) << 32) | un[j + n - 1];
+    uint64_t qhat = num / vn[n - 1];
+    uint64_t rhat = num % vn[n - 1];
+    while (qhat >= BASE ||
+           qhat * vn[n - 2] > ((rhat << 32) | un[j + n - 2])) {
+      qhat--;
+      rhat += vn[n - 1];
+      if (rhat >= BASE)
+        break;
+    }
+    // un[j, j + n] -= qhat * vn
+    int64_t borrow = 0;
+    uint64_t carry = 0;
+    for (size_t i = 0; i < n; i++) {
+      const uint64_t p = qhat * vn[i] + carry;
+      carry = p >> 32;
+      const int64_t t = int64_t(un[i + j]) - borrow - int64_t(p & 0xffffffff);
+      un[i + j] = static_cast<uint32_t>(t);
+      borrow = t < 0;
+    }
+    const int64_t t = int64_t(un[j + n]) - borrow - int64_t(carry);
+    un[j + n] = static_cast<uint32_t>(t);
+    if (t < 0) {
+      // qhat was one too large, add the divisor back
+      qhat--;
+      uint64_t c = 0;
+      for (size_t i = 0; i < n; i++) {
+        c += uint64_t(un[i + j]) + vn[i];
+        un[i + j] = static_cast<uint32_t>(c);
+        c >>= 32;
+      }
+      un[j + n] += static_cast<uint32_t>(c);
+    }
+    q[j] = static_cast<uint32_t>(qhat);
+  }
+  trim(q);
+
+  r.resize(n);
+  for (size_t i = 0; i < n; i++)
+    r[i] = (un[i] >> s) | (s ? un[i + 1] << (32 - s) : 0);
+  trim(r);
+}
+
+} // namespace
+
+BigInt::BigInt(int64_t value) : negative(value < 0) {
+  uint64_t magnitude =
+      negative ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+  while (magnitude) {
+    limbs.push_back(static_cast<uint32_t>(magnitude));
+    magnitude >>= 32;
+  }
+}
+
+BigInt::BigInt(bool negative, Limbs limbs)
+    : negative(negative), limbs(std::move(limbs)) {
+  trim(this->limbs);
+  if (this->limbs.empty())
+    this->negative = false;
+}
+
+BigInt BigInt::fromString(const char *str) {
+  bool negative = false;
+  if ('-' == *str) {
+    negative = true;
+    str++;
+  }
+  Limbs limbs;
+  while (*str >= '0' && *str <= '9') {
+    uint32_t chunk = 0;
+    uint32_t factor = 1;
+    for (unsigned int i = 0;
+         i < DECIMAL_DIGITS && *str >= '0' && *str <= '9'; i++, str++) {
+      chunk = chunk * 10 + static_cast<uint32_t>(*str - '0');
+      factor *= 10;
+    }
+    multiplyAdd(limbs, factor, chunk);
+  }
+  return BigInt(negative, std::move(limbs));
+}
+
+bool BigInt::fitsInt64() const {
+  if (limbs.size() > 2)
+    return false;
+  const uint64_t limit = uint64_t(1) << 63;
+  const uint64_t magnitude =
+      limbs.empty() ? 0
+                    : limbs[0] | (limbs.size() > 1 ? uint64_t(limbs[1]) << 32
+                                                   : 0);
+  return negative ? magnitude <= limit : magnitude < limit;
+}
+
+int64_t BigInt::toInt64() const {
+  assert(fitsInt64());
+  uint64_t magnitude = 0;
+  for (size_t i = limbs.size(); i-- > 0;)
+    magnitude = magnitude << 32 | limbs[i];
+  return static_cast<int64_t>(negative ? 0 - magnitude : magnitude);
+}
+
+double BigInt::toDouble() const {
+  double res = 0;
+  for (size_t i = limbs.size(); i-- > 0;)
+    res = res * static_cast<double>(BASE) + limbs[i];
+  return negative ? -res : res;
+}
+
+std::string BigInt::toString() const {
+  if (limbs.empty())
+    return "0";
+  auto xs = limbs;
+  std::vector<uint32_t> chunks;
+  while (!xs.empty())
+    chunks.push_back(divideSmall(xs, DECIMAL_BASE));
+  std::string res = negative ? "-" : "";
+  res += std::to_string(chunks.back());
+  char buf[DECIMAL_DIGITS + 1];
+  for (size_t i = chunks.size() - 1; i-- > 0;) {
+    snprintf(buf, sizeof(buf), "%09u", chunks[i]);
+    res += buf;
+  }
+  return res;
+}
+
+size_t BigInt::hash() const {
+  size_t hash = negative;
+  for (const auto limb : limbs)
+    hash ^= limb + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+  return hash;
+}
+
+BigInt BigInt::add(const BigInt &a, const BigInt &b, bool subtract) {
+  const bool bNegative = b.negative != subtract;
+  if (a.negative == bNegative)
+    return BigInt(a.negative, addMagnitudes(a.limbs.data(), a.limbs.size(),
+                                            b.limbs.data(), b.limbs.size()));
+  // the signs differ, subtract the smaller magnitude
+  if (compareMagnitudes(a.limbs, b.limbs) >= 0) {
+    auto limbs = a.limbs;
+    subtractMagnitude(limbs, b.limbs);
+    return BigInt(a.negative, std::move(limbs));
+  }
+  auto limbs = b.limbs;
+  subtractMagnitude(limbs, a.limbs);
+  return BigInt(bNegative, std::move(limbs));
+}
+
+BigInt operator+(const BigInt &a, const BigInt &b) {
+  return BigInt::add(a, b, false);
+}
+
+BigInt operator-(const BigInt &a, const BigInt &b) {
+  return BigInt::add(a, b, true);
+}
+
+BigInt operator*(const BigInt &a, const BigInt &b) {
+  return BigInt(a.negative != b.negative,
+                karatsuba(a.limbs.data(), a.limbs.size(), b.limbs.data(),
+                          b.limbs.size()));
+}
+
+BigInt BigInt::operator-() const { return BigInt(!negative, limbs); }
+
+BigInt BigInt::multiplySchoolbook(const BigInt &a, const BigInt &b) {
+  return BigInt(a.negative != b.negative,
+                schoolbook(a.limbs.data(), a.limbs.size(), b.limbs.data(),
+                           b.limbs.size()));
+}
+
+void BigInt::divide(const BigInt &a, const BigInt &b, BigInt &quotient,
+                    BigInt &remainder) {
+  assert(!b.isZero());
+  Limbs q;
+  Limbs r;
+  if (compareMagnitudes(a.limbs, b.limbs) < 0) {
+    r = a.limbs;
+  } else if (1 == b.limbs.size()) {
+    q = a.limbs;
+    const auto rem = divideSmall(q, b.limbs[0]);
+    if (rem)
+      r.push_back(rem);
+  } else {
+    divideMagnitudes(a.limbs, b.limbs, q, r);
+  }
+  quotient = BigInt(a.negative != b.negative, std::move(q));
+  remainder = BigInt(a.negative, std::move(r));
+}
+
+int BigInt::compare(const BigInt &a, const BigInt &b) {
+  if (a.negative != b.negative)
+    return a.negative ? -1 : 1;
+  const auto res = compareMagnitudes(a.limbs, b.limbs);
+  return a.negative ? -res : res;
+}
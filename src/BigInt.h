@@ -0,0 +1,68 @@
+#ifndef BIGINT_H_
+#define BIGINT_H_
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// Arbitrary precision integer, the sign and the magnitude in 32 bit limbs,
+/// least significant first and without leading zero limbs. Division
+/// truncates and the remainder has the sign of the dividend, as for int64_t.
+class BigInt {
+public:
+  /// Operands with fewer limbs are multiplied by the schoolbook algorithm,
+  /// larger ones by Karatsuba's
+  static const size_t KARATSUBA_THRESHOLD = 32;
+
+  BigInt() = default;
+  explicit BigInt(int64_t value);
+  /// Parse decimal digits with an optional leading minus, reading stops at
+  /// the first other character
+  static BigInt fromString(const char *str);
+
+  bool isZero() const { return limbs.empty(); }
+  bool isNegative() const { return negative; }
+  bool fitsInt64() const;
+  /// The value, which must fit
+  int64_t toInt64() const;
+  /// The value as a double, infinite beyond its range
+  double toDouble() const;
+  std::string toString() const;
+  size_t hash() const;
+  /// Number of limbs of the magnitude
+  size_t size() const { return limbs.size(); }
+
+  friend BigInt operator+(const BigInt &a, const BigInt &b);
+  friend BigInt operator-(const BigInt &a, const BigInt &b);
+  friend BigInt operator*(const BigInt &a, const BigInt &b);
+  BigInt operator-() const;
+
+  /// The product by the schoolbook algorithm only, for tests and
+  /// benchmarks of the multiplication
+  static BigInt multiplySchoolbook(const BigInt &a, const BigInt &b);
+  /// Truncated quotient and remainder of a by a nonzero b
+  static void divide(const BigInt &a, const BigInt &b, BigInt &quotient,
+                     BigInt &remainder);
+
+  /// Negative, zero or positive as a is less, equal or greater than b
+  static int compare(const BigInt &a, const BigInt &b);
+  bool operator==(const BigInt &other) const {
+    return negative == other.negative && limbs == other.limbs;
+  }
+  bool operator!=(const BigInt &other) const { return !(*this == other); }
+  bool operator<(const BigInt &other) const {
+    return compare(*this, other) < 0;
+  }
+
+private:
+  using Limbs = std::vector<uint32_t>;
+
+  BigInt(bool negative, Limbs limbs);
+  /// a + b with the sign of b flipped if subtract
+  static BigInt add(const BigInt &a, const BigInt &b, bool subtract);
+
+  bool negative = false;
+  Limbs limbs;
+};
+
+#endif /* !BIGINT_H_ */
@@ -0,0 +1,113 @@
+#include "Bytecode.h"
+#include "Util.h"
+
+#include <cassert>
+#include <iostream>
+
+const char *opCodeToCString(OpCode op) {
+  switch (op) {
+  case OpCode::CONST:
+    return "CONST";
+  case OpCode::LOAD_ARG:
+    return "LOAD_ARG";
+  case OpCode::LOAD_GLOBAL:
+    return "LOAD_GLOBAL";
+  case OpCode::ADD:
+    return "ADD";
+  case OpCode::SUB:
+    return "SUB";
+  case OpCode::MUL:
+    return "MUL";
+  case OpCode::DIV:
+    return "DIV";
+  case OpCode::MOD:
+    return "MOD";
+  case OpCode::EQ:
+    return "EQ";
+  case OpCode::GT:
+    return "GT";
+  case OpCode::GE:
+    return "GE";
+  case OpCode::LT:
+    return "LT";
+  case OpCode::LE:
+    return "LE";
+  case OpCode::JUMP:
+    return "JUMP";
+  case OpCode::JUMP_IF_FALSE:
+    return "JUMP_IF_FALSE";
+  case OpCode::CALL:
+    return "CALL";
+  case OpCode::TAIL_CALL:
+    return "TAIL_CALL";
+  case OpCode::RETURN:
+    return "RETURN";
+  case OpCode::DEFINE:
+    return "DEFINE";
+  case OpCode::EVAL_AST:
+    return "EVAL_AST";
+  }
+  return "UNKNOWN";
+}
+
+void Chunk::emit8(unsigned int value) {
+  assert(value <= UINT8_MAX);
+  code.push_back(static_cast<uint8_t>(value));
+}
+
+void Chunk::emit16(unsigned int value) {
+  assert(value <= UINT16_MAX);
+  code.push_back(static_cast<uint8_t>(value & 0xff));
+  code.push_back(static_cast<uint8_t>(value >> 8));
+}
+
+void Chunk::patch16(size_t offset, unsigned int value) {
+  assert(value <= UINT16_MAX);
+  code[offset] = static_cast<uint8_t>(value & 0xff);
+  code[offset + 1] = static_cast<uint8_t>(value >> 8);
+}
+
+unsigned int Chunk::addConstant(const std::shared_ptr<AST> &node) {
+  constants.emplace_back(node);
+  return constants.size() - 1;
+}
+
+void Chunk::dump() const {
+  std::cout << "---------Chunk dump (arity " << arity << ")----------"
+            << std::endl;
+  size_t ip = 0;
+  while (ip < code.size()) {
+    const auto op = static_cast<OpCode>(code[ip]);
+    std::cout << ip << "\t" << opCodeToCString(op);
+    ip++;
+    switch (op) {
+    case OpCode::CONST:
+    case OpCode::LOAD_GLOBAL:
+    case OpCode::DEFINE:
+    case OpCode::EVAL_AST:
+      std::cout << "\t";
+      util::print(constants[read16(ip)].toAST());
+      ip += 2;
+      break;
+    case OpCode::JUMP:
+    case OpCode::JUMP_IF_FALSE:
+      std::cout << "\t" << read16(ip);
+      ip += 2;
+      break;
+    case OpCode::CALL:
+    case OpCode::TAIL_CALL:
+      std::cout << "\t" << static_cast<int>(code[ip]) << "\t@"
+                << read16(ip + 1);
+      ip += 3;
+      break;
+    case OpCode::RETURN:
+      break;
+    default:
+      std::cout << "\t" << static_cast<int>(code[ip]);
+      ip++;
+      break;
+    }
+    std::cout << std::endl;
+  }
+  std::cout << "--------------------------------------" << std::endl;
+}
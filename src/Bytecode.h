@@ -0,0 +1,68 @@
+#ifndef BYTECODE_H_
+#define BYTECODE_H_
+#include "AST.h"
+#include "Value.h"
+
+#include <cstdint>
+#include <vector>
+
+/// Instructions for the stack VM. Operands follow the opcode in the code
+/// stream, u8 for counts and slots, u16 for constant indices and jumps.
+enum class OpCode : uint8_t {
+  CONST,         // k16: push constants[k]
+  LOAD_ARG,      // s8: push argument s of the current frame
+  LOAD_GLOBAL,   // k16: push value of the symbol in constants[k]
+  ADD,           // n8: fold n integers
+  SUB,           // n8
+  MUL,           // n8
+  DIV,           // n8
+  MOD,           // n8
+  EQ,            // n8: compare n values pairwise
+  GT,            // n8
+  GE,            // n8
+  LT,            // n8
+  LE,            // n8
+  JUMP,          // a16: continue at absolute offset a
+  JUMP_IF_FALSE, // a16: pop, continue at a if the value is not true
+  CALL,          // n8 c16: call function below the n arguments, c is the
+                 // call site
+  TAIL_CALL,     // n8 c16: as CALL but replacing the current frame
+  RETURN,        // return top of stack to the caller
+  DEFINE,        // k16: evaluate the define form in constants[k]
+  EVAL_AST,      // k16: let the tree walker evaluate constants[k]
+};
+
+const char *opCodeToCString(OpCode op);
+
+/// A compiled function body or top-level form
+struct Chunk {
+  std::vector<uint8_t> code;
+  std::vector<Value> constants;
+  /// Argument list (name args...) of the define, nullptr for top-level forms
+  std::shared_ptr<AST> params;
+  unsigned int arity = 0;
+  /// Defined by define-memo, results are cached by the VM
+  bool memoized = false;
+
+  /// Inline cache of a call, the function called last and its chunk
+  struct CallSite {
+    const AST *fun = nullptr;
+    const Chunk *chunk = nullptr;
+  };
+  /// One per call, filled in by the VM
+  mutable std::vector<CallSite> callSites;
+
+  void emit(OpCode op) { code.push_back(static_cast<uint8_t>(op)); }
+  void emit8(unsigned int value);
+  void emit16(unsigned int value);
+  /// Overwrite the u16 operand at offset, used to patch jumps
+  void patch16(size_t offset, unsigned int value);
+  uint16_t read16(size_t offset) const {
+    return static_cast<uint16_t>(code[offset] | (code[offset + 1] << 8));
+  }
+  unsigned int addConstant(const std::shared_ptr<AST> &node);
+
+  void dump() const;
+};
+
+#endif /* !BYTECODE_H_ */
@@ -0,0 +1,188 @@
+#include "Compiler.h"
+#include "SyntaxError.h"
+
+#include <cassert>
+
+std::shared_ptr<Chunk> Compiler::compile(const std::shared_ptr<AST> &node) {
+  auto chunk = std::make_shared<Chunk>();
+  compileExpr(*chunk, node);
+  chunk->emit(OpCode::RETURN);
+  return chunk;
+}
+
+std::shared_ptr<Chunk>
+Compiler::compileFunction(const std::shared_ptr<AST> &fun) {
+  assert(fun->type() == AST::Type::FUN);
+  const auto &params = (*fun)[1];
+  if (params->children().size() - 1 > UINT8_MAX) {
+    throw SyntaxError("Too many arguments to compile", fun);
+  }
+  auto chunk = std::make_shared<Chunk>();
+  chunk->params = params;
+  chunk->arity = params->children().size() - 1;
+  chunk->memoized = fun->head()->isBuiltin(Builtin::DEFINE_MEMO);
+  compileExpr(*chunk, (*fun)[2], true);
+  chunk->emit(OpCode::RETURN);
+  return chunk;
+}
+
+void Compiler::compileExpr(Chunk &chunk, const std::shared_ptr<AST> &node,
+                           bool tail) {
+  if (node->children().size() > 0) {
+    compileSexpr(chunk, node, tail);
+    return;
+  }
+  if (AST::Type::SYMBOL == node->type()) {
+    const auto symbol = std::static_pointer_cast<ASTSymbol>(node)->data();
+    const auto slot = slotOf(chunk, symbol);
+    if (slot >= 0) {
+      chunk.emit(OpCode::LOAD_ARG);
+      chunk.emit8(slot);
+    } else {
+      emitConstant(chunk, OpCode::LOAD_GLOBAL, node);
+    }
+    return;
+  }
+  emitConstant(chunk, OpCode::CONST, node);
+}
+
+void Compiler::compileSexpr(Chunk &chunk, const std::shared_ptr<AST> &node,
+                            bool tail) {
+  if (AST::Type::BUILTIN == node->head()->type()) {
+    compileBuiltin(chunk, node, tail);
+  } else {
+    compileCall(chunk, node, tail);
+  }
+}
+
+void Compiler::compileBuiltin(Chunk &chunk, const std::shared_ptr<AST> &node,
+                              bool tail) {
+  const auto opnode = std::static_pointer_cast<ASTBuiltin>(node->head());
+  const auto op = [&opnode]() {
+    switch (opnode->op()) {
+    case Builtin::ADD:
+      return OpCode::ADD;
+    case Builtin::SUB:
+      return OpCode::SUB;
+    case Builtin::MUL:
+      return OpCode::MUL;
+    case Builtin::DIV:
+      return OpCode::DIV;
+    case Builtin::MOD:
+      return OpCode::MOD;
+    case Builtin::EQ:
+      return OpCode::EQ;
+    case Builtin::GT:
+      return OpCode::GT;
+    case Builtin::GE:
+      return OpCode::GE;
+    case Builtin::LT:
+      return OpCode::LT;
+    case Builtin::LE:
+      return OpCode::LE;
+    case Builtin::IF:
+      return OpCode::JUMP_IF_FALSE;
+    case Builtin::DEFINE:
+    case Builtin::DEFINE_MEMO:
+      return OpCode::DEFINE;
+    default:
+      return OpCode::EVAL_AST;
+    }
+  }();
+
+  switch (op) {
+  case OpCode::ADD:
+  case OpCode::SUB:
+  case OpCode::MUL:
+  case OpCode::DIV:
+  case OpCode::MOD:
+    if (node->children().size() < 2)
+      throw SyntaxError("Expected operators for operator", opnode);
+    compileArgs(chunk, node);
+    chunk.emit(op);
+    chunk.emit8(node->children().size() - 1);
+    break;
+  case OpCode::EQ:
+  case OpCode::GT:
+  case OpCode::GE:
+  case OpCode::LT:
+  case OpCode::LE:
+    if (node->children().size() < 3)
+      throw SyntaxError("Expected operators for operator", opnode);
+    compileArgs(chunk, node);
+    chunk.emit(op);
+    chunk.emit8(node->children().size() - 1);
+    break;
+  case OpCode::JUMP_IF_FALSE:
+    compileIf(chunk, node, tail);
+    break;
+  default:
+    emitConstant(chunk, op, node);
+    break;
+  }
+}
+
+void Compiler::compileIf(Chunk &chunk, const std::shared_ptr<AST> &node,
+                         bool tail) {
+  if (node->children().size() < 4)
+    throw SyntaxError("If-expression must har predicate and such", node);
+  compileExpr(chunk, (*node)[1]);
+  const auto elseJump = emitJump(chunk, OpCode::JUMP_IF_FALSE);
+  compileExpr(chunk, (*node)[2], tail);
+  const auto endJump = emitJump(chunk, OpCode::JUMP);
+  patchJump(chunk, elseJump);
+  compileExpr(chunk, (*node)[3], tail);
+  patchJump(chunk, endJump);
+}
+
+void Compiler::compileCall(Chunk &chunk, const std::shared_ptr<AST> &node,
+                           bool tail) {
+  compileExpr(chunk, node->head());
+  compileArgs(chunk, node);
+  if (chunk.callSites.size() >= UINT16_MAX)
+    throw SyntaxError("Too many calls to compile", node);
+  chunk.emit(tail ? OpCode::TAIL_CALL : OpCode::CALL);
+  chunk.emit8(node->children().size() - 1);
+  chunk.emit16(chunk.callSites.size());
+  chunk.callSites.emplace_back();
+}
+
+void Compiler::compileArgs(Chunk &chunk, const std::shared_ptr<AST> &node) {
+  const auto &children = node->children();
+  if (children.size() - 1 > UINT8_MAX)
+    throw SyntaxError("Too many arguments to compile", node);
+  for (auto it = children.cbegin() + 1; it != children.cend(); ++it) {
+    compileExpr(chunk, *it);
+  }
+}
+
+void Compiler::emitConstant(Chunk &chunk, OpCode op,
+                            const std::shared_ptr<AST> &node) {
+  if (chunk.constants.size() >= UINT16_MAX)
+    throw SyntaxError("Too many constants to compile", node);
+  chunk.emit(op);
+  chunk.emit16(chunk.addConstant(node));
+}
+
+size_t Compiler::emitJump(Chunk &chunk, OpCode op) {
+  chunk.emit(op);
+  chunk.emit16(0);
+  return chunk.code.size() - 2;
+}
+
+void Compiler::patchJump(Chunk &chunk, size_t offset) {
+  if (chunk.code.size() > UINT16_MAX)
+    throw SyntaxError("Form is too large to compile", 0, 0);
+  chunk.patch16(offset, chunk.code.size());
+}
+
+int Compiler::slotOf(const Chunk &chunk, Symbol symbol) const {
+  if (!chunk.params)
+    return -1;
+  const auto &params = chunk.params->children();
+  for (unsigned int i = 1; i < params.size(); i++) {
+    if (std::static_pointer_cast<ASTSymbol>(params[i])->data() == symbol)
+      return i - 1;
+  }
+  return -1;
+}
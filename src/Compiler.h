@@ -0,0 +1,37 @@
+#ifndef COMPILER_H_
+#define COMPILER_H_
+#include "AST.h"
+#include "Bytecode.h"
+
+#include <memory>
+
+/// Lowers parsed forms into bytecode for the VM. Forms the VM has no
+/// instructions for are left to the tree walker via EVAL_AST.
+class Compiler {
+public:
+  /// Compile a top-level form into a chunk taking no arguments
+  std::shared_ptr<Chunk> compile(const std::shared_ptr<AST> &node);
+
+  /// Compile the body of a function created by (define (name args...) body)
+  std::shared_ptr<Chunk> compileFunction(const std::shared_ptr<AST> &fun);
+
+private:
+  /// tail is true when the value of node is returned from the function
+  void compileExpr(Chunk &chunk, const std::shared_ptr<AST> &node,
+                   bool tail = false);
+  void compileSexpr(Chunk &chunk, const std::shared_ptr<AST> &node, bool tail);
+  void compileBuiltin(Chunk &chunk, const std::shared_ptr<AST> &node,
+                      bool tail);
+  void compileIf(Chunk &chunk, const std::shared_ptr<AST> &node, bool tail);
+  void compileCall(Chunk &chunk, const std::shared_ptr<AST> &node, bool tail);
+  void compileArgs(Chunk &chunk, const std::shared_ptr<AST> &node);
+
+  void emitConstant(Chunk &chunk, OpCode op, const std::shared_ptr<AST> &node);
+  size_t emitJump(Chunk &chunk, OpCode op);
+  void patchJump(Chunk &chunk, size_t offset);
+
+  /// Index of the argument named by symbol, -1 if it is not an argument
+  int slotOf(const Chunk &chunk, Symbol symbol) const;
+};
+
+#endif /* !COMPILER_H_ */
@@ -1,52 +1,114 @@
 #include "Environment.h"
 #include "Util.h"
 
+#include <atomic>
 #include <cassert>
 #include <iostream>
-#include <algorithm>
-#include <iterator>
 
-Environment::Environment(std::shared_ptr<Environment> parent)
-    : parent_(parent) {}
-
-Environment::~Environment() {
-  for (const auto e : env) {
-    free(const_cast<char *>(e.first));
-  }
+static uint64_t nextVersion() {
+  static std::atomic<uint64_t> version{1};
+  return version++;
 }
 
-void Environment::setEntry(const char *symbol, std::shared_ptr<AST> node) {
-  // std::cout << "Set:" << symbol << "-->";
-  // util::print(node);
-  // std::cout <<std::endl;
-  env[strdup(symbol)] = node;
-  assert(env.find(symbol) != env.cend());
-}
+Environment::Environment() : version_(nextVersion()) {}
 
-std::shared_ptr<AST> Environment::operator[](const char *symbol) {
-  auto it = env.find(symbol);
-  if (it != env.end())
-    return (*it).second;
-  if (parent_)
-    return (*parent_)[symbol];
-  return nullptr;
+void Environment::setEntry(Symbol symbol, Value value) {
+  // std::cout << "Set:" << SymbolTable::name(symbol) << "-->";
+  // util::print(value.toAST());
+  // std::cout <<std::endl;
+  if (symbol >= cells.size())
+    cells.resize(symbol + 1);
+  if (cells[symbol] && AST::Type::FUN == cells[symbol].type())
+    version_ = nextVersion();
+  revision_++;
+  cells[symbol] = std::move(value);
 }
 
 std::vector<std::string> Environment::symbols() {
   auto res = std::vector<std::string>();
-  std::transform(env.cbegin(), env.cend(), std::back_inserter(res),
-                 [] (const auto e) -> std::string { return  std::string(e.first);});
+  for (Symbol symbol = 0; symbol < cells.size(); symbol++) {
+    if (cells[symbol])
+      res.emplace_back(SymbolTable::name(symbol));
+  }
   return res;
 }
 
-std::shared_ptr<Environment> Environment::parent() const { return parent_; }
-
-void Environment::setParent(std::shared_ptr<Environment> o) { parent_ = o; }
-
 void Environment::dump() const {
   std::cout << "---------Environment dump-------------" << std::endl;
-  for (const auto e : env) {
-    std::cout << e.first << ": " << e.second->toString() << std::endl;
+  for (Symbol symbol = 0; symbol < cells.size(); symbol++) {
+    if (cells[symbol])
+      std::cout << SymbolTable::name(symbol) << ": "
+                << cells[symbol].toAST()->toString() << std::endl;
   }
   std::cout << "--------------------------------------" << std::endl;
 }
+
+Frame::Frame(std::shared_ptr<AST> params)
+    : params_(params), slots(params->children().size() - 1) {}
+
+void Frame::trace(Heap &heap) const { heap.mark(caller_); }
+
+size_t Frame::bytes() const {
+  return sizeof(Frame) + slots.capacity() * sizeof(Value);
+}
+
+Value Frame::lookup(Symbol symbol) const {
+  const auto slot = slotOf(symbol);
+  return slot < 0 ? nullptr : slots[slot];
+}
+
+int Frame::slotOf(Symbol symbol) const {
+  const auto &params = params_->children();
+  for (unsigned int i = 1; i < params.size(); i++) {
+    if (std::static_pointer_cast<ASTSymbol>(params[i])->data() == symbol)
+      return i - 1;
+  }
+  return -1;
+}
+
+void Frame::reset(std::shared_ptr<AST> params) {
+  params_ = std::move(params);
+  slots.resize(params_->children().size() - 1);
+  typed_ = false;
+}
+
+void Frame::clear() {
+  params_.reset();
+  slots.clear();
+  caller_ = nullptr;
+  typed_ = false;
+}
+
+void Frame::dump() const {
+  std::cout << "---------Frame dump-------------------" << std::endl;
+  const auto &params = params_->children();
+  for (unsigned int i = 1; i < params.size(); i++) {
+    std::cout << params[i]->toString() << ": "
+              << slots[i - 1].toAST()->toString() << std::endl;
+  }
+  std::cout << "--------------------------------------" << std::endl;
+}
+
+FramePool::FramePool(Heap &heap) : heap(heap) {}
+
+Frame *FramePool::acquire(const std::shared_ptr<AST> &params) {
+  if (frames.empty())
+    return heap.make<Frame>(params);
+  const auto frame = frames.back();
+  frames.pop_back();
+  frame->reset(params);
+  return frame;
+}
+
+void FramePool::release(Frame *frame) {
+  if (frames.size() == CAPACITY)
+    return;
+  frame->clear();
+  frames.push_back(frame);
+}
+
+void FramePool::trace(Heap &heap) const {
+  for (const auto frame : frames) {
+    heap.mark(frame);
+  }
+}
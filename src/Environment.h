@@ -2,33 +2,107 @@
 #define ENVIRONMENT_H_
 
 #include "AST.h"
+#include "Heap.h"
+#include "Symbol.h"
+#include "Value.h"
 
-#include <cstring>
-#include <map>
 #include <memory>
+#include <string>
 #include <vector>
 
+/// The global definitions, one cell per interned symbol
 class Environment {
 public:
-  explicit Environment(std::shared_ptr<Environment> parent = nullptr);
-  ~Environment();
-  void setEntry(const char *symbol, std::shared_ptr<AST> node);
-  std::shared_ptr<AST> operator[](const char *symbol);
+  void setEntry(Symbol symbol, Value value);
+  /// Value of symbol, the null value if it is not defined
+  Value operator[](Symbol symbol) const {
+    return symbol < cells.size() ? cells[symbol] : nullptr;
+  }
   std::vector<std::string> symbols();
+  Environment();
 
-  std::shared_ptr<Environment> parent() const;
-  void setParent(std::shared_ptr<Environment> o);
+  /// Changes when a function is replaced by a new definition, call sites
+  /// cache functions for a version. Versions are unique across
+  /// environments as parsed code may be evaluated by several.
+  uint64_t version() const { return version_; }
+  /// Changes with every definition, copies of the environment are stale
+  /// once it changed
+  uint64_t revision() const { return revision_; }
 
   void dump() const;
 
 private:
-  struct cmp_str {
-    bool operator()(char const *a, char const *b) {
-      return std::strcmp(a, b) < 0;
-    }
-  };
-  std::map<const char *, std::shared_ptr<AST>, cmp_str> env;
-  std::shared_ptr<Environment> parent_;
+  std::vector<Value> cells;
+  uint64_t version_;
+  uint64_t revision_ = 0;
+};
+
+/// The arguments of a function call, addressed by slot. Frames are made
+/// on the Heap of the Interpreter.
+class Frame : public Object {
+public:
+  /// params is the arglist (name args...) of the called function
+  explicit Frame(std::shared_ptr<AST> params);
+
+  void trace(Heap &heap) const override;
+  size_t bytes() const override;
+
+  Value &operator[](size_t slot) { return slots[slot]; }
+  size_t size() const { return slots.size(); }
+  /// The size() argument values in slot order
+  const Value *args() const { return slots.data(); }
+
+  /// Argument named symbol, the null value if the function has no such
+  /// argument
+  Value lookup(Symbol symbol) const;
+  /// Slot of the argument named symbol, -1 if there is no such argument
+  int slotOf(Symbol symbol) const;
+  const std::shared_ptr<AST> &params() const { return params_; }
+  /// The frame restored when the call returns, nullptr at top-level
+  Frame *caller() const { return caller_; }
+  void setCaller(Frame *caller) { caller_ = caller; }
+  /// Set if the arguments passed the entry check of the function, see
+  /// TypeInference
+  bool typed() const { return typed_; }
+  void setTyped(bool typed) { typed_ = typed; }
+
+  /// Reuse a cleared frame for a call of the function with params
+  void reset(std::shared_ptr<AST> params);
+  /// Drop the arguments and params of a call that returned
+  void clear();
+
+  void dump() const;
+
+private:
+  std::shared_ptr<AST> params_;
+  std::vector<Value> slots;
+  Frame *caller_ = nullptr;
+  bool typed_ = false;
+};
+
+/// Frames of calls that returned, kept to be reused by later calls so a
+/// call does not allocate. Frames never outlive their call as there are
+/// no closures, the interpreter releases a frame when its call returns or
+/// is replaced by a tail call. The pooled frames stay on the Heap, they
+/// are marked as roots by trace.
+class FramePool {
+public:
+  /// Frames kept at most, deeper recursions leave the rest to the
+  /// collector
+  static const size_t CAPACITY = 1024;
+
+  explicit FramePool(Heap &heap);
+
+  /// A pooled frame reset for params, a new one if the pool is empty
+  Frame *acquire(const std::shared_ptr<AST> &params);
+  /// Return frame to the pool, it must not be reachable anymore
+  void release(Frame *frame);
+  void trace(Heap &heap) const;
+  size_t size() const { return frames.size(); }
+
+private:
+  Heap &heap;
+  std::vector<Frame *> frames;
 };
 
 #endif /* !ENVIRONMENT_H_ */
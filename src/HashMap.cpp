@@ -0,0 +1,154 @@
+#include "HashMap.h"
+#include "AST.h"
+
+#include <cassert>
+#include <cstring>
+
+namespace {
+
+/// Spread the bits of x over the word, the finalizer of splitmix64
+size_t mix(uint64_t x) {
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebULL;
+  x ^= x >> 31;
+  return x;
+}
+
+} // namespace
+
+bool HashMap::hashable(const AST &node) {
+  switch (node.type()) {
+  case AST::Type::INTEGER:
+  case AST::Type::BIGNUM:
+  case AST::Type::FLOAT:
+  case AST::Type::STRING:
+  case AST::Type::SYMBOL:
+  case AST::Type::BOOLEAN:
+    return true;
+  default:
+    return false;
+  }
+}
+
+size_t HashMap::hash(const AST &node) {
+  // the type is mixed in so that equal bits of other types differ
+  const uint64_t type = static_cast<uint64_t>(node.type()) << 56;
+  switch (node.type()) {
+  case AST::Type::INTEGER:
+    return mix(static_cast<const ASTInt &>(node).data() ^ type);
+  case AST::Type::BIGNUM:
+    return mix(static_cast<const ASTBignum &>(node).data().hash() ^ type);
+  case AST::Type::FLOAT: {
+    // 0.0 and -0.0 are equal
+    const double d = static_cast<const ASTFloat &>(node).data() + 0.0;
+    uint64_t bits;
+    memcpy(&bits, &d, sizeof(bits));
+    return mix(bits ^ type);
+  }
+  case AST::Type::STRING:
+    return mix(static_cast<const ASTString &>(node).data().hash() ^ type);
+  case AST::Type::SYMBOL:
+    // interned, the symbol is its own hash
+    return mix(static_cast<const ASTSymbol &>(node).data() ^ type);
+  case AST::Type::BOOLEAN:
+    return mix(static_cast<const ASTBoolean &>(node).data() ^ type);
+  default:
+    assert(false && "not a key");
+    return 0;
+  }
+}
+
+bool HashMap::equal(const AST &a, const AST &b) {
+  if (a.type() != b.type())
+    return false;
+  switch (a.type()) {
+  case AST::Type::INTEGER:
+    return static_cast<const ASTInt &>(a).data() ==
+           static_cast<const ASTInt &>(b).data();
+  case AST::Type::BIGNUM:
+    return static_cast<const ASTBignum &>(a).data() ==
+           static_cast<const ASTBignum &>(b).data();
+  case AST::Type::FLOAT:
+    return static_cast<const ASTFloat &>(a).data() ==
+           static_cast<const ASTFloat &>(b).data();
+  case AST::Type::STRING:
+    return static_cast<const ASTString &>(a).data() ==
+           static_cast<const ASTString &>(b).data();
+  case AST::Type::SYMBOL:
+    return static_cast<const ASTSymbol &>(a).data() ==
+           static_cast<const ASTSymbol &>(b).data();
+  case AST::Type::BOOLEAN:
+    return static_cast<const ASTBoolean &>(a).data() ==
+           static_cast<const ASTBoolean &>(b).data();
+  default:
+    return false;
+  }
+}
+
+const HashMap::Element *HashMap::find(const AST &key, size_t hash) const {
+  if (slots.empty())
+    return nullptr;
+  const auto &slot = slots[probe(key, hash)];
+  return slot.key ? &slot.value : nullptr;
+}
+
+void HashMap::set(Element key, Element value) {
+  const auto h = hash(*key);
+  if (slots.empty() || 4 * (size_ + 1) > 3 * slots.size())
+    grow();
+  auto &slot = slots[probe(*key, h)];
+  if (!slot.key) {
+    slot.hash = h;
+    slot.key = std::move(key);
+    size_++;
+  }
+  slot.value = std::move(value);
+}
+
+bool HashMap::remove(const AST &key) {
+  if (slots.empty())
+    return false;
+  const size_t mask = slots.size() - 1;
+  size_t i = probe(key, hash(key));
+  if (!slots[i].key)
+    return false;
+  // shift the following slots of the run back instead of leaving a
+  // tombstone, a slot moves if i is between its home and it
+  for (size_t j = (i + 1) & mask; slots[j].key; j = (j + 1) & mask) {
+    const size_t home = slots[j].hash & mask;
+    if (((j - home) & mask) >= ((j - i) & mask)) {
+      slots[i] = std::move(slots[j]);
+      i = j;
+    }
+  }
+  slots[i] = Slot{0, nullptr, nullptr};
+  size_--;
+  return true;
+}
+
+size_t HashMap::probe(const AST &key, size_t hash) const {
+  const size_t mask = slots.size() - 1;
+  size_t i = hash & mask;
+  while (slots[i].key &&
+         (slots[i].hash != hash || !equal(*slots[i].key, key))) {
+    i = (i + 1) & mask;
+  }
+  return i;
+}
+
+void HashMap::grow() {
+  std::vector<Slot> old(slots.empty() ? MIN_CAPACITY : 2 * slots.size());
+  old.swap(slots);
+  const size_t mask = slots.size() - 1;
+  for (auto &slot : old) {
+    if (!slot.key)
+      continue;
+    size_t i = slot.hash & mask;
+    while (slots[i].key) {
+      i = (i + 1) & mask;
+    }
+    slots[i] = std::move(slot);
+  }
+}
@@ -0,0 +1,59 @@
+#ifndef HASHMAP_H_
+#define HASHMAP_H_
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+class AST;
+
+/// Mutable hash map from fixnums, bignums, floats, strings, symbols and
+/// booleans to nodes, the transient maps. Open addressing with linear
+/// probing in a power of two table at most 3/4 full. The hash of each key
+/// is kept in its slot and compared before the keys are.
+class HashMap {
+public:
+  using Element = std::shared_ptr<AST>;
+
+  /// Whether node may be a key, and its hash. Keys of different types are
+  /// different, 1 and 1.0 are two keys.
+  /// @{
+  static bool hashable(const AST &node);
+  static size_t hash(const AST &node);
+  static bool equal(const AST &a, const AST &b);
+  /// @}
+
+  size_t size() const { return size_; }
+
+  /// The value of key or nullptr
+  const Element *find(const AST &key, size_t hash) const;
+  const Element *find(const AST &key) const { return find(key, hash(key)); }
+  /// Add key or replace its value
+  void set(Element key, Element value);
+  /// false if there is no key
+  bool remove(const AST &key);
+
+  /// Call fn with each key and value, in no particular order
+  template <typename Fn> void forEach(Fn fn) const {
+    for (const auto &slot : slots) {
+      if (slot.key)
+        fn(slot.key, slot.value);
+    }
+  }
+
+private:
+  struct Slot {
+    size_t hash;
+    Element key;
+    Element value;
+  };
+  static const size_t MIN_CAPACITY = 8;
+
+  /// Index of the slot holding key or of the empty slot ending its probe
+  size_t probe(const AST &key, size_t hash) const;
+  void grow();
+
+  std::vector<Slot> slots;
+  size_t size_ = 0;
+};
+
+#endif /* !HASHMAP_H_ */
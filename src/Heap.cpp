@@ -0,0 +1,86 @@
+#include "Heap.h"
+
+#include <chrono>
+#include <iostream>
+
+Heap::Heap(size_t size) : size_(size) {}
+
+Heap::~Heap() {
+  while (objects) {
+    const auto next = objects->next;
+    delete objects;
+    objects = next;
+  }
+}
+
+void Heap::setRootTracer(std::function<void(Heap &)> tracer) {
+  rootTracer = tracer;
+}
+
+void Heap::add(Object *object) {
+  object->size = object->bytes();
+  if (bytes_ + object->size > size_) {
+    // the new object is not reachable yet, keep it out of the collection
+    collect();
+    if (stats_.liveBytes > size_ / 2)
+      size_ *= 2;
+  }
+  object->next = objects;
+  objects = object;
+  bytes_ += object->size;
+  stats_.allocated++;
+}
+
+void Heap::collect() {
+  const auto start = std::chrono::steady_clock::now();
+  for (const auto root : roots) {
+    mark(root);
+  }
+  if (rootTracer)
+    rootTracer(*this);
+  while (!grey.empty()) {
+    const auto object = grey.back();
+    grey.pop_back();
+    object->trace(*this);
+  }
+  sweep();
+  stats_.collections++;
+  stats_.pauseMicroseconds +=
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::steady_clock::now() - start)
+          .count();
+}
+
+void Heap::sweep() {
+  size_t live = 0;
+  bytes_ = 0;
+  Object **link = &objects;
+  while (*link) {
+    const auto object = *link;
+    if (object->marked) {
+      object->marked = false;
+      live++;
+      bytes_ += object->size;
+      link = &object->next;
+    } else {
+      *link = object->next;
+      delete object;
+      stats_.freed++;
+    }
+  }
+  stats_.live = live;
+  stats_.liveBytes = bytes_;
+}
+
+void Heap::dumpStats() const {
+  std::cout << "---------GC stats---------------------" << std::endl;
+  std::cout << "heap size:   " << size_ << " bytes" << std::endl;
+  std::cout << "collections: " << stats_.collections << std::endl;
+  std::cout << "allocated:   " << stats_.allocated << " objects" << std::endl;
+  std::cout << "freed:       " << stats_.freed << " objects" << std::endl;
+  std::cout << "live:        " << stats_.live << " objects, "
+            << stats_.liveBytes << " bytes" << std::endl;
+  std::cout << "pause:       " << stats_.pauseMicroseconds << " us"
+            << std::endl;
+  std::cout << "--------------------------------------" << std::endl;
+}
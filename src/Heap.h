@@ -0,0 +1,114 @@
+#ifndef HEAP_H_
+#define HEAP_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+class Heap;
+
+/// Base of the objects managed by a Heap. Objects are made by Heap::make
+/// and released by the collector once they can not be reached from the
+/// roots.
+class Object {
+public:
+  virtual ~Object() {}
+  /// Mark the objects this object refers to
+  virtual void trace(Heap & /* heap */) const {}
+  /// Bytes owned by the object, counted against the heap size
+  virtual size_t bytes() const = 0;
+
+private:
+  friend class Heap;
+  Object *next = nullptr;
+  size_t size = 0;
+  mutable bool marked = false;
+};
+
+/// Mark and sweep collector. A collection is started by make when the
+/// objects made since the last collection would exceed the heap size. The
+/// heap grows when more than half of it is live after a collection.
+///
+/// The roots are the objects on the root stack and those marked by the
+/// root tracer.
+///
+/// Only call frames are collected here. Values stay shared_ptr nodes
+/// released by their counts, which is enough as values are never cyclic:
+/// there are no closures, and hash-set rejects storing into a transient,
+/// the only value changed in place, anything that reaches a transient.
+class Heap {
+public:
+  static const size_t DEFAULT_SIZE = 1 << 20;
+
+  struct Stats {
+    size_t collections = 0;
+    /// Objects made and released since the heap was created
+    size_t allocated = 0;
+    size_t freed = 0;
+    /// Objects and bytes alive after the last collection
+    size_t live = 0;
+    size_t liveBytes = 0;
+    /// Time spent collecting
+    uint64_t pauseMicroseconds = 0;
+  };
+
+  /// Keeps an object alive while in scope
+  class Root {
+  public:
+    Root(Heap &heap, const Object *object) : heap(heap) {
+      heap.roots.push_back(object);
+    }
+    ~Root() { heap.roots.pop_back(); }
+    Root(const Root &) = delete;
+    Root &operator=(const Root &) = delete;
+
+  private:
+    Heap &heap;
+  };
+
+  explicit Heap(size_t size = DEFAULT_SIZE);
+  ~Heap();
+  Heap(const Heap &) = delete;
+  Heap &operator=(const Heap &) = delete;
+
+  template <class T, class... Args> T *make(Args &&... args) {
+    T *object = new T(std::forward<Args>(args)...);
+    add(object);
+    return object;
+  }
+
+  /// Mark object and, before the collection ends, what it refers to
+  void mark(const Object *object) {
+    if (object && !object->marked) {
+      object->marked = true;
+      grey.push_back(object);
+    }
+  }
+  void collect();
+
+  /// Called by each collection to mark the roots not on the root stack
+  void setRootTracer(std::function<void(Heap &)> tracer);
+
+  size_t size() const { return size_; }
+  void setSize(size_t size) { size_ = size; }
+  /// Bytes of the objects made since the last collection included
+  size_t bytes() const { return bytes_; }
+  const Stats &stats() const { return stats_; }
+  void dumpStats() const;
+
+private:
+  void add(Object *object);
+  void sweep();
+
+  Object *objects = nullptr;
+  std::vector<const Object *> roots;
+  std::vector<const Object *> grey;
+  std::function<void(Heap &)> rootTracer;
+  size_t size_;
+  size_t bytes_ = 0;
+  Stats stats_;
+};
+
+#endif /* !HEAP_H_ */
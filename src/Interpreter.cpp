@@ -1,13 +1,34 @@
 #include "Interpreter.h"
 #include "Environment.h"
+#include "Kernels.h"
+#include "Number.h"
+#include "Memo.h"
 #include "SyntaxError.h"
+#include "ThreadPool.h"
 #include "Util.h"
+#include "VM.h"
 
 #include <algorithm>
 #include <cassert>
 #include <iostream>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <unistd.h>
+#include <unordered_set>
 
-Interpreter::Interpreter() : env(std::make_shared<Environment>()) {}
+Interpreter::Interpreter(Engine engine, size_t heapSize)
+    : heap_(heapSize), output_(STDOUT_FILENO), framePool(heap_),
+      globals(std::make_shared<Environment>()), engine_(engine),
+      vm(new VM(*this)), memoCapacity_(Memo::DEFAULT_CAPACITY),
+      threads_(std::max(1u, std::thread::hardware_concurrency())) {
+  heap_.setRootTracer([this](Heap &heap) {
+    heap.mark(frame);
+    framePool.trace(heap);
+  });
+}
+
+Interpreter::~Interpreter() {}
 
 static void showNode(const char *prefix, const std::shared_ptr<AST> &node) {
 #if 0
@@ -19,253 +40,1265 @@ static void showNode(const char *prefix, const std::shared_ptr<AST> &node) {
 }
 
 const std::shared_ptr<Environment> Interpreter::environment() const {
-  return env;
+  return globals;
+}
+
+Heap &Interpreter::heap() { return heap_; }
+
+Printer &Interpreter::output() { return output_; }
+
+double Interpreter::CallCacheStats::hitRate() const {
+  const auto calls = hits + misses;
+  return calls ? static_cast<double>(hits) / calls : 0;
+}
+
+const Interpreter::CallCacheStats &Interpreter::callCacheStats() const {
+  return callCacheStats_;
+}
+
+const Interpreter::MemoStats &Interpreter::memoStats() const {
+  return memoStats_;
+}
+
+void Interpreter::setMemoCapacity(size_t capacity) {
+  memoCapacity_ = capacity;
+}
+
+void Interpreter::enableJit(unsigned int threshold) {
+  jit_.reset(new Jit(*globals, threshold));
+}
+
+const Jit *Interpreter::jit() const { return jit_.get(); }
+
+void Interpreter::setTypeInference(bool enabled) { inferTypes = enabled; }
+
+void Interpreter::setThreads(unsigned threads) {
+  threads_ = std::max(1u, threads);
+  pool.reset();
+  workers.clear();
+  scheduler_.reset();
+  taskWorkers.clear();
+}
+
+unsigned Interpreter::threads() const { return threads_; }
+
+void Interpreter::setSerialCutoff(size_t items) { serialCutoff_ = items; }
+
+void Interpreter::setSpawnCutoff(size_t tasks) {
+  spawnCutoff_ = tasks;
+  scheduler_.reset();
+  taskWorkers.clear();
+}
+
+const Scheduler *Interpreter::scheduler() const { return scheduler_.get(); }
+
+const TypeInference::Stats &Interpreter::typeInferenceStats() const {
+  return typeInference.stats();
+}
+
+Interpreter::Engine Interpreter::engine() const { return engine_; }
+
+void Interpreter::setEngine(Engine engine) { engine_ = engine; }
+
+const char *Interpreter::engineToCString(Engine engine) {
+  switch (engine) {
+  case Engine::TREE:
+    return "tree";
+  case Engine::BYTECODE:
+    return "vm";
+  }
+  return "UNKNOWN";
+}
+
+Interpreter::Engine Interpreter::engineFromCString(const char *str) {
+  if (0 == strcmp("vm", str) || 0 == strcmp("bytecode", str))
+    return Engine::BYTECODE;
+  return Engine::TREE;
 }
 
 std::shared_ptr<AST> Interpreter::eval(std::shared_ptr<AST> node) {
-  showNode("EVAL: ", node);
-  if (node->children().size() == 0) {
-    if (node->type() == AST::Type::SYMBOL) {
-      const auto &symbol = std::static_pointer_cast<ASTSymbol>(node);
-      const auto name = symbol->data();
-      const auto ret = (*env)[name];
-      if (!ret) {
-        std::cout << "name:" << name << std::endl;
-        throw SyntaxError("Identifier is not known:", node);
-      }
-      return ret;
+  // integers and booleans are only boxed when they leave the interpreter
+  if (Engine::BYTECODE == engine_)
+    return vm->run(node).toAST();
+  return evalIn(nullptr, node).toAST();
+}
+
+Value Interpreter::evalIn(Frame *scope, std::shared_ptr<AST> node) {
+  const auto saved = frame;
+  Heap::Root root(heap_, saved);
+  frame = scope;
+  try {
+    const auto res = evalTree(node);
+    frame = saved;
+    return res;
+  } catch (...) {
+    frame = saved;
+    throw;
+  }
+}
+
+void Interpreter::returnTo(Frame *caller) {
+  // any other frame is of a call made by evalTree, it has returned
+  if (frame != caller)
+    framePool.release(frame);
+  frame = caller;
+}
+
+Value Interpreter::lookup(const ASTSymbol &symbol) {
+  switch (symbol.scope()) {
+  case ASTSymbol::Scope::ARGUMENT:
+    assert(frame && symbol.slot() < frame->size());
+    return (*frame)[symbol.slot()];
+  case ASTSymbol::Scope::GLOBAL:
+    return (*globals)[symbol.data()];
+  case ASTSymbol::Scope::UNRESOLVED:
+    // from code built at runtime, e.g. by (eval (list + x 1))
+    if (frame) {
+      const auto arg = frame->lookup(symbol.data());
+      if (arg)
+        return arg;
     }
+    return (*globals)[symbol.data()];
+  }
+  return nullptr;
+}
+
+const AST *Interpreter::cachedCall(const std::shared_ptr<AST> &head) {
+  if (AST::Type::SYMBOL != head->type())
+    return nullptr;
+  const auto &symbol = static_cast<const ASTSymbol &>(*head);
+  // arguments and names in code built at runtime are not cached
+  if (ASTSymbol::Scope::GLOBAL != symbol.scope())
+    return nullptr;
+  const auto fun = symbol.cachedFunction(globals->version());
+  if (fun)
+    callCacheStats_.hits++;
+  else
+    callCacheStats_.misses++;
+  return fun;
+}
+
+void Interpreter::cacheCall(const std::shared_ptr<AST> &head,
+                            const AST *fun) {
+  if (AST::Type::SYMBOL != head->type())
+    return;
+  auto &symbol = static_cast<ASTSymbol &>(*head);
+  if (ASTSymbol::Scope::GLOBAL == symbol.scope())
+    symbol.cacheFunction(fun, globals->version());
+}
+
+std::shared_ptr<Memo> Interpreter::memoOf(const AST *fun) const {
+  const auto it = memos.find(fun);
+  return it == memos.cend() ? nullptr : it->second;
+}
+
+bool Interpreter::recall(Memo &memo, const Value *args, size_t argc,
+                         Value &result) {
+  if (!Memo::cacheable(args, argc))
+    return false;
+  if (memo.find(Memo::Key(args, args + argc), result)) {
+    memoStats_.hits++;
+    return true;
+  }
+  memoStats_.misses++;
+  return false;
+}
+
+void Interpreter::memorize(Memo &memo, const Value *args, size_t argc,
+                           Value result) {
+  if (Memo::cacheable(args, argc) &&
+      memo.insert(Memo::Key(args, args + argc), std::move(result)))
+    memoStats_.evictions++;
+}
+
+Value Interpreter::evalMemoized(const AST *fun, Frame *callee,
+                                const std::shared_ptr<AST> &body) {
+  // held, the function may be redefined while its body is evaluated
+  const auto memo = memoOf(fun);
+  Value res;
+  if (memo && recall(*memo, callee->args(), callee->size(), res))
+    return res;
+  res = evalIn(callee, body);
+  if (memo)
+    memorize(*memo, callee->args(), callee->size(), res);
+  return res;
+}
+
+namespace {
+
+/// A copy of node sharing no node that is referenced when it is evaluated,
+/// the data of list, array and map values is shared
+std::shared_ptr<AST> copyNode(const std::shared_ptr<AST> &node) {
+  std::shared_ptr<AST> res;
+  switch (node->type()) {
+  case AST::Type::SEXPR:
+    res = std::make_shared<ASTSexpr>();
+    break;
+  case AST::Type::FUN:
+    res = std::make_shared<ASTFun>();
+    break;
+  case AST::Type::SYMBOL: {
+    const auto &symbol = static_cast<const ASTSymbol &>(*node);
+    const auto copy = std::make_shared<ASTSymbol>(symbol.data());
+    copy->resolve(symbol.scope(), symbol.slot());
+    res = copy;
+    break;
+  }
+  case AST::Type::INTEGER:
+    res = std::make_shared<ASTInt>(static_cast<const ASTInt &>(*node).data());
+    break;
+  case AST::Type::BIGNUM:
+    res = std::make_shared<ASTBignum>(
+        static_cast<const ASTBignum &>(*node).data());
+    break;
+  case AST::Type::FLOAT:
+    res = std::make_shared<ASTFloat>(
+        static_cast<const ASTFloat &>(*node).data());
+    break;
+  case AST::Type::STRING:
+    res = std::make_shared<ASTString>(
+        static_cast<const ASTString &>(*node).data());
+    break;
+  case AST::Type::BOOLEAN:
+    res = std::make_shared<ASTBoolean>(
+        static_cast<const ASTBoolean &>(*node).data());
+    break;
+  case AST::Type::BUILTIN:
+    res = std::make_shared<ASTBuiltin>(
+        static_cast<const ASTBuiltin &>(*node).op());
+    break;
+  default:
     return node;
   }
+  res->setProven(node->proven());
+  for (const auto &child : node->children()) {
+    res->addChild(copyNode(child));
+  }
+  return res;
+}
+
+} // namespace
+
+Interpreter::Callable
+Interpreter::callable(const std::shared_ptr<AST> &opnode, const Value &f,
+                      size_t arity) {
+  if (f && AST::Type::FUN == f.type()) {
+    const auto &fun = worker_ ? copyOf(f.node()) : f.node();
+    return Callable{fun, fun->children()[1], fun->children()[2]};
+  }
+  if (!f || AST::Type::BUILTIN != f.type())
+    throw SyntaxError("Argument must be a function", opnode);
+  const auto op = std::static_pointer_cast<ASTBuiltin>(f.node())->op();
+  auto params = std::make_shared<ASTSexpr>();
+  auto body = std::make_shared<ASTSexpr>();
+  params->addChild(std::make_shared<ASTBuiltin>(op));
+  body->addChild(std::make_shared<ASTBuiltin>(op));
+  for (size_t i = 0; i < arity; i++) {
+    const auto name = "$" + std::to_string(i);
+    params->addChild(std::make_shared<ASTSymbol>(name.c_str()));
+    const auto arg = std::make_shared<ASTSymbol>(name.c_str());
+    arg->resolve(ASTSymbol::Scope::ARGUMENT, i);
+    body->addChild(arg);
+  }
+  return Callable{nullptr, params, body};
+}
+
+Value Interpreter::apply(const Callable &f, const Value *args, size_t argc) {
+  const auto callee = framePool.acquire(f.params);
+  if (callee->size() != argc) {
+    framePool.release(callee);
+    throw SyntaxError("Wrong number of arguments", f.params);
+  }
+  for (size_t i = 0; i < argc; i++) {
+    (*callee)[i] = args[i];
+  }
+  callee->setCaller(frame);
+  callee->setTyped(f.fun && inferTypes &&
+                   TypeInference::entryCheck(*f.params, callee->args()));
+  Value res;
+  const bool compiled =
+      f.fun && jit_ && jit_->call(f.fun.get(), callee->args(), argc, res);
+  if (!compiled) {
+    res = f.fun && f.fun->children().front()->isBuiltin(Builtin::DEFINE_MEMO)
+              ? evalMemoized(f.fun.get(), callee, f.body)
+              : evalIn(callee, f.body);
+  }
+  framePool.release(callee);
+  return res;
+}
+
+void Interpreter::parallel(const std::shared_ptr<AST> &opnode, const Value &f,
+                           size_t arity, size_t n, const Chunk &chunk) {
+  if (serial(n)) {
+    chunk(*this, callable(opnode, f, arity), 0, n);
+    return;
+  }
+  if (!pool) {
+    for (unsigned i = 0; i < threads_; i++) {
+      workers.push_back(makeWorker());
+    }
+    pool.reset(new ThreadPool(threads_));
+  }
+  // the workers are prepared here, they intern no symbols while running
+  std::vector<Callable> fs;
+  for (const auto &worker : workers) {
+    worker->syncWith(globals);
+    fs.push_back(worker->callable(opnode, f, arity));
+  }
+  // more chunks than threads even out elements of different cost
+  const size_t chunks = std::min<size_t>(n, 4 * threads_);
+  std::mutex mutex;
+  std::exception_ptr error;
+  std::atomic<bool> failed{false};
+  pool->run(chunks, [&](unsigned worker, size_t i) {
+    if (failed)
+      return;
+    try {
+      chunk(*workers[worker], fs[worker], n * i / chunks,
+            n * (i + 1) / chunks);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!error)
+        error = std::current_exception();
+      failed = true;
+    }
+  });
+  if (error)
+    std::rethrow_exception(error);
+}
+
+std::unique_ptr<Interpreter> Interpreter::makeWorker() const {
+  std::unique_ptr<Interpreter> worker(
+      new Interpreter(Engine::TREE, heap_.size()));
+  worker->worker_ = true;
+  worker->threads_ = 1;
+  worker->inferTypes = inferTypes;
+  return worker;
+}
+
+void Interpreter::syncWith(const std::shared_ptr<Environment> &env) {
+  if (env.get() == synced && env->revision() == syncedRevision)
+    return;
+  globals = std::make_shared<Environment>();
+  copies.clear();
+  originals.clear();
+  for (Symbol symbol = 0; symbol < SymbolTable::size(); symbol++) {
+    const auto value = (*env)[symbol];
+    if (!value)
+      continue;
+    if (AST::Type::FUN == value.type())
+      globals->setEntry(symbol, copyOf(value.node()));
+    else
+      globals->setEntry(symbol, value);
+  }
+  synced = env.get();
+  syncedRevision = env->revision();
+}
+
+const std::shared_ptr<AST> &
+Interpreter::copyOf(const std::shared_ptr<AST> &fun) {
+  auto &copy = copies[fun.get()];
+  if (!copy.first) {
+    copy = std::make_pair(fun, copyNode(fun));
+    originals[copy.second.get()] = fun;
+  }
+  return copy.second;
+}
+
+struct Interpreter::Spawned : Task {
+  Spawned(Interpreter &root, Value fun, std::vector<Value> args)
+      : root(root), fun(std::move(fun)), args(std::move(args)) {}
+
+  void run(unsigned worker) override {
+    auto &interpreter = *root.taskWorkers[worker];
+    try {
+      const auto &copy = interpreter.copyOf(fun.node());
+      for (auto &arg : args) {
+        arg = interpreter.local(arg);
+      }
+      const Callable f{copy, copy->children()[1], copy->children()[2]};
+      result = interpreter.original(
+          interpreter.apply(f, args.data(), args.size()));
+    } catch (...) {
+      error = std::current_exception();
+    }
+    args.clear();
+  }
+
+  Interpreter &root;
+  Value fun;
+  std::vector<Value> args;
+  /// Set by run
+  /// @{
+  Value result;
+  std::exception_ptr error;
+  /// @}
+};
+
+Scheduler *Interpreter::spawner() {
+  if (root_ != this)
+    return root_->scheduler_.get();
+  if (threads_ < 2)
+    return nullptr;
+  if (!scheduler_) {
+    for (unsigned i = 0; i < threads_; i++) {
+      taskWorkers.push_back(makeWorker());
+      taskWorkers.back()->root_ = this;
+      taskWorkers.back()->taskWorker_ = i;
+    }
+    scheduler_.reset(new Scheduler(threads_, spawnCutoff_));
+  }
+  return scheduler_.get();
+}
+
+Value Interpreter::original(const Value &value) const {
+  if (!worker_ || AST::Type::FUN != value.type())
+    return value;
+  const auto it = originals.find(value.node().get());
+  return it == originals.cend() ? value : Value(it->second);
+}
+
+Value Interpreter::local(const Value &value) {
+  if (!worker_ || AST::Type::FUN != value.type())
+    return value;
+  return copyOf(value.node());
+}
+
+void Interpreter::forgetMemo(Symbol name) {
+  const auto old = (*globals)[name];
+  if (old && AST::Type::FUN == old.type())
+    memos.erase(old.node().get());
+}
+
+void Interpreter::requirePure(const std::shared_ptr<AST> &node) {
+  if (AST::Type::BUILTIN == node->type()) {
+    switch (std::static_pointer_cast<ASTBuiltin>(node)->op()) {
+    case Builtin::PPRINT:
+    case Builtin::EVAL:
+    case Builtin::DEFINE:
+    case Builtin::DEFINE_MEMO:
+    case Builtin::TRANSIENT:
+    case Builtin::HASH_SET:
+    case Builtin::HASH_REMOVE:
+      throw SyntaxError(
+          "Memoized functions can not print, define, eval or use transients",
+          node);
+    default:
+      return;
+    }
+  }
+  const auto &children = node->children();
+  // the operands of list are data
+  if (children.empty() || children.front()->isBuiltin(Builtin::LIST))
+    return;
+  for (const auto &child : children) {
+    requirePure(child);
+  }
+}
 
-  const auto op = eval(node->head());
-  if (op->type() == AST::Type::BUILTIN) {
-    return evalBuiltin(node);
-  } else if (op->type() == AST::Type::FUN) {
-    assert(op->children().size() == 3);
-    const auto arglist = op->children()[1];
+bool Interpreter::isTrue(const Value &value) {
+  switch (value.type()) {
+  case AST::Type::BOOLEAN:
+    return value.boolean();
+  case AST::Type::INTEGER:
+    return 0 != value.integer();
+  case AST::Type::FLOAT:
+    return 0 != value.floating();
+  case AST::Type::ARRAY:
+    return std::static_pointer_cast<ASTArray>(value.node())->data().size() > 0;
+  case AST::Type::LIST:
+    return !std::static_pointer_cast<ASTList>(value.node())->data().empty();
+  case AST::Type::MAP:
+    return std::static_pointer_cast<ASTMap>(value.node())->data().size() > 0;
+  case AST::Type::TRANSIENT_MAP:
+    return std::static_pointer_cast<ASTTransientMap>(value.node())
+               ->data()
+               .size() > 0;
+  default:
+    return true;
+  }
+}
+
+Value Interpreter::evalTree(const std::shared_ptr<AST> &form) {
+  // Expressions in tail position are evaluated by this loop instead of by
+  // recursion. A function called from tail position replaces the frame of
+  // the function it is called from, the caller's frame is restored once.
+  const auto caller = frame;
+  // The node evaluated is held once the loop moved on from form, to a
+  // function body a definition may release or to a form built by eval.
+  // Operands are evaluated through references, their counts are not
+  // touched: once several threads run, each change is an atomic operation.
+  const std::shared_ptr<AST> *node = &form;
+  std::shared_ptr<AST> held;
+  for (;;) {
+    showNode("EVAL: ", *node);
+    const auto &children = (*node)->children();
+    if (children.size() == 0) {
+      if ((*node)->type() == AST::Type::SYMBOL) {
+        const auto &symbol = static_cast<const ASTSymbol &>(**node);
+        const auto ret = lookup(symbol);
+        if (!ret) {
+          std::cout << "name:" << symbol.name() << std::endl;
+          throw SyntaxError("Identifier is not known:", *node);
+        }
+        returnTo(caller);
+        return ret;
+      }
+      returnTo(caller);
+      return *node;
+    }
+
+    const auto &head = children.front();
+    const AST *fun = cachedCall(head);
+    Value op;
+    if (!fun) {
+      // a builtin evaluates to itself
+      if (AST::Type::BUILTIN != head->type())
+        op = evalTree(head);
+      if (head->isBuiltin(Builtin::IF)) {
+        // the branch is a child of the node, which is held as long
+        node = &ifBranch(children);
+        continue;
+      }
+      if (AST::Type::BUILTIN == head->type() ||
+          op.type() == AST::Type::BUILTIN) {
+        auto tail = evalToTail(*node);
+        if (tail) {
+          held = std::move(tail);
+          node = &held;
+          continue;
+        }
+        const auto res = evalBuiltin(*node);
+        returnTo(caller);
+        return res;
+      } else if (op.type() != AST::Type::FUN) {
+        std::cout << AST::TypeToCString((*node)->type()) << std::endl;
+        throw SyntaxError("Uknown node type", *node);
+      }
+      fun = op.node().get();
+      cacheCall(head, fun);
+    }
+
+    assert(fun->children().size() == 3);
+    const auto &arglist = fun->children()[1];
+    // evaluating the arguments may redefine the function
+    auto body = fun->children()[2];
     showNode("ArgList: ", arglist);
-    showNode("Call: ", node);
-    auto newEnv = std::make_shared<Environment>();
-    for (unsigned int i = 1; i < arglist->children().size(); i++) {
-      newEnv->setEntry(symbolName(arglist->children()[i]),
-                       eval(node->children()[i]));
+    showNode("Call: ", *node);
+    const auto callee = framePool.acquire(arglist);
+    if (callee->size() != children.size() - 1)
+      throw SyntaxError("Wrong number of arguments", *node);
+    {
+      // not reachable from frame until it is called
+      Heap::Root root(heap_, callee);
+      for (unsigned int i = 0; i < callee->size(); i++) {
+        (*callee)[i] = evalTree(children[i + 1]);
+      }
     }
-    //    newEnv->dump();
-    newEnv->setParent(env);
-    env = newEnv;
-    const auto res = eval(op->children()[2]);
-    env = env->parent();
-    return res;
+    callee->setCaller(caller);
+    callee->setTyped(inferTypes && TypeInference::entryCheck(
+                                       *callee->params(), callee->args()));
+    Value res;
+    if (jit_ && jit_->call(fun, callee->args(), callee->size(), res)) {
+      framePool.release(callee);
+      returnTo(caller);
+      return res;
+    }
+    if (fun->children().front()->isBuiltin(Builtin::DEFINE_MEMO)) {
+      res = evalMemoized(fun, callee, body);
+      framePool.release(callee);
+      returnTo(caller);
+      return res;
+    }
+    //    callee->dump();
+    // the frame of a call replaced by a tail call is no longer needed
+    returnTo(caller);
+    frame = callee;
+    held = std::move(body);
+    node = &held;
   }
-  std::cout << AST::TypeToCString(node->type()) << std::endl;
-  throw SyntaxError("Uknown node type", node);
   return nullptr;
 }
 
-std::shared_ptr<AST> Interpreter::evalBuiltin(std::shared_ptr<AST> node) {
-  AST::List ls = node->children();
+std::shared_ptr<AST>
+Interpreter::evalToTail(const std::shared_ptr<AST> &node) {
+  const auto &ls = node->children();
+  const auto &opnode = ls.front();
+  switch (static_cast<const ASTBuiltin &>(*opnode).op()) {
+  case Builtin::IF:
+    return ifBranch(ls);
+  case Builtin::EVAL: {
+    // the elements of the list are the form evaluated
+    const auto form = std::make_shared<ASTSexpr>();
+    form->setChildren(getSingleListArg(opnode, ls)->data().toVector());
+    return form;
+  }
+  case Builtin::PPRINT:
+    return evalPPrint(opnode, ls);
+  default:
+    return nullptr;
+  }
+}
+
+Value Interpreter::evalBuiltin(const std::shared_ptr<AST> &node) {
+  const auto &ls = node->children();
   if (ls.front()->type() != AST::Type::BUILTIN) {
     throw SyntaxError("Expected builtin", ls.front());
   }
-  const auto opnode = std::static_pointer_cast<ASTBuiltin>(ls.front());
-  const auto op = opnode->op();
+  const auto &opnode = ls.front();
+  const auto op = static_cast<const ASTBuiltin &>(*opnode).op();
 
   switch (op) {
   case Builtin::ADD:
+    return evalIntOp<Builtin::ADD>(ls, isProven(*node));
   case Builtin::SUB:
+    return evalIntOp<Builtin::SUB>(ls, isProven(*node));
   case Builtin::DIV:
+    return evalIntOp<Builtin::DIV>(ls, isProven(*node));
   case Builtin::MUL:
+    return evalIntOp<Builtin::MUL>(ls, isProven(*node));
   case Builtin::MOD:
-    return evalIntOp(op, ls);
+    return evalIntOp<Builtin::MOD>(ls, isProven(*node));
   case Builtin::DEFINE:
+  case Builtin::DEFINE_MEMO:
     return evalDefine(node);
   case Builtin::LIST:
     return evalList(ls);
   case Builtin::HEAD:
-    return getSingleListArg(opnode, ls)->children().front();
+    return getSingleListArg(opnode, ls, isProven(*node))->data().front();
   case Builtin::TAIL:
-    return getSingleListArg(opnode, ls)->children().back();
+    return getSingleListArg(opnode, ls, isProven(*node))->data().back();
   case Builtin::JOIN:
-    return evalJoin(opnode, ls);
+    return evalJoin(opnode, ls, isProven(*node));
   case Builtin::EVAL:
-    return eval(getSingleListArg(opnode, ls));
   case Builtin::PPRINT:
-    return evalPPrint(opnode, ls);
   case Builtin::IF:
-    return evalIf(ls);
+    // handled by evalToTail
+    break;
   case Builtin::UNKNOWN:
     break;
   case Builtin::EQ:
-    return evalEq(ls);
+    return evalCompare<Builtin::EQ>(ls, isProven(*node));
   case Builtin::GT:
-    return evalIntCmp(ls, [](const auto &a, const auto &b) { return a > b; });
+    return evalCompare<Builtin::GT>(ls, isProven(*node));
   case Builtin::GE:
-    return evalIntCmp(ls, [](const auto &a, const auto &b) { return a >= b; });
+    return evalCompare<Builtin::GE>(ls, isProven(*node));
   case Builtin::LT:
-    return evalIntCmp(ls, [](const auto &a, const auto &b) { return a < b; });
+    return evalCompare<Builtin::LT>(ls, isProven(*node));
   case Builtin::LE:
-    return evalIntCmp(ls, [](const auto &a, const auto &b) { return a <= b; });
-    break;
+    return evalCompare<Builtin::LE>(ls, isProven(*node));
+  case Builtin::ARRAY:
+    return evalArray(ls);
+  case Builtin::MAKE_ARRAY:
+    return evalMakeArray(opnode, ls);
+  case Builtin::ARRAY_GET:
+    return evalArrayGet(opnode, ls);
+  case Builtin::ARRAY_SLICE:
+    return evalArraySlice(opnode, ls);
+  case Builtin::ARRAY_LENGTH:
+    requireSingleArgument(opnode, ls);
+    return Value::integer(getArrayArg(opnode, ls[1])->data().size());
+  case Builtin::CONS:
+    return evalCons(opnode, ls, isProven(*node));
+  case Builtin::REST:
+    return std::make_shared<ASTList>(
+        getSingleListArg(opnode, ls, isProven(*node))->data().rest());
+  case Builtin::CONCAT:
+    return evalConcat(opnode, ls);
+  case Builtin::SUBSTRING:
+    return evalSubstring(opnode, ls);
+  case Builtin::STRING_LENGTH:
+    requireSingleArgument(opnode, ls);
+    return Value::integer(getStringArg(opnode, ls[1])->data().size());
+  case Builtin::STRING_TO_LIST:
+    return evalStringToList(opnode, ls);
+  case Builtin::HASH:
+    return evalHash(opnode, ls);
+  case Builtin::HASH_GET:
+    return evalHashGet(opnode, ls);
+  case Builtin::HASH_SET:
+    return evalHashSet(opnode, ls);
+  case Builtin::HASH_REMOVE:
+    return evalHashRemove(opnode, ls);
+  case Builtin::HASH_SIZE: {
+    requireSingleArgument(opnode, ls);
+    const auto map = getMapArg(opnode, ls[1]);
+    return Value::integer(
+        AST::Type::MAP == map->type()
+            ? std::static_pointer_cast<ASTMap>(map)->data().size()
+            : std::static_pointer_cast<ASTTransientMap>(map)->data().size());
+  }
+  case Builtin::HASH_KEYS:
+    return evalHashEntries(opnode, ls, true);
+  case Builtin::HASH_VALUES:
+    return evalHashEntries(opnode, ls, false);
+  case Builtin::TRANSIENT:
+    return evalTransient(opnode, ls);
+  case Builtin::PERSISTENT:
+    return evalPersistent(opnode, ls);
+  case Builtin::PMAP:
+    return evalPMap(opnode, ls, false);
+  case Builtin::PFILTER:
+    return evalPMap(opnode, ls, true);
+  case Builtin::PREDUCE:
+    return evalPReduce(opnode, ls);
+  case Builtin::SPAWN:
+    return evalSpawn(opnode, ls);
+  case Builtin::SYNC:
+    return evalSync(opnode, ls);
   };
   throw SyntaxError("Unimplemented builtin", opnode);
   return nullptr;
 }
 
 std::shared_ptr<AST> Interpreter::evalList(const AST::List &ls) {
-  auto ret = std::make_shared<ASTBuiltin>(Builtin::LIST);
-  AST::List children(ls.begin() + 1, ls.end());
-  ret->setChildren(children);
-  return ret;
+  return std::make_shared<ASTList>(PersistentList(ls.begin() + 1, ls.end()));
 }
 
 std::shared_ptr<AST> Interpreter::evalJoin(const std::shared_ptr<AST> &opnode,
-                                           const AST::List &ls) {
-  AST::List children;
+                                           const AST::List &ls, bool proven) {
+  PersistentList res;
   for (auto it = (ls.begin() + 1); it != ls.end(); ++it) {
-    const auto node = eval(*it);
-    requireListType(opnode, node);
-    const auto xs = node->children();
-    children.insert(children.cend(), xs.cbegin(), xs.cend());
+    const auto value = evalTree(*it);
+    if (!proven)
+      requireListType(opnode, value);
+    res = PersistentList::join(
+        res, std::static_pointer_cast<ASTList>(value.node())->data());
   }
-  auto ret = std::make_shared<ASTBuiltin>(Builtin::LIST);
-  ret->setChildren(children);
-  return ret;
+  return std::make_shared<ASTList>(std::move(res));
 }
 
-std::shared_ptr<AST> Interpreter::evalIf(const AST::List &ls) {
-  const auto res = eval(ls[1]);
-  const auto isTrue = [ type = res->type(), &res ] {
-    if (AST::Type::BOOLEAN == res->type()) {
-      return std::static_pointer_cast<ASTBoolean>(res)->data();
-    }
-    if (res->isBuiltin(Builtin::LIST)) {
-      return res->children().size() > 0;
-    }
-
-    return 0 != std::static_pointer_cast<ASTInt>(res)->data();
-  }
-  ();
+std::shared_ptr<AST> Interpreter::evalCons(const std::shared_ptr<AST> &opnode,
+                                           const AST::List &ls, bool proven) {
+  requireArguments(opnode, ls, 2);
+  const auto element = evalTree(ls[1]).toAST();
+  const auto value = evalTree(ls[2]);
+  if (!proven)
+    requireListType(opnode, value);
+  return std::make_shared<ASTList>(
+      std::static_pointer_cast<ASTList>(value.node())->data().cons(element));
+}
 
-  if (isTrue) {
-    return eval(ls[2]);
-  } else {
-    return eval(ls[3]);
-  }
+const std::shared_ptr<AST> &Interpreter::ifBranch(const AST::List &ls) {
+  return isTrue(evalTree(ls[1])) ? ls[2] : ls[3];
 }
 
 std::shared_ptr<AST> Interpreter::evalPPrint(const std::shared_ptr<AST> &opnode,
                                              const AST::List &ls) {
   requireSingleArgument(opnode, ls);
+  if (worker_)
+    throw SyntaxError("Parallel functions can not print", opnode);
   const auto node = ls[1];
-  util::print(node);
-  std::cout << std::endl;
-  return eval(node);
+  output_.print(*node);
+  output_.write('\n');
+  return node;
 }
 
-std::shared_ptr<AST> Interpreter::evalIntOp(Builtin intOp, AST::List ls) {
+template <Builtin op>
+Value Interpreter::evalIntOp(const AST::List &ls, bool proven) {
   if (ls.size() == 1)
     throw SyntaxError("Expected operators for operator", ls.front());
 
-  const auto first = eval(ls[1]);
-  requireIntType(first);
-  const auto firstVal = std::static_pointer_cast<ASTInt>(first)->data();
-
-  const auto op = [intOp, &ls]() -> std::function<int(const int, const int)> {
-    switch (intOp) {
-    case Builtin::ADD:
-      return [](const int a, const int b) { return a + b; };
-    case Builtin::SUB:
-      return [](const int a, const int b) { return a - b; };
-    case Builtin::MUL:
-      return [](const int a, const int b) { return a * b; };
-    case Builtin::DIV:
-      return [](const int a, const int b) { return a / b; };
-    case Builtin::MOD:
-      return [](const int a, const int b) { return a % b; };
-    default:
-      throw SyntaxError("Can not use unknown op", ls.front());
+  auto acc = evalTree(ls[1]);
+  if (!proven)
+    requireArithmeticType(acc);
+  for (size_t i = 2; i < ls.size(); i++) {
+    const auto n = evalTree(ls[i]);
+    if (!proven)
+      requireArithmeticType(n);
+    acc = number::arithmetic<op>(acc, n);
+  }
+  return acc;
+}
+
+template <Builtin op>
+Value Interpreter::evalCompare(const AST::List &ls, bool proven) {
+  if (proven) {
+    // no vector of the operands to check for the same type
+    auto a = evalTree(ls[1]);
+    bool res = true;
+    for (size_t i = 2; i < ls.size(); i++) {
+      auto b = evalTree(ls[i]);
+      res = res && number::compare<op>(a, b);
+      a = std::move(b);
     }
-    return nullptr;
-  }();
-  return std::make_shared<ASTInt>(applyIntOp(firstVal, ls, 2, op));
+    return Value::boolean(res);
+  }
+  if (3 == ls.size()) {
+    const auto a = evalTree(ls[1]);
+    const auto b = evalTree(ls[2]);
+    if (a.isInteger() && b.isInteger())
+      return Value::boolean(IntKernel<op>::apply(a.integer(), b.integer()));
+    return compare<op>(ls, {a, b});
+  }
+  return compare<op>(ls, getEvaledArgs(ls));
 }
 
-int Interpreter::applyIntOp(const int acc, const AST::List ls, const size_t idx,
-                            std::function<int(const int, const int)> op) {
-  if (ls.size() == idx)
-    return acc;
-  const auto n = eval(ls[idx]);
-  requireIntType(n);
-  const auto intNode = std::static_pointer_cast<ASTInt>(n);
-  return applyIntOp(op(acc, intNode->data()), ls, idx + 1, op);
-}
-
-template <typename PtrType, class BinOp>
-bool applyOp(const AST::List &ls, BinOp op) {
-  for (unsigned int i = 1; i < ls.size(); i++) {
-    const auto &a = std::static_pointer_cast<PtrType>(ls[i - 1])->data();
-    const auto &b = std::static_pointer_cast<PtrType>(ls[i])->data();
-    if (!op(a, b))
-      return false;
+template <Builtin op>
+Value Interpreter::compare(const AST::List &ls, const std::vector<Value> &ys) {
+  if (std::all_of(std::cbegin(ys), std::cend(ys),
+                  [](const auto &y) { return y.isNumber(); })) {
+    // fixnums, bignums and floats
+    for (size_t i = 1; i < ys.size(); i++) {
+      if (!number::compare<op>(ys[i - 1], ys[i]))
+        return Value::boolean(false);
+    }
+    return Value::boolean(true);
+  }
+  const auto type = ys.front().type();
+  if (!std::all_of(std::cbegin(ys), std::cend(ys),
+                   [type](const auto &y) { return type == y.type(); })) {
+    throw SyntaxError("All arguments must be of same type", ls.front());
+  }
+  if (Builtin::EQ == op && AST::Type::STRING == type) {
+    for (size_t i = 1; i < ys.size(); i++) {
+      const auto a = std::static_pointer_cast<ASTString>(ys[i - 1].node());
+      const auto b = std::static_pointer_cast<ASTString>(ys[i].node());
+      if (a->data() != b->data())
+        return Value::boolean(false);
+    }
+    return Value::boolean(true);
+  }
+  if (Builtin::EQ == op)
+    throw SyntaxError("Uniplemented operation", ls.front());
+  requireIntType(ys.front());
+  return Value::boolean(true);
+}
+
+Value Interpreter::evalArray(const AST::List &ls) {
+  std::vector<Value> elements;
+  bool floats = false;
+  for (size_t i = 1; i < ls.size(); i++) {
+    elements.emplace_back(evalTree(ls[i]));
+    if (!elements.back().isNumber())
+      throw SyntaxError("Array elements must be numbers", ls[i]);
+    floats = floats || elements.back().isFloat();
+  }
+  if (floats) {
+    TypedArray array(TypedArray::Element::FLOAT, elements.size());
+    for (size_t i = 0; i < elements.size(); i++) {
+      array.floats()[i] = number::toDouble(elements[i]);
+    }
+    return std::make_shared<ASTArray>(std::move(array));
   }
-  return true;
+  TypedArray array(TypedArray::Element::INT, elements.size());
+  for (size_t i = 0; i < elements.size(); i++) {
+    if (!elements[i].isInteger())
+      throw SyntaxError("Array element does not fit in 64 bits", ls[i + 1]);
+    array.ints()[i] = elements[i].integer();
+  }
+  return std::make_shared<ASTArray>(std::move(array));
 }
 
-std::shared_ptr<AST> Interpreter::evalEq(AST::List xs) {
-  const auto ys = getEvaledArgs(xs);
-  switch (ys.front()->type()) {
-  case AST::Type::STRING: {
-    const auto res = applyOp<ASTString>(
-        ys, [](const auto &a, const auto &b) { return 0 == strcmp(a, b); });
-    return std::make_shared<ASTBoolean>(res);
+Value Interpreter::evalMakeArray(const std::shared_ptr<AST> &opnode,
+                                 const AST::List &ls) {
+  requireArguments(opnode, ls, 2);
+  const auto size =
+      getIndexArg(opnode, ls[1], std::numeric_limits<int64_t>::max());
+  const auto fill = evalTree(ls[2]);
+  if (fill.isFloat()) {
+    TypedArray array(TypedArray::Element::FLOAT, size);
+    std::fill_n(array.floats(), size, fill.floating());
+    return std::make_shared<ASTArray>(std::move(array));
   }
-  case AST::Type::INTEGER: {
-    const auto res = applyOp<ASTInt>(
-        ys, [](const auto &a, const auto &b) { return a == b; });
-    return std::make_shared<ASTBoolean>(res);
+  if (!fill.isInteger())
+    throw SyntaxError("Array elements must be fixnums or floats", ls[2]);
+  TypedArray array(TypedArray::Element::INT, size);
+  std::fill_n(array.ints(), size, fill.integer());
+  return std::make_shared<ASTArray>(std::move(array));
+}
+
+Value Interpreter::evalArrayGet(const std::shared_ptr<AST> &opnode,
+                                const AST::List &ls) {
+  requireArguments(opnode, ls, 2);
+  const auto array = getArrayArg(opnode, ls[1]);
+  const auto &data = array->data();
+  if (!data.size())
+    throw SyntaxError("Index out of range", ls[2]);
+  const auto i = getIndexArg(opnode, ls[2], data.size() - 1);
+  if (TypedArray::Element::FLOAT == data.element())
+    return Value::floating(data.floats()[i]);
+  return Value::integer(data.ints()[i]);
+}
+
+Value Interpreter::evalArraySlice(const std::shared_ptr<AST> &opnode,
+                                  const AST::List &ls) {
+  requireArguments(opnode, ls, 3);
+  const auto array = getArrayArg(opnode, ls[1]);
+  const auto &data = array->data();
+  const auto start = getIndexArg(opnode, ls[2], data.size());
+  const auto end = getIndexArg(opnode, ls[3], data.size());
+  if (end < start)
+    throw SyntaxError("Slice ends before it starts", ls[3]);
+  return std::make_shared<ASTArray>(data.slice(start, end));
+}
+
+Value Interpreter::evalConcat(const std::shared_ptr<AST> &opnode,
+                              const AST::List &ls) {
+  Rope res;
+  for (size_t i = 1; i < ls.size(); i++) {
+    res = Rope::concat(res, getStringArg(opnode, ls[i])->data());
   }
+  return std::make_shared<ASTString>(std::move(res));
+}
+
+Value Interpreter::evalSubstring(const std::shared_ptr<AST> &opnode,
+                                 const AST::List &ls) {
+  requireArguments(opnode, ls, 3);
+  const auto str = getStringArg(opnode, ls[1]);
+  const auto &data = str->data();
+  const auto start = getIndexArg(opnode, ls[2], data.size());
+  const auto end = getIndexArg(opnode, ls[3], data.size());
+  if (end < start)
+    throw SyntaxError("Substring ends before it starts", ls[3]);
+  return std::make_shared<ASTString>(data.substring(start, end));
+}
+
+Value Interpreter::evalStringToList(const std::shared_ptr<AST> &opnode,
+                                    const AST::List &ls) {
+  requireSingleArgument(opnode, ls);
+  const auto str = getStringArg(opnode, ls[1]);
+  PersistentList::Elements chars;
+  chars.reserve(str->data().size());
+  str->data().forEachPiece([&chars](const char *piece, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+      chars.push_back(std::make_shared<ASTString>(Rope(piece + i, 1)));
+    }
+  });
+  return std::make_shared<ASTList>(PersistentList(chars.begin(), chars.end()));
+}
+
+/// Call fn with the node of the key, fixnums, floats and booleans are
+/// looked up without boxing them on the heap
+template <typename Fn>
+static auto withKeyNode(const Value &key, Fn fn)
+    -> decltype(fn(std::declval<const AST &>())) {
+  switch (key.type()) {
+  case AST::Type::INTEGER:
+    return fn(ASTInt(key.integer()));
+  case AST::Type::FLOAT:
+    return fn(ASTFloat(key.floating()));
+  case AST::Type::BOOLEAN:
+    return fn(ASTBoolean(key.boolean()));
   default:
-    throw SyntaxError("Uniplemented operation", xs.front());
+    return fn(*key.node());
   }
+}
 
-  return std::make_shared<ASTBoolean>(false);
+/// Call fn with each key and value of a persistent or transient map
+template <typename Fn>
+static void forEachEntry(const std::shared_ptr<AST> &map, Fn fn) {
+  if (AST::Type::MAP == map->type())
+    std::static_pointer_cast<ASTMap>(map)->data().forEach(fn);
+  else
+    std::static_pointer_cast<ASTTransientMap>(map)->data().forEach(fn);
 }
 
-std::shared_ptr<AST>
-Interpreter::evalIntCmp(const AST::List &ls,
-                        std::function<bool(const int &, const int &)> cmp) {
-  const auto ys = getEvaledArgs(ls);
-  requireIntType(ys.front());
-  const auto res = applyOp<ASTInt>(ys, cmp);
-  return std::make_shared<ASTBoolean>(res);
+/// True if value is or holds a transient map, or a future whose value may
+/// be one. Lists, maps and forms are walked with an explicit stack, each
+/// node shared by several of them once.
+static bool reachesTransient(const std::shared_ptr<AST> &value) {
+  const auto leaf = [](const AST &node) {
+    switch (node.type()) {
+    case AST::Type::LIST:
+    case AST::Type::MAP:
+    case AST::Type::TRANSIENT_MAP:
+    case AST::Type::FUTURE:
+      return false;
+    default:
+      return node.children().empty();
+    }
+  };
+  if (leaf(*value))
+    return false;
+  std::vector<const AST *> stack{value.get()};
+  std::unordered_set<const AST *> seen{value.get()};
+  const auto push = [&stack, &seen, &leaf](const std::shared_ptr<AST> &node) {
+    if (!leaf(*node) && seen.insert(node.get()).second)
+      stack.push_back(node.get());
+  };
+  while (!stack.empty()) {
+    const auto &node = *stack.back();
+    stack.pop_back();
+    switch (node.type()) {
+    case AST::Type::TRANSIENT_MAP:
+    case AST::Type::FUTURE:
+      return true;
+    case AST::Type::LIST:
+      static_cast<const ASTList &>(node).data().forEach(push);
+      break;
+    case AST::Type::MAP:
+      // the keys are atoms
+      static_cast<const ASTMap &>(node).data().forEach(
+          [&push](const std::shared_ptr<AST> &,
+                  const std::shared_ptr<AST> &value) { push(value); });
+      break;
+    default:
+      for (const auto &child : node.children()) {
+        push(child);
+      }
+    }
+  }
+  return false;
+}
+
+Value Interpreter::evalHash(const std::shared_ptr<AST> &opnode,
+                            const AST::List &ls) {
+  if (0 == ls.size() % 2)
+    throw SyntaxError("Builtin requires keys and values", opnode);
+  PersistentMap map;
+  for (size_t i = 1; i < ls.size(); i += 2) {
+    const auto key = getKeyArg(opnode, ls[i]);
+    map = map.set(key.toAST(), evalTree(ls[i + 1]).toAST());
+  }
+  return std::make_shared<ASTMap>(std::move(map));
+}
+
+Value Interpreter::evalHashGet(const std::shared_ptr<AST> &opnode,
+                               const AST::List &ls) {
+  // (hash-get map key) or (hash-get map key default)
+  if (3 != ls.size() && 4 != ls.size())
+    throw SyntaxError("Wrong number of arguments", opnode);
+  const auto map = getMapArg(opnode, ls[1]);
+  const auto key = getKeyArg(opnode, ls[2]);
+  const auto value = withKeyNode(key, [&map](const AST &node) {
+    if (AST::Type::MAP == map->type())
+      return std::static_pointer_cast<ASTMap>(map)->data().find(node);
+    return std::static_pointer_cast<ASTTransientMap>(map)->data().find(node);
+  });
+  if (value)
+    return *value;
+  if (4 == ls.size())
+    return evalTree(ls[3]);
+  throw SyntaxError("Key not found", key.toAST());
+}
+
+Value Interpreter::evalHashSet(const std::shared_ptr<AST> &opnode,
+                               const AST::List &ls) {
+  requireArguments(opnode, ls, 3);
+  const auto map = getMapArg(opnode, ls[1]);
+  auto key = getKeyArg(opnode, ls[2]).toAST();
+  auto value = evalTree(ls[3]).toAST();
+  if (AST::Type::TRANSIENT_MAP == map->type()) {
+    // A value reaching a transient, this one maybe, could close a cycle
+    // no count releases and printing never ends. It is the only change
+    // made in place, so values are never cyclic. Keys are atoms already.
+    if (reachesTransient(value))
+      throw SyntaxError(
+          "A transient can not hold transients or futures, nested or not",
+          opnode);
+    std::static_pointer_cast<ASTTransientMap>(map)->map().set(
+        std::move(key), std::move(value));
+    return map;
+  }
+  return std::make_shared<ASTMap>(
+      std::static_pointer_cast<ASTMap>(map)->data().set(std::move(key),
+                                                        std::move(value)));
+}
+
+Value Interpreter::evalHashRemove(const std::shared_ptr<AST> &opnode,
+                                  const AST::List &ls) {
+  requireArguments(opnode, ls, 2);
+  const auto map = getMapArg(opnode, ls[1]);
+  const auto key = getKeyArg(opnode, ls[2]);
+  if (AST::Type::TRANSIENT_MAP == map->type()) {
+    auto &data = std::static_pointer_cast<ASTTransientMap>(map)->map();
+    withKeyNode(key, [&data](const AST &node) { return data.remove(node); });
+    return map;
+  }
+  const auto &data = std::static_pointer_cast<ASTMap>(map)->data();
+  return std::make_shared<ASTMap>(withKeyNode(
+      key, [&data](const AST &node) { return data.remove(node); }));
+}
+
+Value Interpreter::evalHashEntries(const std::shared_ptr<AST> &opnode,
+                                   const AST::List &ls, bool keys) {
+  requireSingleArgument(opnode, ls);
+  PersistentList::Elements elements;
+  forEachEntry(getMapArg(opnode, ls[1]),
+               [&elements, keys](const std::shared_ptr<AST> &key,
+                                 const std::shared_ptr<AST> &value) {
+                 elements.push_back(keys ? key : value);
+               });
+  return std::make_shared<ASTList>(
+      PersistentList(elements.begin(), elements.end()));
+}
+
+Value Interpreter::evalTransient(const std::shared_ptr<AST> &opnode,
+                                 const AST::List &ls) {
+  requireSingleArgument(opnode, ls);
+  HashMap map;
+  forEachEntry(getMapArg(opnode, ls[1]),
+               [&map](const std::shared_ptr<AST> &key,
+                      const std::shared_ptr<AST> &value) {
+                 map.set(key, value);
+               });
+  return std::make_shared<ASTTransientMap>(std::move(map));
+}
+
+Value Interpreter::evalPersistent(const std::shared_ptr<AST> &opnode,
+                                  const AST::List &ls) {
+  requireSingleArgument(opnode, ls);
+  const auto node = getMapArg(opnode, ls[1]);
+  if (AST::Type::MAP == node->type())
+    return node;
+  return std::make_shared<ASTMap>(PersistentMap(
+      std::static_pointer_cast<ASTTransientMap>(node)->data()));
+}
+
+Value Interpreter::evalPMap(const std::shared_ptr<AST> &opnode,
+                            const AST::List &ls, bool filter) {
+  requireArguments(opnode, ls, 2);
+  const auto f = evalTree(ls[1]);
+  const auto xs = evalTree(ls[2]);
+  requireListType(opnode, xs);
+  const auto elements =
+      std::static_pointer_cast<ASTList>(xs.node())->data().toVector();
+  std::vector<Value> results(elements.size());
+  parallel(opnode, f, 1, elements.size(),
+           [&elements, &results](Interpreter &interpreter,
+                                 const Callable &fun, size_t begin,
+                                 size_t end) {
+             for (auto i = begin; i < end; i++) {
+               const Value x = elements[i];
+               results[i] = interpreter.apply(fun, &x, 1);
+             }
+           });
+  PersistentList::Elements res;
+  res.reserve(elements.size());
+  for (size_t i = 0; i < elements.size(); i++) {
+    if (!filter)
+      res.push_back(results[i].toAST());
+    else if (isTrue(results[i]))
+      res.push_back(elements[i]);
+  }
+  return std::make_shared<ASTList>(PersistentList(res.begin(), res.end()));
+}
+
+Value Interpreter::evalPReduce(const std::shared_ptr<AST> &opnode,
+                               const AST::List &ls) {
+  requireArguments(opnode, ls, 3);
+  const auto f = evalTree(ls[1]);
+  auto acc = evalTree(ls[2]);
+  const auto xs = evalTree(ls[3]);
+  requireListType(opnode, xs);
+  const auto elements =
+      std::static_pointer_cast<ASTList>(xs.node())->data().toVector();
+  if (serial(elements.size())) {
+    // the left fold from init, which needs no associative f
+    const auto fun = callable(opnode, f, 2);
+    for (const auto &x : elements) {
+      const Value args[2] = {acc, x};
+      acc = apply(fun, args, 2);
+    }
+    return acc;
+  }
+  // the fold of each chunk, at the index of its first element
+  std::vector<Value> folds(elements.size());
+  parallel(opnode, f, 2, elements.size(),
+           [&elements, &folds](Interpreter &interpreter, const Callable &fun,
+                               size_t begin, size_t end) {
+             if (begin == end)
+               return;
+             Value args[2] = {elements[begin], nullptr};
+             for (auto i = begin + 1; i < end; i++) {
+               args[1] = elements[i];
+               args[0] = interpreter.apply(fun, args, 2);
+             }
+             folds[begin] = args[0];
+           });
+  // the folds are joined in order, starting from init
+  const auto fun = callable(opnode, f, 2);
+  for (const auto &fold : folds) {
+    if (!fold)
+      continue;
+    const Value args[2] = {acc, fold};
+    acc = apply(fun, args, 2);
+  }
+  return acc;
+}
+
+Value Interpreter::evalSpawn(const std::shared_ptr<AST> &opnode,
+                             const AST::List &ls) {
+  requireSingleArgument(opnode, ls);
+  const auto &call = ls[1];
+  const auto &children = call->children();
+  auto *scheduler = spawner();
+  // a builtin is cheap once its operands are evaluated
+  if (!scheduler || children.empty() ||
+      AST::Type::BUILTIN == children.front()->type() ||
+      scheduler->inlines(taskWorker_))
+    return evalTree(call);
+  if (this == root_ && 0 == scheduler->pending()) {
+    // no task runs, the workers copy the functions defined since
+    for (const auto &worker : taskWorkers) {
+      worker->syncWith(globals);
+    }
+  }
+  const auto f = evalTree(children.front());
+  if (AST::Type::FUN != f.type()) {
+    // a builtin bound to a name, or not a function
+    return evalTree(call);
+  }
+  if (f.node()->children()[1]->children().size() != children.size())
+    throw SyntaxError("Wrong number of arguments", call);
+  std::vector<Value> args;
+  args.reserve(children.size() - 1);
+  for (size_t i = 1; i < children.size(); i++) {
+    args.push_back(original(evalTree(children[i])));
+  }
+  auto task = std::make_shared<Spawned>(*root_, original(f), std::move(args));
+  scheduler->spawn(taskWorker_, task);
+  return std::make_shared<ASTFuture>(std::move(task));
 }
 
-AST::List Interpreter::getEvaledArgs(const AST::List xs) {
+Value Interpreter::evalSync(const std::shared_ptr<AST> &opnode,
+                            const AST::List &ls) {
+  requireSingleArgument(opnode, ls);
+  const auto value = evalTree(ls[1]);
+  if (AST::Type::FUTURE != value.type())
+    return value;
+  const auto &task = static_cast<const Spawned &>(
+      *std::static_pointer_cast<ASTFuture>(value.node())->data());
+  if (!task.done()) {
+    auto *scheduler = root_->scheduler_.get();
+    if (scheduler) {
+      scheduler->wait(taskWorker_, task);
+    } else {
+      // spawned by another interpreter, which is not done with it
+      task.root.scheduler_->await(task);
+    }
+  }
+  if (task.error)
+    std::rethrow_exception(task.error);
+  return local(task.result);
+}
+
+std::vector<Value> Interpreter::getEvaledArgs(const AST::List &xs) {
   if (xs.size() < 3)
     throw SyntaxError("Expected operators for operator", xs.front());
 
-  AST::List ys;
+  std::vector<Value> ys;
   for (unsigned int i = 1; i < xs.size(); i++) {
-    ys.emplace_back(eval(xs[i]));
-  }
-  if (!std::all_of(std::cbegin(ys), std::cend(ys),
-                   [type = ys.front()->type()](const auto &y) {
-                     return type == y->type();
-                   })) {
-    throw SyntaxError("All arguments must be of same type", xs.front());
+    ys.emplace_back(evalTree(xs[i]));
   }
   return ys;
 }
 
-std::shared_ptr<AST> Interpreter::evalDefine(const std::shared_ptr<AST> &node) {
-  const auto ls = node->children();
-  const auto argList = ls[1];
+Value Interpreter::evalDefine(const std::shared_ptr<AST> &node) {
+  if (worker_)
+    throw SyntaxError("Parallel functions can not define", node);
+  const auto &ls = node->children();
+  const auto &argList = ls[1];
+  const bool memoized = ls.front()->isBuiltin(Builtin::DEFINE_MEMO);
   if (AST::Type::SYMBOL == argList->type()) {
     // Define a variable
-    const auto name = symbolName(argList);
+    if (memoized)
+      throw SyntaxError("Only functions can be memoized", node);
+    const auto name = symbol(argList);
     const auto body = ls[2];
-    env->setEntry(name, body);
+    forgetMemo(name);
+    globals->setEntry(name, body);
   } else {
     showNode("Define function: ", node);
     if (argList->children().size() < 1) {
@@ -276,48 +1309,145 @@ std::shared_ptr<AST> Interpreter::evalDefine(const std::shared_ptr<AST> &node) {
         throw SyntaxError("Arglist must only contain identifiers", argList);
       }
     }
+    if (memoized)
+      requirePure(ls[2]);
+    resolve(argList, ls[2]);
+    if (inferTypes)
+      typeInference.infer(*node);
     node->setType(AST::Type::FUN);
-    env->setEntry(symbolName(argList->head()), node);
+    const auto name = symbol(argList->head());
+    forgetMemo(name);
+    if (memoized)
+      memos[node.get()] = std::make_shared<Memo>(memoCapacity_);
+    globals->setEntry(name, node);
   }
   return std::make_shared<ASTSexpr>();
 }
 
-void Interpreter::requireIntType(std::shared_ptr<AST> node) {
-  if (node->type() != AST::Type::INTEGER) {
-    throw SyntaxError("Operator works only on integer types", node);
+void Interpreter::resolve(const std::shared_ptr<AST> &params,
+                          const std::shared_ptr<AST> &node) {
+  if (AST::Type::SYMBOL == node->type()) {
+    const auto symbol = std::static_pointer_cast<ASTSymbol>(node);
+    const auto &args = params->children();
+    for (unsigned int i = 1; i < args.size(); i++) {
+      if (std::static_pointer_cast<ASTSymbol>(args[i])->data() ==
+          symbol->data()) {
+        symbol->resolve(ASTSymbol::Scope::ARGUMENT, i - 1);
+        return;
+      }
+    }
+    symbol->resolve(ASTSymbol::Scope::GLOBAL);
+    return;
+  }
+  const auto &children = node->children();
+  if (children.empty())
+    return;
+  // the operands of list and define are data, not references
+  if (children.front()->isBuiltin(Builtin::LIST) ||
+      children.front()->isBuiltin(Builtin::DEFINE) ||
+      children.front()->isBuiltin(Builtin::DEFINE_MEMO))
+    return;
+  for (const auto &child : children) {
+    resolve(params, child);
   }
 }
 
-std::shared_ptr<AST>
-Interpreter::getSingleListArg(const std::shared_ptr<AST> &opnode,
-                              const AST::List &ls) {
-  requireSingleArgument(opnode, ls);
-  const auto node = eval(ls[1]);
-  requireNonEmptyList(opnode, node);
-  return node;
+void Interpreter::requireIntType(const Value &value) {
+  if (!value.isNumber()) {
+    throw SyntaxError("Operator works only on integer types", value.toAST());
+  }
 }
 
-void Interpreter::requireNonEmptyList(const std::shared_ptr<AST> &opnode,
-                                      std::shared_ptr<AST> node) {
-  requireListType(opnode, node);
-  if (0 == node->children().size())
+void Interpreter::requireArithmeticType(const Value &value) {
+  if (!value.isNumber() && !value.isArray()) {
+    throw SyntaxError("Operator works only on integer types", value.toAST());
+  }
+}
+
+std::shared_ptr<ASTList>
+Interpreter::getSingleListArg(const std::shared_ptr<AST> &opnode,
+                              const AST::List &ls, bool proven) {
+  requireSingleArgument(opnode, ls);
+  const auto value = evalTree(ls[1]);
+  if (!proven)
+    requireListType(opnode, value);
+  const auto list = std::static_pointer_cast<ASTList>(value.node());
+  if (list->data().empty())
     throw SyntaxError("Operator does not work on empty list", opnode);
+  return list;
 }
 
 void Interpreter::requireSingleArgument(const std::shared_ptr<AST> &opnode,
-                                        AST::List ls) {
+                                        const AST::List &ls) {
   if (2 != ls.size()) {
     throw SyntaxError("Builtin requires exactly one argument", opnode);
   }
 }
 
+void Interpreter::requireArguments(const std::shared_ptr<AST> &opnode,
+                                   const AST::List &ls, size_t count) {
+  if (count + 1 != ls.size()) {
+    throw SyntaxError("Wrong number of arguments", opnode);
+  }
+}
+
+std::shared_ptr<ASTArray>
+Interpreter::getArrayArg(const std::shared_ptr<AST> &opnode,
+                         const std::shared_ptr<AST> &node) {
+  const auto value = evalTree(node);
+  if (!value.isArray())
+    throw SyntaxError("Argument must be an array", opnode);
+  return std::static_pointer_cast<ASTArray>(value.node());
+}
+
+std::shared_ptr<ASTString>
+Interpreter::getStringArg(const std::shared_ptr<AST> &opnode,
+                          const std::shared_ptr<AST> &node) {
+  const auto value = evalTree(node);
+  if (AST::Type::STRING != value.type())
+    throw SyntaxError("Argument must be a string", opnode);
+  return std::static_pointer_cast<ASTString>(value.node());
+}
+
+std::shared_ptr<AST>
+Interpreter::getMapArg(const std::shared_ptr<AST> &opnode,
+                       const std::shared_ptr<AST> &node) {
+  const auto value = evalTree(node);
+  if (AST::Type::MAP != value.type() &&
+      AST::Type::TRANSIENT_MAP != value.type())
+    throw SyntaxError("Argument must be a map", opnode);
+  return value.node();
+}
+
+Value Interpreter::getKeyArg(const std::shared_ptr<AST> &opnode,
+                             const std::shared_ptr<AST> &node) {
+  auto value = evalTree(node);
+  const bool hashable = withKeyNode(
+      value, [](const AST &key) { return HashMap::hashable(key); });
+  if (!hashable)
+    throw SyntaxError("Key must be a number, string, symbol or boolean",
+                      opnode);
+  return value;
+}
+
+size_t Interpreter::getIndexArg(const std::shared_ptr<AST> &opnode,
+                                const std::shared_ptr<AST> &node,
+                                size_t limit) {
+  const auto value = evalTree(node);
+  if (!value.isInteger())
+    throw SyntaxError("Argument must be an integer", opnode);
+  if (value.integer() < 0 || static_cast<size_t>(value.integer()) > limit)
+    throw SyntaxError("Index out of range", node);
+  return value.integer();
+}
+
 void Interpreter::requireListType(const std::shared_ptr<AST> &opnode,
-                                  std::shared_ptr<AST> node) {
-  if (!node || !node->isBuiltin(Builtin::LIST))
+                                  const Value &value) {
+  if (!value || !value.isList())
     throw SyntaxError("Argument must be a list", opnode);
 }
 
-const char *Interpreter::symbolName(std::shared_ptr<AST> node) {
+Symbol Interpreter::symbol(std::shared_ptr<AST> node) {
   if (AST::Type::SYMBOL != node->type())
     throw SyntaxError("Expected symbol", node);
   return std::static_pointer_cast<ASTSymbol>(node)->data();
@@ -1,60 +1,351 @@
 #ifndef INTERPRETER_H_
 #define INTERPRETER_H_
 #include "AST.h"
+#include "Environment.h"
+#include "Heap.h"
+#include "Jit.h"
+#include "Printer.h"
+#include "Scheduler.h"
+#include "TypeInference.h"
+#include "Value.h"
+
 #include <functional>
+#include <unordered_map>
 
-class Environment;
+class Memo;
+class ThreadPool;
+class VM;
 
 class Interpreter {
 public:
-  Interpreter();
+  /// How forms are evaluated, both engines share the global environment
+  enum class Engine { TREE, BYTECODE };
+
+  explicit Interpreter(Engine engine = Engine::TREE,
+                       size_t heapSize = Heap::DEFAULT_SIZE);
+  ~Interpreter();
   std::shared_ptr<AST> eval(std::shared_ptr<AST> node);
 
+  Engine engine() const;
+  void setEngine(Engine engine);
+
   const std::shared_ptr<Environment> environment() const;
+  /// Holds the frames of function calls
+  Heap &heap();
+  /// Where pprint writes, standard output flushed when the buffer is full,
+  /// by flush or when the interpreter is destroyed
+  Printer &output();
+
+  /// Calls of global functions that found the function in the inline
+  /// cache of the call site and those that had to look it up
+  struct CallCacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    /// Hits per call, 0 before the first call
+    double hitRate() const;
+  };
+  const CallCacheStats &callCacheStats() const;
+
+  /// Calls of functions defined by define-memo answered from the memo,
+  /// those evaluated and the results dropped to stay within the capacity
+  struct MemoStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+  };
+  const MemoStats &memoStats() const;
+  /// Results kept per memoized function, for functions defined later
+  void setMemoCapacity(size_t capacity);
+
+  /// Compile functions called threshold times to machine code, see Jit
+  void enableJit(unsigned int threshold = Jit::DEFAULT_THRESHOLD);
+  /// nullptr unless enabled
+  const Jit *jit() const;
+
+  /// Infer the types in functions defined later and skip the checks of
+  /// builtins on proven operands, on by default
+  void setTypeInference(bool enabled);
+  const TypeInference::Stats &typeInferenceStats() const;
+
+  /// Threads evaluating pmap, pfilter, preduce and spawned calls, the
+  /// calling one included, by default the number of cores. With one thread
+  /// they are evaluated serially.
+  void setThreads(unsigned threads);
+  unsigned threads() const;
+  /// Lists shorter than items are mapped and reduced serially, waking the
+  /// workers costs more than evaluating a few elements
+  void setSerialCutoff(size_t items);
+  static const size_t DEFAULT_SERIAL_CUTOFF = 16;
+  /// Tasks queued by a thread at which its spawns evaluate their calls at
+  /// once, see Scheduler
+  void setSpawnCutoff(size_t tasks);
+  /// Runs spawned calls, nullptr before the first spawn on more than one
+  /// thread
+  const Scheduler *scheduler() const;
+
+  /// Truth value of a predicate, false, 0, the empty list and the empty
+  /// array are false
+  static bool isTrue(const Value &value);
+
+  static const char *engineToCString(Engine engine);
+  static Engine engineFromCString(const char *str);
+
 private:
-  std::shared_ptr<AST> evalBuiltin(std::shared_ptr<AST> node);
+  friend class VM;
+
+  Value evalTree(const std::shared_ptr<AST> &form);
+  /// Evaluate node by the tree walker with scope as the current frame,
+  /// nullptr at top-level
+  Value evalIn(Frame *scope, std::shared_ptr<AST> node);
+  /// Restore the frame evalTree was called with, releasing the frame of
+  /// the call it evaluated
+  void returnTo(Frame *caller);
+  Value lookup(const ASTSymbol &symbol);
+  /// The function in the inline cache of a call with head, nullptr on a
+  /// miss or if the call can not be cached
+  const AST *cachedCall(const std::shared_ptr<AST> &head);
+  void cacheCall(const std::shared_ptr<AST> &head, const AST *fun);
+  /// Memo of a function defined by define-memo, nullptr for others
+  std::shared_ptr<Memo> memoOf(const AST *fun) const;
+  /// Find the result of a call with args in memo, false on a miss or if
+  /// the arguments can not be cached
+  bool recall(Memo &memo, const Value *args, size_t argc, Value &result);
+  void memorize(Memo &memo, const Value *args, size_t argc, Value result);
+  /// Evaluate the body of the memoized function fun with the arguments in
+  /// callee
+  Value evalMemoized(const AST *fun, Frame *callee,
+                     const std::shared_ptr<AST> &body);
+  /// A function or builtin applied to values by pmap, pfilter and
+  /// preduce. The function with its arglist and body, for a builtin op
+  /// the body (op $0 $1) with the arguments resolved to the slots of the
+  /// arglist (op $0 $1).
+  struct Callable {
+    std::shared_ptr<AST> fun;
+    std::shared_ptr<AST> params;
+    std::shared_ptr<AST> body;
+  };
+  /// f as a callable of arity arguments, a worker calls its copy of a
+  /// function
+  Callable callable(const std::shared_ptr<AST> &opnode, const Value &f,
+                    size_t arity);
+  Value apply(const Callable &f, const Value *args, size_t argc);
+  /// Evaluates the items from begin up to end by interpreter with f the
+  /// callable there
+  using Chunk = std::function<void(Interpreter &interpreter,
+                                   const Callable &f, size_t begin,
+                                   size_t end)>;
+  /// Call chunk for parts of the items from 0 up to n on the workers, or
+  /// once for all of them by this interpreter. The first exception thrown
+  /// by a chunk is rethrown once all returned.
+  void parallel(const std::shared_ptr<AST> &opnode, const Value &f,
+                size_t arity, size_t n, const Chunk &chunk);
+  /// True if parallel evaluates n items by this interpreter
+  bool serial(size_t n) const { return threads_ < 2 || n < serialCutoff_; }
+  /// Evaluates chunks of pmap, pfilter and preduce, it can not define or
+  /// print
+  std::unique_ptr<Interpreter> makeWorker() const;
+  /// Copy the global definitions of a worker from env if they changed.
+  /// The workers copy the functions, so they share no nodes whose
+  /// reference counts or inline caches change when they are called.
+  void syncWith(const std::shared_ptr<Environment> &env);
+  /// The copy of a function of the environment synced with
+  const std::shared_ptr<AST> &copyOf(const std::shared_ptr<AST> &fun);
+
+  /// Spawn and sync
+  /// @{
+  /// A call spawned, run by a task worker
+  struct Spawned;
+  /// (spawn (f args...)), the arguments are evaluated, the call is queued
+  /// as a task and its future returned. It is evaluated at once on one
+  /// thread, if the function is a builtin or if the thread has cutoff
+  /// tasks queued, and its value returned.
+  Value evalSpawn(const std::shared_ptr<AST> &opnode, const AST::List &ls);
+  /// (sync x), the value of the call if x is a future, x otherwise. Tasks
+  /// are run while the call is evaluated by another thread, which wakes
+  /// this one if there are none.
+  Value evalSync(const std::shared_ptr<AST> &opnode, const AST::List &ls);
+  /// The scheduler of the interpreter the task workers belong to, made by
+  /// its first spawn, nullptr to evaluate spawned calls at once
+  Scheduler *spawner();
+  /// value, with a function replaced by its original if it is a copy of
+  /// this worker, the functions shared between workers
+  Value original(const Value &value) const;
+  /// value, with a function replaced by the copy of this worker
+  Value local(const Value &value);
+  /// @}
+
+  /// Drop the memo of the function bound to name before it is rebound
+  void forgetMemo(Symbol name);
+  /// Throw if the body of a memoized function prints, defines or evals
+  void requirePure(const std::shared_ptr<AST> &node);
+  Value evalBuiltin(const std::shared_ptr<AST> &node);
+  /// Evaluate a builtin with an expression in tail position up to that
+  /// expression and return it, nullptr if the builtin has none
+  std::shared_ptr<AST> evalToTail(const std::shared_ptr<AST> &node);
 
   /// The head of the child list has been evaled to determine operation
   /// @{
-  std::shared_ptr<AST> evalIntOp(Builtin intOp, AST::List ls);
-  std::shared_ptr<AST> evalDefine(const std::shared_ptr<AST> &node);
+  /// True if the builtin application node needs no operand checks in the
+  /// current frame, see TypeInference
+  bool isProven(const AST &node) const {
+    return node.proven() && frame && frame->typed();
+  }
+
+  template <Builtin op> Value evalIntOp(const AST::List &ls, bool proven);
+  Value evalDefine(const std::shared_ptr<AST> &node);
 
   std::shared_ptr<AST> evalList(const AST::List &ls);
   std::shared_ptr<AST> evalJoin(const std::shared_ptr<AST> &opnode,
-                                const AST::List &ls);
+                                const AST::List &ls, bool proven);
+  /// (cons x xs), the list of the value of x followed by the elements of xs
+  std::shared_ptr<AST> evalCons(const std::shared_ptr<AST> &opnode,
+                                const AST::List &ls, bool proven);
+  /// Print the argument unevaluated and return it for evaluation
   std::shared_ptr<AST> evalPPrint(const std::shared_ptr<AST> &opnode,
                                   const AST::List &ls);
-  std::shared_ptr<AST> evalIf(const AST::List &ls);
+  /// Evaluate the predicate and return the branch to evaluate
+  const std::shared_ptr<AST> &ifBranch(const AST::List &ls);
 
-  std::shared_ptr<AST> evalEq(AST::List ls);
+  template <Builtin op> Value evalCompare(const AST::List &ls, bool proven);
 
-  std::shared_ptr<AST>
-  evalIntCmp(const AST::List &ls,
-             std::function<bool(const int &, const int &)>);
+  /// Arrays of fixnums or floats, see TypedArray
+  /// @{
+  Value evalArray(const AST::List &ls);
+  Value evalMakeArray(const std::shared_ptr<AST> &opnode,
+                      const AST::List &ls);
+  Value evalArrayGet(const std::shared_ptr<AST> &opnode, const AST::List &ls);
+  Value evalArraySlice(const std::shared_ptr<AST> &opnode,
+                       const AST::List &ls);
+  /// @}
+
+  /// Strings, see Rope
+  /// @{
+  Value evalConcat(const std::shared_ptr<AST> &opnode, const AST::List &ls);
+  Value evalSubstring(const std::shared_ptr<AST> &opnode,
+                      const AST::List &ls);
+  /// The list of the one char strings of a string
+  Value evalStringToList(const std::shared_ptr<AST> &opnode,
+                         const AST::List &ls);
+  /// @}
+
+  /// Hash maps, persistent or transient, see PersistentMap and HashMap
+  /// @{
+  Value evalHash(const std::shared_ptr<AST> &opnode, const AST::List &ls);
+  Value evalHashGet(const std::shared_ptr<AST> &opnode, const AST::List &ls);
+  Value evalHashSet(const std::shared_ptr<AST> &opnode, const AST::List &ls);
+  Value evalHashRemove(const std::shared_ptr<AST> &opnode,
+                       const AST::List &ls);
+  /// The list of the keys or of the values of a map
+  Value evalHashEntries(const std::shared_ptr<AST> &opnode,
+                        const AST::List &ls, bool keys);
+  Value evalTransient(const std::shared_ptr<AST> &opnode,
+                      const AST::List &ls);
+  Value evalPersistent(const std::shared_ptr<AST> &opnode,
+                       const AST::List &ls);
+  /// @}
 
   /// @}
 
-  AST::List getEvaledArgs(const AST::List xs);
+  /// Map, filter and reduce a list in parallel, see parallel
+  /// @{
+  Value evalPMap(const std::shared_ptr<AST> &opnode, const AST::List &ls,
+                 bool filter);
+  /// (preduce f init xs), the left fold of xs by f from init. In parallel
+  /// the folds of the chunks are joined in order from init, the same for
+  /// an associative f only.
+  Value evalPReduce(const std::shared_ptr<AST> &opnode, const AST::List &ls);
+  /// @}
+
+  std::vector<Value> getEvaledArgs(const AST::List &xs);
+  /// Compare the evaluated arguments ys of the comparison ls
+  template <Builtin op>
+  Value compare(const AST::List &ls, const std::vector<Value> &ys);
+
+  void requireIntType(const Value &value);
+  /// A number or an array, arithmetic on arrays is elementwise
+  void requireArithmeticType(const Value &value);
 
-  void requireIntType(std::shared_ptr<AST> node);
+  /// The list operand of a builtin, proven if it needs no type check
+  std::shared_ptr<ASTList>
+  getSingleListArg(const std::shared_ptr<AST> &opnode, const AST::List &ls,
+                   bool proven = false);
 
-  std::shared_ptr<AST> getSingleListArg(const std::shared_ptr<AST> &opnode,
-                                        const AST::List &ls);
+  void requireSingleArgument(const std::shared_ptr<AST> &opnode,
+                             const AST::List &ls);
+  void requireArguments(const std::shared_ptr<AST> &opnode,
+                        const AST::List &ls, size_t count);
 
-  void requireSingleArgument(const std::shared_ptr<AST> &opnode, AST::List ls);
+  /// The evaluated array operand node of a builtin
+  std::shared_ptr<ASTArray> getArrayArg(const std::shared_ptr<AST> &opnode,
+                                        const std::shared_ptr<AST> &node);
+  /// The evaluated string operand node of a builtin
+  std::shared_ptr<ASTString> getStringArg(const std::shared_ptr<AST> &opnode,
+                                          const std::shared_ptr<AST> &node);
+  /// The evaluated map operand node of a builtin, persistent or transient
+  std::shared_ptr<AST> getMapArg(const std::shared_ptr<AST> &opnode,
+                                 const std::shared_ptr<AST> &node);
+  /// The evaluated key operand of a builtin
+  Value getKeyArg(const std::shared_ptr<AST> &opnode,
+                  const std::shared_ptr<AST> &node);
+  /// The evaluated fixnum operand node of a builtin, from 0 up to limit
+  size_t getIndexArg(const std::shared_ptr<AST> &opnode,
+                     const std::shared_ptr<AST> &node, size_t limit);
 
   void requireListType(const std::shared_ptr<AST> &opnode,
-                       std::shared_ptr<AST> node);
-  void requireNonEmptyList(const std::shared_ptr<AST> &opnode,
-                           std::shared_ptr<AST> node);
+                       const Value &value);
 
-  int applyIntOp(const int acc, const AST::List ls, const size_t idx,
-                 std::function<int(const int, const int)> op);
+  /// Return symbol in node, throw error if not a symbol
+  Symbol symbol(std::shared_ptr<AST> node);
 
-  /// Return name of symbol in node, throw error if not a symbol
-  const char *symbolName(std::shared_ptr<AST> node);
+  /// Resolve the references in the body of a function to argument slots
+  /// or globals, params is the argument list (name args...)
+  void resolve(const std::shared_ptr<AST> &params,
+               const std::shared_ptr<AST> &node);
 
-  std::shared_ptr<Environment> env;
+  Heap heap_;
+  Printer output_;
+  FramePool framePool;
+  /// Frame of the function being evaluated, its callers are reached
+  /// through it
+  Frame *frame = nullptr;
+  std::shared_ptr<Environment> globals;
+  Engine engine_;
+  std::unique_ptr<VM> vm;
+  CallCacheStats callCacheStats_;
+  std::unique_ptr<Jit> jit_;
+  TypeInference typeInference;
+  bool inferTypes = true;
+  std::unordered_map<const AST *, std::shared_ptr<Memo>> memos;
+  size_t memoCapacity_;
+  MemoStats memoStats_;
+  unsigned threads_;
+  size_t serialCutoff_ = DEFAULT_SERIAL_CUTOFF;
+  /// Set for the workers of parallel
+  bool worker_ = false;
+  /// Of a worker, the environment its globals are copied from, the
+  /// revision copied and the copies of the functions by the originals
+  /// they keep alive
+  /// @{
+  const Environment *synced = nullptr;
+  uint64_t syncedRevision = 0;
+  std::unordered_map<const AST *,
+                     std::pair<std::shared_ptr<AST>, std::shared_ptr<AST>>>
+      copies;
+  std::unordered_map<const AST *, std::shared_ptr<AST>> originals;
+  /// @}
+  std::vector<std::unique_ptr<Interpreter>> workers;
+  /// Made by the first parallel evaluation, destroyed before the workers
+  std::unique_ptr<ThreadPool> pool;
+  /// Of a task worker, the interpreter spawning the tasks and the worker
+  /// of its scheduler evaluating here, see spawner
+  /// @{
+  Interpreter *root_ = this;
+  unsigned taskWorker_ = 0;
+  /// @}
+  size_t spawnCutoff_ = Scheduler::DEFAULT_CUTOFF;
+  std::vector<std::unique_ptr<Interpreter>> taskWorkers;
+  /// Made by the first spawn, destroyed before its workers
+  std::unique_ptr<Scheduler> scheduler_;
 };
 
 #endif /* !INTERPRETER_H_ */
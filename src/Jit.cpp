@@ -0,0 +1,573 @@
+#include "Jit.h"
+#include "Environment.h"
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+
+#if defined(__x86_64__) && defined(__linux__)
+#define JIT_X86_64 1
+#include <sys/mman.h>
+#endif
+
+/// Encodes the few x86-64 instructions the compiler uses. Values are
+/// computed in rax, rcx holds the second operand, temporaries are pushed
+/// on the machine stack and arguments are addressed from rbp.
+class Jit::Assembler {
+public:
+  std::vector<uint8_t> code;
+
+  size_t size() const { return code.size(); }
+
+  void bytes(std::initializer_list<uint8_t> bs) {
+    code.insert(code.end(), bs.begin(), bs.end());
+  }
+  void imm32(int32_t value) {
+    uint8_t b[4];
+    memcpy(b, &value, 4);
+    code.insert(code.end(), b, b + 4);
+  }
+  void imm64(uint64_t value) {
+    uint8_t b[8];
+    memcpy(b, &value, 8);
+    code.insert(code.end(), b, b + 8);
+  }
+  /// Point the rel32 at offset at to target
+  void patch32(size_t at, size_t target) {
+    const int32_t rel = static_cast<int32_t>(target - (at + 4));
+    memcpy(&code[at], &rel, 4);
+  }
+
+  void pushRax() { bytes({0x50}); }
+  void popRax() { bytes({0x58}); }
+  void ret() { bytes({0xc3}); }
+  /// push rbp; mov rbp, rsp
+  void enter() { bytes({0x55, 0x48, 0x89, 0xe5}); }
+  /// mov rsp, rbp; pop rbp
+  void leave() { bytes({0x48, 0x89, 0xec, 0x5d}); }
+  void movEaxImm(int32_t value) {
+    bytes({0xb8});
+    imm32(value);
+  }
+  void movRaxImm(uint64_t value) {
+    bytes({0x48, 0xb8});
+    imm64(value);
+  }
+  /// The shortest mov of a signed value to rax
+  void movRaxInt(int64_t value) {
+    if (value < INT32_MIN || value > INT32_MAX) {
+      movRaxImm(static_cast<uint64_t>(value));
+      return;
+    }
+    bytes({0x48, 0xc7, 0xc0});
+    imm32(static_cast<int32_t>(value));
+  }
+  /// mov rax, [rbp + disp]
+  void loadRax(int32_t disp) {
+    bytes({0x48, 0x8b, 0x85});
+    imm32(disp);
+  }
+  /// mov [rbp + disp], rax
+  void storeRax(int32_t disp) {
+    bytes({0x48, 0x89, 0x85});
+    imm32(disp);
+  }
+  /// mov rcx, rax; pop rax, the operands of a binary operation
+  void popOperands() { bytes({0x48, 0x89, 0xc1, 0x58}); }
+  void addRaxRcx() { bytes({0x48, 0x01, 0xc8}); }
+  void subRaxRcx() { bytes({0x48, 0x29, 0xc8}); }
+  void imulRaxRcx() { bytes({0x48, 0x0f, 0xaf, 0xc1}); }
+  void negRax() { bytes({0x48, 0xf7, 0xd8}); }
+  /// cqo; idiv rcx
+  void idivRcx() { bytes({0x48, 0x99, 0x48, 0xf7, 0xf9}); }
+  void movRaxRdx() { bytes({0x48, 0x89, 0xd0}); }
+  void movRaxRcx() { bytes({0x48, 0x89, 0xc8}); }
+  void cmpRaxRcx() { bytes({0x48, 0x39, 0xc8}); }
+  /// cmp rcx, -1
+  void cmpRcxMinusOne() { bytes({0x48, 0x83, 0xf9, 0xff}); }
+  void testRaxRax() { bytes({0x48, 0x85, 0xc0}); }
+  void testRcxRcx() { bytes({0x48, 0x85, 0xc9}); }
+  void xorEaxEax() { bytes({0x31, 0xc0}); }
+  /// add rsp, n
+  void dropBytes(int32_t n) {
+    bytes({0x48, 0x81, 0xc4});
+    imm32(n);
+  }
+  /// cmp rsp, [rax]
+  void cmpRspAtRax() { bytes({0x48, 0x3b, 0x20}); }
+  void jmpRax() { bytes({0xff, 0xe0}); }
+  void callRax() { bytes({0xff, 0xd0}); }
+
+  /// Jumps with a rel32 to be patched, the offset of the rel32 is returned
+  /// @{
+  size_t jcc(uint8_t cc) {
+    bytes({0x0f, cc});
+    imm32(0);
+    return size() - 4;
+  }
+  size_t jmp() {
+    bytes({0xe9});
+    imm32(0);
+    return size() - 4;
+  }
+  size_t call() {
+    bytes({0xe8});
+    imm32(0);
+    return size() - 4;
+  }
+  /// @}
+
+  /// Condition codes of jcc
+  static const uint8_t JO = 0x80, JNO = 0x81, JZ = 0x84, JNZ = 0x85,
+                       JAE = 0x83, JL = 0x8c, JGE = 0x8d, JLE = 0x8e,
+                       JG = 0x8f;
+
+  /// The jcc taken after cmp rax, rcx when the comparison op fails
+  static uint8_t unless(Builtin op) {
+    switch (op) {
+    case Builtin::EQ:
+      return JNZ;
+    case Builtin::GT:
+      return JLE;
+    case Builtin::GE:
+      return JL;
+    case Builtin::LT:
+      return JGE;
+    default:
+      return JG;
+    }
+  }
+};
+
+namespace {
+
+/// Offset from rbp of argument i of n, the caller pushes them in order
+int32_t argOffset(unsigned int i, unsigned int n) {
+  return 16 + 8 * static_cast<int32_t>(n - 1 - i);
+}
+
+} // namespace
+
+Jit::Jit(const Environment &globals, unsigned int threshold)
+    : globals(globals), threshold(threshold), version(globals.version()) {
+#ifdef JIT_X86_64
+  void *mem = mmap(nullptr, CODE_SIZE, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (MAP_FAILED == mem)
+    return;
+  buffer = static_cast<uint8_t *>(mem);
+  emitEntry();
+#endif
+}
+
+Jit::~Jit() {
+#ifdef JIT_X86_64
+  if (buffer)
+    munmap(buffer, CODE_SIZE);
+#endif
+}
+
+bool Jit::supported() {
+#ifdef JIT_X86_64
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool Jit::call(const AST *fun, const Value *args, size_t argc,
+               Value &result) {
+  if (!buffer)
+    return false;
+  flushIfStale();
+  auto &profile = profiles[fun];
+  if (!profile.function) {
+    if (profile.rejected || ++profile.calls < threshold)
+      return false;
+    profile.function = compile(fun);
+    if (!profile.function) {
+      profile.rejected = true;
+      stats_.rejected++;
+      return false;
+    }
+  }
+  if (profile.backoff) {
+    profile.backoff--;
+    return false;
+  }
+  argBuffer.resize(argc);
+  for (size_t i = 0; i < argc; i++) {
+    if (!args[i].isInteger())
+      return false;
+    argBuffer[i] = args[i].integer();
+  }
+  context.failed = 0;
+  const auto res = entry(argBuffer.data(), argc, profile.function->code);
+  if (context.failed) {
+    stats_.bailouts++;
+    profile.backoff = BACKOFF;
+    return false;
+  }
+  stats_.nativeCalls++;
+  if (Type::BOOL == profile.function->result)
+    result = Value::boolean(0 != res);
+  else
+    result = Value::integer(res);
+  return true;
+}
+
+void Jit::flushIfStale() {
+  if (globals.version() == version)
+    return;
+  version = globals.version();
+  if (functions.empty() && profiles.empty())
+    return;
+  // no compiled code is running, it does not call the interpreter
+  functions.clear();
+  profiles.clear();
+  used = codeStart;
+  stats_.flushes++;
+}
+
+const Jit::Function *Jit::compile(const AST *fun) {
+  const auto it = functions.find(fun);
+  if (it != functions.cend())
+    return &it->second;
+  if (compiling.count(fun))
+    return nullptr;
+  const auto &ls = fun->children();
+  if (3 != ls.size() || !ls[0]->isBuiltin(Builtin::DEFINE))
+    return nullptr;
+  const auto arity = ls[1]->children().size() - 1;
+  if (arity > 255)
+    return nullptr;
+
+  compiling.insert(fun);
+  auto type = typeOf(*ls[2], fun, Type::UNKNOWN);
+  // again knowing the type of recursive calls
+  if ((Type::INT == type || Type::BOOL == type) &&
+      typeOf(*ls[2], fun, type) != type)
+    type = Type::NONE;
+  compiling.erase(fun);
+  if (Type::INT != type && Type::BOOL != type)
+    return nullptr;
+
+  Assembler a;
+  emitFunction(a, fun);
+  const auto code = install(a.code);
+  if (!code)
+    return nullptr;
+  stats_.compiled++;
+  auto &function = functions[fun];
+  function.code = code;
+  function.result = type;
+  function.arity = arity;
+  return &function;
+}
+
+const AST *Jit::callee(const AST &head) const {
+  if (AST::Type::SYMBOL != head.type())
+    return nullptr;
+  const auto &symbol = static_cast<const ASTSymbol &>(head);
+  if (ASTSymbol::Scope::GLOBAL != symbol.scope())
+    return nullptr;
+  const auto value = globals[symbol.data()];
+  if (!value || AST::Type::FUN != value.type())
+    return nullptr;
+  return value.node().get();
+}
+
+Jit::Type Jit::typeOf(const AST &node, const AST *fun, Type self) {
+  const auto isInt = [](Type t) {
+    return Type::INT == t || Type::UNKNOWN == t;
+  };
+  switch (node.type()) {
+  case AST::Type::INTEGER:
+    return Type::INT;
+  case AST::Type::BOOLEAN:
+    return Type::BOOL;
+  case AST::Type::SYMBOL:
+    return ASTSymbol::Scope::ARGUMENT ==
+                   static_cast<const ASTSymbol &>(node).scope()
+               ? Type::INT
+               : Type::NONE;
+  case AST::Type::SEXPR:
+    break;
+  default:
+    return Type::NONE;
+  }
+  const auto &ls = node.children();
+  if (ls.empty())
+    return Type::NONE;
+
+  if (AST::Type::BUILTIN == ls[0]->type()) {
+    const auto op = static_cast<const ASTBuiltin &>(*ls[0]).op();
+    switch (op) {
+    case Builtin::ADD:
+    case Builtin::SUB:
+    case Builtin::MUL:
+    case Builtin::DIV:
+    case Builtin::MOD:
+    case Builtin::EQ:
+    case Builtin::GT:
+    case Builtin::GE:
+    case Builtin::LT:
+    case Builtin::LE: {
+      const bool compare = Builtin::EQ == op || Builtin::GT == op ||
+                           Builtin::GE == op || Builtin::LT == op ||
+                           Builtin::LE == op;
+      if (ls.size() < (compare ? 3u : 2u))
+        return Type::NONE;
+      for (size_t i = 1; i < ls.size(); i++) {
+        if (!isInt(typeOf(*ls[i], fun, self)))
+          return Type::NONE;
+      }
+      return compare ? Type::BOOL : Type::INT;
+    }
+    case Builtin::IF: {
+      if (ls.size() < 4 || Type::NONE == typeOf(*ls[1], fun, self))
+        return Type::NONE;
+      const auto a = typeOf(*ls[2], fun, self);
+      const auto b = typeOf(*ls[3], fun, self);
+      if (Type::NONE == a || Type::NONE == b)
+        return Type::NONE;
+      if (Type::UNKNOWN == a)
+        return b;
+      if (Type::UNKNOWN == b || a == b)
+        return a;
+      return Type::NONE;
+    }
+    default:
+      return Type::NONE;
+    }
+  }
+
+  const auto target = callee(*ls[0]);
+  if (!target || target->children()[1]->children().size() != ls.size())
+    return Type::NONE;
+  for (size_t i = 1; i < ls.size(); i++) {
+    if (!isInt(typeOf(*ls[i], fun, self)))
+      return Type::NONE;
+  }
+  if (target == fun)
+    return self;
+  const auto function = compile(target);
+  return function ? function->result : Type::NONE;
+}
+
+void Jit::emitEntry() {
+  // int64_t entry(const int64_t *args (rdi), size_t argc (rsi),
+  //               const uint8_t *code (rdx))
+  Assembler a;
+  a.bytes({0x55, 0x41, 0x54}); // push rbp; push r12
+  a.bytes({0x49, 0xbc});       // mov r12, &context
+  a.imm64(reinterpret_cast<uint64_t>(&context));
+  a.bytes({0x49, 0x89, 0x24, 0x24}); // mov [r12], rsp
+  a.bytes({0x48, 0x8d, 0x84, 0x24}); // lea rax, [rsp - STACK_BUDGET]
+  a.imm32(-static_cast<int32_t>(STACK_BUDGET));
+  a.bytes({0x49, 0x89, 0x44, 0x24, 0x08}); // mov [r12 + 8], rax
+  a.bytes({0x31, 0xc9});                   // xor ecx, ecx
+  const auto loop = a.size();
+  a.bytes({0x48, 0x39, 0xf1}); // cmp rcx, rsi
+  a.bytes({0x73, 0x08});       // jae done
+  a.bytes({0xff, 0x34, 0xcf}); // push qword [rdi + rcx * 8]
+  a.bytes({0x48, 0xff, 0xc1}); // inc rcx
+  a.bytes({0xeb, static_cast<uint8_t>(loop - (a.size() + 2))}); // jmp loop
+  a.bytes({0xff, 0xd2});                   // done: call rdx
+  a.bytes({0x49, 0x8b, 0x24, 0x24});       // mov rsp, [r12]
+  a.bytes({0x41, 0x5c, 0x5d, 0xc3});       // pop r12; pop rbp; ret
+  const auto bailoutOffset = a.size();
+  a.bytes({0x49, 0xbc}); // mov r12, &context
+  a.imm64(reinterpret_cast<uint64_t>(&context));
+  a.bytes({0x49, 0x8b, 0x24, 0x24});             // mov rsp, [r12]
+  a.bytes({0x41, 0xc6, 0x44, 0x24, 0x10, 0x01}); // mov byte [r12 + 16], 1
+  a.bytes({0x41, 0x5c, 0x5d, 0xc3});             // pop r12; pop rbp; ret
+
+  const auto code = install(a.code);
+  entry = reinterpret_cast<Entry>(const_cast<uint8_t *>(code));
+  bailout = code + bailoutOffset;
+  codeStart = used;
+}
+
+void Jit::emitFunction(Assembler &a, const AST *fun) {
+  a.enter();
+  // bail out before the stack runs out
+  a.movRaxImm(reinterpret_cast<uint64_t>(&context.stackLimit));
+  a.cmpRspAtRax();
+  emitBailoutUnless(a, Assembler::JAE);
+  emitExpr(a, *fun->children()[2], fun, true);
+  a.leave();
+  a.ret();
+}
+
+void Jit::emitExpr(Assembler &a, const AST &node, const AST *fun,
+                   bool tail) {
+  switch (node.type()) {
+  case AST::Type::INTEGER:
+    a.movRaxInt(static_cast<const ASTInt &>(node).data());
+    return;
+  case AST::Type::BOOLEAN:
+    a.movEaxImm(static_cast<const ASTBoolean &>(node).data() ? 1 : 0);
+    return;
+  case AST::Type::SYMBOL:
+    a.loadRax(argOffset(static_cast<const ASTSymbol &>(node).slot(),
+                        fun->children()[1]->children().size() - 1));
+    return;
+  default:
+    break;
+  }
+
+  const auto &ls = node.children();
+  if (AST::Type::BUILTIN != ls[0]->type()) {
+    emitCall(a, node, fun, tail);
+    return;
+  }
+  const auto op = static_cast<const ASTBuiltin &>(*ls[0]).op();
+  switch (op) {
+  case Builtin::IF: {
+    emitExpr(a, *ls[1], fun, false);
+    a.testRaxRax();
+    const auto otherwise = a.jcc(Assembler::JZ);
+    emitExpr(a, *ls[2], fun, tail);
+    const auto end = a.jmp();
+    a.patch32(otherwise, a.size());
+    emitExpr(a, *ls[3], fun, tail);
+    a.patch32(end, a.size());
+    return;
+  }
+  case Builtin::EQ:
+  case Builtin::GT:
+  case Builtin::GE:
+  case Builtin::LT:
+  case Builtin::LE: {
+    // pairwise, the remaining operands are skipped once one pair fails
+    std::vector<size_t> failed;
+    emitExpr(a, *ls[1], fun, false);
+    for (size_t i = 2; i < ls.size(); i++) {
+      a.pushRax();
+      emitExpr(a, *ls[i], fun, false);
+      a.popOperands();
+      a.cmpRaxRcx();
+      failed.push_back(a.jcc(Assembler::unless(op)));
+      a.movRaxRcx();
+    }
+    a.movEaxImm(1);
+    const auto end = a.jmp();
+    for (const auto at : failed) {
+      a.patch32(at, a.size());
+    }
+    a.xorEaxEax();
+    a.patch32(end, a.size());
+    return;
+  }
+  default:
+    break;
+  }
+
+  emitExpr(a, *ls[1], fun, false);
+  for (size_t i = 2; i < ls.size(); i++) {
+    a.pushRax();
+    emitExpr(a, *ls[i], fun, false);
+    a.popOperands();
+    switch (op) {
+    case Builtin::ADD:
+      a.addRaxRcx();
+      emitBailoutUnless(a, Assembler::JNO);
+      break;
+    case Builtin::SUB:
+      a.subRaxRcx();
+      emitBailoutUnless(a, Assembler::JNO);
+      break;
+    case Builtin::MUL:
+      a.imulRaxRcx();
+      emitBailoutUnless(a, Assembler::JNO);
+      break;
+    default: {
+      // division by zero is left to the interpreter
+      a.testRcxRcx();
+      emitBailoutUnless(a, Assembler::JNZ);
+      // idiv faults on the overflow of the minimum by -1
+      a.cmpRcxMinusOne();
+      const auto divide = a.jcc(Assembler::JNZ);
+      if (Builtin::MOD == op) {
+        a.xorEaxEax();
+      } else {
+        a.negRax();
+        emitBailoutUnless(a, Assembler::JNO);
+      }
+      const auto end = a.jmp();
+      a.patch32(divide, a.size());
+      a.idivRcx();
+      if (Builtin::MOD == op)
+        a.movRaxRdx();
+      a.patch32(end, a.size());
+      break;
+    }
+    }
+  }
+}
+
+void Jit::emitBailoutUnless(Assembler &a, uint8_t cc) {
+  const auto ok = a.jcc(cc);
+  a.movRaxImm(reinterpret_cast<uint64_t>(bailout));
+  a.jmpRax();
+  a.patch32(ok, a.size());
+}
+
+void Jit::emitCall(Assembler &a, const AST &node, const AST *fun,
+                   bool tail) {
+  const auto &ls = node.children();
+  const auto target = callee(*ls[0]);
+  assert(target);
+  const unsigned int argc = ls.size() - 1;
+  const unsigned int arity = fun->children()[1]->children().size() - 1;
+  for (size_t i = 1; i < ls.size(); i++) {
+    emitExpr(a, *ls[i], fun, false);
+    a.pushRax();
+  }
+  const auto code = target == fun ? nullptr : functions[target].code;
+
+  if (tail && argc == arity) {
+    // replace the arguments of this call and jump
+    for (unsigned int i = argc; i-- > 0;) {
+      a.popRax();
+      a.storeRax(argOffset(i, arity));
+    }
+    a.leave();
+    if (code) {
+      a.movRaxImm(reinterpret_cast<uint64_t>(code));
+      a.jmpRax();
+    } else {
+      a.patch32(a.jmp(), 0);
+    }
+    return;
+  }
+
+  if (code) {
+    a.movRaxImm(reinterpret_cast<uint64_t>(code));
+    a.callRax();
+  } else {
+    a.patch32(a.call(), 0);
+  }
+  if (argc)
+    a.dropBytes(8 * argc);
+}
+
+const uint8_t *Jit::install(const std::vector<uint8_t> &code) {
+#ifdef JIT_X86_64
+  if (used + code.size() > CODE_SIZE)
+    return nullptr;
+  if (0 != mprotect(buffer, CODE_SIZE, PROT_READ | PROT_WRITE))
+    return nullptr;
+  const auto start = buffer + used;
+  memcpy(start, code.data(), code.size());
+  used += code.size();
+  if (0 != mprotect(buffer, CODE_SIZE, PROT_READ | PROT_EXEC))
+    return nullptr;
+  return start;
+#else
+  (void)code;
+  return nullptr;
+#endif
+}
@@ -0,0 +1,137 @@
+#ifndef JIT_H_
+#define JIT_H_
+#include "AST.h"
+#include "Value.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class Environment;
+
+/// Baseline compiler of hot functions to x86-64 machine code. A function
+/// is compiled once it has been called threshold times if its body only
+/// uses integer literals, its arguments, the arithmetic and comparison
+/// builtins, if and calls of such functions. Booleans only come from
+/// comparisons and literals, so every expression has a type known when
+/// it is compiled.
+///
+/// Compiled code is entered with integer arguments only, calls with other
+/// arguments are left to the interpreter. Such functions have no side
+/// effects, so when the code runs out of stack, divides by zero or an
+/// operation overflows a fixnum it bails out and the call is evaluated
+/// again by the interpreter, which promotes the result to a bignum.
+///
+/// Code is written to an mmap'd buffer that is only writable while a
+/// function is compiled. All code is dropped when a function is rebound,
+/// as calls between compiled functions are direct.
+class Jit {
+public:
+  static const unsigned int DEFAULT_THRESHOLD = 100;
+  static const size_t CODE_SIZE = 1 << 20;
+  /// Machine stack compiled code may use before bailing out
+  static const size_t STACK_BUDGET = 1 << 19;
+
+  struct Stats {
+    size_t compiled = 0;
+    /// Functions found not to be compilable
+    size_t rejected = 0;
+    size_t nativeCalls = 0;
+    size_t bailouts = 0;
+    /// Times all code was dropped since a function was rebound
+    size_t flushes = 0;
+  };
+
+  Jit(const Environment &globals, unsigned int threshold);
+  ~Jit();
+  Jit(const Jit &) = delete;
+  Jit &operator=(const Jit &) = delete;
+
+  /// True on x86-64 Linux, elsewhere no code is compiled
+  static bool supported();
+
+  /// Count a call of fun with argc args and run it natively if it is
+  /// compiled. False if the interpreter has to evaluate the call.
+  bool call(const AST *fun, const Value *args, size_t argc, Value &result);
+
+  const Stats &stats() const { return stats_; }
+
+private:
+  /// Static type of an expression. UNKNOWN is the result of a recursive
+  /// call while the type of the function is inferred, NONE marks code that
+  /// can not be compiled.
+  enum class Type { INT, BOOL, UNKNOWN, NONE };
+
+  struct Function {
+    const uint8_t *code = nullptr;
+    Type result = Type::NONE;
+    unsigned int arity = 0;
+  };
+
+  /// Calls of a function left to the interpreter after a bailout, so a
+  /// recursion too deep for the stack budget is not entered again at each
+  /// level
+  static const unsigned int BACKOFF = 1024;
+
+  struct Profile {
+    unsigned int calls = 0;
+    unsigned int backoff = 0;
+    /// Compiled code, nullptr before compilation or if it was rejected
+    const Function *function = nullptr;
+    bool rejected = false;
+  };
+
+  /// Function a compiled function is entered through, see emitEntry
+  using Entry = int64_t (*)(const int64_t *args, size_t argc,
+                            const uint8_t *code);
+
+  /// Shared by the entry and the compiled code, the offsets are used in
+  /// the machine code
+  struct Context {
+    uint64_t savedStack = 0; // 0
+    uint64_t stackLimit = 0; // 8
+    uint8_t failed = 0;      // 16
+  };
+
+  class Assembler;
+
+  void flushIfStale();
+  /// Compile fun and the functions it calls, nullptr if it can not be
+  /// compiled
+  const Function *compile(const AST *fun);
+  /// Type of node in the body of fun, self is the type of fun
+  Type typeOf(const AST &node, const AST *fun, Type self);
+  /// Function bound to the symbol at the head of a call, nullptr if it
+  /// is not a global function
+  const AST *callee(const AST &head) const;
+
+  void emitEntry();
+  void emitFunction(Assembler &a, const AST *fun);
+  void emitExpr(Assembler &a, const AST &node, const AST *fun, bool tail);
+  void emitCall(Assembler &a, const AST &node, const AST *fun, bool tail);
+  /// Jump to the bailout unless the condition code cc holds
+  void emitBailoutUnless(Assembler &a, uint8_t cc);
+  /// Copy code to the buffer, nullptr if it is full
+  const uint8_t *install(const std::vector<uint8_t> &code);
+
+  const Environment &globals;
+  unsigned int threshold;
+  uint64_t version = 0;
+  uint8_t *buffer = nullptr;
+  size_t used = 0;
+  /// Start of the code after the entry
+  size_t codeStart = 0;
+  Entry entry = nullptr;
+  const uint8_t *bailout = nullptr;
+  Context context;
+  std::unordered_map<const AST *, Profile> profiles;
+  std::unordered_map<const AST *, Function> functions;
+  /// Functions being compiled, calls between them are not compiled
+  std::unordered_set<const AST *> compiling;
+  std::vector<int64_t> argBuffer;
+  Stats stats_;
+};
+
+#endif /* !JIT_H_ */
@@ -0,0 +1,101 @@
+#ifndef KERNELS_H_
+#define KERNELS_H_
+#include "AST.h"
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+/// The integer operation of an arithmetic or comparison builtin, one
+/// specialization per builtin so a call compiles to the instruction itself.
+/// Arithmetic on fixnums sets res and is false if the result does not fit,
+/// on overflow or division by zero, the overflow flag of the instruction
+/// is tested for addition, subtraction and multiplication.
+template <Builtin op> struct IntKernel;
+
+template <> struct IntKernel<Builtin::ADD> {
+  static bool apply(int64_t a, int64_t b, int64_t &res) {
+    return !__builtin_add_overflow(a, b, &res);
+  }
+};
+template <> struct IntKernel<Builtin::SUB> {
+  static bool apply(int64_t a, int64_t b, int64_t &res) {
+    return !__builtin_sub_overflow(a, b, &res);
+  }
+};
+template <> struct IntKernel<Builtin::MUL> {
+  static bool apply(int64_t a, int64_t b, int64_t &res) {
+    return !__builtin_mul_overflow(a, b, &res);
+  }
+};
+template <> struct IntKernel<Builtin::DIV> {
+  static bool apply(int64_t a, int64_t b, int64_t &res) {
+    if (0 == b || (-1 == b && std::numeric_limits<int64_t>::min() == a))
+      return false;
+    res = a / b;
+    return true;
+  }
+};
+template <> struct IntKernel<Builtin::MOD> {
+  static bool apply(int64_t a, int64_t b, int64_t &res) {
+    if (0 == b)
+      return false;
+    res = -1 == b ? 0 : a % b;
+    return true;
+  }
+};
+
+template <> struct IntKernel<Builtin::EQ> {
+  static bool apply(int64_t a, int64_t b) { return a == b; }
+};
+template <> struct IntKernel<Builtin::GT> {
+  static bool apply(int64_t a, int64_t b) { return a > b; }
+};
+template <> struct IntKernel<Builtin::GE> {
+  static bool apply(int64_t a, int64_t b) { return a >= b; }
+};
+template <> struct IntKernel<Builtin::LT> {
+  static bool apply(int64_t a, int64_t b) { return a < b; }
+};
+template <> struct IntKernel<Builtin::LE> {
+  static bool apply(int64_t a, int64_t b) { return a <= b; }
+};
+
+/// The float operation of an arithmetic or comparison builtin, IEEE 754
+/// semantics: no overflow, division by zero gives an infinity or NaN and
+/// % is fmod
+template <Builtin op> struct FloatKernel;
+
+template <> struct FloatKernel<Builtin::ADD> {
+  static double apply(double a, double b) { return a + b; }
+};
+template <> struct FloatKernel<Builtin::SUB> {
+  static double apply(double a, double b) { return a - b; }
+};
+template <> struct FloatKernel<Builtin::MUL> {
+  static double apply(double a, double b) { return a * b; }
+};
+template <> struct FloatKernel<Builtin::DIV> {
+  static double apply(double a, double b) { return a / b; }
+};
+template <> struct FloatKernel<Builtin::MOD> {
+  static double apply(double a, double b) { return std::fmod(a, b); }
+};
+
+template <> struct FloatKernel<Builtin::EQ> {
+  static bool apply(double a, double b) { return a == b; }
+};
+template <> struct FloatKernel<Builtin::GT> {
+  static bool apply(double a, double b) { return a > b; }
+};
+template <> struct FloatKernel<Builtin::GE> {
+  static bool apply(double a, double b) { return a >= b; }
+};
+template <> struct FloatKernel<Builtin::LT> {
+  static bool apply(double a, double b) { return a < b; }
+};
+template <> struct FloatKernel<Builtin::LE> {
+  static bool apply(double a, double b) { return a <= b; }
+};
+
+#endif /* !KERNELS_H_ */
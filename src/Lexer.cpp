@@ -1,6 +1,7 @@
 #include "Lexer.h"
 #include <cassert>
 #include <ctype.h>
+#include <errno.h>
 #include <iostream>
 #include <stdio.h>
 #include <stdlib.h>
@@ -85,11 +86,17 @@ Lexer::TokenType Lexer::readAtom() {
       break;
   } while (nextChar());
 
-  if (isdigit(buffer.front()))
-    return TokenType::INTEGER;
-  if ('-' == buffer.front() && buffer.size() > 1)
-    return TokenType::INTEGER;
-  return TokenType::SYMBOL;
+  const bool negative = '-' == buffer.front() && buffer.size() > 1;
+  if (!isdigit(buffer.front()) && !negative)
+    return TokenType::SYMBOL;
+  // digits with a point or an exponent
+  if (isdigit(buffer[negative ? 1 : 0])) {
+    for (const auto c : buffer) {
+      if ('.' == c || 'e' == c || 'E' == c)
+        return TokenType::FLOAT;
+    }
+  }
+  return TokenType::INTEGER;
 }
 
 bool Lexer::isparen(char c) const { return ('(' == c) || (')' == c); }
@@ -99,7 +106,17 @@ const char *Lexer::string() {
   return buffer.data();
 }
 
-int Lexer::integer() { return atoi(string()); }
+Symbol Lexer::symbol() { return SymbolTable::intern(string()); }
+
+int64_t Lexer::integer() { return strtoll(string(), nullptr, 10); }
+
+double Lexer::floating() { return strtod(string(), nullptr); }
+
+bool Lexer::integerOverflows() {
+  errno = 0;
+  integer();
+  return ERANGE == errno;
+}
 
 const char *Lexer::TokenToCString(const TokenType &tokenType) {
   switch (tokenType) {
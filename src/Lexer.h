@@ -1,7 +1,10 @@
 #ifndef LEXER_H_
 #define LEXER_H_
+#include <cstdint>
 #include <vector>
 
+#include "Symbol.h"
+
 /// Must work in arduino so no std::strings
 class Lexer {
 public:
@@ -20,8 +23,15 @@ public:
 
   /// The value of a string
   const char *string();
+  /// The interned name of a symbol
+  Symbol symbol();
   /// The Value as Integer
-  int integer();
+  int64_t integer();
+  /// True if the integer read does not fit an int64_t, its digits are
+  /// the string
+  bool integerOverflows();
+  /// The Value as Float
+  double floating();
 
   /// Current line in src
   int line() const;
@@ -0,0 +1,115 @@
+#include "Memo.h"
+
+#include <cstring>
+
+Memo::Memo(size_t capacity) : capacity_(capacity) {}
+
+bool Memo::cacheable(const Value *args, size_t argc) {
+  for (size_t i = 0; i < argc; i++) {
+    switch (args[i].type()) {
+    case AST::Type::INTEGER:
+    case AST::Type::BIGNUM:
+    case AST::Type::FLOAT:
+    case AST::Type::BOOLEAN:
+    case AST::Type::STRING:
+      break;
+    default:
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Memo::find(const Key &key, Value &result) {
+  const auto it = index.find(key);
+  if (it == index.cend())
+    return false;
+  entries.splice(entries.begin(), entries, it->second);
+  result = it->second->second;
+  return true;
+}
+
+bool Memo::insert(Key key, Value result) {
+  if (0 == capacity_ || AST::Type::TRANSIENT_MAP == result.type())
+    return false;
+  const auto it = index.find(key);
+  if (it != index.cend()) {
+    it->second->second = std::move(result);
+    entries.splice(entries.begin(), entries, it->second);
+    return false;
+  }
+  bool evicted = false;
+  if (entries.size() == capacity_) {
+    index.erase(entries.back().first);
+    entries.pop_back();
+    evicted = true;
+  }
+  entries.emplace_front(std::move(key), std::move(result));
+  index.emplace(entries.front().first, entries.begin());
+  return evicted;
+}
+
+size_t Memo::size() const { return entries.size(); }
+
+size_t Memo::capacity() const { return capacity_; }
+
+size_t Memo::Hash::operator()(const Key &key) const {
+  size_t hash = key.size();
+  for (const auto &value : key) {
+    size_t h;
+    switch (value.type()) {
+    case AST::Type::INTEGER:
+      h = std::hash<int64_t>()(value.integer());
+      break;
+    case AST::Type::FLOAT:
+      h = std::hash<double>()(value.floating());
+      break;
+    case AST::Type::BIGNUM:
+      h = std::static_pointer_cast<ASTBignum>(value.node())->data().hash();
+      break;
+    case AST::Type::BOOLEAN:
+      h = value.boolean();
+      break;
+    default:
+      h = std::static_pointer_cast<ASTString>(value.node())->data().hash();
+      break;
+    }
+    hash ^= h + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+  }
+  return hash;
+}
+
+bool Memo::Equal::operator()(const Key &a, const Key &b) const {
+  if (a.size() != b.size())
+    return false;
+  for (size_t i = 0; i < a.size(); i++) {
+    const auto type = a[i].type();
+    if (type != b[i].type())
+      return false;
+    switch (type) {
+    case AST::Type::INTEGER:
+      if (a[i].integer() != b[i].integer())
+        return false;
+      break;
+    case AST::Type::FLOAT:
+      if (a[i].floating() != b[i].floating())
+        return false;
+      break;
+    case AST::Type::BIGNUM:
+      if (std::static_pointer_cast<ASTBignum>(a[i].node())->data() !=
+          std::static_pointer_cast<ASTBignum>(b[i].node())->data())
+        return false;
+      break;
+    case AST::Type::BOOLEAN:
+      if (a[i].boolean() != b[i].boolean())
+        return false;
+      break;
+    default:
+      if (std::static_pointer_cast<ASTString>(a[i].node())->data() !=
+          std::static_pointer_cast<ASTString>(b[i].node())->data())
+        return false;
+      break;
+    }
+  }
+  return true;
+}
@@ -0,0 +1,50 @@
+#ifndef MEMO_H_
+#define MEMO_H_
+#include "Value.h"
+
+#include <cstddef>
+#include <list>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/// Results of a function defined by define-memo keyed on the values of its
+/// arguments. Beyond the capacity the least recently used result is
+/// evicted.
+class Memo {
+public:
+  using Key = std::vector<Value>;
+
+  static const size_t DEFAULT_CAPACITY = 1 << 16;
+
+  explicit Memo(size_t capacity = DEFAULT_CAPACITY);
+
+  /// Only numbers, booleans and strings are compared by value, calls with
+  /// other arguments are not cached
+  static bool cacheable(const Value *args, size_t argc);
+
+  /// Set result to the value cached for key, false if there is none
+  bool find(const Key &key, Value &result);
+  /// Cache result for key, true if another result was evicted for it. A
+  /// transient map is changed in place, it is not cached.
+  bool insert(Key key, Value result);
+
+  size_t size() const;
+  size_t capacity() const;
+
+private:
+  struct Hash {
+    size_t operator()(const Key &key) const;
+  };
+  struct Equal {
+    bool operator()(const Key &a, const Key &b) const;
+  };
+  /// Most recently used first
+  using Entries = std::list<std::pair<Key, Value>>;
+
+  size_t capacity_;
+  Entries entries;
+  std::unordered_map<Key, Entries::iterator, Hash, Equal> index;
+};
+
+#endif /* !MEMO_H_ */
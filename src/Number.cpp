@@ -0,0 +1,184 @@
+#include "Number.h"
+#include "Simd.h"
+#include "SyntaxError.h"
+
+#include <vector>
+
+namespace {
+
+const TypedArray *arrayOf(const Value &value) {
+  return value.isArray()
+             ? &std::static_pointer_cast<ASTArray>(value.node())->data()
+             : nullptr;
+}
+
+bool isFloating(const Value &value) {
+  const auto array = arrayOf(value);
+  return array ? TypedArray::Element::FLOAT == array->element()
+               : value.isFloat();
+}
+
+/// value as an operand of elementwise float arithmetic, integer arrays are
+/// converted into converted and numbers into scalar
+simd::Operand<double> floatOperand(const Value &value,
+                                   std::vector<double> &converted,
+                                   double &scalar) {
+  const auto array = arrayOf(value);
+  if (!array) {
+    scalar = number::toDouble(value);
+    return {&scalar, true};
+  }
+  if (TypedArray::Element::FLOAT == array->element())
+    return {array->floats(), false};
+  converted.assign(array->ints(), array->ints() + array->size());
+  return {converted.data(), false};
+}
+
+simd::Operand<int64_t> intOperand(Builtin op, const Value &value,
+                                  int64_t &scalar) {
+  const auto array = arrayOf(value);
+  if (array)
+    return {array->ints(), false};
+  if (!value.isInteger())
+    throw SyntaxError("Array element does not fit in 64 bits",
+                      std::make_shared<ASTBuiltin>(op));
+  scalar = value.integer();
+  return {&scalar, true};
+}
+
+/// Elementwise op on arrays of the same length, or an array and a number.
+/// The result has float elements if an operand does, integer arrays
+/// throw instead of promoting to bignums.
+Value applyArrays(Builtin op, const Value &a, const Value &b) {
+  const auto x = arrayOf(a);
+  const auto y = arrayOf(b);
+  for (const auto *value : {&a, &b}) {
+    if (!value->isArray() && !value->isNumber())
+      throw SyntaxError("Operator works only on integer types",
+                        value->toAST());
+  }
+  if (x && y && x->size() != y->size())
+    throw SyntaxError("Arrays must have the same length",
+                      std::make_shared<ASTBuiltin>(op));
+  const auto n = x ? x->size() : y->size();
+
+  if (isFloating(a) || isFloating(b)) {
+    TypedArray res(TypedArray::Element::FLOAT, n);
+    std::vector<double> ca, cb;
+    double sa, sb;
+    simd::apply(op, floatOperand(a, ca, sa), floatOperand(b, cb, sb),
+                res.floats(), n);
+    return std::make_shared<ASTArray>(std::move(res));
+  }
+  TypedArray res(TypedArray::Element::INT, n);
+  int64_t sa, sb;
+  if (!simd::apply(op, intOperand(op, a, sa), intOperand(op, b, sb),
+                   res.ints(), n))
+    throw SyntaxError("Array element does not fit in 64 bits or division "
+                      "by zero",
+                      std::make_shared<ASTBuiltin>(op));
+  return std::make_shared<ASTArray>(std::move(res));
+}
+
+} // namespace
+
+namespace number {
+
+BigInt toBig(const Value &value) {
+  if (value.isInteger())
+    return BigInt(value.integer());
+  return std::static_pointer_cast<ASTBignum>(value.node())->data();
+}
+
+double toDouble(const Value &value) {
+  if (value.isFloat())
+    return value.floating();
+  if (value.isInteger())
+    return static_cast<double>(value.integer());
+  return std::static_pointer_cast<ASTBignum>(value.node())->data().toDouble();
+}
+
+Value normalize(BigInt n) {
+  if (n.fitsInt64())
+    return Value::integer(n.toInt64());
+  return std::make_shared<ASTBignum>(std::move(n));
+}
+
+Value apply(Builtin op, const Value &a, const Value &b) {
+  if (a.isArray() || b.isArray())
+    return applyArrays(op, a, b);
+  for (const auto *value : {&a, &b}) {
+    if (!value->isNumber())
+      throw SyntaxError("Operator works only on integer types",
+                        value->toAST());
+  }
+  if (a.isFloat() || b.isFloat()) {
+    const auto x = toDouble(a);
+    const auto y = toDouble(b);
+    switch (op) {
+    case Builtin::ADD:
+      return Value::floating(FloatKernel<Builtin::ADD>::apply(x, y));
+    case Builtin::SUB:
+      return Value::floating(FloatKernel<Builtin::SUB>::apply(x, y));
+    case Builtin::MUL:
+      return Value::floating(FloatKernel<Builtin::MUL>::apply(x, y));
+    case Builtin::DIV:
+      return Value::floating(FloatKernel<Builtin::DIV>::apply(x, y));
+    default:
+      return Value::floating(FloatKernel<Builtin::MOD>::apply(x, y));
+    }
+  }
+  const auto x = toBig(a);
+  const auto y = toBig(b);
+  switch (op) {
+  case Builtin::ADD:
+    return normalize(x + y);
+  case Builtin::SUB:
+    return normalize(x - y);
+  case Builtin::MUL:
+    return normalize(x * y);
+  default:
+    break;
+  }
+  if (y.isZero())
+    throw SyntaxError("Division by zero", std::make_shared<ASTBuiltin>(op));
+  BigInt quotient;
+  BigInt remainder;
+  BigInt::divide(x, y, quotient, remainder);
+  return normalize(Builtin::DIV == op ? std::move(quotient)
+                                      : std::move(remainder));
+}
+
+bool compare(Builtin op, const Value &a, const Value &b) {
+  if (a.isFloat() || b.isFloat()) {
+    const auto x = toDouble(a);
+    const auto y = toDouble(b);
+    switch (op) {
+    case Builtin::EQ:
+      return FloatKernel<Builtin::EQ>::apply(x, y);
+    case Builtin::GT:
+      return FloatKernel<Builtin::GT>::apply(x, y);
+    case Builtin::GE:
+      return FloatKernel<Builtin::GE>::apply(x, y);
+    case Builtin::LT:
+      return FloatKernel<Builtin::LT>::apply(x, y);
+    default:
+      return FloatKernel<Builtin::LE>::apply(x, y);
+    }
+  }
+  const auto res = BigInt::compare(toBig(a), toBig(b));
+  switch (op) {
+  case Builtin::EQ:
+    return 0 == res;
+  case Builtin::GT:
+    return res > 0;
+  case Builtin::GE:
+    return res >= 0;
+  case Builtin::LT:
+    return res < 0;
+  default:
+    return res <= 0;
+  }
+}
+
+} // namespace number
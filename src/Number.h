@@ -0,0 +1,51 @@
+#ifndef NUMBER_H_
+#define NUMBER_H_
+#include "AST.h"
+#include "BigInt.h"
+#include "Kernels.h"
+#include "Value.h"
+
+/// Arithmetic of the engines. Integers are fixnums until an operation
+/// overflows, its result is then promoted to a bignum. Results that fit in
+/// a fixnum are always stored as one, so a bignum never equals a fixnum.
+/// An operation with a float operand converts the other one to a double
+/// and has a float result, integers beyond 2^53 compared to a float are
+/// rounded. Arithmetic with an array operand is elementwise, see Simd.
+namespace number {
+
+/// The bignum of the integer value
+BigInt toBig(const Value &value);
+/// The double nearest to the number value
+double toDouble(const Value &value);
+/// n as a fixnum if it fits
+Value normalize(BigInt n);
+
+/// The arithmetic builtin op applied to numbers a and b when the fixnum
+/// operation did not fit or one of them is a bignum or an array. Throws on
+/// operands that are not numbers or arrays and on division by zero.
+Value apply(Builtin op, const Value &a, const Value &b);
+/// The comparison builtin op applied to numbers a and b
+bool compare(Builtin op, const Value &a, const Value &b);
+
+/// op on fixnums without overflow or on floats, the fast paths, or apply
+template <Builtin op> Value arithmetic(const Value &a, const Value &b) {
+  int64_t res;
+  if (a.isInteger() && b.isInteger() &&
+      IntKernel<op>::apply(a.integer(), b.integer(), res))
+    return Value::integer(res);
+  if (a.isFloat() && b.isFloat())
+    return Value::floating(FloatKernel<op>::apply(a.floating(), b.floating()));
+  return apply(op, a, b);
+}
+
+template <Builtin op> bool compare(const Value &a, const Value &b) {
+  if (a.isInteger() && b.isInteger())
+    return IntKernel<op>::apply(a.integer(), b.integer());
+  if (a.isFloat() && b.isFloat())
+    return FloatKernel<op>::apply(a.floating(), b.floating());
+  return compare(op, a, b);
+}
+
+} // namespace number
+
+#endif /* !NUMBER_H_ */
@@ -0,0 +1,239 @@
+#include "Optimizer.h"
+#include "Kernels.h"
+#include "Util.h"
+
+#include <iostream>
+
+namespace {
+
+bool isDefine(const std::shared_ptr<AST> &node) {
+  return node->isBuiltin(Builtin::DEFINE) ||
+         node->isBuiltin(Builtin::DEFINE_MEMO);
+}
+
+bool isLiteral(const std::shared_ptr<AST> &node) {
+  return AST::Type::INTEGER == node->type() ||
+         AST::Type::BOOLEAN == node->type();
+}
+
+int64_t integer(const std::shared_ptr<AST> &node) {
+  return std::static_pointer_cast<ASTInt>(node)->data();
+}
+
+template <Builtin op> std::shared_ptr<AST> foldInts(AST::List::iterator first,
+                                                    AST::List::iterator last) {
+  auto acc = integer(*first);
+  for (auto it = first + 1; it != last; ++it) {
+    // overflows and divisions by zero are left to the evaluation
+    if (!IntKernel<op>::apply(acc, integer(*it), acc))
+      return nullptr;
+  }
+  return std::make_shared<ASTInt>(acc);
+}
+
+template <Builtin op> bool compareInts(const AST::List &ls) {
+  for (size_t i = 2; i < ls.size(); i++) {
+    if (!IntKernel<op>::apply(integer(ls[i - 1]), integer(ls[i])))
+      return false;
+  }
+  return true;
+}
+
+} // namespace
+
+AST::List Optimizer::optimize(const AST::List &program) {
+  definitions.clear();
+  dynamicDefines = false;
+  constants.clear();
+  for (const auto &form : program) {
+    countDefinitions(form);
+  }
+
+  AST::List res;
+  for (const auto &form : program) {
+    res.emplace_back(optimizeExpr(form, nullptr));
+    const auto constant = constantOf(form);
+    if (constant)
+      constants[std::static_pointer_cast<ASTSymbol>(form->children()[1])
+                    ->data()] = constant;
+    if (dump_) {
+      util::print(res.back());
+      std::cout << std::endl;
+    }
+  }
+  return res;
+}
+
+void Optimizer::setDump(bool dump) { dump_ = dump; }
+
+const Optimizer::Stats &Optimizer::stats() const { return stats_; }
+
+void Optimizer::countDefinitions(const std::shared_ptr<AST> &node) {
+  const auto &ls = node->children();
+  for (size_t i = 0; i < ls.size(); i++) {
+    if (0 < i && isDefine(ls[i]))
+      dynamicDefines = true;
+    countDefinitions(ls[i]);
+  }
+  if (ls.size() < 2 || !isDefine(ls.front()))
+    return;
+  // (define name body) or (define (name args...) body)
+  auto name = ls[1];
+  if (!name->children().empty())
+    name = name->children().front();
+  if (AST::Type::SYMBOL == name->type())
+    definitions[std::static_pointer_cast<ASTSymbol>(name)->data()]++;
+}
+
+std::shared_ptr<AST>
+Optimizer::constantOf(const std::shared_ptr<AST> &form) const {
+  const auto &ls = form->children();
+  if (dynamicDefines || 3 != ls.size() ||
+      !ls.front()->isBuiltin(Builtin::DEFINE) ||
+      AST::Type::SYMBOL != ls[1]->type() || !isLiteral(ls[2]))
+    return nullptr;
+  const auto it =
+      definitions.find(std::static_pointer_cast<ASTSymbol>(ls[1])->data());
+  return it != definitions.cend() && 1 == it->second ? ls[2] : nullptr;
+}
+
+std::shared_ptr<AST>
+Optimizer::optimizeExpr(const std::shared_ptr<AST> &node,
+                        const std::shared_ptr<AST> &params) {
+  if (AST::Type::SYMBOL == node->type())
+    return optimizeSymbol(node, params);
+  const auto &ls = node->children();
+  if (ls.empty())
+    return node;
+  const auto &head = ls.front();
+  // operands that are data or printed as written
+  if (head->isBuiltin(Builtin::LIST) || head->isBuiltin(Builtin::PPRINT))
+    return node;
+  if (isDefine(head))
+    return optimizeDefine(node);
+
+  AST::List children;
+  bool changed = false;
+  for (const auto &child : ls) {
+    children.emplace_back(optimizeExpr(child, params));
+    changed = changed || children.back() != child;
+  }
+  if (AST::Type::BUILTIN == head->type()) {
+    const auto folded = foldBuiltin(
+        std::static_pointer_cast<ASTBuiltin>(head)->op(), children);
+    if (folded)
+      return folded;
+  }
+  if (!changed)
+    return node;
+  const auto res = std::make_shared<ASTSexpr>();
+  res->setChildren(std::move(children));
+  return res;
+}
+
+std::shared_ptr<AST>
+Optimizer::optimizeDefine(const std::shared_ptr<AST> &node) {
+  const auto &ls = node->children();
+  // the body of a variable is data, it is not evaluated by define
+  if (3 != ls.size() || AST::Type::SYMBOL == ls[1]->type())
+    return node;
+  const auto body = optimizeExpr(ls[2], ls[1]);
+  if (body == ls[2])
+    return node;
+  const auto res = std::make_shared<ASTSexpr>();
+  res->setChildren({ls[0], ls[1], body});
+  return res;
+}
+
+std::shared_ptr<AST>
+Optimizer::optimizeSymbol(const std::shared_ptr<AST> &node,
+                          const std::shared_ptr<AST> &params) {
+  const auto symbol = std::static_pointer_cast<ASTSymbol>(node)->data();
+  if (params) {
+    const auto &args = params->children();
+    for (size_t i = 1; i < args.size(); i++) {
+      if (AST::Type::SYMBOL == args[i]->type() &&
+          std::static_pointer_cast<ASTSymbol>(args[i])->data() == symbol)
+        return node;
+    }
+  }
+  const auto it = constants.find(symbol);
+  if (it == constants.cend())
+    return node;
+  stats_.propagated++;
+  return it->second;
+}
+
+std::shared_ptr<AST> Optimizer::foldBuiltin(Builtin op, AST::List ls) {
+  if (Builtin::IF == op) {
+    if (ls.size() < 4 || !isLiteral(ls[1]))
+      return nullptr;
+    const bool predicate =
+        AST::Type::BOOLEAN == ls[1]->type()
+            ? std::static_pointer_cast<ASTBoolean>(ls[1])->data()
+            : 0 != integer(ls[1]);
+    stats_.pruned++;
+    return predicate ? ls[2] : ls[3];
+  }
+
+  // the leading integer operands
+  auto last = ls.begin() + 1;
+  while (last != ls.end() && AST::Type::INTEGER == (*last)->type())
+    ++last;
+  const auto count = last - ls.begin() - 1;
+  switch (op) {
+  case Builtin::ADD:
+  case Builtin::SUB:
+  case Builtin::MUL:
+  case Builtin::DIV:
+  case Builtin::MOD: {
+    if (count < 2 && (count < 1 || last != ls.end()))
+      return nullptr;
+    std::shared_ptr<AST> folded;
+    if (Builtin::ADD == op)
+      folded = foldInts<Builtin::ADD>(ls.begin() + 1, last);
+    else if (Builtin::SUB == op)
+      folded = foldInts<Builtin::SUB>(ls.begin() + 1, last);
+    else if (Builtin::MUL == op)
+      folded = foldInts<Builtin::MUL>(ls.begin() + 1, last);
+    else if (Builtin::DIV == op)
+      folded = foldInts<Builtin::DIV>(ls.begin() + 1, last);
+    else
+      folded = foldInts<Builtin::MOD>(ls.begin() + 1, last);
+    if (!folded)
+      return nullptr;
+    stats_.folded++;
+    if (last == ls.end())
+      return folded;
+    // (op a b x...) to (op a.b x...)
+    ls.erase(ls.begin() + 2, last);
+    ls[1] = folded;
+    const auto res = std::make_shared<ASTSexpr>();
+    res->setChildren(std::move(ls));
+    return res;
+  }
+  case Builtin::EQ:
+  case Builtin::GT:
+  case Builtin::GE:
+  case Builtin::LT:
+  case Builtin::LE: {
+    if (ls.size() < 3 || last != ls.end())
+      return nullptr;
+    bool value;
+    if (Builtin::EQ == op)
+      value = compareInts<Builtin::EQ>(ls);
+    else if (Builtin::GT == op)
+      value = compareInts<Builtin::GT>(ls);
+    else if (Builtin::GE == op)
+      value = compareInts<Builtin::GE>(ls);
+    else if (Builtin::LT == op)
+      value = compareInts<Builtin::LT>(ls);
+    else
+      value = compareInts<Builtin::LE>(ls);
+    stats_.folded++;
+    return std::make_shared<ASTBoolean>(value);
+  }
+  default:
+    return nullptr;
+  }
+}
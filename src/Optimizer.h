@@ -0,0 +1,64 @@
+#ifndef OPTIMIZER_H_
+#define OPTIMIZER_H_
+#include "AST.h"
+
+#include <memory>
+#include <unordered_map>
+
+/// Rewrites parsed programs before they are evaluated:
+///  - applications of arithmetic and comparison builtins to integer
+///    literals are folded, leading literal operands are folded into one
+///  - an if with a literal predicate is replaced by the branch it takes
+///  - names defined once by a top-level (define name literal) are
+///    replaced by the literal in the forms after the definition
+///
+/// The operands of list and pprint are left as written. Nodes are not
+/// modified, the result shares the subtrees that did not change.
+///
+/// Programs are optimized one at a time, a constant redefined by a later
+/// program keeps its old value in the functions folded earlier.
+class Optimizer {
+public:
+  struct Stats {
+    /// Builtin applications replaced by their value or with fewer operands
+    size_t folded = 0;
+    /// If expressions replaced by a branch
+    size_t pruned = 0;
+    /// References replaced by the value of a constant
+    size_t propagated = 0;
+  };
+
+  /// The optimized forms of program, in the same order
+  AST::List optimize(const AST::List &program);
+
+  /// Print each optimized form by util::print
+  void setDump(bool dump);
+  const Stats &stats() const;
+
+private:
+  /// Count the definitions of each name in program, including those in
+  /// function bodies and in data
+  void countDefinitions(const std::shared_ptr<AST> &node);
+  /// Literal bound by form if it defines a constant, nullptr otherwise
+  std::shared_ptr<AST> constantOf(const std::shared_ptr<AST> &form) const;
+
+  /// params is the argument list of the function node is in, nullptr at
+  /// top-level
+  std::shared_ptr<AST> optimizeExpr(const std::shared_ptr<AST> &node,
+                                    const std::shared_ptr<AST> &params);
+  std::shared_ptr<AST> optimizeDefine(const std::shared_ptr<AST> &node);
+  std::shared_ptr<AST> optimizeSymbol(const std::shared_ptr<AST> &node,
+                                      const std::shared_ptr<AST> &params);
+  /// Fold the builtin application with optimized children ls
+  std::shared_ptr<AST> foldBuiltin(Builtin op, AST::List ls);
+
+  std::unordered_map<Symbol, unsigned int> definitions;
+  /// Set if define is used other than as the head of a form, so names may
+  /// be defined by code built at runtime
+  bool dynamicDefines = false;
+  std::unordered_map<Symbol, std::shared_ptr<AST>> constants;
+  bool dump_ = false;
+  Stats stats_;
+};
+
+#endif /* !OPTIMIZER_H_ */
@@ -20,20 +20,20 @@ AST::List Parser::read() {
 }
 
 std::shared_ptr<AST> Parser::readSexpr() {
-  AST::List ls;
-  while (const auto element = readExpr()) {
+  const auto ret = std::make_shared<ASTSexpr>();
+  while (auto element = readExpr()) {
     //    std::cout << "Adding element: " << element->type() << std::endl;
-    ls.emplace_back(element);
+    ret->addChild(std::move(element));
   }
+  const auto &ls = ret->children();
   if (ls.size() == 0) {
-    return std::make_shared<ASTSexpr>();
+    return ret;
   }
-  const auto ret = std::make_shared<ASTSexpr>();
-  ret->setChildren(ls);
 
-  const auto first = ls[0];
+  const auto &first = ls[0];
   if (AST::Type::BUILTIN == first->type()) {
-    checkSyntaxForBuiltin(ls);
+    checkSyntaxForBuiltin(std::static_pointer_cast<ASTBuiltin>(first)->op(),
+                          ls.size());
   }
   return ret;
 }
@@ -42,20 +42,26 @@ std::shared_ptr<AST> Parser::readExpr() {
   const auto tokenType = lexer.nextToken();
   //  std::cout << "Read token: " << tokenType << std::endl;
   if (TokenType::SYMBOL == tokenType) {
-    const auto name = lexer.string();
-    const auto op = builtinFromCString(name);
+    static const auto TRUE = SymbolTable::intern("true");
+    static const auto FALSE = SymbolTable::intern("false");
+    const auto symbol = lexer.symbol();
+    const auto op = builtinFromSymbol(symbol);
     if (Builtin::UNKNOWN != op) {
       return std::make_shared<ASTBuiltin>(op);
     }
-    if (0 == strcmp("true", name)) {
+    if (TRUE == symbol) {
       return std::make_shared<ASTBoolean>(true);
-    } else if (0 == strcmp("false", name)) {
+    } else if (FALSE == symbol) {
       return std::make_shared<ASTBoolean>(false);
     }
 
-    return std::make_shared<ASTSymbol>(name);
+    return std::make_shared<ASTSymbol>(symbol);
   } else if (TokenType::INTEGER == tokenType) {
+    if (lexer.integerOverflows())
+      return std::make_shared<ASTBignum>(BigInt::fromString(lexer.string()));
     return std::make_shared<ASTInt>(lexer.integer());
+  } else if (TokenType::FLOAT == tokenType) {
+    return std::make_shared<ASTFloat>(lexer.floating());
   } else if (TokenType::STRING == tokenType) {
     return std::make_shared<ASTString>(lexer.string());
   } else if (TokenType::START_PAREN == tokenType) {
@@ -71,11 +77,74 @@ std::shared_ptr<AST> Parser::readExpr() {
   return nullptr; // to please the compiler
 }
 
-void Parser::checkSyntaxForBuiltin(AST::List ls) const {
-  const auto first = std::static_pointer_cast<ASTBuiltin>(ls.front());
-  if (!first)
-    throw SyntaxError("Expected builtin", ls.front());
-  switch (first->op()) {
+Arena Parser::readArena() {
+  Arena arena;
+  std::vector<NodeId> pending;
+  NodeId id;
+  while (readExpr(arena, pending, id)) {
+    arena.addRoot(id);
+  }
+  return arena;
+}
+
+NodeId Parser::readSexpr(Arena &arena, std::vector<NodeId> &pending) {
+  const auto start = pending.size();
+  NodeId element;
+  while (readExpr(arena, pending, element)) {
+    pending.push_back(element);
+  }
+  const auto size = pending.size() - start;
+  if (size > 0 && AST::Type::BUILTIN == arena[pending[start]].type) {
+    checkSyntaxForBuiltin(arena[pending[start]].op, size);
+  }
+  const auto id = arena.addSexpr(pending.data() + start, size);
+  pending.resize(start);
+  return id;
+}
+
+bool Parser::readExpr(Arena &arena, std::vector<NodeId> &pending,
+                      NodeId &id) {
+  const auto tokenType = lexer.nextToken();
+  if (TokenType::SYMBOL == tokenType) {
+    static const auto TRUE = SymbolTable::intern("true");
+    static const auto FALSE = SymbolTable::intern("false");
+    const auto symbol = lexer.symbol();
+    const auto op = builtinFromSymbol(symbol);
+    if (Builtin::UNKNOWN != op) {
+      id = arena.addBuiltin(op);
+    } else if (TRUE == symbol || FALSE == symbol) {
+      id = arena.addBoolean(TRUE == symbol);
+    } else {
+      id = arena.addSymbol(symbol);
+    }
+    return true;
+  } else if (TokenType::INTEGER == tokenType) {
+    id = lexer.integerOverflows() ? arena.addBignum(lexer.string())
+                                  : arena.addInteger(lexer.integer());
+    return true;
+  } else if (TokenType::FLOAT == tokenType) {
+    id = arena.addFloat(lexer.floating());
+    return true;
+  } else if (TokenType::STRING == tokenType) {
+    id = arena.addString(lexer.string());
+    return true;
+  } else if (TokenType::START_PAREN == tokenType) {
+    depth++;
+    id = readSexpr(arena, pending);
+    return true;
+  } else if (TokenType::END_PAREN == tokenType) {
+    depth--;
+    return false;
+  } else if (0 == depth && TokenType::TOKEN_EOF == tokenType) {
+    return false;
+  }
+  syntaxError("Expected expression");
+  return false; // to please the compiler
+}
+
+void Parser::checkSyntaxForBuiltin(Builtin op, size_t size) const {
+  const auto opnode = [op] { return std::make_shared<ASTBuiltin>(op); };
+  switch (op) {
   case Builtin::EQ:
   case Builtin::GT:
   case Builtin::GE:
@@ -88,31 +157,61 @@ void Parser::checkSyntaxForBuiltin(AST::List ls) const {
   case Builtin::MOD:
   case Builtin::HEAD:
   case Builtin::TAIL:
+  case Builtin::REST:
   case Builtin::EVAL:
   case Builtin::PPRINT:
-    if (1 == ls.size()) {
-      throw SyntaxError("Builtin requires operands", first);
+  case Builtin::MAKE_ARRAY:
+  case Builtin::ARRAY_GET:
+  case Builtin::ARRAY_SLICE:
+  case Builtin::ARRAY_LENGTH:
+  case Builtin::HASH_SIZE:
+  case Builtin::CONCAT:
+  case Builtin::SUBSTRING:
+  case Builtin::STRING_LENGTH:
+  case Builtin::STRING_TO_LIST:
+  case Builtin::HASH_KEYS:
+  case Builtin::HASH_VALUES:
+  case Builtin::TRANSIENT:
+  case Builtin::PERSISTENT:
+  case Builtin::SPAWN:
+  case Builtin::SYNC:
+    if (1 == size) {
+      throw SyntaxError("Builtin requires operands", opnode());
     }
     break;
-  case Builtin::DEFINE: {
-    if (1 == ls.size()) {
-      throw SyntaxError("Definition must have argumentlist and body", first);
-    } else if (2 == ls.size()) {
-      throw SyntaxError("Definition must have a body", first);
+  case Builtin::DEFINE:
+  case Builtin::DEFINE_MEMO: {
+    if (1 == size) {
+      throw SyntaxError("Definition must have argumentlist and body", opnode());
+    } else if (2 == size) {
+      throw SyntaxError("Definition must have a body", opnode());
     }
     break;
   }
   case Builtin::JOIN:
-    if (ls.size() < 3) {
-      throw SyntaxError("Builtin requires two operands", first);
+  case Builtin::CONS:
+  case Builtin::HASH_GET:
+  case Builtin::HASH_SET:
+  case Builtin::HASH_REMOVE:
+  case Builtin::PMAP:
+  case Builtin::PFILTER:
+    if (size < 3) {
+      throw SyntaxError("Builtin requires two operands", opnode());
+    }
+    break;
+  case Builtin::PREDUCE:
+    if (size < 4) {
+      throw SyntaxError("Builtin requires three operands", opnode());
     }
     break;
   case Builtin::IF:
-    if (ls.size() < 4) {
-      throw SyntaxError("If-expression must har predicate and such", first);
+    if (size < 4) {
+      throw SyntaxError("If-expression must har predicate and such", opnode());
     }
     break;
   case Builtin::LIST:
+  case Builtin::ARRAY:
+  case Builtin::HASH:
     break;
   case Builtin::UNKNOWN:
     break;
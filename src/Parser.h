@@ -1,6 +1,7 @@
 #ifndef PARSER_H_
 #define PARSER_H_
 #include "AST.h"
+#include "Arena.h"
 #include "Lexer.h"
 
 #include <memory>
@@ -10,14 +11,21 @@ public:
   explicit Parser(const Lexer &lexer);
 
   AST::List read();
+  /// Read the program into a compact arena instead of separate nodes
+  Arena readArena();
 
 private:
   Lexer lexer;
   int depth;
-  void checkSyntaxForBuiltin(AST::List ls) const;
+  void checkSyntaxForBuiltin(Builtin op, size_t size) const;
   void syntaxError(const char *msg);
   std::shared_ptr<AST> readSexpr();
   std::shared_ptr<AST> readExpr();
+
+  /// Read an expression into the arena, false at the end of a list or the
+  /// program. pending holds the children of the lists being read.
+  bool readExpr(Arena &arena, std::vector<NodeId> &pending, NodeId &id);
+  NodeId readSexpr(Arena &arena, std::vector<NodeId> &pending);
 };
 
 #endif /* !PARSER_H_ */
@@ -0,0 +1,162 @@
+#include "PersistentList.h"
+#include "AST.h"
+
+#include <algorithm>
+#include <cassert>
+
+PersistentList::PersistentList(Elements::const_iterator begin,
+                               Elements::const_iterator end)
+    : root(build(begin, end)) {}
+
+PersistentList::~PersistentList() {
+  std::vector<NodePtr> dying;
+  release(root, dying);
+  while (!dying.empty()) {
+    const auto node = std::move(dying.back());
+    dying.pop_back();
+    // the last reference, nothing else sees the node emptied
+    auto &n = const_cast<Node &>(*node);
+    release(n.left, dying);
+    release(n.right, dying);
+    for (auto &element : n.elements) {
+      if (1 == element.use_count() && AST::Type::LIST == element->type())
+        release(static_cast<ASTList &>(*element).list().root, dying);
+    }
+  }
+}
+
+const PersistentList::Element &PersistentList::front() const {
+  assert(root);
+  const Node *node = root.get();
+  while (node->height) {
+    node = node->left.get();
+  }
+  return node->elements.front();
+}
+
+const PersistentList::Element &PersistentList::back() const {
+  assert(root);
+  const Node *node = root.get();
+  while (node->height) {
+    node = node->right.get();
+  }
+  return node->elements.back();
+}
+
+const PersistentList::Element &PersistentList::operator[](size_t i) const {
+  assert(i < size());
+  const Node *node = root.get();
+  while (node->height) {
+    if (i < node->left->size) {
+      node = node->left.get();
+    } else {
+      i -= node->left->size;
+      node = node->right.get();
+    }
+  }
+  return node->elements[i];
+}
+
+PersistentList PersistentList::join(const PersistentList &a,
+                                    const PersistentList &b) {
+  return PersistentList(concat(a.root, b.root));
+}
+
+PersistentList PersistentList::cons(Element x) const {
+  return PersistentList(concat(chunk(Elements{std::move(x)}), root));
+}
+
+PersistentList PersistentList::rest() const {
+  assert(root);
+  return PersistentList(rest(root));
+}
+
+PersistentList::Elements PersistentList::toVector() const {
+  Elements res;
+  res.reserve(size());
+  forEach([&res](const Element &element) { res.push_back(element); });
+  return res;
+}
+
+PersistentList::NodePtr PersistentList::chunk(Elements elements) {
+  assert(!elements.empty() && elements.size() <= CHUNK);
+  const auto size = elements.size();
+  return std::make_shared<const Node>(
+      Node{size, 0, nullptr, nullptr, std::move(elements)});
+}
+
+PersistentList::NodePtr PersistentList::build(Elements::const_iterator begin,
+                                              Elements::const_iterator end) {
+  const size_t size = end - begin;
+  if (!size)
+    return nullptr;
+  if (size <= CHUNK)
+    return chunk(Elements(begin, end));
+  // halves of whole chunks have heights differing by at most 1
+  const auto chunks = (size + CHUNK - 1) / CHUNK;
+  const auto mid = begin + chunks / 2 * CHUNK;
+  return make(build(begin, mid), build(mid, end));
+}
+
+PersistentList::NodePtr PersistentList::make(NodePtr left, NodePtr right) {
+  const auto size = left->size + right->size;
+  const auto height = std::max(left->height, right->height) + 1;
+  return std::make_shared<const Node>(
+      Node{size, height, std::move(left), std::move(right), {}});
+}
+
+PersistentList::NodePtr PersistentList::balance(NodePtr left, NodePtr right) {
+  if (left->height > right->height + 1) {
+    if (left->left->height >= left->right->height)
+      return make(left->left, make(left->right, std::move(right)));
+    return make(make(left->left, left->right->left),
+                make(left->right->right, std::move(right)));
+  }
+  if (right->height > left->height + 1) {
+    if (right->right->height >= right->left->height)
+      return make(make(std::move(left), right->left), right->right);
+    return make(make(std::move(left), right->left->left),
+                make(right->left->right, right->right));
+  }
+  return make(std::move(left), std::move(right));
+}
+
+PersistentList::NodePtr PersistentList::concat(const NodePtr &a,
+                                               const NodePtr &b) {
+  if (!a)
+    return b;
+  if (!b)
+    return a;
+  if (a->size + b->size <= CHUNK) {
+    Elements elements;
+    elements.reserve(a->size + b->size);
+    const auto append = [&elements](const Element &element) {
+      elements.push_back(element);
+    };
+    forEach(*a, append);
+    forEach(*b, append);
+    return chunk(std::move(elements));
+  }
+  // a chunk joined to a tree is merged into its nearest chunk, so lists
+  // built an element at a time still have full chunks
+  if (a->height > b->height + 1 || (a->height && !b->height))
+    return balance(a->left, concat(a->right, b));
+  if (b->height > a->height + 1 || (b->height && !a->height))
+    return balance(concat(a, b->left), b->right);
+  return make(a, b);
+}
+
+PersistentList::NodePtr PersistentList::rest(const NodePtr &node) {
+  if (!node->height) {
+    if (1 == node->size)
+      return nullptr;
+    return chunk(Elements(node->elements.begin() + 1, node->elements.end()));
+  }
+  const auto left = rest(node->left);
+  return left ? concat(left, node->right) : node->right;
+}
+
+void PersistentList::release(NodePtr &node, std::vector<NodePtr> &dying) {
+  if (1 == node.use_count())
+    dying.push_back(std::move(node));
+}
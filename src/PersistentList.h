@@ -0,0 +1,99 @@
+#ifndef PERSISTENTLIST_H_
+#define PERSISTENTLIST_H_
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+class AST;
+
+/// Immutable sequence of nodes, the elements of a list value. The elements
+/// are kept in chunks of up to CHUNK nodes at the leaves of a height
+/// balanced tree, lists made from others share their subtrees.
+///
+/// join is O(log n) and cons and rest are O(log n) plus the copy of a
+/// chunk, front, back and indexing walk down the tree in O(log n).
+class PersistentList {
+public:
+  using Element = std::shared_ptr<AST>;
+  using Elements = std::vector<Element>;
+  static const size_t CHUNK = 32;
+
+  PersistentList() = default;
+  /// The elements from begin up to end
+  PersistentList(Elements::const_iterator begin, Elements::const_iterator end);
+  PersistentList(const PersistentList &) = default;
+  PersistentList(PersistentList &&) = default;
+  PersistentList &operator=(PersistentList other) {
+    root.swap(other.root);
+    return *this;
+  }
+  /// Lists nested in the elements and held only by them are torn down one
+  /// after the other, not by recursing as deep as they nest
+  ~PersistentList();
+
+  size_t size() const { return root ? root->size : 0; }
+  bool empty() const { return !root; }
+  /// The first and the last element of a non-empty list
+  /// @{
+  const Element &front() const;
+  const Element &back() const;
+  /// @}
+  const Element &operator[](size_t i) const;
+
+  /// The elements of a followed by those of b
+  static PersistentList join(const PersistentList &a, const PersistentList &b);
+  /// x followed by the elements
+  PersistentList cons(Element x) const;
+  /// All elements but the first of a non-empty list
+  PersistentList rest() const;
+
+  /// Call fn with each element in order
+  template <typename Fn> void forEach(Fn fn) const {
+    if (root)
+      forEach(*root, fn);
+  }
+  Elements toVector() const;
+
+  /// Height of the tree, 0 for a single chunk
+  unsigned int height() const { return root ? root->height : 0; }
+
+private:
+  /// A chunk of elements if height is 0, else the concatenation of left
+  /// and right, whose heights differ by at most 1
+  struct Node {
+    size_t size;
+    unsigned int height;
+    std::shared_ptr<const Node> left;
+    std::shared_ptr<const Node> right;
+    Elements elements;
+  };
+  using NodePtr = std::shared_ptr<const Node>;
+
+  explicit PersistentList(NodePtr root) : root(std::move(root)) {}
+
+  template <typename Fn> static void forEach(const Node &node, Fn &fn) {
+    if (0 == node.height) {
+      for (const auto &element : node.elements) {
+        fn(element);
+      }
+      return;
+    }
+    forEach(*node.left, fn);
+    forEach(*node.right, fn);
+  }
+
+  static NodePtr chunk(Elements elements);
+  static NodePtr build(Elements::const_iterator begin,
+                       Elements::const_iterator end);
+  static NodePtr make(NodePtr left, NodePtr right);
+  /// make with a rotation if the heights of left and right differ by 2
+  static NodePtr balance(NodePtr left, NodePtr right);
+  static NodePtr concat(const NodePtr &a, const NodePtr &b);
+  static NodePtr rest(const NodePtr &node);
+  /// Move node onto dying if it is its last reference
+  static void release(NodePtr &node, std::vector<NodePtr> &dying);
+
+  NodePtr root;
+};
+
+#endif /* !PERSISTENTLIST_H_ */
@@ -0,0 +1,225 @@
+#include "PersistentMap.h"
+#include "HashMap.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+const unsigned int HASH_BITS = 64;
+
+uint32_t bitOf(size_t hash, unsigned int shift) {
+  return uint32_t(1) << ((hash >> shift) & 31);
+}
+
+/// Index of the entry for bit among the entries of bitmap
+size_t indexOf(uint32_t bitmap, uint32_t bit) {
+  return __builtin_popcount(bitmap & (bit - 1));
+}
+
+/// The 5 bit groups of hash from the lowest one, which is indexed first,
+/// as the most significant digits
+uint64_t trieOrder(size_t hash) {
+  uint64_t res = 0;
+  for (unsigned int shift = 0; shift < HASH_BITS; shift += 5) {
+    const unsigned int width = std::min(5u, HASH_BITS - shift);
+    res = (res << width) | ((hash >> shift) & ((1u << width) - 1));
+  }
+  return res;
+}
+
+} // namespace
+
+PersistentMap::PersistentMap(const HashMap &map) : size_(map.size()) {
+  if (!size_)
+    return;
+  std::vector<Entry> entries;
+  entries.reserve(size_);
+  map.forEach([&entries](const Element &key, const Element &value) {
+    entries.push_back(Entry{HashMap::hash(*key), key, value, nullptr});
+  });
+  std::sort(entries.begin(), entries.end(),
+            [](const Entry &a, const Entry &b) {
+              return trieOrder(a.hash) < trieOrder(b.hash);
+            });
+  root = build(entries.begin(), entries.end(), 0);
+}
+
+const PersistentMap::Element *PersistentMap::find(const AST &key) const {
+  return find(key, HashMap::hash(key));
+}
+
+const PersistentMap::Element *PersistentMap::find(const AST &key,
+                                                  size_t hash) const {
+  const Node *node = root.get();
+  for (unsigned int shift = 0; node; shift += BITS) {
+    if (shift >= HASH_BITS) {
+      for (const auto &entry : node->entries) {
+        if (HashMap::equal(*entry.key, key))
+          return &entry.value;
+      }
+      return nullptr;
+    }
+    const auto bit = bitOf(hash, shift);
+    if (!(node->bitmap & bit))
+      return nullptr;
+    const auto &entry = node->entries[indexOf(node->bitmap, bit)];
+    if (!entry.child) {
+      if (entry.hash == hash && HashMap::equal(*entry.key, key))
+        return &entry.value;
+      return nullptr;
+    }
+    node = entry.child.get();
+  }
+  return nullptr;
+}
+
+PersistentMap PersistentMap::set(Element key, Element value) const {
+  const auto hash = HashMap::hash(*key);
+  bool added = false;
+  auto node =
+      set(root, 0, Entry{hash, std::move(key), std::move(value), nullptr},
+          added);
+  return PersistentMap(std::move(node), size_ + (added ? 1 : 0));
+}
+
+PersistentMap PersistentMap::remove(const AST &key) const {
+  if (!root)
+    return *this;
+  bool removed = false;
+  auto node = remove(root, 0, key, HashMap::hash(key), removed);
+  if (!removed)
+    return *this;
+  return PersistentMap(std::move(node), size_ - 1);
+}
+
+PersistentMap::NodePtr PersistentMap::set(const NodePtr &node,
+                                          unsigned int shift, Entry entry,
+                                          bool &added) {
+  if (!node) {
+    added = true;
+    const auto bit = bitOf(entry.hash, shift);
+    return std::make_shared<const Node>(Node{bit, {std::move(entry)}});
+  }
+  auto copy = std::make_shared<Node>(*node);
+  if (shift >= HASH_BITS) {
+    for (auto &other : copy->entries) {
+      if (HashMap::equal(*other.key, *entry.key)) {
+        other.value = std::move(entry.value);
+        return copy;
+      }
+    }
+    added = true;
+    copy->entries.push_back(std::move(entry));
+    return copy;
+  }
+  const auto bit = bitOf(entry.hash, shift);
+  const auto i = indexOf(node->bitmap, bit);
+  if (!(node->bitmap & bit)) {
+    added = true;
+    copy->bitmap |= bit;
+    copy->entries.insert(copy->entries.begin() + i, std::move(entry));
+    return copy;
+  }
+  auto &other = copy->entries[i];
+  if (other.child) {
+    other.child = set(other.child, shift + BITS, std::move(entry), added);
+  } else if (other.hash == entry.hash &&
+             HashMap::equal(*other.key, *entry.key)) {
+    other.value = std::move(entry.value);
+  } else {
+    added = true;
+    other = Entry{0, nullptr, nullptr,
+                  pair(std::move(other), std::move(entry), shift + BITS)};
+  }
+  return copy;
+}
+
+PersistentMap::NodePtr PersistentMap::pair(Entry a, Entry b,
+                                           unsigned int shift) {
+  if (shift >= HASH_BITS)
+    return std::make_shared<const Node>(Node{0, {std::move(a), std::move(b)}});
+  const auto bitA = bitOf(a.hash, shift);
+  const auto bitB = bitOf(b.hash, shift);
+  if (bitA == bitB) {
+    auto child = pair(std::move(a), std::move(b), shift + BITS);
+    return std::make_shared<const Node>(
+        Node{bitA, {Entry{0, nullptr, nullptr, std::move(child)}}});
+  }
+  if (bitB < bitA)
+    std::swap(a, b);
+  return std::make_shared<const Node>(
+      Node{bitA | bitB, {std::move(a), std::move(b)}});
+}
+
+PersistentMap::NodePtr PersistentMap::build(std::vector<Entry>::iterator begin,
+                                            std::vector<Entry>::iterator end,
+                                            unsigned int shift) {
+  auto node = std::make_shared<Node>(Node{0, {}});
+  if (shift >= HASH_BITS) {
+    node->entries.assign(std::make_move_iterator(begin),
+                         std::make_move_iterator(end));
+    return node;
+  }
+  while (begin != end) {
+    const auto bit = bitOf(begin->hash, shift);
+    auto run = begin + 1;
+    while (run != end && bitOf(run->hash, shift) == bit) {
+      ++run;
+    }
+    node->bitmap |= bit;
+    if (run - begin == 1)
+      node->entries.push_back(std::move(*begin));
+    else
+      node->entries.push_back(
+          Entry{0, nullptr, nullptr, build(begin, run, shift + BITS)});
+    begin = run;
+  }
+  return node;
+}
+
+PersistentMap::NodePtr PersistentMap::remove(const NodePtr &node,
+                                             unsigned int shift,
+                                             const AST &key, size_t hash,
+                                             bool &removed) {
+  size_t i = 0;
+  if (shift >= HASH_BITS) {
+    while (i < node->entries.size() &&
+           !HashMap::equal(*node->entries[i].key, key)) {
+      i++;
+    }
+    if (i == node->entries.size())
+      return node;
+  } else {
+    const auto bit = bitOf(hash, shift);
+    if (!(node->bitmap & bit))
+      return node;
+    i = indexOf(node->bitmap, bit);
+    const auto &entry = node->entries[i];
+    if (entry.child) {
+      const auto child = remove(entry.child, shift + BITS, key, hash, removed);
+      if (child == entry.child)
+        return node;
+      if (child) {
+        auto copy = std::make_shared<Node>(*node);
+        if (1 == child->entries.size() && !child->entries.front().child) {
+          // a single key moves up in place of its node
+          copy->entries[i] = child->entries.front();
+        } else {
+          copy->entries[i].child = child;
+        }
+        return copy;
+      }
+    } else if (entry.hash != hash || !HashMap::equal(*entry.key, key)) {
+      return node;
+    }
+  }
+  removed = true;
+  if (1 == node->entries.size())
+    return nullptr;
+  auto copy = std::make_shared<Node>(*node);
+  if (shift < HASH_BITS)
+    copy->bitmap &= ~bitOf(hash, shift);
+  copy->entries.erase(copy->entries.begin() + i);
+  return copy;
+}
@@ -0,0 +1,86 @@
+#ifndef PERSISTENTMAP_H_
+#define PERSISTENTMAP_H_
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class AST;
+class HashMap;
+
+/// Immutable hash map with the keys of HashMap, the value of hash. A hash
+/// array mapped trie: each level indexes 5 bits of the 64 bit hash into a
+/// node holding only its present entries, keys whose hashes are equal
+/// share a node below the last level. set and remove copy the nodes on
+/// the path to the key, O(log32 n), and share the rest.
+class PersistentMap {
+public:
+  using Element = std::shared_ptr<AST>;
+
+  PersistentMap() = default;
+  /// The entries of a transient map, built in one pass
+  explicit PersistentMap(const HashMap &map);
+
+  size_t size() const { return size_; }
+
+  /// The value of key or nullptr
+  const Element *find(const AST &key, size_t hash) const;
+  const Element *find(const AST &key) const;
+  /// The map with key bound to value
+  PersistentMap set(Element key, Element value) const;
+  /// The map without key
+  PersistentMap remove(const AST &key) const;
+
+  /// Call fn with each key and value, in the order of their hashes
+  template <typename Fn> void forEach(Fn fn) const {
+    if (root)
+      forEach(*root, fn);
+  }
+
+private:
+  struct Node;
+  using NodePtr = std::shared_ptr<const Node>;
+  /// A key and its value, or a subtree if child is set
+  struct Entry {
+    size_t hash;
+    Element key;
+    Element value;
+    NodePtr child;
+  };
+  /// Bit i of bitmap is set if there is an entry for the 5 bits i of the
+  /// hash, the entries are in the order of the bits. Below the last level
+  /// bitmap is unused and the entries are the keys of equal hashes.
+  struct Node {
+    uint32_t bitmap;
+    std::vector<Entry> entries;
+  };
+  static const unsigned int BITS = 5;
+
+  PersistentMap(NodePtr root, size_t size)
+      : root(std::move(root)), size_(size) {}
+
+  template <typename Fn> static void forEach(const Node &node, Fn &fn) {
+    for (const auto &entry : node.entries) {
+      if (entry.child)
+        forEach(*entry.child, fn);
+      else
+        fn(entry.key, entry.value);
+    }
+  }
+
+  static NodePtr set(const NodePtr &node, unsigned int shift, Entry entry,
+                     bool &added);
+  static NodePtr remove(const NodePtr &node, unsigned int shift,
+                        const AST &key, size_t hash, bool &removed);
+  /// The node holding two entries whose hashes agree below shift
+  static NodePtr pair(Entry a, Entry b, unsigned int shift);
+  /// The node of entries sorted by the bits of their hashes from shift up,
+  /// whose hashes agree below shift
+  static NodePtr build(std::vector<Entry>::iterator begin,
+                       std::vector<Entry>::iterator end, unsigned int shift);
+
+  NodePtr root;
+  size_t size_ = 0;
+};
+
+#endif /* !PERSISTENTMAP_H_ */
@@ -0,0 +1,188 @@
+#include "Printer.h"
+#include "AST.h"
+
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+
+Printer::Printer(std::string &out) : out(&out), fd(-1) {}
+
+Printer::Printer(int fd) : out(nullptr), fd(fd) {}
+
+Printer::~Printer() { drain(); }
+
+void Printer::print(const AST &node) {
+  const auto base = depth;
+  open(node);
+  while (depth > base) {
+    auto &frame = stack[depth - 1];
+    if (frame.next == frame.items.size()) {
+      put(frame.close);
+      depth--;
+      continue;
+    }
+    if (frame.next > 0 || frame.leadingSpace)
+      put(' ');
+    // open may grow the stack and move frame
+    open(*frame.items[frame.next++]);
+  }
+  done();
+}
+
+void Printer::open(const AST &node) {
+  using Type = AST::Type;
+  switch (node.type()) {
+  case Type::SEXPR:
+  case Type::FUN: {
+    const bool sexpr = Type::SEXPR == node.type();
+    put(sexpr ? "(" : "<function>: ");
+    auto &items = push(false, sexpr ? ")" : "").items;
+    for (const auto &child : node.children()) {
+      items.push_back(child.get());
+    }
+    break;
+  }
+  case Type::LIST: {
+    put("(list");
+    auto &items = push(true, ")").items;
+    static_cast<const ASTList &>(node).data().forEach(
+        [&items](const std::shared_ptr<AST> &element) {
+          items.push_back(element.get());
+        });
+    break;
+  }
+  case Type::MAP:
+  case Type::TRANSIENT_MAP: {
+    const auto add = [](std::vector<const AST *> &items) {
+      return [&items](const std::shared_ptr<AST> &key,
+                      const std::shared_ptr<AST> &value) {
+        items.push_back(key.get());
+        items.push_back(value.get());
+      };
+    };
+    if (Type::MAP == node.type()) {
+      put("(hash");
+      static_cast<const ASTMap &>(node).data().forEach(
+          add(push(true, ")").items));
+    } else {
+      put("(transient (hash");
+      static_cast<const ASTTransientMap &>(node).data().forEach(
+          add(push(true, "))").items));
+    }
+    break;
+  }
+  case Type::ARRAY: {
+    const auto &array = static_cast<const ASTArray &>(node).data();
+    put("(array");
+    for (size_t i = 0; i < array.size(); i++) {
+      put(' ');
+      if (TypedArray::Element::INT == array.element())
+        putInteger(array.ints()[i]);
+      else
+        putFloat(array.floats()[i]);
+    }
+    put(')');
+    break;
+  }
+  case Type::STRING:
+    put('"');
+    static_cast<const ASTString &>(node).data().forEachPiece(
+        [this](const char *piece, size_t n) { put(piece, n); });
+    put('"');
+    break;
+  case Type::SYMBOL:
+    put(static_cast<const ASTSymbol &>(node).name());
+    break;
+  case Type::BOOLEAN:
+    put(static_cast<const ASTBoolean &>(node).data() ? "true" : "false");
+    break;
+  case Type::INTEGER:
+    putInteger(static_cast<const ASTInt &>(node).data());
+    break;
+  case Type::BIGNUM:
+    // the digits of a bignum are only made as a string
+    put(static_cast<const ASTBignum &>(node).data().toString());
+    break;
+  case Type::FLOAT:
+    putFloat(static_cast<const ASTFloat &>(node).data());
+    break;
+  case Type::BUILTIN:
+    put(builtinToCString(static_cast<const ASTBuiltin &>(node).op()));
+    break;
+  case Type::FUTURE:
+    put("<future>");
+    break;
+  }
+}
+
+Printer::Frame &Printer::push(bool leadingSpace, const char *close) {
+  if (depth == stack.size())
+    stack.emplace_back();
+  auto &frame = stack[depth++];
+  frame.items.clear();
+  frame.next = 0;
+  frame.leadingSpace = leadingSpace;
+  frame.close = close;
+  return frame;
+}
+
+void Printer::write(const char *s, size_t n) {
+  put(s, n);
+  done();
+}
+
+void Printer::write(const char *s) { write(s, strlen(s)); }
+
+void Printer::write(char c) {
+  put(c);
+  done();
+}
+
+void Printer::writeInteger(int64_t i) {
+  putInteger(i);
+  done();
+}
+
+void Printer::writeFloat(double d) {
+  putFloat(d);
+  done();
+}
+
+void Printer::putInteger(int64_t i) {
+  char buf[24];
+  char *end = buf + sizeof(buf);
+  char *p = end;
+  // the magnitude of INT64_MIN only fits unsigned
+  uint64_t magnitude = i < 0 ? 0 - static_cast<uint64_t>(i) : i;
+  do {
+    *--p = static_cast<char>('0' + magnitude % 10);
+    magnitude /= 10;
+  } while (magnitude);
+  if (i < 0)
+    *--p = '-';
+  put(p, end - p);
+}
+
+void Printer::putFloat(double d) {
+  char buf[32];
+  ASTFloat::format(d, buf);
+  put(buf, strlen(buf));
+}
+
+void Printer::sink(const char *s, size_t n) {
+  if (out) {
+    out->append(s, n);
+    return;
+  }
+  while (n) {
+    const auto written = ::write(fd, s, n);
+    if (written < 0) {
+      if (EINTR == errno)
+        continue;
+      // nowhere to report it, the output is dropped like cout would
+      return;
+    }
+    s += written;
+    n -= written;
+  }
+}
@@ -0,0 +1,100 @@
+#ifndef PRINTER_H_
+#define PRINTER_H_
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+class AST;
+
+/// Writes the printed form of nodes into a growable buffer of the caller,
+/// or to a file descriptor. Output is collected in a buffer of BUFFER
+/// bytes, written to the file descriptor when full and appended to the
+/// buffer of the caller by each call. Nested values are walked with an
+/// explicit stack so their depth is bounded by memory only, and atoms are
+/// formatted on the machine stack: once the buffer of the caller and the
+/// stack have grown, printing allocates nothing.
+class Printer {
+public:
+  static const size_t BUFFER = 64 * 1024;
+
+  /// Append to out
+  explicit Printer(std::string &out);
+  /// Write to fd, what is left in the buffer when flushed or destroyed
+  explicit Printer(int fd);
+  ~Printer();
+  Printer(const Printer &) = delete;
+  Printer &operator=(const Printer &) = delete;
+
+  /// Write node as util::print does
+  void print(const AST &node);
+  /// @{
+  void write(const char *s, size_t n);
+  void write(const char *s);
+  void write(const std::string &s) { write(s.data(), s.size()); }
+  void write(char c);
+  void writeInteger(int64_t i);
+  void writeFloat(double d);
+  /// @}
+  /// Write the buffer to the file descriptor
+  void flush() { drain(); }
+
+private:
+  /// A value whose items are being printed, items separated by a space
+  /// and a space before the first one if leadingSpace is set
+  struct Frame {
+    std::vector<const AST *> items;
+    size_t next;
+    bool leadingSpace;
+    const char *close;
+  };
+
+  /// Write an atom, or the opening of a nested value and push its frame
+  void open(const AST &node);
+  /// The frame on top of the stack, reusing the items of a popped one
+  Frame &push(bool leadingSpace, const char *close);
+  /// Append to the buffer, the output of the public calls
+  /// @{
+  void put(const char *s, size_t n) {
+    if (used + n > BUFFER) {
+      drain();
+      if (n > BUFFER) {
+        sink(s, n);
+        return;
+      }
+    }
+    memcpy(chars + used, s, n);
+    used += n;
+  }
+  void put(char c) {
+    if (used == BUFFER)
+      drain();
+    chars[used++] = c;
+  }
+  void put(const char *s) { put(s, strlen(s)); }
+  void put(const std::string &s) { put(s.data(), s.size()); }
+  void putInteger(int64_t i);
+  void putFloat(double d);
+  /// @}
+  /// Pass what is buffered to the caller if it is a string
+  void done() {
+    if (out)
+      drain();
+  }
+  /// Write the buffer to the string or the file descriptor
+  void drain() {
+    sink(chars, used);
+    used = 0;
+  }
+  void sink(const char *s, size_t n);
+
+  std::string *out;
+  int fd;
+  size_t used = 0;
+  char chars[BUFFER];
+  std::vector<Frame> stack;
+  size_t depth = 0;
+};
+
+#endif /* !PRINTER_H_ */
@@ -0,0 +1,201 @@
+#include "Rope.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+Rope::Rope(const char *str) : Rope(str, strlen(str)) {}
+
+Rope::Rope(const char *chars, size_t size) : size_(size) {
+  if (size <= INLINE) {
+    memcpy(chars_, chars, size);
+    chars_[size] = '\0';
+  } else {
+    chars_[0] = '\0';
+    rope = leaf(std::string(chars, size));
+  }
+}
+
+Rope::Rope(NodePtr node) : size_(node ? node->size : 0) {
+  chars_[0] = '\0';
+  if (size_ > INLINE) {
+    rope = std::move(node);
+    return;
+  }
+  if (!node)
+    return;
+  size_t at = 0;
+  auto copy = [this, &at](const char *chars, size_t size) {
+    memcpy(chars_ + at, chars, size);
+    at += size;
+  };
+  forEachPiece(*node, copy);
+  chars_[size_] = '\0';
+}
+
+char Rope::operator[](size_t i) const {
+  assert(i < size_);
+  if (!rope)
+    return chars_[i];
+  const Node *node = rope.get();
+  while (node->height) {
+    if (i < node->left->size) {
+      node = node->left.get();
+    } else {
+      i -= node->left->size;
+      node = node->right.get();
+    }
+  }
+  return node->chars[i];
+}
+
+Rope Rope::concat(const Rope &a, const Rope &b) {
+  if (a.size_ + b.size_ <= INLINE) {
+    Rope res;
+    a.forEachPiece([&res](const char *chars, size_t size) {
+      memcpy(res.chars_ + res.size_, chars, size);
+      res.size_ += size;
+    });
+    b.forEachPiece([&res](const char *chars, size_t size) {
+      memcpy(res.chars_ + res.size_, chars, size);
+      res.size_ += size;
+    });
+    res.chars_[res.size_] = '\0';
+    return res;
+  }
+  return Rope(concat(a.node(), b.node()));
+}
+
+Rope Rope::substring(size_t start, size_t end) const {
+  assert(start <= end && end <= size_);
+  if (!rope)
+    return Rope(chars_ + start, end - start);
+  return Rope(substring(rope, start, end));
+}
+
+std::string Rope::str() const {
+  std::string res;
+  res.reserve(size_);
+  forEachPiece(
+      [&res](const char *chars, size_t size) { res.append(chars, size); });
+  return res;
+}
+
+bool Rope::operator==(const Rope &other) const {
+  if (size_ != other.size_)
+    return false;
+  if (!rope && !other.rope)
+    return 0 == memcmp(chars_, other.chars_, size_);
+  // compare the pieces of one with the chars of the other at the same
+  // offset, walking the pieces of both in step
+  std::vector<std::pair<const char *, size_t>> pieces;
+  other.forEachPiece([&pieces](const char *chars, size_t size) {
+    pieces.emplace_back(chars, size);
+  });
+  size_t piece = 0, at = 0;
+  bool equal = true;
+  forEachPiece([&](const char *chars, size_t size) {
+    while (equal && size) {
+      const auto n = std::min(size, pieces[piece].second - at);
+      equal = 0 == memcmp(chars, pieces[piece].first + at, n);
+      chars += n;
+      size -= n;
+      at += n;
+      if (at == pieces[piece].second) {
+        piece++;
+        at = 0;
+      }
+    }
+  });
+  return equal;
+}
+
+size_t Rope::hash() const {
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  forEachPiece([&hash](const char *chars, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+      hash ^= static_cast<unsigned char>(chars[i]);
+      hash *= 0x100000001b3ULL;
+    }
+  });
+  return hash;
+}
+
+Rope::NodePtr Rope::node() const {
+  if (rope || !size_)
+    return rope;
+  return leaf(std::string(chars_, size_));
+}
+
+Rope::NodePtr Rope::leaf(std::string chars) {
+  const auto size = chars.size();
+  return std::make_shared<const Node>(
+      Node{size, 0, nullptr, nullptr, std::move(chars)});
+}
+
+Rope::NodePtr Rope::make(NodePtr left, NodePtr right) {
+  const auto size = left->size + right->size;
+  const auto height = std::max(left->height, right->height) + 1;
+  return std::make_shared<const Node>(
+      Node{size, height, std::move(left), std::move(right), {}});
+}
+
+Rope::NodePtr Rope::balance(NodePtr left, NodePtr right) {
+  if (left->height > right->height + 1) {
+    if (left->left->height >= left->right->height)
+      return make(left->left, make(left->right, std::move(right)));
+    return make(make(left->left, left->right->left),
+                make(left->right->right, std::move(right)));
+  }
+  if (right->height > left->height + 1) {
+    if (right->right->height >= right->left->height)
+      return make(make(std::move(left), right->left), right->right);
+    return make(make(std::move(left), right->left->left),
+                make(right->left->right, right->right));
+  }
+  return make(std::move(left), std::move(right));
+}
+
+Rope::NodePtr Rope::concat(const NodePtr &a, const NodePtr &b) {
+  if (!a)
+    return b;
+  if (!b)
+    return a;
+  if (a->size + b->size <= LEAF) {
+    std::string chars;
+    chars.reserve(a->size + b->size);
+    auto append = [&chars](const char *piece, size_t size) {
+      chars.append(piece, size);
+    };
+    forEachPiece(*a, append);
+    forEachPiece(*b, append);
+    return leaf(std::move(chars));
+  }
+  // a short piece joined to a rope is merged into its nearest piece, so
+  // ropes built by appending a little at a time have few long pieces
+  if (a->height > b->height + 1 || (a->height && !b->height))
+    return balance(a->left, concat(a->right, b));
+  if (b->height > a->height + 1 || (b->height && !a->height))
+    return balance(concat(a, b->left), b->right);
+  return make(a, b);
+}
+
+Rope::NodePtr Rope::substring(const NodePtr &node, size_t start,
+                                  size_t end) {
+  if (start == end)
+    return nullptr;
+  if (0 == start && node->size == end)
+    return node;
+  if (!node->height)
+    return leaf(node->chars.substr(start, end - start));
+  const auto middle = node->left->size;
+  if (end <= middle)
+    return substring(node->left, start, end);
+  if (start >= middle)
+    return substring(node->right, start - middle, end - middle);
+  return concat(substring(node->left, start, middle),
+                substring(node->right, 0, end - middle));
+}
@@ -0,0 +1,87 @@
+#ifndef ROPE_H_
+#define ROPE_H_
+#include <cstddef>
+#include <memory>
+#include <string>
+
+/// Immutable string, the data of string values. Strings of up to INLINE
+/// chars are kept in the object, longer ones are ropes: pieces of chars
+/// at the leaves of a height balanced tree, shared by the strings made
+/// from them. concat and substring are O(log n) plus the copy of at most
+/// LEAF chars, pieces shorter than that are merged when joined.
+class Rope {
+public:
+  static const size_t INLINE = 22;
+  static const size_t LEAF = 512;
+
+  Rope() { chars_[0] = '\0'; }
+  explicit Rope(const char *str);
+  Rope(const char *chars, size_t size);
+
+  size_t size() const { return size_; }
+  bool empty() const { return 0 == size_; }
+  char operator[](size_t i) const;
+
+  /// The chars of a followed by those of b
+  static Rope concat(const Rope &a, const Rope &b);
+  /// The chars from start up to end, end within the string and not
+  /// before start
+  Rope substring(size_t start, size_t end) const;
+
+  /// Call fn(const char *chars, size_t size) with the pieces in order
+  template <typename Fn> void forEachPiece(Fn fn) const {
+    if (rope)
+      forEachPiece(*rope, fn);
+    else if (size_)
+      fn(chars_, size_);
+  }
+  /// A flat copy
+  std::string str() const;
+
+  bool operator==(const Rope &other) const;
+  bool operator!=(const Rope &other) const { return !(*this == other); }
+  /// FNV-1a of the chars, the same for equal strings of any shape
+  size_t hash() const;
+
+  /// Height of the rope, 0 for an inline string or a single piece
+  unsigned int height() const { return rope ? rope->height : 0; }
+  bool isInline() const { return !rope; }
+
+private:
+  /// A piece of chars if height is 0, else the concatenation of left and
+  /// right, whose heights differ by at most 1
+  struct Node {
+    size_t size;
+    unsigned int height;
+    std::shared_ptr<const Node> left;
+    std::shared_ptr<const Node> right;
+    std::string chars;
+  };
+  using NodePtr = std::shared_ptr<const Node>;
+
+  /// The string of the chars of node, inline if they fit
+  explicit Rope(NodePtr node);
+
+  template <typename Fn> static void forEachPiece(const Node &node, Fn &fn) {
+    if (0 == node.height) {
+      fn(node.chars.data(), node.chars.size());
+      return;
+    }
+    forEachPiece(*node.left, fn);
+    forEachPiece(*node.right, fn);
+  }
+
+  /// The rope of the string, a piece for an inline one
+  NodePtr node() const;
+  static NodePtr leaf(std::string chars);
+  static NodePtr make(NodePtr left, NodePtr right);
+  static NodePtr balance(NodePtr left, NodePtr right);
+  static NodePtr concat(const NodePtr &a, const NodePtr &b);
+  static NodePtr substring(const NodePtr &node, size_t start, size_t end);
+
+  size_t size_ = 0;
+  char chars_[INLINE + 1];
+  NodePtr rope;
+};
+
+#endif /* !ROPE_H_ */
@@ -0,0 +1,125 @@
+#include "Runtime.h"
+#include "Interpreter.h"
+#include "Printer.h"
+#include "SyntaxError.h"
+
+#include <algorithm>
+#include <unistd.h>
+
+namespace {
+
+std::shared_ptr<AST> opnode(Builtin op) {
+  return std::make_shared<ASTBuiltin>(op);
+}
+
+const PersistentList &listOf(Builtin op, const Value &value) {
+  if (!value || !value.isList())
+    throw SyntaxError("Argument must be a list", opnode(op));
+  return std::static_pointer_cast<ASTList>(value.node())->data();
+}
+
+const PersistentList &nonEmptyList(Builtin op, const Value &value) {
+  const auto &xs = listOf(op, value);
+  if (xs.empty())
+    throw SyntaxError("Operator does not work on empty list", opnode(op));
+  return xs;
+}
+
+} // namespace
+
+namespace runtime {
+
+void notInteger(const Value &value) {
+  throw SyntaxError("Operator works only on integer types", value.toAST());
+}
+
+bool isTrue(const Value &value) { return Interpreter::isTrue(value); }
+
+bool compare(Builtin op, std::initializer_list<Value> ys) {
+  if (std::all_of(ys.begin(), ys.end(),
+                  [](const Value &y) { return y.isNumber(); })) {
+    // fixnums, bignums and floats
+    for (auto it = ys.begin() + 1; it != ys.end(); ++it) {
+      if (!number::compare(op, *(it - 1), *it))
+        return false;
+    }
+    return true;
+  }
+  const auto type = ys.begin()->type();
+  if (!std::all_of(ys.begin(), ys.end(),
+                   [type](const Value &y) { return type == y.type(); }))
+    throw SyntaxError("All arguments must be of same type", opnode(op));
+  if (Builtin::EQ == op && AST::Type::STRING == type) {
+    for (auto it = ys.begin() + 1; it != ys.end(); ++it) {
+      const auto a = std::static_pointer_cast<ASTString>((it - 1)->node());
+      const auto b = std::static_pointer_cast<ASTString>(it->node());
+      if (a->data() != b->data())
+        return false;
+    }
+    return true;
+  }
+  if (Builtin::EQ == op)
+    throw SyntaxError("Uniplemented operation", opnode(op));
+  notInteger(*ys.begin());
+}
+
+Value head(const Value &list) {
+  return nonEmptyList(Builtin::HEAD, list).front();
+}
+
+Value tail(const Value &list) {
+  return nonEmptyList(Builtin::TAIL, list).back();
+}
+
+Value join(std::initializer_list<Value> lists) {
+  PersistentList res;
+  for (const auto &value : lists) {
+    res = PersistentList::join(res, listOf(Builtin::JOIN, value));
+  }
+  return std::make_shared<ASTList>(std::move(res));
+}
+
+Value cons(const Value &element, const Value &list) {
+  return std::make_shared<ASTList>(
+      listOf(Builtin::CONS, list).cons(element.toAST()));
+}
+
+Value rest(const Value &list) {
+  return std::make_shared<ASTList>(nonEmptyList(Builtin::REST, list).rest());
+}
+
+std::shared_ptr<AST> list(const AST::List &children) {
+  return std::make_shared<ASTList>(
+      PersistentList(children.begin(), children.end()));
+}
+
+std::shared_ptr<AST> sexpr(AST::List children) {
+  auto ret = std::make_shared<ASTSexpr>();
+  ret->setChildren(std::move(children));
+  return ret;
+}
+
+std::shared_ptr<AST> atom(const char *name) {
+  const auto op = builtinFromCString(name);
+  if (Builtin::UNKNOWN != op)
+    return std::make_shared<ASTBuiltin>(op);
+  return std::make_shared<ASTSymbol>(name);
+}
+
+bool recall(Memo &memo, const Memo::Key &args, Value &result) {
+  return Memo::cacheable(args.data(), args.size()) && memo.find(args, result);
+}
+
+void memorize(Memo &memo, Memo::Key args, Value result) {
+  if (Memo::cacheable(args.data(), args.size()))
+    memo.insert(std::move(args), std::move(result));
+}
+
+void print(const Value &value) {
+  // flushed when the program exits
+  static Printer out(STDOUT_FILENO);
+  out.print(*value.toAST());
+  out.write('\n');
+}
+
+} // namespace runtime
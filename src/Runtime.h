@@ -0,0 +1,65 @@
+#ifndef RUNTIME_H_
+#define RUNTIME_H_
+#include "AST.h"
+#include "Kernels.h"
+#include "Memo.h"
+#include "Number.h"
+#include "Value.h"
+
+#include <initializer_list>
+#include <memory>
+
+/// Operations used by the C++ translated from scripts by lispc, see
+/// Translator. They check their operands and fail like the interpreter.
+namespace runtime {
+
+/// Throw the error of an arithmetic builtin applied to value
+[[noreturn]] void notInteger(const Value &value);
+
+/// Check the first operand of an arithmetic builtin before the others are
+/// evaluated
+inline void checkNumber(const Value &value) {
+  if (!value.isNumber())
+    notInteger(value);
+}
+
+/// Arithmetic builtins, fixnums inline
+using number::arithmetic;
+
+/// Truth value of the predicate of an if
+bool isTrue(const Value &value);
+
+/// Compare the evaluated operands ys of the comparison op
+bool compare(Builtin op, std::initializer_list<Value> ys);
+template <Builtin op> bool compare(const Value &a, const Value &b) {
+  if (a.isInteger() && b.isInteger())
+    return IntKernel<op>::apply(a.integer(), b.integer());
+  return compare(op, {a, b});
+}
+
+Value head(const Value &list);
+Value tail(const Value &list);
+Value join(std::initializer_list<Value> lists);
+Value cons(const Value &element, const Value &list);
+Value rest(const Value &list);
+
+/// Nodes of the data in the operands of list
+/// @{
+std::shared_ptr<AST> list(const AST::List &children);
+std::shared_ptr<AST> sexpr(AST::List children);
+/// A builtin or a symbol, as the parser reads name
+std::shared_ptr<AST> atom(const char *name);
+/// @}
+
+/// The memo of a function defined by define-memo
+/// @{
+bool recall(Memo &memo, const Memo::Key &args, Value &result);
+void memorize(Memo &memo, Memo::Key args, Value result);
+/// @}
+
+/// Print value and a newline as the repl does
+void print(const Value &value);
+
+} // namespace runtime
+
+#endif /* !RUNTIME_H_ */
@@ -0,0 +1,312 @@
+#include "Scheduler.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace {
+
+/// Add to a counter only its worker writes, without a locked instruction
+void bump(std::atomic<uint64_t> &counter, uint64_t n = 1) {
+  counter.store(counter.load(std::memory_order_relaxed) + n,
+                std::memory_order_relaxed);
+}
+
+} // namespace
+
+TaskDeque::Buffer::Buffer(size_t capacity)
+    : mask(capacity - 1), slots(new std::atomic<Task *>[capacity]()) {}
+
+TaskDeque::TaskDeque() {
+  buffers.emplace_back(new Buffer(INITIAL_CAPACITY));
+  buffer.store(buffers.back().get(), std::memory_order_relaxed);
+}
+
+void TaskDeque::push(Task *task) {
+  const auto b = bottom.load(std::memory_order_relaxed);
+  const auto t = top.load(std::memory_order_acquire);
+  auto *a = buffer.load(std::memory_order_relaxed);
+  if (b - t >= static_cast<int64_t>(a->capacity())) {
+    std::unique_ptr<Buffer> grown(new Buffer(2 * a->capacity()));
+    for (auto i = t; i < b; i++) {
+      grown->put(i, a->get(i));
+    }
+    a = grown.get();
+    buffers.push_back(std::move(grown));
+    buffer.store(a, std::memory_order_release);
+  }
+  a->put(b, task);
+  // publishes the task and what its spawner stored in it to the thieves
+  bottom.store(b + 1, std::memory_order_release);
+}
+
+Task *TaskDeque::take() {
+  const auto b = bottom.load(std::memory_order_relaxed) - 1;
+  auto *a = buffer.load(std::memory_order_relaxed);
+  // a thief reading top after this sees the task reserved
+  bottom.store(b, std::memory_order_seq_cst);
+  auto t = top.load(std::memory_order_seq_cst);
+  if (t > b) {
+    bottom.store(b + 1, std::memory_order_relaxed);
+    return nullptr;
+  }
+  auto *task = a->get(b);
+  if (t == b) {
+    // the last task, a thief may take it first
+    if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                     std::memory_order_relaxed))
+      task = nullptr;
+    bottom.store(b + 1, std::memory_order_relaxed);
+  }
+  return task;
+}
+
+Task *TaskDeque::steal() {
+  auto t = top.load(std::memory_order_seq_cst);
+  const auto b = bottom.load(std::memory_order_seq_cst);
+  if (t >= b)
+    return nullptr;
+  auto *task = buffer.load(std::memory_order_acquire)->get(t);
+  if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                   std::memory_order_relaxed))
+    return nullptr;
+  return task;
+}
+
+size_t TaskDeque::size() const {
+  const auto b = bottom.load(std::memory_order_relaxed);
+  const auto t = top.load(std::memory_order_relaxed);
+  return b > t ? static_cast<size_t>(b - t) : 0;
+}
+
+Scheduler::Scheduler(unsigned threads, size_t cutoff) : cutoff_(cutoff) {
+  threads = std::max(1u, threads);
+  for (unsigned worker = 0; worker < threads; worker++) {
+    workers.emplace_back(new Worker());
+    workers.back()->seed = 2654435761u * (worker + 1);
+  }
+  for (unsigned worker = 1; worker < threads; worker++) {
+    threads_.emplace_back([this, worker] { work(worker); });
+  }
+}
+
+Scheduler::~Scheduler() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+    events++;
+  }
+  woken.notify_all();
+  for (auto &thread : threads_) {
+    thread.join();
+  }
+  // the tasks never taken are run here, so each of them is done
+  while (anyQueued()) {
+    for (auto &worker : workers) {
+      while (auto *task = worker->deque.take()) {
+        execute(0, task);
+      }
+    }
+  }
+}
+
+bool Scheduler::inlines(unsigned worker) {
+  auto &w = *workers[worker];
+  const auto queued = w.deque.size();
+  if (queued < cutoff_ &&
+      (!queued || hungry.load(std::memory_order_relaxed)))
+    return false;
+  bump(w.inlined);
+  return true;
+}
+
+void Scheduler::spawn(unsigned worker, std::shared_ptr<Task> task) {
+  auto &w = *workers[worker];
+  auto *queued = task.get();
+  queued->self = std::move(task);
+  pending_.fetch_add(1, std::memory_order_relaxed);
+  bump(w.tasks);
+  w.deque.push(queued);
+  // A worker going to sleep counts itself before it looks at the deques a
+  // last time, so it either finds the task or is counted here.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (sleeping.load(std::memory_order_relaxed)) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      events++;
+    }
+    woken.notify_one();
+  }
+}
+
+void Scheduler::wait(unsigned worker, const Task &task) {
+  bool idle = false;
+  Clock::time_point idleSince;
+  while (!task.done()) {
+    auto *next = find(worker);
+    if (next) {
+      if (idle)
+        fed(worker, idleSince);
+      idle = false;
+      execute(worker, next);
+    } else {
+      // the task is run by another worker, which may be busy for a while
+      if (!idle)
+        idleSince = starving();
+      idle = true;
+      block(task, true);
+    }
+  }
+  if (idle)
+    fed(worker, idleSince);
+}
+
+void Scheduler::await(const Task &task) {
+  while (!task.done()) {
+    block(task, false);
+  }
+}
+
+Scheduler::Stats Scheduler::stats() const {
+  Stats res;
+  uint64_t idle = 0;
+  for (const auto &worker : workers) {
+    res.tasks += worker->tasks.load(std::memory_order_relaxed);
+    res.inlined += worker->inlined.load(std::memory_order_relaxed);
+    res.steals += worker->steals.load(std::memory_order_relaxed);
+    idle += worker->idleNanoseconds.load(std::memory_order_relaxed);
+  }
+  res.idleSeconds = idle / 1e9;
+  return res;
+}
+
+void Scheduler::dumpStats() const {
+  const auto s = stats();
+  std::cout << "---------Scheduler stats--------------" << std::endl;
+  std::cout << "workers:     " << threads() << std::endl;
+  std::cout << "tasks:       " << s.tasks << std::endl;
+  std::cout << "inlined:     " << s.inlined << std::endl;
+  std::cout << "steals:      " << s.steals << std::endl;
+  std::cout << "idle:        " << s.idleSeconds * 1000 << " ms" << std::endl;
+  std::cout << "--------------------------------------" << std::endl;
+}
+
+void Scheduler::work(unsigned worker) {
+  // searches failed in a row before sleeping
+  static const unsigned SPINS = 64;
+  unsigned misses = 0;
+  Clock::time_point idleSince;
+  while (!stopping.load(std::memory_order_relaxed)) {
+    auto *task = find(worker);
+    if (task) {
+      if (misses)
+        fed(worker, idleSince);
+      misses = 0;
+      execute(worker, task);
+      continue;
+    }
+    if (0 == misses++)
+      idleSince = starving();
+    if (misses < SPINS) {
+      std::this_thread::yield();
+      continue;
+    }
+    // still hungry while sleeping, the time is not counted
+    addIdle(worker, idleSince);
+    if (!sleep())
+      return;
+    misses = 1;
+    idleSince = Clock::now();
+  }
+}
+
+Task *Scheduler::find(unsigned worker) {
+  auto &w = *workers[worker];
+  auto *task = w.deque.take();
+  if (task)
+    return task;
+  const auto n = threads();
+  // xorshift, the victims are tried from a random one on
+  w.seed ^= w.seed << 13;
+  w.seed ^= w.seed >> 17;
+  w.seed ^= w.seed << 5;
+  const auto first = w.seed % n;
+  for (unsigned i = 0; i < n; i++) {
+    const auto victim = (first + i) % n;
+    if (victim == worker)
+      continue;
+    task = workers[victim]->deque.steal();
+    if (task) {
+      bump(w.steals);
+      return task;
+    }
+  }
+  return nullptr;
+}
+
+void Scheduler::execute(unsigned worker, Task *task) {
+  // the spawner may have dropped the task, it is held until done
+  const auto held = std::move(task->self);
+  task->run(worker);
+  // counted out first, so a thread seeing the task done sees it
+  pending_.fetch_sub(1, std::memory_order_release);
+  // A blocked thread sets waited before it looks at done a last time, so
+  // it either sees the task done or is seen here.
+  task->done_.store(true, std::memory_order_seq_cst);
+  if (task->waited_.load(std::memory_order_seq_cst)) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+    }
+    woken.notify_all();
+  }
+}
+
+bool Scheduler::sleep() {
+  std::unique_lock<std::mutex> lock(mutex);
+  const auto seen = events;
+  sleeping.fetch_add(1, std::memory_order_seq_cst);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (!anyQueued())
+    woken.wait(lock, [this, seen] { return events != seen || stopping; });
+  sleeping.fetch_sub(1, std::memory_order_relaxed);
+  return !stopping;
+}
+
+void Scheduler::block(const Task &task, bool helping) {
+  std::unique_lock<std::mutex> lock(mutex);
+  const auto seen = events;
+  task.waited_.store(true, std::memory_order_seq_cst);
+  if (helping)
+    sleeping.fetch_add(1, std::memory_order_seq_cst);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (!helping || !anyQueued())
+    woken.wait(lock, [this, &task, helping, seen] {
+      return task.done() || (helping && events != seen);
+    });
+  if (helping)
+    sleeping.fetch_sub(1, std::memory_order_relaxed);
+}
+
+bool Scheduler::anyQueued() const {
+  for (const auto &worker : workers) {
+    if (worker->deque.size())
+      return true;
+  }
+  return false;
+}
+
+Scheduler::Clock::time_point Scheduler::starving() {
+  hungry.fetch_add(1, std::memory_order_relaxed);
+  return Clock::now();
+}
+
+void Scheduler::fed(unsigned worker, Clock::time_point since) {
+  hungry.fetch_sub(1, std::memory_order_relaxed);
+  addIdle(worker, since);
+}
+
+void Scheduler::addIdle(unsigned worker, Clock::time_point since) {
+  bump(workers[worker]->idleNanoseconds,
+       std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() -
+                                                            since)
+           .count());
+}
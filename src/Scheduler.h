@@ -0,0 +1,185 @@
+#ifndef SCHEDULER_H_
+#define SCHEDULER_H_
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// A unit of work of a Scheduler, run once by the worker taking it
+class Task {
+public:
+  virtual ~Task() = default;
+  /// Set once run returned, what run stored is visible to a thread that
+  /// sees it set
+  bool done() const { return done_.load(std::memory_order_acquire); }
+
+protected:
+  /// Called with the worker running the task, it must not throw
+  virtual void run(unsigned worker) = 0;
+
+private:
+  friend class Scheduler;
+  std::atomic<bool> done_{false};
+  /// Set by a thread blocking until done, which its worker then wakes
+  mutable std::atomic<bool> waited_{false};
+  /// The task while it is queued, released by the worker taking it
+  std::shared_ptr<Task> self;
+};
+
+/// The deque of the tasks of a worker by Chase and Lev, "Dynamic Circular
+/// Work-Stealing Deque", with the orderings of Le et al. for weak memory
+/// models. The owner pushes and takes at the bottom, other threads steal
+/// from the top, the oldest and so usually the largest task. The buffer
+/// grows when full, the smaller ones are kept as thieves may still read
+/// them.
+class TaskDeque {
+public:
+  TaskDeque();
+  TaskDeque(const TaskDeque &) = delete;
+  TaskDeque &operator=(const TaskDeque &) = delete;
+
+  /// By the owner
+  /// @{
+  void push(Task *task);
+  /// The newest task, nullptr if empty or stolen
+  Task *take();
+  /// @}
+  /// The oldest task, nullptr if empty or another thread took it first
+  Task *steal();
+  /// Tasks queued, exact for the owner
+  size_t size() const;
+
+private:
+  struct Buffer {
+    explicit Buffer(size_t capacity);
+    Task *get(int64_t i) const {
+      return slots[i & mask].load(std::memory_order_relaxed);
+    }
+    void put(int64_t i, Task *task) {
+      slots[i & mask].store(task, std::memory_order_relaxed);
+    }
+    size_t capacity() const { return mask + 1; }
+
+    size_t mask;
+    std::unique_ptr<std::atomic<Task *>[]> slots;
+  };
+
+  static const size_t INITIAL_CAPACITY = 64;
+
+  /// Owner and thieves update them, each on a cache line of its own
+  /// @{
+  std::atomic<int64_t> top{0};
+  char topLine[64 - sizeof(int64_t)];
+  std::atomic<int64_t> bottom{0};
+  char bottomLine[64 - sizeof(int64_t)];
+  /// @}
+  std::atomic<Buffer *> buffer;
+  std::vector<std::unique_ptr<Buffer>> buffers;
+};
+
+/// Runs the tasks spawned by its workers, each with a TaskDeque. Worker 0
+/// is the thread creating the scheduler, which runs tasks only while it
+/// waits for one, workers 1 and up are threads of the scheduler. A worker
+/// out of tasks steals from the others, picked at random, and sleeps when
+/// none had any for a while. Spawns are run at once by their worker while
+/// it has cutoff tasks queued, or one while no worker is looking for
+/// tasks: tasks are only queued when they may be stolen. Tasks still
+/// queued when the scheduler is destroyed are run by the destroying
+/// thread.
+class Scheduler {
+public:
+  /// Queued tasks per worker at which further tasks are run at once
+  static const size_t DEFAULT_CUTOFF = 4;
+
+  struct Stats {
+    /// Tasks queued, spawns run at once by the cutoff and tasks taken
+    /// from the deque of another worker
+    uint64_t tasks = 0;
+    uint64_t inlined = 0;
+    uint64_t steals = 0;
+    /// Time the workers spent looking for a task, or waiting for one run
+    /// by another, the time they slept for lack of tasks not counted
+    double idleSeconds = 0;
+  };
+
+  explicit Scheduler(unsigned threads, size_t cutoff = DEFAULT_CUTOFF);
+  ~Scheduler();
+  Scheduler(const Scheduler &) = delete;
+  Scheduler &operator=(const Scheduler &) = delete;
+
+  /// Workers, the creating thread included
+  unsigned threads() const { return static_cast<unsigned>(workers.size()); }
+
+  /// True if the task worker would spawn should be run by it at once, as
+  /// its deque holds enough tasks for the workers looking for one
+  bool inlines(unsigned worker);
+  /// Queue task on the deque of worker, the thread calling
+  void spawn(unsigned worker, std::shared_ptr<Task> task);
+  /// Run tasks of worker, or stolen ones, until task is done. While there
+  /// are none the worker blocks until task is done or another is spawned.
+  void wait(unsigned worker, const Task &task);
+  /// Block the calling thread, which is not a worker, until task is done
+  void await(const Task &task);
+  /// Tasks spawned that are not done
+  size_t pending() const { return pending_.load(std::memory_order_acquire); }
+
+  Stats stats() const;
+  void dumpStats() const;
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Worker {
+    TaskDeque deque;
+    /// Only written by the worker
+    /// @{
+    std::atomic<uint64_t> tasks{0};
+    std::atomic<uint64_t> inlined{0};
+    std::atomic<uint64_t> steals{0};
+    std::atomic<uint64_t> idleNanoseconds{0};
+    uint32_t seed;
+    /// @}
+    /// Keeps the counters of workers apart
+    char line[64];
+  };
+
+  void work(unsigned worker);
+  /// A task of the deque of worker or stolen from another, nullptr if
+  /// there was none
+  Task *find(unsigned worker);
+  void execute(unsigned worker, Task *task);
+  /// Wait until a task is spawned, false when stopping
+  bool sleep();
+  /// Wait until task is done, or if helping until a task is spawned
+  void block(const Task &task, bool helping);
+  bool anyQueued() const;
+  /// A worker starts and stops looking for a task, returns the time it
+  /// started
+  Clock::time_point starving();
+  void fed(unsigned worker, Clock::time_point since);
+  void addIdle(unsigned worker, Clock::time_point since);
+
+  const size_t cutoff_;
+  std::vector<std::unique_ptr<Worker>> workers;
+  std::vector<std::thread> threads_;
+  std::atomic<size_t> pending_{0};
+  /// Workers looking for a task, sleeping or waiting for one
+  std::atomic<unsigned> hungry{0};
+  /// Sleeping workers are woken by a change of events, blocked threads
+  /// also when the task they wait for is done
+  /// @{
+  std::mutex mutex;
+  std::condition_variable woken;
+  /// Sleeping workers and helping blocked ones, woken on a spawn
+  std::atomic<unsigned> sleeping{0};
+  uint64_t events = 0;
+  std::atomic<bool> stopping{false};
+  /// @}
+};
+
+#endif /* !SCHEDULER_H_ */
@@ -0,0 +1,208 @@
+#include "Simd.h"
+#include "Kernels.h"
+
+#include <cassert>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define SIMD_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+using simd::Isa;
+using simd::Operand;
+
+/// Elements i up to n by the scalar kernel, a scalar operand has stride 0
+template <Builtin op>
+bool intLoop(Operand<int64_t> a, Operand<int64_t> b, int64_t *res, size_t i,
+             size_t n) {
+  const size_t sa = a.scalar ? 0 : 1;
+  const size_t sb = b.scalar ? 0 : 1;
+  bool ok = true;
+  for (; i < n; i++) {
+    ok = IntKernel<op>::apply(a.data[i * sa], b.data[i * sb], res[i]) && ok;
+  }
+  return ok;
+}
+
+template <Builtin op>
+void floatLoop(Operand<double> a, Operand<double> b, double *res, size_t i,
+               size_t n) {
+  const size_t sa = a.scalar ? 0 : 1;
+  const size_t sb = b.scalar ? 0 : 1;
+  for (; i < n; i++) {
+    res[i] = FloatKernel<op>::apply(a.data[i * sa], b.data[i * sb]);
+  }
+}
+
+#ifdef SIMD_AVX2
+
+/// Addition or subtraction of 4 fixnums per instruction. The signs of the
+/// lanes that overflowed are collected and tested once at the end.
+template <Builtin op>
+__attribute__((target("avx2"))) bool
+intLoopAvx2(Operand<int64_t> a, Operand<int64_t> b, int64_t *res, size_t n) {
+  const auto *pa = reinterpret_cast<const __m256i *>(a.data);
+  const auto *pb = reinterpret_cast<const __m256i *>(b.data);
+  __m256i overflow = _mm256_setzero_si256();
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const __m256i x = a.scalar ? _mm256_set1_epi64x(a.data[0])
+                               : _mm256_loadu_si256(pa + i / 4);
+    const __m256i y = b.scalar ? _mm256_set1_epi64x(b.data[0])
+                               : _mm256_loadu_si256(pb + i / 4);
+    __m256i r;
+    if (Builtin::ADD == op) {
+      r = _mm256_add_epi64(x, y);
+      // the operands have the same sign and the result the other one
+      overflow = _mm256_or_si256(
+          overflow, _mm256_and_si256(_mm256_xor_si256(x, r),
+                                     _mm256_xor_si256(y, r)));
+    } else {
+      r = _mm256_sub_epi64(x, y);
+      overflow = _mm256_or_si256(
+          overflow, _mm256_and_si256(_mm256_xor_si256(x, y),
+                                     _mm256_xor_si256(x, r)));
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(res + i), r);
+  }
+  if (_mm256_movemask_pd(_mm256_castsi256_pd(overflow)))
+    return false;
+  return intLoop<op>(a, b, res, i, n);
+}
+
+template <Builtin op>
+__attribute__((target("avx2"))) void
+floatLoopAvx2(Operand<double> a, Operand<double> b, double *res, size_t n) {
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const __m256d x =
+        a.scalar ? _mm256_set1_pd(a.data[0]) : _mm256_loadu_pd(a.data + i);
+    const __m256d y =
+        b.scalar ? _mm256_set1_pd(b.data[0]) : _mm256_loadu_pd(b.data + i);
+    __m256d r;
+    switch (op) {
+    case Builtin::ADD:
+      r = _mm256_add_pd(x, y);
+      break;
+    case Builtin::SUB:
+      r = _mm256_sub_pd(x, y);
+      break;
+    case Builtin::MUL:
+      r = _mm256_mul_pd(x, y);
+      break;
+    default:
+      r = _mm256_div_pd(x, y);
+      break;
+    }
+    _mm256_storeu_pd(res + i, r);
+  }
+  floatLoop<op>(a, b, res, i, n);
+}
+
+#endif
+
+Isa detect() {
+#ifdef SIMD_AVX2
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    return Isa::AVX2;
+#endif
+  return Isa::SCALAR;
+}
+
+Isa &current() {
+  static Isa isa = detect();
+  return isa;
+}
+
+} // namespace
+
+namespace simd {
+
+Isa isa() { return current(); }
+
+bool setIsa(Isa isa) {
+  if (Isa::AVX2 == isa && Isa::AVX2 != detect())
+    return false;
+  current() = isa;
+  return true;
+}
+
+const char *isaToCString(Isa isa) {
+  switch (isa) {
+  case Isa::SCALAR:
+    return "scalar";
+  case Isa::AVX2:
+    return "avx2";
+  }
+  return "UNKNOWN";
+}
+
+bool apply(Builtin op, Operand<int64_t> a, Operand<int64_t> b, int64_t *res,
+           size_t n) {
+#ifdef SIMD_AVX2
+  if (Isa::AVX2 == current()) {
+    switch (op) {
+    case Builtin::ADD:
+      return intLoopAvx2<Builtin::ADD>(a, b, res, n);
+    case Builtin::SUB:
+      return intLoopAvx2<Builtin::SUB>(a, b, res, n);
+    default:
+      break;
+    }
+  }
+#endif
+  switch (op) {
+  case Builtin::ADD:
+    return intLoop<Builtin::ADD>(a, b, res, 0, n);
+  case Builtin::SUB:
+    return intLoop<Builtin::SUB>(a, b, res, 0, n);
+  case Builtin::MUL:
+    return intLoop<Builtin::MUL>(a, b, res, 0, n);
+  case Builtin::DIV:
+    return intLoop<Builtin::DIV>(a, b, res, 0, n);
+  case Builtin::MOD:
+    return intLoop<Builtin::MOD>(a, b, res, 0, n);
+  default:
+    assert(false && "not an arithmetic builtin");
+    return false;
+  }
+}
+
+void apply(Builtin op, Operand<double> a, Operand<double> b, double *res,
+           size_t n) {
+#ifdef SIMD_AVX2
+  if (Isa::AVX2 == current()) {
+    switch (op) {
+    case Builtin::ADD:
+      return floatLoopAvx2<Builtin::ADD>(a, b, res, n);
+    case Builtin::SUB:
+      return floatLoopAvx2<Builtin::SUB>(a, b, res, n);
+    case Builtin::MUL:
+      return floatLoopAvx2<Builtin::MUL>(a, b, res, n);
+    case Builtin::DIV:
+      return floatLoopAvx2<Builtin::DIV>(a, b, res, n);
+    default:
+      break;
+    }
+  }
+#endif
+  switch (op) {
+  case Builtin::ADD:
+    return floatLoop<Builtin::ADD>(a, b, res, 0, n);
+  case Builtin::SUB:
+    return floatLoop<Builtin::SUB>(a, b, res, 0, n);
+  case Builtin::MUL:
+    return floatLoop<Builtin::MUL>(a, b, res, 0, n);
+  case Builtin::DIV:
+    return floatLoop<Builtin::DIV>(a, b, res, 0, n);
+  case Builtin::MOD:
+    return floatLoop<Builtin::MOD>(a, b, res, 0, n);
+  default:
+    assert(false && "not an arithmetic builtin");
+  }
+}
+
+} // namespace simd
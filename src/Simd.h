@@ -0,0 +1,39 @@
+#ifndef SIMD_H_
+#define SIMD_H_
+#include "AST.h"
+
+#include <cstddef>
+#include <cstdint>
+
+/// Elementwise arithmetic on arrays of fixnums and doubles. The loops use
+/// AVX2 when the CPU has it, checked once at runtime, and a scalar loop
+/// otherwise. AVX2 has no 64 bit integer multiplication or division, those
+/// and % of doubles are always scalar.
+namespace simd {
+
+enum class Isa { SCALAR, AVX2 };
+
+/// The instruction set the loops use, the best the CPU supports unless set
+Isa isa();
+/// Use isa if the CPU supports it, false if it does not
+bool setIsa(Isa isa);
+const char *isaToCString(Isa isa);
+
+/// An operand of an elementwise operation, an array or a scalar used for
+/// every element
+template <typename T> struct Operand {
+  const T *data;
+  bool scalar;
+};
+
+/// res[i] = a[i] op b[i] for the n elements of res, op is an arithmetic
+/// builtin. Integer operations are false if a result does not fit in 64
+/// bits or on division by zero, the elements of res are then undefined.
+bool apply(Builtin op, Operand<int64_t> a, Operand<int64_t> b, int64_t *res,
+           size_t n);
+void apply(Builtin op, Operand<double> a, Operand<double> b, double *res,
+           size_t n);
+
+} // namespace simd
+
+#endif /* !SIMD_H_ */
@@ -0,0 +1,53 @@
+#include "Symbol.h"
+#include "AST.h"
+
+#include <cassert>
+#include <cstdlib>
+
+SymbolTable::SymbolTable() {
+  for (int op = 0; op < static_cast<int>(Builtin::UNKNOWN); op++) {
+    const auto name = builtinToCString(static_cast<Builtin>(op));
+    names.emplace_back(strdup(name));
+    symbols[names.back()] = op;
+  }
+}
+
+SymbolTable::~SymbolTable() {
+  for (const auto name : names) {
+    free(const_cast<char *>(name));
+  }
+}
+
+SymbolTable &SymbolTable::instance() {
+  static SymbolTable table;
+  return table;
+}
+
+Symbol SymbolTable::intern(const char *name) {
+  auto &table = instance();
+  const auto it = table.symbols.find(name);
+  if (it != table.symbols.cend())
+    return it->second;
+  const Symbol symbol = table.names.size();
+  table.names.emplace_back(strdup(name));
+  table.symbols[table.names.back()] = symbol;
+  return symbol;
+}
+
+const char *SymbolTable::name(Symbol symbol) {
+  const auto &table = instance();
+  assert(symbol < table.names.size());
+  return table.names[symbol];
+}
+
+size_t SymbolTable::size() { return instance().names.size(); }
+
+size_t SymbolTable::hash_str::operator()(const char *str) const {
+  // FNV-1a
+  size_t hash = 14695981039346656037ULL;
+  for (; *str; str++) {
+    hash ^= static_cast<unsigned char>(*str);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
@@ -0,0 +1,42 @@
+#ifndef SYMBOL_H_
+#define SYMBOL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+/// An interned name, equal names have equal symbols
+using Symbol = uint32_t;
+
+/// Process wide table of interned names. Names are never released, so a
+/// symbol and the string returned for it stay valid until exit.
+///
+/// The builtins are interned first, in the order of the Builtin enum, so
+/// the symbol of a builtin name is its enum value.
+class SymbolTable {
+public:
+  static Symbol intern(const char *name);
+  static const char *name(Symbol symbol);
+  /// Number of interned names
+  static size_t size();
+
+private:
+  SymbolTable();
+  ~SymbolTable();
+  static SymbolTable &instance();
+
+  struct hash_str {
+    size_t operator()(const char *str) const;
+  };
+  struct eq_str {
+    bool operator()(const char *a, const char *b) const {
+      return 0 == std::strcmp(a, b);
+    }
+  };
+  std::unordered_map<const char *, Symbol, hash_str, eq_str> symbols;
+  std::vector<const char *> names;
+};
+
+#endif /* !SYMBOL_H_ */
@@ -1,17 +1,11 @@
 #include "SyntaxError.h"
 
 SyntaxError::SyntaxError(const char *what, int line, int col)
-    : msg(what), line(line), col(col) {}
+    : msg(std::string(what) + " on line " + std::to_string(line) + ":" +
+          std::to_string(col)) {}
 
 SyntaxError::SyntaxError(const char *what, std::shared_ptr<AST> node)
-    : line(0), col(0) {
-  char *buf = static_cast<char *>(malloc(strlen(what) + 1024));
-  sprintf(buf, "%s @ \"%s\"", what, node->toString());
-  msg = buf;
-}
+    : msg(std::string(what) + " @ \"" + node->toString() +
+          "\" on line 0:0") {}
 
-const char *SyntaxError::what() const noexcept {
-  char *buf = static_cast<char *>(malloc(strlen(msg) + 1024));
-  sprintf(buf, "%s on line %d:%d", msg, line, col);
-  return buf;
-}
+const char *SyntaxError::what() const noexcept { return msg.c_str(); }
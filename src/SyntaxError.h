@@ -2,6 +2,7 @@
 #define SYNTAXERROR_H_
 #include "AST.h"
 #include <exception>
+#include <string>
 
 
 class SyntaxError : public std::exception {
@@ -12,9 +13,8 @@ public:
   const char *what() const noexcept override;
 
 private:
-  const char *msg;
-  int line;
-  int col;
+  /// what with the node or the position appended
+  std::string msg;
 };
 
 #endif /* !SYNTAXERROR_H_ */
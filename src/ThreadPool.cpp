@@ -0,0 +1,59 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(unsigned threads) : threads_(std::max(1u, threads)) {
+  for (unsigned worker = 1; worker < threads_; worker++) {
+    workers.emplace_back([this, worker] { work(worker); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  started.notify_all();
+  for (auto &worker : workers) {
+    worker.join();
+  }
+}
+
+void ThreadPool::run(size_t count, const Task &task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    this->task = &task;
+    this->count = count;
+    next = 0;
+    busy = static_cast<unsigned>(workers.size());
+    generation++;
+  }
+  started.notify_all();
+  drain(0);
+  std::unique_lock<std::mutex> lock(mutex);
+  finished.wait(lock, [this] { return 0 == busy; });
+  this->task = nullptr;
+}
+
+void ThreadPool::work(unsigned worker) {
+  uint64_t seen = 0;
+  std::unique_lock<std::mutex> lock(mutex);
+  for (;;) {
+    started.wait(lock, [this, seen] { return stopping || generation != seen; });
+    if (stopping)
+      return;
+    seen = generation;
+    lock.unlock();
+    drain(worker);
+    lock.lock();
+    // run waits for every thread, so none misses a generation
+    if (0 == --busy)
+      finished.notify_one();
+  }
+}
+
+void ThreadPool::drain(unsigned worker) {
+  for (size_t i = next++; i < count; i = next++) {
+    (*task)(worker, i);
+  }
+}
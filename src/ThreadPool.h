@@ -0,0 +1,54 @@
+#ifndef THREADPOOL_H_
+#define THREADPOOL_H_
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// A fixed set of threads running the tasks of run. The thread calling run
+/// takes part as worker 0, the threads of the pool are workers 1 and up,
+/// so a pool of one thread starts none.
+class ThreadPool {
+public:
+  /// Called with the worker running it and the index of the task, it must
+  /// not throw
+  using Task = std::function<void(unsigned worker, size_t task)>;
+
+  explicit ThreadPool(unsigned threads);
+  ~ThreadPool();
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  /// Workers, the calling thread included
+  unsigned threads() const { return threads_; }
+  /// Run the tasks from 0 up to count, each taken by the next free worker,
+  /// and return when all have returned
+  void run(size_t count, const Task &task);
+
+private:
+  void work(unsigned worker);
+  /// Run tasks until there are none left
+  void drain(unsigned worker);
+
+  unsigned threads_;
+  std::vector<std::thread> workers;
+  std::mutex mutex;
+  std::condition_variable started;
+  std::condition_variable finished;
+  /// The run of generation, taken by the workers until next reaches count
+  /// @{
+  const Task *task = nullptr;
+  size_t count = 0;
+  std::atomic<size_t> next{0};
+  uint64_t generation = 0;
+  /// @}
+  /// Threads of the pool still running tasks of the generation
+  unsigned busy = 0;
+  bool stopping = false;
+};
+
+#endif /* !THREADPOOL_H_ */
@@ -0,0 +1,672 @@
+#include "Translator.h"
+#include "SyntaxError.h"
+
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+
+namespace {
+
+bool isDefine(const std::shared_ptr<AST> &node) {
+  return node->isBuiltin(Builtin::DEFINE) ||
+         node->isBuiltin(Builtin::DEFINE_MEMO);
+}
+
+bool isDefinition(const std::shared_ptr<AST> &form) {
+  return AST::Type::SEXPR == form->type() && !form->children().empty() &&
+         isDefine(form->head());
+}
+
+bool isLiteral(const std::shared_ptr<AST> &node) {
+  return AST::Type::INTEGER == node->type() ||
+         AST::Type::BIGNUM == node->type() ||
+         AST::Type::FLOAT == node->type() ||
+         AST::Type::BOOLEAN == node->type() ||
+         AST::Type::STRING == node->type();
+}
+
+Symbol symbolOf(const std::shared_ptr<AST> &node) {
+  return std::static_pointer_cast<ASTSymbol>(node)->data();
+}
+
+/// Names that are not lisp names in the generated code
+const char *const RESERVED[] = {
+    "alignas",   "alignof",      "and",        "and_eq",    "asm",
+    "auto",      "bitand",       "bitor",      "bool",      "break",
+    "case",      "catch",        "char",       "class",     "compl",
+    "const",     "const_cast",   "constexpr",  "continue",  "decltype",
+    "default",   "delete",       "do",         "double",    "dynamic_cast",
+    "else",      "enum",         "explicit",   "export",    "extern",
+    "false",     "float",        "for",        "friend",    "goto",
+    "if",        "inline",       "int",        "long",      "mutable",
+    "namespace", "new",          "noexcept",   "not",       "not_eq",
+    "nullptr",   "operator",     "or",         "or_eq",     "private",
+    "protected", "public",       "register",   "reinterpret_cast",
+    "return",    "short",        "signed",     "sizeof",    "static",
+    "static_assert",             "static_cast", "struct",   "switch",
+    "template",  "this",         "thread_local",            "throw",
+    "true",      "try",          "typedef",    "typeid",    "typename",
+    "union",     "unsigned",     "using",      "virtual",   "void",
+    "volatile",  "wchar_t",      "while",      "xor",       "xor_eq",
+    "AST",       "Builtin",      "Memo",       "Value",     "main",
+    "run",       "runtime",      "std",
+};
+
+std::string cString(const char *str) {
+  std::string res = "\"";
+  for (const char *c = str; *c; c++) {
+    if ('"' == *c || '\\' == *c) {
+      res += '\\';
+      res += *c;
+    } else if (isprint(static_cast<unsigned char>(*c))) {
+      res += *c;
+    } else {
+      char buf[8];
+      snprintf(buf, sizeof(buf), "\\%03o", static_cast<unsigned char>(*c));
+      res += buf;
+    }
+  }
+  return res + "\"";
+}
+
+/// C++ literal of an integer node
+std::string intLiteral(const std::shared_ptr<AST> &node) {
+  const auto n = std::static_pointer_cast<ASTInt>(node)->data();
+  if (std::numeric_limits<int64_t>::min() == n)
+    return "(" + std::to_string(n + 1) + " - 1)";
+  return std::to_string(n);
+}
+
+/// C++ literal of the double of a float node, exact when read back
+std::string floatLiteral(const std::shared_ptr<AST> &node) {
+  const auto d = std::static_pointer_cast<ASTFloat>(node)->data();
+  if (std::isinf(d))
+    return d < 0 ? "-std::numeric_limits<double>::infinity()"
+                 : "std::numeric_limits<double>::infinity()";
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%.17g", d);
+  std::string literal = buf;
+  if (std::string::npos == literal.find_first_of(".e"))
+    literal += ".0";
+  return literal;
+}
+
+/// Expression building a bignum node
+std::string bignum(const std::shared_ptr<AST> &node) {
+  return "std::make_shared<ASTBignum>(BigInt::fromString(\"" +
+         std::static_pointer_cast<ASTBignum>(node)->data().toString() +
+         "\"))";
+}
+
+const char *infixOf(Builtin op) {
+  switch (op) {
+  case Builtin::EQ:
+    return "==";
+  case Builtin::GT:
+    return ">";
+  case Builtin::GE:
+    return ">=";
+  case Builtin::LT:
+    return "<";
+  default:
+    return "<=";
+  }
+}
+
+const char *builtinName(Builtin op) {
+  switch (op) {
+  case Builtin::ADD:
+    return "Builtin::ADD";
+  case Builtin::SUB:
+    return "Builtin::SUB";
+  case Builtin::MUL:
+    return "Builtin::MUL";
+  case Builtin::DIV:
+    return "Builtin::DIV";
+  case Builtin::MOD:
+    return "Builtin::MOD";
+  case Builtin::EQ:
+    return "Builtin::EQ";
+  case Builtin::GT:
+    return "Builtin::GT";
+  case Builtin::GE:
+    return "Builtin::GE";
+  case Builtin::LT:
+    return "Builtin::LT";
+  default:
+    return "Builtin::LE";
+  }
+}
+
+template <typename Range, typename Fn>
+std::string joined(const Range &range, Fn fn) {
+  std::string res;
+  for (const auto &x : range) {
+    if (!res.empty())
+      res += ", ";
+    res += fn(x);
+  }
+  return res;
+}
+
+} // namespace
+
+std::string Translator::identifier(const char *name) {
+  std::string res;
+  for (const char *c = name; *c; c++) {
+    if (isalnum(static_cast<unsigned char>(*c)) || '_' == *c) {
+      res += *c;
+    } else if ('-' == *c) {
+      res += '_';
+    } else {
+      char buf[8];
+      snprintf(buf, sizeof(buf), "_x%02x", static_cast<unsigned char>(*c));
+      res += buf;
+    }
+  }
+  // _ prefixes the temporaries of the generated code
+  if (res.empty() || '_' == res[0] || isdigit(static_cast<unsigned char>(res[0])))
+    res = "x" + res;
+  for (const auto reserved : RESERVED) {
+    if (res == reserved)
+      return res + "_";
+  }
+  return res;
+}
+
+Translator::Output Translator::translate(const AST::List &program,
+                                         const std::string &file,
+                                         const std::string &ns,
+                                         const std::string &header,
+                                         bool main) {
+  functions.clear();
+  order.clear();
+  variables.clear();
+  defined.clear();
+  this->ns = ns;
+  collect(program);
+
+  Output res;
+  std::string guard;
+  for (const auto c : ns) {
+    guard += static_cast<char>(toupper(static_cast<unsigned char>(c)));
+  }
+  guard += "_H_";
+  const auto banner = "// Generated by lispc from " + file + ", do not edit\n";
+  res.header = banner + "#ifndef " + guard + "\n#define " + guard +
+               "\n#include \"Runtime.h\"\n\n#include <vector>\n\nnamespace " +
+               ns + " {\n\n";
+  for (const auto symbol : order) {
+    res.header += signature(functions[symbol]) + ";\n";
+  }
+  res.header += "\n/// Values of the top-level forms that are not definitions\n"
+                "std::vector<Value> run();\n\n} // namespace " +
+                ns + "\n\n#endif /* !" + guard + " */\n";
+
+  out.str("");
+  out << banner << "#include \"" << header << "\"\n\nnamespace " << ns
+      << " {\n";
+  for (const auto symbol : order) {
+    out << "\n";
+    translateFunction(functions[symbol]);
+  }
+
+  out << "\nstd::vector<Value> run() {\n";
+  indent = 1;
+  temporaries = 0;
+  checked.clear();
+  line("std::vector<Value> results;");
+  for (const auto &form : program) {
+    if (isDefinition(form)) {
+      const auto &name = form->children()[1];
+      defined.insert(AST::Type::SYMBOL == name->type() ? symbolOf(name)
+                                                       : symbolOf(name->head()));
+      continue;
+    }
+    const auto expr = translateExpr(form);
+    line("results.push_back(" + value(expr) + ");");
+  }
+  line("return results;");
+  out << "}\n\n} // namespace " << ns << "\n";
+  if (main) {
+    out << "\nint main() {\n  for (const auto &value : " << ns
+        << "::run()) {\n    runtime::print(value);\n  }\n  return 0;\n}\n";
+  }
+  res.source = out.str();
+  return res;
+}
+
+void Translator::collect(const AST::List &program) {
+  std::unordered_set<std::string> names;
+  for (const auto &form : program) {
+    if (!isDefinition(form))
+      continue;
+    const auto &ls = form->children();
+    const bool memoized = ls.front()->isBuiltin(Builtin::DEFINE_MEMO);
+    const auto &argList = ls[1];
+    Symbol name;
+    if (AST::Type::SYMBOL == argList->type()) {
+      if (memoized)
+        throw SyntaxError("Only functions can be memoized", form);
+      if (!isLiteral(ls[2]))
+        throw SyntaxError("Only variables bound to literals are translated",
+                          form);
+      name = symbolOf(argList);
+      if (functions.count(name) || variables.count(name))
+        throw SyntaxError("Names are only translated if defined once", form);
+      variables[name] = ls[2];
+      continue;
+    }
+    if (argList->children().empty())
+      throw SyntaxError("Define must have a name", form);
+    Function f;
+    for (const auto &child : argList->children()) {
+      if (AST::Type::SYMBOL != child->type())
+        throw SyntaxError("Arglist must only contain identifiers", argList);
+      f.params.push_back(symbolOf(child));
+    }
+    name = f.params.front();
+    f.params.erase(f.params.begin());
+    std::unordered_set<std::string> params;
+    for (const auto param : f.params) {
+      if (!params.insert(identifier(SymbolTable::name(param))).second)
+        throw SyntaxError("Arguments translate to the same identifier",
+                          argList);
+    }
+    if (functions.count(name) || variables.count(name))
+      throw SyntaxError("Names are only translated if defined once", form);
+    f.name = identifier(SymbolTable::name(name));
+    if (!names.insert(f.name).second)
+      throw SyntaxError("Functions translate to the same identifier", form);
+    f.node = form;
+    f.memoized = memoized;
+    functions[name] = std::move(f);
+    order.push_back(name);
+  }
+}
+
+std::string Translator::signature(const Function &f) const {
+  return "Value " + f.name + "(" + joined(f.params, [](Symbol param) {
+           return "Value " + identifier(SymbolTable::name(param));
+         }) + ")";
+}
+
+void Translator::translateFunction(const Function &f) {
+  current = &f;
+  temporaries = 0;
+  checked.clear();
+  out << signature(f) << " {\n";
+  indent = 1;
+  const auto &body = f.node->children()[2];
+  if (f.memoized) {
+    line("static Memo _memo;");
+    line("const Memo::Key _args{" + joined(f.params, [](Symbol param) {
+           return identifier(SymbolTable::name(param));
+         }) + "};");
+    line("Value _result;");
+    line("if (runtime::recall(_memo, _args, _result))");
+    line("  return _result;");
+    openBlock("_result = [&]() -> Value {");
+    translateReturn(body);
+    closeBlock("}();");
+    line("runtime::memorize(_memo, _args, _result);");
+    line("return _result;");
+  } else if (callsSelfInTail(body)) {
+    openBlock("for (;;) {");
+    translateReturn(body);
+    closeBlock("}");
+  } else {
+    translateReturn(body);
+  }
+  out << "}\n";
+  current = nullptr;
+}
+
+int Translator::paramOf(Symbol symbol) const {
+  if (!current)
+    return -1;
+  for (size_t i = 0; i < current->params.size(); i++) {
+    if (symbol == current->params[i])
+      return static_cast<int>(i);
+  }
+  return -1;
+}
+
+bool Translator::isSelfCall(const std::shared_ptr<AST> &node) const {
+  if (!current || current->memoized || AST::Type::SEXPR != node->type() ||
+      node->children().empty() ||
+      AST::Type::SYMBOL != node->head()->type())
+    return false;
+  const auto symbol = symbolOf(node->head());
+  return -1 == paramOf(symbol) && functions.count(symbol) &&
+         &functions.at(symbol) == current;
+}
+
+bool Translator::callsSelfInTail(const std::shared_ptr<AST> &node) const {
+  if (isSelfCall(node))
+    return true;
+  if (AST::Type::SEXPR != node->type() || node->children().empty() ||
+      !node->head()->isBuiltin(Builtin::IF))
+    return false;
+  const auto &ls = node->children();
+  return callsSelfInTail(ls[2]) || callsSelfInTail(ls[3]);
+}
+
+void Translator::translateReturn(const std::shared_ptr<AST> &node) {
+  if (AST::Type::SEXPR == node->type() && !node->children().empty() &&
+      node->head()->isBuiltin(Builtin::IF)) {
+    const auto &ls = node->children();
+    openBlock("if (" + condition(translateExpr(ls[1])) + ") {");
+    translateReturn(ls[2]);
+    closeBlock("} else {");
+    openBlock("");
+    translateReturn(ls[3]);
+    closeBlock("}");
+    return;
+  }
+  if (isSelfCall(node)) {
+    callee(node);
+    const auto args = translateArgs(node->children());
+    std::vector<std::string> values;
+    for (size_t i = 0; i < args.size(); i++) {
+      const auto param = identifier(SymbolTable::name(current->params[i]));
+      const auto v = value(args[i]);
+      // arguments are evaluated before the parameters are assigned
+      values.push_back(v == param ? v : temporary(Kind::VALUE, v).code);
+    }
+    for (size_t i = 0; i < args.size(); i++) {
+      const auto param = identifier(SymbolTable::name(current->params[i]));
+      if (values[i] != param)
+        line(param + " = " + values[i] + ";");
+    }
+    line("continue;");
+    return;
+  }
+  line("return " + value(translateExpr(node)) + ";");
+}
+
+Translator::Expr Translator::translateExpr(const std::shared_ptr<AST> &node) {
+  switch (node->type()) {
+  case AST::Type::INTEGER:
+    return {intLiteral(node), Kind::INT};
+  case AST::Type::BIGNUM:
+    return temporary(Kind::VALUE, bignum(node), true);
+  case AST::Type::FLOAT:
+    return {"Value::floating(" + floatLiteral(node) + ")", Kind::NUMBER};
+  case AST::Type::BOOLEAN:
+    return {std::static_pointer_cast<ASTBoolean>(node)->data() ? "true"
+                                                               : "false",
+            Kind::BOOL};
+  case AST::Type::STRING: {
+    const auto str = std::static_pointer_cast<ASTString>(node)->data().str();
+    return temporary(Kind::VALUE,
+                     "std::make_shared<ASTString>(" + cString(str.c_str()) +
+                         ")",
+                     true);
+  }
+  case AST::Type::SYMBOL:
+    return translateSymbol(node);
+  case AST::Type::SEXPR:
+    break;
+  default:
+    throw SyntaxError("Builtins are only translated as the head of a form",
+                      node);
+  }
+  const auto &ls = node->children();
+  if (ls.empty())
+    return temporary(Kind::VALUE, "std::make_shared<ASTSexpr>()", true);
+  if (AST::Type::BUILTIN == ls.front()->type())
+    return translateBuiltin(
+        std::static_pointer_cast<ASTBuiltin>(ls.front())->op(), node);
+  const auto &f = callee(node);
+  const auto args = translateArgs(ls);
+  return temporary(Kind::VALUE,
+                   "::" + ns + "::" + f.name + "(" +
+                       joined(args, [this](const Expr &e) { return value(e); }) +
+                       ")");
+}
+
+Translator::Expr
+Translator::translateSymbol(const std::shared_ptr<AST> &node) {
+  const auto symbol = symbolOf(node);
+  const auto slot = paramOf(symbol);
+  if (-1 != slot)
+    return {identifier(SymbolTable::name(symbol)), Kind::VALUE};
+  const bool visible = current || defined.count(symbol);
+  const auto variable = variables.find(symbol);
+  if (visible && variable != variables.cend())
+    return translateExpr(variable->second);
+  if (visible && functions.count(symbol))
+    throw SyntaxError("Functions are only translated as the head of a call",
+                      node);
+  throw SyntaxError("Identifier is not known:", node);
+}
+
+const Translator::Function &
+Translator::callee(const std::shared_ptr<AST> &node) const {
+  const auto &ls = node->children();
+  const auto &head = ls.front();
+  if (AST::Type::SYMBOL != head->type() || -1 != paramOf(symbolOf(head)))
+    throw SyntaxError("Only calls of functions by name are translated", node);
+  const auto symbol = symbolOf(head);
+  const auto it = functions.find(symbol);
+  if (it == functions.cend() || (!current && !defined.count(symbol))) {
+    if (variables.count(symbol))
+      throw SyntaxError("Only calls of functions by name are translated",
+                        node);
+    throw SyntaxError("Identifier is not known:", head);
+  }
+  if (it->second.params.size() != ls.size() - 1)
+    throw SyntaxError("Wrong number of arguments", node);
+  return it->second;
+}
+
+std::vector<Translator::Expr>
+Translator::translateArgs(const AST::List &ls) {
+  std::vector<Expr> args;
+  for (size_t i = 1; i < ls.size(); i++) {
+    args.push_back(translateExpr(ls[i]));
+  }
+  return args;
+}
+
+Translator::Expr Translator::translateBuiltin(Builtin op,
+                                              const std::shared_ptr<AST> &node) {
+  const auto &ls = node->children();
+  switch (op) {
+  case Builtin::ADD:
+  case Builtin::SUB:
+  case Builtin::MUL:
+  case Builtin::DIV:
+  case Builtin::MOD:
+    return translateArithmetic(op, ls);
+  case Builtin::EQ:
+  case Builtin::GT:
+  case Builtin::GE:
+  case Builtin::LT:
+  case Builtin::LE:
+    return translateCompare(op, ls);
+  case Builtin::IF: {
+    const auto predicate = condition(translateExpr(ls[1]));
+    const auto res = "_t" + std::to_string(temporaries++);
+    line("Value " + res + ";");
+    openBlock("if (" + predicate + ") {");
+    line(res + " = " + value(translateExpr(ls[2])) + ";");
+    closeBlock("} else {");
+    openBlock("");
+    line(res + " = " + value(translateExpr(ls[3])) + ";");
+    closeBlock("}");
+    return {res, Kind::VALUE};
+  }
+  case Builtin::LIST:
+    return temporary(Kind::VALUE,
+                     "runtime::list({" +
+                         joined(AST::List(ls.begin() + 1, ls.end()),
+                                [this](const std::shared_ptr<AST> &child) {
+                                  return quote(child);
+                                }) +
+                         "})",
+                     true);
+  case Builtin::HEAD:
+  case Builtin::TAIL:
+  case Builtin::REST: {
+    if (2 != ls.size())
+      throw SyntaxError("Builtin requires exactly one argument", ls.front());
+    const auto list = value(translateExpr(ls[1]));
+    return temporary(Kind::VALUE, std::string("runtime::") +
+                                      builtinToCString(op) + "(" + list + ")");
+  }
+  case Builtin::CONS: {
+    if (3 != ls.size())
+      throw SyntaxError("Wrong number of arguments", ls.front());
+    const auto element = value(translateExpr(ls[1]));
+    const auto list = value(translateExpr(ls[2]));
+    return temporary(Kind::VALUE,
+                     "runtime::cons(" + element + ", " + list + ")");
+  }
+  case Builtin::JOIN: {
+    const auto args = translateArgs(ls);
+    return temporary(Kind::VALUE, "runtime::join({" +
+                                      joined(args,
+                                             [this](const Expr &e) {
+                                               return value(e);
+                                             }) +
+                                      "})");
+  }
+  default:
+    throw SyntaxError("Can not be translated ahead of time", ls.front());
+  }
+}
+
+Translator::Expr Translator::translateArithmetic(Builtin op,
+                                                 const AST::List &ls) {
+  // operands are checked in order, as by the interpreter
+  auto acc = translateExpr(ls[1]);
+  checkNumber(acc);
+  for (size_t i = 2; i < ls.size(); i++) {
+    const auto operand = translateExpr(ls[i]);
+    acc = temporary(Kind::NUMBER, std::string("runtime::arithmetic<") +
+                                     builtinName(op) + ">(" + value(acc) +
+                                     ", " + value(operand) + ")");
+  }
+  return acc;
+}
+
+Translator::Expr Translator::translateCompare(Builtin op,
+                                              const AST::List &ls) {
+  if (ls.size() < 3)
+    throw SyntaxError("Expected operators for operator", ls.front());
+  const auto args = translateArgs(ls);
+  bool ints = true;
+  for (const auto &arg : args) {
+    ints = ints && Kind::INT == arg.kind;
+  }
+  if (ints) {
+    std::string res;
+    for (size_t i = 1; i < args.size(); i++) {
+      if (!res.empty())
+        res += " && ";
+      res += args[i - 1].code + " " + infixOf(op) + " " + args[i].code;
+    }
+    return {"(" + res + ")", Kind::BOOL};
+  }
+  const auto values =
+      joined(args, [this](const Expr &e) { return value(e); });
+  if (2 == args.size())
+    return temporary(Kind::BOOL, std::string("runtime::compare<") +
+                                     builtinName(op) + ">(" + values + ")");
+  return temporary(Kind::BOOL, std::string("runtime::compare(") +
+                                   builtinName(op) + ", {" + values + "})");
+}
+
+std::string Translator::quote(const std::shared_ptr<AST> &node) const {
+  switch (node->type()) {
+  case AST::Type::INTEGER:
+    return "std::make_shared<ASTInt>(" + intLiteral(node) + ")";
+  case AST::Type::BIGNUM:
+    return bignum(node);
+  case AST::Type::FLOAT:
+    return "std::make_shared<ASTFloat>(" + floatLiteral(node) + ")";
+  case AST::Type::BOOLEAN:
+    return std::string("std::make_shared<ASTBoolean>(") +
+           (std::static_pointer_cast<ASTBoolean>(node)->data() ? "true"
+                                                               : "false") +
+           ")";
+  case AST::Type::STRING: {
+    const auto str = std::static_pointer_cast<ASTString>(node)->data().str();
+    return "std::make_shared<ASTString>(" + cString(str.c_str()) + ")";
+  }
+  case AST::Type::SYMBOL:
+  case AST::Type::BUILTIN:
+    return "runtime::atom(" + cString(node->toString().c_str()) + ")";
+  default:
+    return "runtime::sexpr({" +
+           joined(node->children(),
+                  [this](const std::shared_ptr<AST> &child) {
+                    return quote(child);
+                  }) +
+           "})";
+  }
+}
+
+std::string Translator::value(const Expr &expr) const {
+  switch (expr.kind) {
+  case Kind::INT:
+    return "Value::integer(" + expr.code + ")";
+  case Kind::BOOL:
+    return "Value::boolean(" + expr.code + ")";
+  case Kind::VALUE:
+  case Kind::NUMBER:
+    break;
+  }
+  return expr.code;
+}
+
+void Translator::checkNumber(const Expr &expr) {
+  if (Kind::VALUE != expr.kind || checked.count(expr.code))
+    return;
+  line("runtime::checkNumber(" + expr.code + ");");
+  checked.insert(expr.code);
+}
+
+std::string Translator::condition(const Expr &expr) const {
+  switch (expr.kind) {
+  case Kind::BOOL:
+    return expr.code;
+  case Kind::INT:
+    return "0 != " + expr.code;
+  case Kind::VALUE:
+  case Kind::NUMBER:
+    break;
+  }
+  return "runtime::isTrue(" + expr.code + ")";
+}
+
+Translator::Expr Translator::temporary(Kind kind, const std::string &code,
+                                       bool isStatic) {
+  Expr res{"_t" + std::to_string(temporaries++), kind};
+  const char *type =
+      Kind::INT == kind ? "int64_t" : Kind::BOOL == kind ? "bool" : "Value";
+  line(std::string(isStatic ? "static " : "") + "const " + type + " " +
+       res.code + " = " + code + ";");
+  return res;
+}
+
+void Translator::openBlock(const std::string &code) {
+  if (!code.empty())
+    line(code);
+  indent++;
+  outerChecked.push_back(checked);
+}
+
+void Translator::closeBlock(const std::string &code) {
+  indent--;
+  checked = std::move(outerChecked.back());
+  outerChecked.pop_back();
+  line(code);
+}
+
+void Translator::line(const std::string &code) {
+  out << std::string(2 * indent, ' ') << code << "\n";
+}
@@ -0,0 +1,113 @@
+#ifndef TRANSLATOR_H_
+#define TRANSLATOR_H_
+#include "AST.h"
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/// Translates a script to C++ ahead of time, see lispc. Each function the
+/// script defines becomes a C++ function taking and returning Values in
+/// the namespace of the script, the other top-level forms are evaluated
+/// in order by its run(). The code uses the runtime of Runtime.h and
+/// fails like the interpreter, integer arithmetic takes the inline fixnum
+/// path of Number.h and self calls in tail position are loops.
+///
+/// Only scripts whose meaning is known when they are translated are
+/// accepted: functions must be defined once at top-level and only be
+/// called by name, variables must be bound to literals, eval, pprint and
+/// nested definitions are rejected by a SyntaxError.
+class Translator {
+public:
+  struct Output {
+    std::string header;
+    std::string source;
+  };
+
+  /// Translate program, the forms of the script file, to C++ declared in
+  /// namespace ns. The source includes the header by the name header,
+  /// with main the source also defines a main printing what run() returns.
+  Output translate(const AST::List &program, const std::string &file,
+                   const std::string &ns, const std::string &header,
+                   bool main = false);
+
+  /// C++ identifier for a lisp name
+  static std::string identifier(const char *name);
+
+private:
+  struct Function {
+    std::string name;
+    std::shared_ptr<AST> node;
+    /// Names of the arguments in slot order
+    std::vector<Symbol> params;
+    bool memoized = false;
+  };
+
+  /// How the value of a translated expression is represented. INT and
+  /// BOOL are unboxed, NUMBER is a Value known to be a number. An
+  /// expression is only left unassigned to a temporary if evaluating it
+  /// can not fail.
+  enum class Kind { VALUE, NUMBER, INT, BOOL };
+  struct Expr {
+    std::string code;
+    Kind kind;
+  };
+
+  void collect(const AST::List &program);
+  std::string signature(const Function &f) const;
+  void translateFunction(const Function &f);
+  /// Translate node in tail position of the current function
+  void translateReturn(const std::shared_ptr<AST> &node);
+  Expr translateExpr(const std::shared_ptr<AST> &node);
+  Expr translateSymbol(const std::shared_ptr<AST> &node);
+  Expr translateBuiltin(Builtin op, const std::shared_ptr<AST> &node);
+  Expr translateArithmetic(Builtin op, const AST::List &ls);
+  Expr translateCompare(Builtin op, const AST::List &ls);
+  /// Function called by node, throws if it is not a call of a function
+  /// of the script with the right number of arguments
+  const Function &callee(const std::shared_ptr<AST> &node) const;
+  std::vector<Expr> translateArgs(const AST::List &ls);
+  /// Slot of the argument of the current function named symbol, -1 if
+  /// there is none
+  int paramOf(Symbol symbol) const;
+  /// True if node calls the current function and the call can be a loop
+  bool isSelfCall(const std::shared_ptr<AST> &node) const;
+  /// True if the body of the current function calls it in tail position
+  bool callsSelfInTail(const std::shared_ptr<AST> &node) const;
+  /// C++ expression building a node equal to the parsed node
+  std::string quote(const std::shared_ptr<AST> &node) const;
+
+  std::string value(const Expr &expr) const;
+  /// Check that expr is a number unless it is known to be one
+  void checkNumber(const Expr &expr);
+  std::string condition(const Expr &expr) const;
+  /// A new temporary assigned code of kind
+  Expr temporary(Kind kind, const std::string &code, bool isStatic = false);
+  void line(const std::string &code);
+  /// Open a block, the numbers checked in it are forgotten by closeBlock
+  void openBlock(const std::string &code);
+  void closeBlock(const std::string &code);
+
+  std::unordered_map<Symbol, Function> functions;
+  /// Functions in the order they are defined
+  std::vector<Symbol> order;
+  std::unordered_map<Symbol, std::shared_ptr<AST>> variables;
+  std::string ns;
+  /// Function being translated, nullptr for the top-level forms
+  const Function *current = nullptr;
+  /// Functions and variables defined by the forms before the top-level
+  /// form being translated
+  std::unordered_set<Symbol> defined;
+  /// Values checked to be numbers in the block being translated, so an
+  /// argument is only checked once per block
+  std::unordered_set<std::string> checked;
+  std::vector<std::unordered_set<std::string>> outerChecked;
+  std::ostringstream out;
+  int indent = 0;
+  int temporaries = 0;
+};
+
+#endif /* !TRANSLATOR_H_ */
@@ -0,0 +1,198 @@
+#include "TypeInference.h"
+
+namespace {
+
+bool isArithmetic(Builtin op) {
+  switch (op) {
+  case Builtin::ADD:
+  case Builtin::SUB:
+  case Builtin::MUL:
+  case Builtin::DIV:
+  case Builtin::MOD:
+    return true;
+  default:
+    return false;
+  }
+}
+
+bool isComparison(Builtin op) {
+  switch (op) {
+  case Builtin::EQ:
+  case Builtin::GT:
+  case Builtin::GE:
+  case Builtin::LT:
+  case Builtin::LE:
+    return true;
+  default:
+    return false;
+  }
+}
+
+/// The builtin at the head of node, UNKNOWN if it is not an application
+/// of a builtin
+Builtin builtinOf(const AST &node) {
+  const auto &ls = node.children();
+  if (ls.empty() || AST::Type::BUILTIN != ls.front()->type())
+    return Builtin::UNKNOWN;
+  return std::static_pointer_cast<ASTBuiltin>(ls.front())->op();
+}
+
+bool isArgument(const AST &node) {
+  return AST::Type::SYMBOL == node.type() &&
+         ASTSymbol::Scope::ARGUMENT ==
+             static_cast<const ASTSymbol &>(node).scope();
+}
+
+unsigned int slotOf(const AST &node) {
+  return static_cast<const ASTSymbol &>(node).slot();
+}
+
+} // namespace
+
+void TypeInference::infer(const AST &fun) {
+  auto &params = *fun.children()[1];
+  auto &body = *fun.children()[2];
+  numbers.assign(params.children().size() - 1, false);
+  anyProven = false;
+  assumeNumbers(body);
+  typeOf(body);
+
+  stats_.functions++;
+  if (anyProven)
+    stats_.typed++;
+  for (size_t i = 0; i < numbers.size(); i++) {
+    params.children()[i + 1]->setProven(anyProven && numbers[i]);
+  }
+  params.setProven(anyProven);
+}
+
+bool TypeInference::entryCheck(const AST &params, const Value *args) {
+  if (!params.proven())
+    return false;
+  const auto &ls = params.children();
+  for (size_t i = 1; i < ls.size(); i++) {
+    if (ls[i]->proven() && !args[i - 1].isNumber())
+      return false;
+  }
+  return true;
+}
+
+const TypeInference::Stats &TypeInference::stats() const { return stats_; }
+
+void TypeInference::assumeNumbers(const AST &node) {
+  const auto op = builtinOf(node);
+  // the operands of list and define are data, not references
+  if (Builtin::LIST == op || Builtin::DEFINE == op ||
+      Builtin::DEFINE_MEMO == op)
+    return;
+  const bool intOperands = isArithmetic(op) || isComparison(op);
+  const auto &ls = node.children();
+  for (size_t i = 0; i < ls.size(); i++) {
+    if (intOperands && i > 0 && isArgument(*ls[i]))
+      numbers[slotOf(*ls[i])] = true;
+    assumeNumbers(*ls[i]);
+  }
+}
+
+TypeInference::Type TypeInference::typeOf(AST &node) {
+  switch (node.type()) {
+  case AST::Type::INTEGER:
+  case AST::Type::BIGNUM:
+  case AST::Type::FLOAT:
+    return Type::NUMBER;
+  case AST::Type::BOOLEAN:
+    return Type::BOOL;
+  case AST::Type::SYMBOL: {
+    const bool assumed = isArgument(node) && numbers[slotOf(node)];
+    node.setProven(assumed);
+    return assumed ? Type::NUMBER : Type::ANY;
+  }
+  case AST::Type::SEXPR:
+    break;
+  default:
+    return Type::ANY;
+  }
+
+  const auto op = builtinOf(node);
+  const auto &ls = node.children();
+  if (isArithmetic(op)) {
+    // unproven operands may be arrays
+    checkOperands(node, Type::NUMBER);
+    return node.proven() ? Type::NUMBER : Type::ANY;
+  }
+  if (isComparison(op)) {
+    checkOperands(node, Type::NUMBER, 2);
+    return Type::BOOL;
+  }
+  switch (op) {
+  case Builtin::LIST:
+    return Type::LIST;
+  case Builtin::JOIN:
+    checkOperands(node, Type::LIST);
+    return Type::LIST;
+  case Builtin::HEAD:
+  case Builtin::TAIL:
+    checkOperands(node, Type::LIST);
+    return Type::ANY;
+  case Builtin::REST:
+    checkOperands(node, Type::LIST);
+    return Type::LIST;
+  case Builtin::STRING_TO_LIST:
+    typeOf(*ls[1]);
+    return Type::LIST;
+  case Builtin::PMAP:
+  case Builtin::PFILTER:
+    for (const auto &child : ls) {
+      typeOf(*child);
+    }
+    return Type::LIST;
+  case Builtin::CONS:
+    // the element may be of any type, the list operand is checked
+    for (const auto &child : ls) {
+      typeOf(*child);
+    }
+    return Type::LIST;
+  case Builtin::IF: {
+    if (ls.size() < 4)
+      return Type::ANY;
+    typeOf(*ls[1]);
+    const auto a = typeOf(*ls[2]);
+    const auto b = typeOf(*ls[3]);
+    return a == b ? a : Type::ANY;
+  }
+  case Builtin::ARRAY_GET:
+  case Builtin::ARRAY_LENGTH:
+  case Builtin::HASH_SIZE:
+  case Builtin::STRING_LENGTH:
+    for (const auto &child : ls) {
+      typeOf(*child);
+    }
+    return Type::NUMBER;
+  case Builtin::PPRINT:
+    return ls.size() == 2 ? typeOf(*ls[1]) : Type::ANY;
+  case Builtin::DEFINE:
+  case Builtin::DEFINE_MEMO:
+    return Type::ANY;
+  default:
+    break;
+  }
+  // calls of functions and eval
+  for (const auto &child : ls) {
+    typeOf(*child);
+  }
+  return Type::ANY;
+}
+
+void TypeInference::checkOperands(AST &node, Type type, size_t operands) {
+  const auto &ls = node.children();
+  bool proven = ls.size() > operands;
+  for (size_t i = 1; i < ls.size(); i++) {
+    proven = type == typeOf(*ls[i]) && proven;
+  }
+  node.setProven(proven);
+  stats_.checks += ls.size() - 1;
+  if (proven) {
+    stats_.eliminated += ls.size() - 1;
+    anyProven = true;
+  }
+}
@@ -0,0 +1,66 @@
+#ifndef TYPEINFERENCE_H_
+#define TYPEINFERENCE_H_
+#include "AST.h"
+#include "Value.h"
+
+#include <memory>
+#include <vector>
+
+/// Infers the types of the expressions in the body of a function when it
+/// is defined, so the tree walker can skip the type checks of builtins
+/// whose operands are proven to have the types they require.
+///
+/// An argument used as an operand of an arithmetic or comparison builtin
+/// is assumed to be a number. A call passing numbers for all those
+/// arguments passes the entry check of the function and is evaluated
+/// typed, other calls are checked as before. Number and list literals,
+/// assumed arguments, proven applications of arithmetic builtins, whose
+/// operands could otherwise be arrays, and applications of list, join,
+/// array-get and array-length have known types. Results of calls have
+/// none, the called function may be rebound. Numbers are fixnums, bignums or floats, the arithmetic
+/// of typed calls still promotes them.
+///
+/// The annotations are set by AST::setProven on
+///  - the argument list of a function with proven applications and the
+///    arguments assumed to be numbers in it
+///  - the references to assumed arguments in the body
+///  - builtin applications whose operands need no checks in a typed call
+class TypeInference {
+public:
+  struct Stats {
+    size_t functions = 0;
+    /// Functions with proven applications
+    size_t typed = 0;
+    /// Operand checks of the builtin applications in the function bodies
+    size_t checks = 0;
+    /// Those skipped in typed calls
+    size_t eliminated = 0;
+  };
+
+  /// Annotate fun, a function definition whose body is resolved
+  void infer(const AST &fun);
+  /// True if args pass the entry check of the function with the argument
+  /// list params
+  static bool entryCheck(const AST &params, const Value *args);
+
+  const Stats &stats() const;
+
+private:
+  enum class Type { NUMBER, BOOL, LIST, ANY };
+
+  /// Assume the arguments used as number operands in node to be numbers
+  void assumeNumbers(const AST &node);
+  /// Type of node, annotating it and its children
+  Type typeOf(AST &node);
+  /// Annotate the application node of a builtin whose operands are all
+  /// required to have type. With fewer than operands it is not proven, so
+  /// the builtin checks their count.
+  void checkOperands(AST &node, Type type, size_t operands = 1);
+
+  /// Indexed by argument slot
+  std::vector<bool> numbers;
+  bool anyProven = false;
+  Stats stats_;
+};
+
+#endif /* !TYPEINFERENCE_H_ */
@@ -0,0 +1,26 @@
+#include "TypedArray.h"
+
+#include <cassert>
+#include <cstdlib>
+#include <new>
+
+TypedArray::TypedArray(Element element, size_t size)
+    : element_(element), size_(size) {
+  static_assert(sizeof(int64_t) == sizeof(double), "elements of 8 bytes");
+  // aligned_alloc wants a multiple of the alignment, and a pointer even for
+  // empty arrays
+  const auto bytes =
+      (size * sizeof(int64_t) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+  data = aligned_alloc(ALIGNMENT, bytes ? bytes : ALIGNMENT);
+  if (!data)
+    throw std::bad_alloc();
+  storage.reset(data, free);
+}
+
+TypedArray TypedArray::slice(size_t start, size_t end) const {
+  assert(start <= end && end <= size_);
+  TypedArray res(*this);
+  res.size_ = end - start;
+  res.data = static_cast<char *>(data) + start * sizeof(int64_t);
+  return res;
+}
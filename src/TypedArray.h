@@ -0,0 +1,40 @@
+#ifndef TYPEDARRAY_H_
+#define TYPEDARRAY_H_
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/// A contiguous array of 64 bit integers or doubles. Arrays are not
+/// changed once built, so a slice shares the storage of the array it is
+/// cut from. The storage is aligned for 256 bit loads.
+class TypedArray {
+public:
+  enum class Element { INT, FLOAT };
+  static const size_t ALIGNMENT = 32;
+
+  /// size elements of the type element, not initialized
+  TypedArray(Element element, size_t size);
+
+  Element element() const { return element_; }
+  size_t size() const { return size_; }
+
+  /// The elements of an INT or FLOAT array
+  /// @{
+  const int64_t *ints() const { return static_cast<const int64_t *>(data); }
+  const double *floats() const { return static_cast<const double *>(data); }
+  /// Only for filling in an array that is being built
+  int64_t *ints() { return static_cast<int64_t *>(data); }
+  double *floats() { return static_cast<double *>(data); }
+  /// @}
+
+  /// Elements start up to end, end within the array and not before start
+  TypedArray slice(size_t start, size_t end) const;
+
+private:
+  Element element_;
+  size_t size_;
+  std::shared_ptr<void> storage;
+  void *data;
+};
+
+#endif /* !TYPEDARRAY_H_ */
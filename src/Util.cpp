@@ -1,18 +1,23 @@
 #include "Util.h"
+#include "Printer.h"
 
 #include <algorithm>
 #include <cassert>
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <unistd.h>
 
 namespace util {
-std::vector<Lexer::TokenType> tokenizeFile(std::string file) {
+std::string readFile(const std::string &file) {
   std::ifstream in(file);
   std::stringstream buffer;
   buffer << in.rdbuf();
+  return buffer.str();
+}
 
-  std::string contents(buffer.str());
+std::vector<Lexer::TokenType> tokenizeFile(std::string file) {
+  const auto contents = readFile(file);
   std::vector<Lexer::TokenType> res;
 
   Lexer lexer(contents.c_str());
@@ -25,40 +30,22 @@ std::vector<Lexer::TokenType> tokenizeFile(std::string file) {
 
 void print(const std::shared_ptr<AST> &node) {
   assert(node);
-  using namespace std;
-  using Type = AST::Type;
-  switch (node->type()) {
-  case Type::SEXPR: {
-    cout << "(";
-    printList(node->children());
-    cout << ")";
-    break;
-  }
-  case Type::SYMBOL:
-  case Type::BOOLEAN:
-  case Type::INTEGER:
-  case Type::STRING:
-  case Type::BUILTIN:
-    cout << node->toString();
-    break;
-  case Type::FUN:
-    cout << "<function>: ";
-    printList(node->children());
-    break;
-  }
+  // what cout buffered goes first
+  std::cout.flush();
+  Printer(STDOUT_FILENO).print(*node);
 }
 
 void printList(const AST::List &ls) {
-  using namespace std;
-
+  std::cout.flush();
+  Printer printer(STDOUT_FILENO);
   bool first = true;
   for (const auto &child : ls) {
     if (!first) {
-      cout << " ";
+      printer.write(' ');
     } else {
       first = false;
     }
-    print(child);
+    printer.print(*child);
   }
 }
 
@@ -10,6 +10,7 @@
 
 /// helping utilites
 namespace util {
+std::string readFile(const std::string &file);
 std::vector<Lexer::TokenType> tokenizeFile(std::string file);
 
 void print(const std::shared_ptr<AST> &node);
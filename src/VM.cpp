@@ -0,0 +1,269 @@
+#include "VM.h"
+#include "Environment.h"
+#include "Interpreter.h"
+#include "Kernels.h"
+#include "Memo.h"
+#include "Number.h"
+#include "SyntaxError.h"
+
+#include <algorithm>
+#include <cassert>
+
+VM::VM(Interpreter &interpreter) : interpreter(interpreter) {}
+
+Value VM::run(const std::shared_ptr<AST> &node) {
+  return execute(compiler.compile(node));
+}
+
+Value VM::execute(const std::shared_ptr<Chunk> &entry) {
+  const auto stackBase = stack.size();
+  const auto frameBase = frames.size();
+  frames.push_back(CallFrame{entry.get(), 0, stackBase});
+  try {
+    CallFrame *frame = &frames.back();
+    for (;;) {
+      const auto &code = frame->chunk->code;
+      const auto op = static_cast<OpCode>(code[frame->ip++]);
+      switch (op) {
+      case OpCode::CONST: {
+        const auto k = frame->chunk->read16(frame->ip);
+        frame->ip += 2;
+        stack.push_back(frame->chunk->constants[k]);
+        break;
+      }
+      case OpCode::LOAD_ARG: {
+        const auto arg = stack[frame->base + code[frame->ip++]];
+        stack.push_back(arg);
+        break;
+      }
+      case OpCode::LOAD_GLOBAL: {
+        const auto &symbol = frame->chunk->constants[frame->chunk->read16(
+            frame->ip)].node();
+        frame->ip += 2;
+        const auto value = (*interpreter.globals)[std::static_pointer_cast<
+            ASTSymbol>(symbol)->data()];
+        if (!value)
+          throw SyntaxError("Identifier is not known:", symbol);
+        stack.push_back(value);
+        break;
+      }
+      case OpCode::ADD:
+        intOp<Builtin::ADD>(code[frame->ip++]);
+        break;
+      case OpCode::SUB:
+        intOp<Builtin::SUB>(code[frame->ip++]);
+        break;
+      case OpCode::MUL:
+        intOp<Builtin::MUL>(code[frame->ip++]);
+        break;
+      case OpCode::DIV:
+        intOp<Builtin::DIV>(code[frame->ip++]);
+        break;
+      case OpCode::MOD:
+        intOp<Builtin::MOD>(code[frame->ip++]);
+        break;
+      case OpCode::EQ:
+        compare<Builtin::EQ>(code[frame->ip++]);
+        break;
+      case OpCode::GT:
+        compare<Builtin::GT>(code[frame->ip++]);
+        break;
+      case OpCode::GE:
+        compare<Builtin::GE>(code[frame->ip++]);
+        break;
+      case OpCode::LT:
+        compare<Builtin::LT>(code[frame->ip++]);
+        break;
+      case OpCode::LE:
+        compare<Builtin::LE>(code[frame->ip++]);
+        break;
+      case OpCode::JUMP:
+        frame->ip = frame->chunk->read16(frame->ip);
+        break;
+      case OpCode::JUMP_IF_FALSE: {
+        const auto target = frame->chunk->read16(frame->ip);
+        frame->ip += 2;
+        const bool predicate = Interpreter::isTrue(stack.back());
+        stack.pop_back();
+        if (!predicate)
+          frame->ip = target;
+        break;
+      }
+      case OpCode::CALL:
+      case OpCode::TAIL_CALL: {
+        const auto argc = code[frame->ip++];
+        auto &site = frame->chunk->callSites[frame->chunk->read16(frame->ip)];
+        frame->ip += 2;
+        const auto base = stack.size() - argc;
+        const auto &callee = stack[base - 1];
+        if (AST::Type::FUN != callee.type()) {
+          if (AST::Type::BUILTIN == callee.type())
+            throw SyntaxError("Expected builtin", callee.node());
+          throw SyntaxError("Uknown node type", callee.toAST());
+        }
+        // functions stay compiled, so their addresses are not reused
+        const Chunk *chunk = site.chunk;
+        if (callee.node().get() == site.fun) {
+          interpreter.callCacheStats_.hits++;
+        } else {
+          interpreter.callCacheStats_.misses++;
+          chunk = functionChunk(callee.node());
+          site = Chunk::CallSite{callee.node().get(), chunk};
+        }
+        if (chunk->arity != argc)
+          throw SyntaxError("Wrong number of arguments", callee.node());
+        Value result;
+        if (interpreter.jit_ &&
+            interpreter.jit_->call(callee.node().get(), stack.data() + base,
+                                   argc, result)) {
+          stack.resize(base - 1);
+          stack.emplace_back(std::move(result));
+          break;
+        }
+        std::shared_ptr<Memo> memo;
+        if (chunk->memoized) {
+          memo = interpreter.memoOf(callee.node().get());
+          if (memo &&
+              interpreter.recall(*memo, stack.data() + base, argc, result)) {
+            stack.resize(base - 1);
+            stack.emplace_back(std::move(result));
+            break;
+          }
+        }
+        // the arguments of a memoized frame are needed on return
+        if (OpCode::CALL == op || frame->memo) {
+          frames.push_back(CallFrame{chunk, 0, base, std::move(memo)});
+          frame = &frames.back();
+          break;
+        }
+        // move callee and arguments down over those of the current frame
+        std::move(stack.begin() + base - 1, stack.end(),
+                  stack.begin() + frame->base - 1);
+        stack.resize(frame->base + argc);
+        frame->chunk = chunk;
+        frame->ip = 0;
+        frame->memo = std::move(memo);
+        break;
+      }
+      case OpCode::RETURN: {
+        auto result = stack.back();
+        if (frame->memo)
+          interpreter.memorize(*frame->memo, stack.data() + frame->base,
+                               frame->chunk->arity, result);
+        if (frames.size() == frameBase + 1) {
+          frames.pop_back();
+          stack.resize(stackBase);
+          return result;
+        }
+        // drop the arguments and the callee below them
+        stack.resize(frame->base - 1);
+        stack.emplace_back(std::move(result));
+        frames.pop_back();
+        frame = &frames.back();
+        break;
+      }
+      case OpCode::DEFINE: {
+        const auto &node = frame->chunk->constants[frame->chunk->read16(
+            frame->ip)].node();
+        frame->ip += 2;
+        stack.push_back(interpreter.evalIn(nullptr, node));
+        break;
+      }
+      case OpCode::EVAL_AST: {
+        const auto &node = frame->chunk->constants[frame->chunk->read16(
+            frame->ip)].node();
+        frame->ip += 2;
+        stack.push_back(evalAST(*frame, node));
+        break;
+      }
+      }
+    }
+  } catch (...) {
+    frames.resize(frameBase);
+    stack.resize(stackBase);
+    throw;
+  }
+}
+
+const Chunk *VM::functionChunk(const std::shared_ptr<AST> &fun) {
+  const auto it = functions.find(fun.get());
+  if (it != functions.cend())
+    return it->second.chunk.get();
+  const auto chunk = compiler.compileFunction(fun);
+  functions[fun.get()] = CompiledFunction{fun, chunk};
+  return chunk.get();
+}
+
+template <Builtin op> void VM::intOp(unsigned int argc) {
+  const auto first = stack.size() - argc;
+  interpreter.requireArithmeticType(stack[first]);
+  if (2 == argc) {
+    interpreter.requireArithmeticType(stack[first + 1]);
+    stack[first] = number::arithmetic<op>(stack[first], stack[first + 1]);
+    stack.pop_back();
+    return;
+  }
+  auto acc = stack[first];
+  for (auto i = first + 1; i < stack.size(); i++) {
+    interpreter.requireArithmeticType(stack[i]);
+    acc = number::arithmetic<op>(acc, stack[i]);
+  }
+  stack.resize(first);
+  stack.emplace_back(std::move(acc));
+}
+
+template <Builtin op> void VM::compare(unsigned int argc) {
+  const auto first = stack.size() - argc;
+  if (2 == argc && stack[first].isInteger() && stack[first + 1].isInteger()) {
+    const auto a = stack[first].integer();
+    const auto b = stack[first + 1].integer();
+    stack.pop_back();
+    stack.back() = Value::boolean(IntKernel<op>::apply(a, b));
+    return;
+  }
+  const bool numbers = std::all_of(
+      stack.cbegin() + first, stack.cend(),
+      [](const Value &value) { return value.isNumber(); });
+  if (!numbers) {
+    const auto type = stack[first].type();
+    for (auto i = first + 1; i < stack.size(); i++) {
+      if (type != stack[i].type())
+        throw SyntaxError("All arguments must be of same type",
+                          stack[i].toAST());
+    }
+    // only strings are left
+    if (Builtin::EQ != op)
+      interpreter.requireIntType(stack[first]);
+    else if (AST::Type::STRING != type)
+      throw SyntaxError("Uniplemented operation", stack[first].toAST());
+  }
+
+  bool res = true;
+  for (auto i = first + 1; res && i < stack.size(); i++) {
+    if (numbers) {
+      res = number::compare<op>(stack[i - 1], stack[i]);
+      continue;
+    }
+    const auto &a =
+        std::static_pointer_cast<ASTString>(stack[i - 1].node())->data();
+    const auto &b =
+        std::static_pointer_cast<ASTString>(stack[i].node())->data();
+    res = a == b;
+  }
+  stack.resize(first);
+  stack.emplace_back(Value::boolean(res));
+}
+
+Value VM::evalAST(const CallFrame &frame, const std::shared_ptr<AST> &node) {
+  if (!frame.chunk->params)
+    return interpreter.evalIn(nullptr, node);
+
+  // hand the arguments to the tree walker in a frame of its own
+  const auto scope = interpreter.framePool.acquire(frame.chunk->params);
+  for (unsigned int i = 0; i < scope->size(); i++) {
+    (*scope)[i] = stack[frame.base + i];
+  }
+  const auto res = interpreter.evalIn(scope, node);
+  interpreter.framePool.release(scope);
+  return res;
+}
@@ -0,0 +1,58 @@
+#ifndef VM_H_
+#define VM_H_
+#include "AST.h"
+#include "Bytecode.h"
+#include "Compiler.h"
+#include "Value.h"
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+class Interpreter;
+class Memo;
+
+/// Stack machine executing chunks produced by the Compiler. Globals,
+/// define and the builtins without instructions are shared with the
+/// tree walking Interpreter that owns the VM.
+class VM {
+public:
+  explicit VM(Interpreter &interpreter);
+
+  /// Compile and execute a top-level form
+  Value run(const std::shared_ptr<AST> &node);
+
+private:
+  struct CallFrame {
+    const Chunk *chunk;
+    size_t ip;
+    /// Index of the first argument on the stack
+    size_t base;
+    /// Stores the result of a memoized function on return
+    std::shared_ptr<Memo> memo;
+  };
+
+  struct CompiledFunction {
+    /// Keeps the definition alive so its address is not reused
+    std::shared_ptr<AST> fun;
+    std::shared_ptr<Chunk> chunk;
+  };
+
+  Value execute(const std::shared_ptr<Chunk> &entry);
+  const Chunk *functionChunk(const std::shared_ptr<AST> &fun);
+
+  /// Fold or compare the argc values on top of the stack
+  /// @{
+  template <Builtin op> void intOp(unsigned int argc);
+  template <Builtin op> void compare(unsigned int argc);
+  /// @}
+  Value evalAST(const CallFrame &frame, const std::shared_ptr<AST> &node);
+
+  Interpreter &interpreter;
+  Compiler compiler;
+  std::vector<Value> stack;
+  std::vector<CallFrame> frames;
+  std::unordered_map<const AST *, CompiledFunction> functions;
+};
+
+#endif /* !VM_H_ */
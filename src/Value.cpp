@@ -0,0 +1,38 @@
+#include "Value.h"
+
+void Value::set(const std::shared_ptr<AST> &node) {
+  if (!node) {
+    return;
+  }
+  switch (node->type()) {
+  case AST::Type::INTEGER:
+    tag = Tag::INTEGER;
+    integer_ = std::static_pointer_cast<ASTInt>(node)->data();
+    break;
+  case AST::Type::FLOAT:
+    tag = Tag::FLOAT;
+    floating_ = std::static_pointer_cast<ASTFloat>(node)->data();
+    break;
+  case AST::Type::BOOLEAN:
+    tag = Tag::BOOLEAN;
+    boolean_ = std::static_pointer_cast<ASTBoolean>(node)->data();
+    break;
+  default:
+    node_ = node;
+    break;
+  }
+}
+
+std::shared_ptr<AST> Value::toAST() const {
+  switch (tag) {
+  case Tag::INTEGER:
+    return std::make_shared<ASTInt>(integer_);
+  case Tag::FLOAT:
+    return std::make_shared<ASTFloat>(floating_);
+  case Tag::BOOLEAN:
+    return std::make_shared<ASTBoolean>(boolean_);
+  case Tag::NODE:
+    break;
+  }
+  return node_;
+}
@@ -0,0 +1,111 @@
+#ifndef VALUE_H_
+#define VALUE_H_
+#include "AST.h"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/// The result of evaluation. Integers that fit in 64 bits, the fixnums,
+/// floats and booleans are stored inline, other values refer to a node:
+/// bignums, arrays, lists, strings, symbols, functions and builtins.
+class Value {
+public:
+  Value() = default;
+  Value(std::nullptr_t) {}
+  /// Integer, float and boolean nodes are unboxed
+  template <typename NodeType> Value(const std::shared_ptr<NodeType> &node) {
+    set(node);
+  }
+
+  static Value integer(int64_t data) {
+    Value v;
+    v.tag = Tag::INTEGER;
+    v.integer_ = data;
+    return v;
+  }
+  static Value floating(double data) {
+    Value v;
+    v.tag = Tag::FLOAT;
+    v.floating_ = data;
+    return v;
+  }
+  static Value boolean(bool data) {
+    Value v;
+    v.tag = Tag::BOOLEAN;
+    v.boolean_ = data;
+    return v;
+  }
+
+  AST::Type type() const {
+    switch (tag) {
+    case Tag::INTEGER:
+      return AST::Type::INTEGER;
+    case Tag::FLOAT:
+      return AST::Type::FLOAT;
+    case Tag::BOOLEAN:
+      return AST::Type::BOOLEAN;
+    case Tag::NODE:
+      break;
+    }
+    return node_->type();
+  }
+
+  /// False for the default constructed value
+  explicit operator bool() const { return Tag::NODE != tag || node_; }
+
+  bool isInteger() const { return Tag::INTEGER == tag; }
+  bool isFloat() const { return Tag::FLOAT == tag; }
+  bool isBoolean() const { return Tag::BOOLEAN == tag; }
+  /// A fixnum, a bignum or a float
+  bool isNumber() const {
+    return Tag::INTEGER == tag || Tag::FLOAT == tag ||
+           (Tag::NODE == tag && node_ && AST::Type::BIGNUM == node_->type());
+  }
+  bool isArray() const {
+    return Tag::NODE == tag && node_ && AST::Type::ARRAY == node_->type();
+  }
+  bool isList() const {
+    return Tag::NODE == tag && node_ && AST::Type::LIST == node_->type();
+  }
+  bool isBuiltin(Builtin op) const {
+    return Tag::NODE == tag && node_->isBuiltin(op);
+  }
+
+  int64_t integer() const {
+    assert(isInteger());
+    return integer_;
+  }
+  double floating() const {
+    assert(isFloat());
+    return floating_;
+  }
+  bool boolean() const {
+    assert(isBoolean());
+    return boolean_;
+  }
+  /// The node of a value that is not stored inline
+  const std::shared_ptr<AST> &node() const {
+    assert(Tag::NODE == tag);
+    return node_;
+  }
+
+  /// The value as a node, inline values are boxed in a new node
+  std::shared_ptr<AST> toAST() const;
+
+private:
+  enum class Tag : unsigned char { NODE, INTEGER, FLOAT, BOOLEAN };
+
+  void set(const std::shared_ptr<AST> &node);
+
+  Tag tag = Tag::NODE;
+  union {
+    int64_t integer_;
+    double floating_;
+    bool boolean_;
+  };
+  std::shared_ptr<AST> node_;
+};
+
+#endif /* !VALUE_H_ */
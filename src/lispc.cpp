@@ -0,0 +1,84 @@
+#include "Lexer.h"
+#include "Optimizer.h"
+#include "Parser.h"
+#include "Translator.h"
+#include "Util.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+// Translates a script to a C++ header and source, see Translator.
+
+using namespace std;
+
+void usage(const char *name) {
+  cout << "Usage " << name
+       << " [--namespace name] [--main] [--optimize] script header source"
+       << endl;
+}
+
+bool writeFile(const string &file, const string &contents) {
+  ofstream out(file);
+  out << contents;
+  return static_cast<bool>(out);
+}
+
+int main(int argc, char *argv[]) {
+  string ns;
+  bool main = false;
+  bool optimize = false;
+  const char *files[3];
+  int nfiles = 0;
+  for (int i = 1; i < argc; i++) {
+    if (0 == strcmp("--namespace", argv[i])) {
+      if (i + 1 == argc) {
+        usage(argv[0]);
+        return -1;
+      }
+      ns = argv[++i];
+    } else if (0 == strcmp("--main", argv[i])) {
+      main = true;
+    } else if (0 == strcmp("--optimize", argv[i])) {
+      optimize = true;
+    } else if (nfiles < 3) {
+      files[nfiles++] = argv[i];
+    } else {
+      usage(argv[0]);
+      return -1;
+    }
+  }
+  if (3 != nfiles) {
+    usage(argv[0]);
+    return -1;
+  }
+
+  const string script = files[0];
+  const auto base = script.substr(script.find_last_of('/') + 1);
+  if (ns.empty())
+    ns = Translator::identifier(base.substr(0, base.find('.')).c_str());
+  const string header = files[1];
+  try {
+    const auto code = util::readFile(script);
+    Lexer l(code.c_str());
+    Parser p(l);
+    auto program = p.read();
+    if (optimize) {
+      Optimizer optimizer;
+      program = optimizer.optimize(program);
+    }
+    Translator translator;
+    const auto output = translator.translate(
+        program, base, ns, header.substr(header.find_last_of('/') + 1), main);
+    if (!writeFile(header, output.header) ||
+        !writeFile(files[2], output.source)) {
+      cout << "Could not write " << header << " and " << files[2] << endl;
+      return -1;
+    }
+  } catch (const exception &e) {
+    cout << script << ": " << e.what() << endl;
+    return -1;
+  }
+  return 0;
+}
@@ -1,6 +1,7 @@
 #include "Environment.h"
 #include "Interpreter.h"
 #include "Lexer.h"
+#include "Optimizer.h"
 #include "Parser.h"
 #include "StopWatch.h"
 #include "Util.h"
@@ -19,45 +20,59 @@ std::string history_file{"./replxx_history.txt"};
 using namespace std;
 const string PROMPT(">");
 Interpreter interpreter;
+Optimizer optimizer;
+bool optimize = false;
 
 void printEvaluation(const char *code) {
   Lexer l(code);
   Parser p(l);
   StopWatch parseTime;
-  const auto program = p.read();
+  auto program = p.read();
   parseTime.stop();
+  if (optimize)
+    program = optimizer.optimize(program);
+  // pprint writes to the same buffer, flushed once per input
+  auto &out = interpreter.output();
   for (const auto &e : program) {
-    util::print(e);
+    out.print(*e);
   }
-  cout << "\n(parse " << parseTime.elapsed() << " ms)" << std::endl;
+  out.write("\n(parse ");
+  out.writeInteger(parseTime.elapsed());
+  out.write(" ms)\n");
   for (const auto &e : program) {
-    util::print(e);
-    cout << "\n";
+    out.print(*e);
+    out.write('\n');
     StopWatch evalTime;
-    cout << interpreter.eval(e)->toString();
+    const auto res = interpreter.eval(e);
     evalTime.stop();
-    cout << "\t\t\t(eval " << evalTime.elapsed() << " ms)" << endl;
+    out.print(*res);
+    out.write("\t\t\t(eval ");
+    out.writeInteger(evalTime.elapsed());
+    out.write(" ms)\n");
   }
+  out.flush();
+}
+
+bool gcStats = false;
+bool spawnStats = false;
+
+void dumpStats() {
+  if (gcStats)
+    interpreter.heap().dumpStats();
+  if (spawnStats && interpreter.scheduler())
+    interpreter.scheduler()->dumpStats();
 }
 
 int runFile(const char *fileName) {
-  std::ifstream ifs(fileName);
-  // get length of file:
-  ifs.seekg(0, ifs.end);
-  int length = ifs.tellg();
-  ifs.seekg(0, ifs.beg);
-
-  char *buffer = new char[length];
-  ifs.read(buffer, length);
-  if (!ifs)
-    std::cout << "error: only " << ifs.gcount() << " could be read";
-  ifs.close();
+  const auto code = util::readFile(fileName);
   try {
-    printEvaluation(buffer);
+    printEvaluation(code.c_str());
   } catch (const exception &e) {
+    interpreter.output().flush();
     cout << "Error occurred: " << e.what() << endl;
     cout << "\n" << PROMPT;
   }
+  dumpStats();
 
   return 0;
 }
@@ -274,9 +289,60 @@ Replxx init_replxx() {
   return rx;
 }
 
+void usage(const char *name) {
+  cout << "Usage " << name
+       << " [--engine tree|vm] [--heap-size bytes] [--gc-stats]"
+       << " [--memo-size entries] [--optimize] [--dump-optimized] [--jit]"
+       << " [--no-inference] [--threads count] [--spawn-stats] [file]"
+       << endl;
+}
+
 int main(int argc, char *argv[]) {
-  if (argc == 2) {
-    return runFile(argv[1]);
+  const char *file = nullptr;
+  for (int i = 1; i < argc; i++) {
+    if (0 == strcmp("--engine", argv[i])) {
+      if (i + 1 == argc) {
+        usage(argv[0]);
+        return -1;
+      }
+      interpreter.setEngine(Interpreter::engineFromCString(argv[++i]));
+    } else if (0 == strcmp("--heap-size", argv[i])) {
+      if (i + 1 == argc) {
+        usage(argv[0]);
+        return -1;
+      }
+      interpreter.heap().setSize(strtoul(argv[++i], nullptr, 10));
+    } else if (0 == strcmp("--memo-size", argv[i])) {
+      if (i + 1 == argc) {
+        usage(argv[0]);
+        return -1;
+      }
+      interpreter.setMemoCapacity(strtoul(argv[++i], nullptr, 10));
+    } else if (0 == strcmp("--threads", argv[i])) {
+      if (i + 1 == argc) {
+        usage(argv[0]);
+        return -1;
+      }
+      interpreter.setThreads(strtoul(argv[++i], nullptr, 10));
+    } else if (0 == strcmp("--optimize", argv[i])) {
+      optimize = true;
+    } else if (0 == strcmp("--dump-optimized", argv[i])) {
+      optimize = true;
+      optimizer.setDump(true);
+    } else if (0 == strcmp("--jit", argv[i])) {
+      interpreter.enableJit();
+    } else if (0 == strcmp("--no-inference", argv[i])) {
+      interpreter.setTypeInference(false);
+    } else if (0 == strcmp("--gc-stats", argv[i])) {
+      gcStats = true;
+    } else if (0 == strcmp("--spawn-stats", argv[i])) {
+      spawnStats = true;
+    } else {
+      file = argv[i];
+    }
+  }
+  if (file) {
+    return runFile(file);
   }
 
   auto rx = init_replxx();
@@ -311,12 +377,14 @@ int main(int argc, char *argv[]) {
     try {
       printEvaluation(cinput);
     } catch (const exception &e) {
+      interpreter.output().flush();
       cout << "Error occurred: " << e.what() << endl;
     }
   }
 
   // save the history
   rx.history_save(history_file);
+  dumpStats();
 
   return 0;
 }
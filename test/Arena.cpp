@@ -0,0 +1,110 @@
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "Arena.h"
+#include "Parser.h"
+#include "SyntaxError.h"
+
+class ArenaTest : public ::testing::Test {
+
+protected:
+  Arena readArena(const char *code) {
+    Lexer l(code);
+    Parser p(l);
+    return p.readArena();
+  }
+
+  AST::List read(const char *code) {
+    Lexer l(code);
+    Parser p(l);
+    return p.read();
+  }
+
+  /// Same structure and leaves
+  void expectSame(const std::shared_ptr<AST> &expected,
+                  const std::shared_ptr<AST> &actual) {
+    ASSERT_EQ(expected->type(), actual->type());
+    EXPECT_EQ(expected->toString(), actual->toString());
+    const auto xs = expected->children();
+    const auto ys = actual->children();
+    ASSERT_EQ(xs.size(), ys.size());
+    for (size_t i = 0; i < xs.size(); i++) {
+      expectSame(xs[i], ys[i]);
+    }
+  }
+};
+
+TEST_F(ArenaTest, empty) {
+  const auto arena = readArena("");
+  EXPECT_EQ(0, arena.roots().size());
+  EXPECT_EQ(0, arena.size());
+}
+
+TEST_F(ArenaTest, leaves) {
+  const auto arena = readArena("12 hest \"fisk\" true false +");
+  const auto &roots = arena.roots();
+  ASSERT_EQ(6, roots.size());
+  EXPECT_EQ(AST::Type::INTEGER, arena[roots[0]].type);
+  EXPECT_EQ(12, arena[roots[0]].integer);
+  EXPECT_EQ(AST::Type::SYMBOL, arena[roots[1]].type);
+  EXPECT_EQ(SymbolTable::intern("hest"), arena[roots[1]].symbol);
+  EXPECT_EQ(AST::Type::STRING, arena[roots[2]].type);
+  EXPECT_STREQ("fisk", arena.string(roots[2]));
+  EXPECT_EQ(AST::Type::BOOLEAN, arena[roots[3]].type);
+  EXPECT_TRUE(arena[roots[3]].boolean);
+  EXPECT_FALSE(arena[roots[4]].boolean);
+  EXPECT_EQ(AST::Type::BUILTIN, arena[roots[5]].type);
+  EXPECT_EQ(Builtin::ADD, arena[roots[5]].op);
+}
+
+TEST_F(ArenaTest, childrenAreContiguous) {
+  const auto arena = readArena("(+ (* 2 3) (- 4 1) 5)");
+  ASSERT_EQ(1, arena.roots().size());
+  const auto root = arena.roots()[0];
+  ASSERT_EQ(AST::Type::SEXPR, arena[root].type);
+  ASSERT_EQ(4, arena[root].size);
+  EXPECT_EQ(Builtin::ADD, arena[arena.child(root, 0)].op);
+  const auto mul = arena.child(root, 1);
+  ASSERT_EQ(3, arena[mul].size);
+  EXPECT_EQ(Builtin::MUL, arena[arena.child(mul, 0)].op);
+  EXPECT_EQ(3, arena[arena.child(mul, 2)].integer);
+  const auto sub = arena.child(root, 2);
+  EXPECT_EQ(Builtin::SUB, arena[arena.child(sub, 0)].op);
+  EXPECT_EQ(5, arena[arena.child(root, 3)].integer);
+}
+
+TEST_F(ArenaTest, emptySexpr) {
+  const auto arena = readArena("(())");
+  const auto root = arena.roots()[0];
+  ASSERT_EQ(1, arena[root].size);
+  EXPECT_EQ(0, arena[arena.child(root, 0)].size);
+}
+
+TEST_F(ArenaTest, toASTMatchesRead) {
+  const char *code = "(define (fib x)"
+                     "  (if (< x 2) x (+ (fib (- x 1)) (fib (- x 2)))))"
+                     "(fib 20) \"str\" (list 1 true false) ()";
+  const auto expected = read(code);
+  const auto actual = readArena(code).toAST();
+  ASSERT_EQ(expected.size(), actual.size());
+  for (size_t i = 0; i < expected.size(); i++) {
+    expectSame(expected[i], actual[i]);
+  }
+}
+
+TEST_F(ArenaTest, unbalanced) {
+  Lexer l("(((()))");
+  Parser p(l);
+  ASSERT_THROW(p.readArena(), SyntaxError);
+}
+
+TEST_F(ArenaTest, builtinSyntaxIsChecked) {
+  Lexer l("(define x)");
+  Parser p(l);
+  ASSERT_THROW(p.readArena(), SyntaxError);
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
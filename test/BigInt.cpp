@@ -0,0 +1,124 @@
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "BigInt.h"
+
+#include <random>
+
+namespace {
+
+BigInt big(const char *digits) { return BigInt::fromString(digits); }
+
+/// A random number of the given count of 32 bit limbs
+BigInt random(std::mt19937_64 &rng, size_t limbs) {
+  BigInt res;
+  const BigInt base = big("4294967296");
+  for (size_t i = 0; i < limbs; i++) {
+    res = res * base + BigInt(static_cast<int64_t>(rng() >> 32));
+  }
+  return rng() & 1 ? -res : res;
+}
+
+} // namespace
+
+TEST(BigInt, int64RoundTrips) {
+  for (const int64_t n : {int64_t(0), int64_t(1), int64_t(-1),
+                          int64_t(4294967296), INT64_MAX, INT64_MIN}) {
+    const BigInt b(n);
+    EXPECT_TRUE(b.fitsInt64());
+    EXPECT_EQ(n, b.toInt64());
+    EXPECT_EQ(std::to_string(n), b.toString());
+  }
+  EXPECT_FALSE((BigInt(INT64_MAX) + BigInt(1)).fitsInt64());
+  EXPECT_FALSE((BigInt(INT64_MIN) - BigInt(1)).fitsInt64());
+}
+
+TEST(BigInt, parsesAndPrints) {
+  EXPECT_EQ("0", big("0").toString());
+  EXPECT_EQ("0", big("-0").toString());
+  EXPECT_EQ("123456789012345678901234567890",
+            big("123456789012345678901234567890").toString());
+  EXPECT_EQ("-1000000000000000000000000000",
+            big("-1000000000000000000000000000").toString());
+  EXPECT_EQ("1000000001", big("0001000000001").toString());
+}
+
+TEST(BigInt, addsWithSigns) {
+  const auto a = big("18446744073709551616");
+  EXPECT_EQ("18446744073709551617", (a + BigInt(1)).toString());
+  EXPECT_EQ("18446744073709551615", (a - BigInt(1)).toString());
+  EXPECT_EQ("-18446744073709551615", (BigInt(1) - a).toString());
+  EXPECT_EQ("0", (a - a).toString());
+  EXPECT_TRUE((a - a).isZero());
+  EXPECT_FALSE((a - a).isNegative());
+  EXPECT_EQ("-36893488147419103232", (-a - a).toString());
+}
+
+TEST(BigInt, multiplies) {
+  const auto a = big("-123456789012345678901234567890");
+  const auto b = big("987654321098765432109876543210");
+  EXPECT_EQ("-121932631137021795226185032733622923332237463801111263526900",
+            (a * b).toString());
+  EXPECT_EQ("0", (a * BigInt()).toString());
+}
+
+TEST(BigInt, karatsubaMatchesSchoolbook) {
+  std::mt19937_64 rng(17);
+  for (const auto limbs : {BigInt::KARATSUBA_THRESHOLD,
+                           3 * BigInt::KARATSUBA_THRESHOLD + 1,
+                           size_t(400)}) {
+    const auto a = random(rng, limbs);
+    const auto b = random(rng, limbs + limbs / 3);
+    const auto c = random(rng, 7);
+    EXPECT_EQ(BigInt::multiplySchoolbook(a, b), a * b) << limbs;
+    // unbalanced operands
+    EXPECT_EQ(BigInt::multiplySchoolbook(a, c), a * c) << limbs;
+  }
+}
+
+TEST(BigInt, dividesTruncating) {
+  BigInt q;
+  BigInt r;
+  BigInt::divide(BigInt(-7), BigInt(2), q, r);
+  EXPECT_EQ(-3, q.toInt64());
+  EXPECT_EQ(-1, r.toInt64());
+  BigInt::divide(big("100000000000000000000"), BigInt(-3), q, r);
+  EXPECT_EQ("-33333333333333333333", q.toString());
+  EXPECT_EQ("1", r.toString());
+  BigInt::divide(BigInt(5), big("100000000000000000000"), q, r);
+  EXPECT_TRUE(q.isZero());
+  EXPECT_EQ(5, r.toInt64());
+}
+
+TEST(BigInt, divisionInvertsMultiplication) {
+  std::mt19937_64 rng(42);
+  for (size_t n = 2; n < 40; n += 3) {
+    const auto a = random(rng, 2 * n + 1);
+    auto b = random(rng, n);
+    if (b.isZero())
+      b = BigInt(3);
+    BigInt q;
+    BigInt r;
+    BigInt::divide(a, b, q, r);
+    EXPECT_EQ(a, q * b + r) << n;
+    EXPECT_LT(BigInt::compare(r.isNegative() ? -r : r,
+                              b.isNegative() ? -b : b),
+              0);
+    EXPECT_TRUE(r.isZero() || r.isNegative() == a.isNegative());
+  }
+}
+
+TEST(BigInt, compares) {
+  const auto a = big("100000000000000000000");
+  EXPECT_LT(BigInt::compare(BigInt(INT64_MAX), a), 0);
+  EXPECT_GT(BigInt::compare(a, BigInt(INT64_MAX)), 0);
+  EXPECT_LT(BigInt::compare(-a, BigInt(INT64_MIN)), 0);
+  EXPECT_EQ(0, BigInt::compare(a, big("100000000000000000000")));
+  EXPECT_TRUE(-a < a);
+  EXPECT_EQ(a.hash(), big("100000000000000000000").hash());
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
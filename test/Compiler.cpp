@@ -0,0 +1,93 @@
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "Compiler.h"
+#include "Lexer.h"
+#include "Parser.h"
+
+class CompilerTest : public ::testing::Test {
+
+protected:
+  std::shared_ptr<Chunk> compileFirst(const char *code) {
+    Lexer l(code);
+    Parser p(l);
+    const auto program = p.read();
+    EXPECT_GT(program.size(), 0);
+    return compiler.compile(program[0]);
+  }
+
+  std::shared_ptr<Chunk> compileFunction(const char *code) {
+    Lexer l(code);
+    Parser p(l);
+    const auto program = p.read();
+    EXPECT_GT(program.size(), 0);
+    program[0]->setType(AST::Type::FUN);
+    return compiler.compileFunction(program[0]);
+  }
+
+  static OpCode at(const std::shared_ptr<Chunk> &chunk, size_t idx) {
+    return static_cast<OpCode>(chunk->code[idx]);
+  }
+
+  Compiler compiler;
+};
+
+TEST_F(CompilerTest, constant) {
+  const auto chunk = compileFirst("12");
+  ASSERT_EQ(4, chunk->code.size());
+  EXPECT_EQ(OpCode::CONST, at(chunk, 0));
+  EXPECT_EQ(OpCode::RETURN, at(chunk, 3));
+  ASSERT_EQ(1, chunk->constants.size());
+  EXPECT_EQ(AST::Type::INTEGER, chunk->constants[0].type());
+}
+
+TEST_F(CompilerTest, intOpTakesOperandCount) {
+  const auto chunk = compileFirst("(+ 1 2 3)");
+  ASSERT_EQ(12, chunk->code.size());
+  EXPECT_EQ(OpCode::ADD, at(chunk, 9));
+  EXPECT_EQ(3, chunk->code[10]);
+  EXPECT_EQ(OpCode::RETURN, at(chunk, 11));
+}
+
+TEST_F(CompilerTest, symbolIsGlobalAtTopLevel) {
+  const auto chunk = compileFirst("x");
+  EXPECT_EQ(OpCode::LOAD_GLOBAL, at(chunk, 0));
+}
+
+TEST_F(CompilerTest, argumentsAreSlots) {
+  const auto chunk = compileFunction("(define (f a b) b)");
+  EXPECT_EQ(2, chunk->arity);
+  EXPECT_EQ(OpCode::LOAD_ARG, at(chunk, 0));
+  EXPECT_EQ(1, chunk->code[1]);
+}
+
+TEST_F(CompilerTest, ifJumpsPastBranches) {
+  const auto chunk = compileFirst("(if true 1 2)");
+  ASSERT_EQ(OpCode::JUMP_IF_FALSE, at(chunk, 3));
+  const auto elseBranch = chunk->read16(4);
+  ASSERT_EQ(OpCode::JUMP, at(chunk, 9));
+  const auto end = chunk->read16(10);
+  EXPECT_EQ(12, elseBranch);
+  EXPECT_EQ(OpCode::CONST, at(chunk, elseBranch));
+  EXPECT_EQ(OpCode::RETURN, at(chunk, end));
+}
+
+TEST_F(CompilerTest, callPushesCalleeFirst) {
+  const auto chunk = compileFirst("(f 1)");
+  EXPECT_EQ(OpCode::LOAD_GLOBAL, at(chunk, 0));
+  EXPECT_EQ(OpCode::CONST, at(chunk, 3));
+  EXPECT_EQ(OpCode::CALL, at(chunk, 6));
+  EXPECT_EQ(1, chunk->code[7]);
+  EXPECT_EQ(0, chunk->read16(8));
+  EXPECT_EQ(1, chunk->callSites.size());
+}
+
+TEST_F(CompilerTest, listBuiltinsFallBackToTreeWalker) {
+  const auto chunk = compileFirst("(head (list 1))");
+  EXPECT_EQ(OpCode::EVAL_AST, at(chunk, 0));
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,131 @@
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "AST.h"
+#include "HashMap.h"
+#include "PersistentMap.h"
+
+#include <map>
+#include <random>
+
+namespace {
+
+std::shared_ptr<AST> integer(int64_t i) { return std::make_shared<ASTInt>(i); }
+
+int64_t value(const std::shared_ptr<AST> *node) {
+  return std::static_pointer_cast<ASTInt>(*node)->data();
+}
+
+} // namespace
+
+TEST(HashMap, keysOfDifferentTypesDiffer) {
+  const ASTInt one(1);
+  const ASTFloat oneFloat(1.0);
+  const ASTString oneString("1");
+  EXPECT_FALSE(HashMap::equal(one, oneFloat));
+  EXPECT_FALSE(HashMap::equal(one, oneString));
+  EXPECT_TRUE(HashMap::equal(ASTFloat(0.0), ASTFloat(-0.0)));
+  EXPECT_EQ(HashMap::hash(ASTFloat(0.0)), HashMap::hash(ASTFloat(-0.0)));
+  EXPECT_EQ(HashMap::hash(ASTString("key")), HashMap::hash(ASTString("key")));
+  EXPECT_TRUE(HashMap::hashable(ASTSymbol("key")));
+  EXPECT_FALSE(HashMap::hashable(ASTSexpr()));
+}
+
+TEST(HashMap, setFindRemove) {
+  HashMap map;
+  EXPECT_EQ(nullptr, map.find(ASTInt(1)));
+  EXPECT_FALSE(map.remove(ASTInt(1)));
+  for (int i = 0; i < 1000; i++) {
+    map.set(integer(i), integer(i * 2));
+  }
+  map.set(integer(7), integer(-7));
+  map.set(std::make_shared<ASTString>("seven"), integer(7));
+  EXPECT_EQ(1001u, map.size());
+  EXPECT_EQ(-7, value(map.find(ASTInt(7))));
+  EXPECT_EQ(7, value(map.find(ASTString("seven"))));
+  for (int i = 0; i < 1000; i += 2) {
+    EXPECT_TRUE(map.remove(ASTInt(i)));
+  }
+  EXPECT_EQ(501u, map.size());
+  // the keys moved back into removed slots are still found
+  for (int i = 1; i < 1000; i += 2) {
+    ASSERT_NE(nullptr, map.find(ASTInt(i))) << i;
+    EXPECT_EQ(i == 7 ? -7 : i * 2, value(map.find(ASTInt(i))));
+    ASSERT_EQ(nullptr, map.find(ASTInt(i - 1))) << i - 1;
+  }
+  size_t count = 0;
+  map.forEach([&count](const std::shared_ptr<AST> &,
+                       const std::shared_ptr<AST> &) { count++; });
+  EXPECT_EQ(map.size(), count);
+}
+
+TEST(PersistentMap, setKeepsTheOriginal) {
+  PersistentMap empty;
+  const auto one = empty.set(integer(1), integer(10));
+  const auto two = one.set(integer(2), integer(20));
+  const auto replaced = two.set(integer(1), integer(11));
+  EXPECT_EQ(0u, empty.size());
+  EXPECT_EQ(1u, one.size());
+  EXPECT_EQ(2u, two.size());
+  EXPECT_EQ(2u, replaced.size());
+  EXPECT_EQ(10, value(two.find(ASTInt(1))));
+  EXPECT_EQ(11, value(replaced.find(ASTInt(1))));
+  EXPECT_EQ(nullptr, one.find(ASTInt(2)));
+  const auto removed = replaced.remove(ASTInt(1));
+  EXPECT_EQ(1u, removed.size());
+  EXPECT_EQ(nullptr, removed.find(ASTInt(1)));
+  EXPECT_EQ(11, value(replaced.find(ASTInt(1))));
+  EXPECT_EQ(1u, removed.remove(ASTInt(3)).size());
+  EXPECT_EQ(0u, removed.remove(ASTInt(2)).size());
+}
+
+TEST(PersistentMap, agreesWithStdMap) {
+  std::mt19937_64 random(42);
+  std::map<int64_t, int64_t> expected;
+  PersistentMap map;
+  HashMap transient;
+  for (int i = 0; i < 100000; i++) {
+    const int64_t key = random() % 20000;
+    if (random() % 4) {
+      expected[key] = i;
+      map = map.set(integer(key), integer(i));
+      transient.set(integer(key), integer(i));
+    } else {
+      expected.erase(key);
+      map = map.remove(ASTInt(key));
+      transient.remove(ASTInt(key));
+    }
+  }
+  ASSERT_EQ(expected.size(), map.size());
+  ASSERT_EQ(expected.size(), transient.size());
+  for (int64_t key = 0; key < 20000; key++) {
+    const auto it = expected.find(key);
+    if (it == expected.end()) {
+      EXPECT_EQ(nullptr, map.find(ASTInt(key)));
+      EXPECT_EQ(nullptr, transient.find(ASTInt(key)));
+    } else {
+      ASSERT_NE(nullptr, map.find(ASTInt(key)));
+      EXPECT_EQ(it->second, value(map.find(ASTInt(key))));
+      EXPECT_EQ(it->second, value(transient.find(ASTInt(key))));
+    }
+  }
+  size_t count = 0;
+  map.forEach([&count](const std::shared_ptr<AST> &,
+                       const std::shared_ptr<AST> &) { count++; });
+  EXPECT_EQ(expected.size(), count);
+  const PersistentMap built(transient);
+  ASSERT_EQ(expected.size(), built.size());
+  for (const auto &entry : expected) {
+    ASSERT_NE(nullptr, built.find(ASTInt(entry.first)));
+    EXPECT_EQ(entry.second, value(built.find(ASTInt(entry.first))));
+  }
+  // the built trie is changed like one made by set
+  EXPECT_EQ(expected.size() - 1,
+            built.remove(ASTInt(expected.begin()->first)).size());
+  EXPECT_EQ(nullptr, built.find(ASTInt(20000)));
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,126 @@
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "Heap.h"
+
+namespace {
+
+/// Counts live instances so tests can see what the collector released
+class Cell : public Object {
+public:
+  Cell() { count++; }
+  ~Cell() { count--; }
+  void trace(Heap &heap) const override {
+    for (const auto ref : refs)
+      heap.mark(ref);
+  }
+  size_t bytes() const override { return sizeof(Cell); }
+
+  std::vector<Cell *> refs;
+  static int count;
+};
+
+int Cell::count = 0;
+
+} // namespace
+
+class HeapTest : public ::testing::Test {
+protected:
+  void SetUp() override { Cell::count = 0; }
+};
+
+TEST_F(HeapTest, unreachableObjectsAreFreed) {
+  Heap heap;
+  heap.make<Cell>();
+  heap.make<Cell>();
+  EXPECT_EQ(2, Cell::count);
+  heap.collect();
+  EXPECT_EQ(0, Cell::count);
+  EXPECT_EQ(2, heap.stats().freed);
+  EXPECT_EQ(0, heap.stats().live);
+  EXPECT_EQ(0, heap.bytes());
+}
+
+TEST_F(HeapTest, rootStackKeepsObjectsAlive) {
+  Heap heap;
+  const auto cell = heap.make<Cell>();
+  {
+    Heap::Root root(heap, cell);
+    heap.collect();
+    EXPECT_EQ(1, Cell::count);
+  }
+  heap.collect();
+  EXPECT_EQ(0, Cell::count);
+}
+
+TEST_F(HeapTest, rootTracerKeepsObjectsAlive) {
+  Heap heap;
+  Cell *global = heap.make<Cell>();
+  heap.setRootTracer([&global](Heap &heap) { heap.mark(global); });
+  heap.collect();
+  EXPECT_EQ(1, Cell::count);
+  global = nullptr;
+  heap.collect();
+  EXPECT_EQ(0, Cell::count);
+}
+
+TEST_F(HeapTest, referencesAreTraced) {
+  Heap heap;
+  const auto a = heap.make<Cell>();
+  const auto b = heap.make<Cell>();
+  a->refs.push_back(b);
+  b->refs.push_back(heap.make<Cell>());
+  heap.make<Cell>();
+  Heap::Root root(heap, a);
+  heap.collect();
+  EXPECT_EQ(3, Cell::count);
+  EXPECT_EQ(3, heap.stats().live);
+  EXPECT_EQ(3 * sizeof(Cell), heap.stats().liveBytes);
+}
+
+TEST_F(HeapTest, cyclesAreFreed) {
+  Heap heap;
+  const auto a = heap.make<Cell>();
+  const auto b = heap.make<Cell>();
+  a->refs.push_back(b);
+  b->refs.push_back(a);
+  a->refs.push_back(a);
+  heap.collect();
+  EXPECT_EQ(0, Cell::count);
+}
+
+TEST_F(HeapTest, makeCollectsWhenHeapIsFull) {
+  Heap heap(10 * sizeof(Cell));
+  for (int i = 0; i < 100; i++) {
+    heap.make<Cell>();
+  }
+  EXPECT_LE(Cell::count, 11);
+  EXPECT_GT(heap.stats().collections, 0);
+  EXPECT_EQ(100, heap.stats().allocated);
+  EXPECT_EQ(10 * sizeof(Cell), heap.size());
+}
+
+TEST_F(HeapTest, heapGrowsWhenMostlyLive) {
+  Heap heap(4 * sizeof(Cell));
+  std::vector<std::unique_ptr<Heap::Root>> roots;
+  for (int i = 0; i < 32; i++) {
+    roots.emplace_back(new Heap::Root(heap, heap.make<Cell>()));
+  }
+  EXPECT_EQ(32, Cell::count);
+  EXPECT_GE(heap.size(), 32 * sizeof(Cell));
+}
+
+TEST_F(HeapTest, destructorFreesEverything) {
+  {
+    Heap heap;
+    const auto a = heap.make<Cell>();
+    Heap::Root root(heap, a);
+    a->refs.push_back(heap.make<Cell>());
+  }
+  EXPECT_EQ(0, Cell::count);
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -7,6 +7,11 @@
 #include "SyntaxError.h"
 #include "Util.h"
 
+// The suite is built once per engine, see test/CMakeLists.txt
+#ifndef TEST_ENGINE
+#define TEST_ENGINE Interpreter::Engine::TREE
+#endif
+
 class InterpreterTest : public ::testing::Test {
 
 protected:
@@ -20,22 +25,35 @@ protected:
   }
 
   std::shared_ptr<AST> eval() { return interpreter.eval(program); }
+
+  struct Printed {
+    const char *code;
+    const char *value;
+  };
+  /// Evaluate each code and expect its value to print as value
+  void expectPrinted(std::initializer_list<Printed> cases) {
+    for (const auto &c : cases) {
+      load(c.code);
+      EXPECT_EQ(c.value, eval()->toString()) << c.code;
+    }
+  }
+
   std::shared_ptr<AST> program;
-  Interpreter interpreter;
+  Interpreter interpreter{TEST_ENGINE};
 };
 
 TEST_F(InterpreterTest, minimal) {
   load("12");
   const auto res = eval();
   EXPECT_EQ(program->type(), res->type());
-  EXPECT_STREQ(program->toString(), res->toString());
+  EXPECT_EQ(program->toString(), res->toString());
 }
 
 TEST_F(InterpreterTest, minimalEmpty) {
   load("()");
   const auto res = eval();
   EXPECT_EQ(program->type(), res->type());
-  EXPECT_STREQ(program->toString(), res->toString());
+  EXPECT_EQ(program->toString(), res->toString());
 }
 
 TEST_F(InterpreterTest, minimalAdd) {
@@ -188,19 +206,19 @@ TEST_F(InterpreterTest, listBuiltin) {
   load("(list a b c)");
   const auto res = eval();
   ASSERT_NE(nullptr, res);
-  EXPECT_EQ(res->type(), AST::Type::BUILTIN);
-  EXPECT_TRUE(res->isBuiltin(Builtin::LIST));
-  EXPECT_EQ(res->children().size(), 3);
-  EXPECT_EQ(res->head()->type(), AST::Type::SYMBOL);
+  ASSERT_EQ(res->type(), AST::Type::LIST);
+  const auto &xs = std::static_pointer_cast<ASTList>(res)->data();
+  EXPECT_EQ(xs.size(), 3);
+  EXPECT_EQ(xs.front()->type(), AST::Type::SYMBOL);
+  EXPECT_EQ("(list a b c)", res->toString());
 }
 
 TEST_F(InterpreterTest, emptyList) {
   load("(list)");
   const auto res = eval();
   ASSERT_NE(nullptr, res);
-  EXPECT_EQ(res->type(), AST::Type::BUILTIN);
-  EXPECT_TRUE(res->isBuiltin(Builtin::LIST));
-  EXPECT_EQ(res->children().size(), 0);
+  ASSERT_EQ(res->type(), AST::Type::LIST);
+  EXPECT_TRUE(std::static_pointer_cast<ASTList>(res)->data().empty());
 }
 
 TEST_F(InterpreterTest, head) {
@@ -275,8 +293,8 @@ TEST_F(InterpreterTest, joinBuiltin) {
   load("(join (list a) (list b))");
   const auto res = eval();
   ASSERT_NE(nullptr, res);
-  EXPECT_TRUE(res->isBuiltin(Builtin::LIST)) << res->toString();
-  EXPECT_EQ(2, res->children().size()) << res->toString();
+  ASSERT_EQ(AST::Type::LIST, res->type()) << res->toString();
+  EXPECT_EQ("(list a b)", res->toString());
 }
 
 TEST_F(InterpreterTest, joinRequiresAtLeastTwo) {
@@ -292,8 +310,34 @@ TEST_F(InterpreterTest, joinManyLists) {
   load("(join (list a) (list b) (list c) (list d))");
   const auto res = eval();
   ASSERT_NE(nullptr, res);
-  EXPECT_TRUE(res->isBuiltin(Builtin::LIST)) << res->toString();
-  EXPECT_EQ(4, res->children().size()) << res->toString();
+  ASSERT_EQ(AST::Type::LIST, res->type()) << res->toString();
+  EXPECT_EQ("(list a b c d)", res->toString());
+}
+
+TEST_F(InterpreterTest, consAndRest) {
+  load("(cons (+ 1 2) (rest (list a b c)))");
+  const auto res = eval();
+  ASSERT_NE(nullptr, res);
+  EXPECT_EQ("(list 3 b c)", res->toString());
+  load("(rest (list a))");
+  EXPECT_EQ("(list)", eval()->toString());
+  for (const auto code :
+       {"(rest (list))", "(cons 1 2)", "(cons 1 (list) (list))"}) {
+    load(code);
+    EXPECT_THROW(eval(), SyntaxError) << code;
+  }
+}
+
+TEST_F(InterpreterTest, listBuiltAnElementAtATime) {
+  load("(define (build n acc) (if (= n 0) acc "
+       "(build (- n 1) (join acc (cons n (list))))))");
+  eval();
+  expectPrinted({
+      {"(head (build 1000 (list)))", "1000"},
+      {"(tail (build 1000 (list)))", "1"},
+      {"(head (rest (build 1000 (list))))", "999"},
+      {"(eval (join (list +) (rest (rest (rest (build 4 (list)))))))", "1"},
+  });
 }
 
 TEST_F(InterpreterTest, evalBuiltin) {
@@ -373,7 +417,7 @@ TEST_F(InterpreterTest, ifPrimitive) {
   const auto res = eval();
   ASSERT_NE(nullptr, res);
   const auto str = std::static_pointer_cast<ASTString>(res);
-  EXPECT_STREQ(str->data(), "false");
+  EXPECT_EQ("false", str->data().str());
 }
 
 TEST_F(InterpreterTest, ifPrimitiveTrue) {
@@ -381,7 +425,7 @@ TEST_F(InterpreterTest, ifPrimitiveTrue) {
   const auto res = eval();
   ASSERT_NE(nullptr, res);
   const auto str = std::static_pointer_cast<ASTString>(res);
-  EXPECT_STREQ(str->data(), "true");
+  EXPECT_EQ("true", str->data().str());
 }
 
 TEST_F(InterpreterTest, ifConstant) {
@@ -389,7 +433,7 @@ TEST_F(InterpreterTest, ifConstant) {
   const auto res = eval();
   ASSERT_NE(nullptr, res);
   const auto str = std::static_pointer_cast<ASTString>(res);
-  EXPECT_STREQ(str->data(), "true");
+  EXPECT_EQ("true", str->data().str());
 }
 
 
@@ -474,6 +518,641 @@ TEST_F(InterpreterTest, gtTrueInteger) {
   EXPECT_TRUE(str->data());
 }
 
+TEST_F(InterpreterTest, twoArgumentComparisons) {
+  const std::vector<std::pair<const char *, bool>> cases{
+      {"(= 2 2)", true},  {"(= 2 3)", false}, {"(> 3 2)", true},
+      {"(> 2 2)", false}, {"(>= 2 2)", true}, {"(>= 1 2)", false},
+      {"(< 1 2)", true},  {"(< 2 2)", false}, {"(<= 2 2)", true},
+      {"(<= 3 2)", false}};
+  for (const auto &c : cases) {
+    load(c.first);
+    const auto res = eval();
+    ASSERT_EQ(res->type(), AST::Type::BOOLEAN) << c.first;
+    EXPECT_EQ(c.second, std::static_pointer_cast<ASTBoolean>(res)->data())
+        << c.first;
+  }
+}
+
+TEST_F(InterpreterTest, twoArgumentComparisonOfMixedTypes) {
+  load("(< 1 \"hest\")");
+  EXPECT_THROW(eval(), SyntaxError);
+  load("(= \"hest\" 1)");
+  EXPECT_THROW(eval(), SyntaxError);
+}
+
+TEST_F(InterpreterTest, comparisonOfOneTypedOperand) {
+  load("(define (g x) (< x))");
+  eval();
+  load("(g 1)");
+  EXPECT_THROW(eval(), SyntaxError);
+  load("(< 1)");
+  EXPECT_THROW(eval(), SyntaxError);
+}
+
+TEST_F(InterpreterTest, secondOperandMustBeInteger) {
+  load("(+ 1 \"hest\")");
+  EXPECT_THROW(eval(), SyntaxError);
+}
+
+TEST_F(InterpreterTest, recursiveFunction) {
+  load("(define (fib x) (if (< x 2) x (+ (fib (- x 1)) (fib (- x 2)))))");
+  eval();
+  load("(fib 15)");
+  const auto res = eval();
+  ASSERT_NE(nullptr, res);
+  ASSERT_EQ(res->type(), AST::Type::INTEGER);
+  const auto i = std::static_pointer_cast<ASTInt>(res);
+  EXPECT_EQ(610, i->data());
+}
+
+TEST_F(InterpreterTest, framesAreCollectedDuringRecursion) {
+  interpreter.heap().setSize(1024);
+  load("(define (fib x) (if (< x 2) x (+ (fib (- x 1)) (fib (- x 2)))))");
+  eval();
+  load("(fib 15)");
+  const auto res = eval();
+  ASSERT_EQ(res->type(), AST::Type::INTEGER);
+  EXPECT_EQ(610, std::static_pointer_cast<ASTInt>(res)->data());
+  EXPECT_LE(interpreter.heap().bytes(), interpreter.heap().size());
+}
+
+TEST_F(InterpreterTest, returnedFramesAreReused) {
+  load("(define (fib x) (if (< x 2) x (+ (fib (- x 1)) (fib (- x 2)))))");
+  eval();
+  load("(fib 15)");
+  eval();
+  // one frame per level of recursion, not one per call
+  EXPECT_LE(interpreter.heap().stats().allocated, 20);
+  EXPECT_EQ(0, interpreter.heap().stats().collections);
+}
+
+TEST_F(InterpreterTest, tailCallsDoNotGrowTheHeap) {
+  interpreter.heap().setSize(1024);
+  load("(define (loop n acc) (if (= n 0) acc (loop (- n 1) (+ acc 1))))");
+  eval();
+  load("(loop 20000 0)");
+  const auto res = eval();
+  ASSERT_EQ(res->type(), AST::Type::INTEGER);
+  EXPECT_EQ(20000, std::static_pointer_cast<ASTInt>(res)->data());
+  EXPECT_EQ(1024, interpreter.heap().size());
+}
+
+TEST_F(InterpreterTest, functionArgsVisibleToListBuiltins) {
+  load("(define (last xs) (tail xs))");
+  eval();
+  load("(last (list 1 2 3))");
+  const auto res = eval();
+  ASSERT_NE(nullptr, res);
+  ASSERT_EQ(res->type(), AST::Type::INTEGER);
+  const auto i = std::static_pointer_cast<ASTInt>(res);
+  EXPECT_EQ(3, i->data());
+}
+TEST_F(InterpreterTest, tailCallInElseBranchRunsInConstantStack) {
+  load("(define (loop n acc) (if (= n 0) acc (loop (- n 1) (+ acc 1))))");
+  eval();
+  load("(loop 2000000 0)");
+  const auto res = eval();
+  ASSERT_NE(nullptr, res);
+  ASSERT_EQ(res->type(), AST::Type::INTEGER);
+  const auto i = std::static_pointer_cast<ASTInt>(res);
+  EXPECT_EQ(2000000, i->data());
+}
+
+TEST_F(InterpreterTest, tailCallInThenBranch) {
+  load("(define (down n) (if (> n 0) (down (- n 1)) n))");
+  eval();
+  load("(down 100000)");
+  const auto res = eval();
+  ASSERT_NE(nullptr, res);
+  ASSERT_EQ(res->type(), AST::Type::INTEGER);
+  const auto i = std::static_pointer_cast<ASTInt>(res);
+  EXPECT_EQ(0, i->data());
+}
+
+TEST_F(InterpreterTest, mutualTailCalls) {
+  load("(define (even n) (if (= n 0) true (odd (- n 1))))");
+  eval();
+  load("(define (odd n) (if (= n 0) false (even (- n 1))))");
+  eval();
+  load("(even 100001)");
+  const auto res = eval();
+  ASSERT_NE(nullptr, res);
+  ASSERT_EQ(res->type(), AST::Type::BOOLEAN);
+  const auto b = std::static_pointer_cast<ASTBoolean>(res);
+  EXPECT_FALSE(b->data());
+}
+TEST_F(InterpreterTest, wrongNumberOfArguments) {
+  load("(define (f a b) (+ a b))");
+  eval();
+  load("(f 1)");
+  EXPECT_THROW(eval(), SyntaxError);
+}
+
+TEST_F(InterpreterTest, argumentsAreNotVisibleToCallees) {
+  load("(define (g) y)");
+  eval();
+  load("(define (f y) (g))");
+  eval();
+  load("(f 1)");
+  EXPECT_THROW(eval(), SyntaxError);
+}
+
+TEST_F(InterpreterTest, argumentsVisibleToEvaluatedLists) {
+  load("(define (f x) (eval (list + x 1)))");
+  eval();
+  load("(f 2)");
+  const auto res = eval();
+  ASSERT_NE(nullptr, res);
+  ASSERT_EQ(res->type(), AST::Type::INTEGER);
+  const auto i = std::static_pointer_cast<ASTInt>(res);
+  EXPECT_EQ(3, i->data());
+}
+
+TEST_F(InterpreterTest, globalsSeenFromFunctions) {
+  load("(define (f x) (+ x y))");
+  eval();
+  load("(define y 2)");
+  eval();
+  load("(f 1)");
+  const auto res = eval();
+  ASSERT_NE(nullptr, res);
+  ASSERT_EQ(res->type(), AST::Type::INTEGER);
+  const auto i = std::static_pointer_cast<ASTInt>(res);
+  EXPECT_EQ(3, i->data());
+}
+
+TEST_F(InterpreterTest, callSitesAreCached) {
+  load("(define (fib n) (if (< n 2) n (+ (fib (- n 1)) (fib (- n 2)))))");
+  eval();
+  load("(fib 15)");
+  const auto res = eval();
+  ASSERT_EQ(res->type(), AST::Type::INTEGER);
+  EXPECT_EQ(610, std::static_pointer_cast<ASTInt>(res)->data());
+  EXPECT_GT(interpreter.callCacheStats().hitRate(), 0.9);
+}
+
+TEST_F(InterpreterTest, redefinitionInvalidatesCallSites) {
+  load("(define (f) 1)");
+  eval();
+  load("(define (g) (+ (f) 0))");
+  eval();
+  load("(g)");
+  EXPECT_EQ(1, std::static_pointer_cast<ASTInt>(eval())->data());
+  load("(define (f) 2)");
+  eval();
+  load("(g)");
+  EXPECT_EQ(2, std::static_pointer_cast<ASTInt>(eval())->data());
+}
+
+TEST_F(InterpreterTest, memoizedFunction) {
+  load("(define-memo (fib n) (if (< n 2) n (+ (fib (- n 1)) (fib (- n 2)))))");
+  eval();
+  load("(fib 40)");
+  const auto res = eval();
+  ASSERT_EQ(res->type(), AST::Type::INTEGER);
+  EXPECT_EQ(102334155, std::static_pointer_cast<ASTInt>(res)->data());
+  EXPECT_EQ(41, interpreter.memoStats().misses);
+  EXPECT_EQ(38, interpreter.memoStats().hits);
+}
+
+TEST_F(InterpreterTest, memoizedFunctionsMustBePure) {
+  load("(define-memo (f x) (pprint x))");
+  EXPECT_THROW(eval(), SyntaxError);
+  load("(define-memo (f x) (define y x))");
+  EXPECT_THROW(eval(), SyntaxError);
+  load("(define-memo (f x) (eval (list + x 1)))");
+  EXPECT_THROW(eval(), SyntaxError);
+  load("(define-memo f 1)");
+  EXPECT_THROW(eval(), SyntaxError);
+  load("(define-memo (mk n) (transient (hash)))");
+  EXPECT_THROW(eval(), SyntaxError);
+  load("(define-memo (f t) (hash-set t 1 2))");
+  EXPECT_THROW(eval(), SyntaxError);
+  load("(define-memo (f t) (hash-remove t 1))");
+  EXPECT_THROW(eval(), SyntaxError);
+}
+
+TEST_F(InterpreterTest, transientResultsAreNotMemoized) {
+  // the body calls a function making one, which is not checked
+  load("(define (empty) (transient (hash)))");
+  eval();
+  load("(define-memo (mk n) (empty))");
+  eval();
+  load("(hash-set (mk 1) 1 2)");
+  eval();
+  load("(hash-size (mk 1))");
+  EXPECT_EQ(0, std::static_pointer_cast<ASTInt>(eval())->data());
+  EXPECT_EQ(0, interpreter.memoStats().hits);
+  EXPECT_EQ(2, interpreter.memoStats().misses);
+}
+
+TEST_F(InterpreterTest, memoEvictsBeyondCapacity) {
+  interpreter.setMemoCapacity(2);
+  load("(define-memo (sq x) (* x x))");
+  eval();
+  for (const auto code : {"(sq 1)", "(sq 2)", "(sq 3)", "(sq 1)"}) {
+    load(code);
+    eval();
+  }
+  EXPECT_EQ(0, interpreter.memoStats().hits);
+  EXPECT_EQ(2, interpreter.memoStats().evictions);
+  load("(sq 1)");
+  EXPECT_EQ(1, std::static_pointer_cast<ASTInt>(eval())->data());
+  EXPECT_EQ(1, interpreter.memoStats().hits);
+}
+
+TEST_F(InterpreterTest, redefinitionDropsMemo) {
+  load("(define-memo (f x) (+ x 1))");
+  eval();
+  load("(f 1)");
+  EXPECT_EQ(2, std::static_pointer_cast<ASTInt>(eval())->data());
+  load("(define-memo (f x) (+ x 2))");
+  eval();
+  load("(f 1)");
+  EXPECT_EQ(3, std::static_pointer_cast<ASTInt>(eval())->data());
+  EXPECT_EQ(0, interpreter.memoStats().hits);
+}
+
+TEST_F(InterpreterTest, fixnumsOverflowToBignums) {
+  load("(* 9223372036854775807 2)");
+  auto res = eval();
+  ASSERT_EQ(AST::Type::BIGNUM, res->type());
+  EXPECT_EQ("18446744073709551614", res->toString());
+  // results that fit are fixnums again
+  load("(- (* 9223372036854775807 2) 9223372036854775807)");
+  res = eval();
+  ASSERT_EQ(AST::Type::INTEGER, res->type());
+  EXPECT_EQ(INT64_MAX, std::static_pointer_cast<ASTInt>(res)->data());
+  load("(- -9223372036854775807 1 1)");
+  EXPECT_EQ("-9223372036854775809", eval()->toString());
+}
+
+TEST_F(InterpreterTest, largeResults) {
+  load("(define (fib-iter a b count) (if (= count 0) b "
+       "(fib-iter (+ a b) a (- count 1))))");
+  eval();
+  load("(fib-iter 1 0 47)");
+  auto res = eval();
+  ASSERT_EQ(AST::Type::INTEGER, res->type());
+  EXPECT_EQ(2971215073, std::static_pointer_cast<ASTInt>(res)->data());
+  load("(define (fac n) (if (= n 0) 1 (* n (fac (- n 1)))))");
+  eval();
+  load("(fac 25)");
+  EXPECT_EQ("15511210043330985984000000", eval()->toString());
+  load("(/ (fac 25) (fac 24))");
+  res = eval();
+  ASSERT_EQ(AST::Type::INTEGER, res->type());
+  EXPECT_EQ(25, std::static_pointer_cast<ASTInt>(res)->data());
+  load("(% (- 0 (fac 25)) 1000000007)");
+  EXPECT_EQ("-440732388", eval()->toString());
+}
+
+TEST_F(InterpreterTest, bignumLiterals) {
+  load("100000000000000000000");
+  const auto res = eval();
+  ASSERT_EQ(AST::Type::BIGNUM, res->type());
+  EXPECT_EQ("100000000000000000000", res->toString());
+  load("(< 1 100000000000000000000 100000000000000000001)");
+  EXPECT_TRUE(std::static_pointer_cast<ASTBoolean>(eval())->data());
+  load("(= 100000000000000000000 100000000000000000000)");
+  EXPECT_TRUE(std::static_pointer_cast<ASTBoolean>(eval())->data());
+  load("(= 100000000000000000000 1)");
+  EXPECT_FALSE(std::static_pointer_cast<ASTBoolean>(eval())->data());
+  load("(< 100000000000000000000 \"a\")");
+  EXPECT_THROW(eval(), SyntaxError);
+}
+
+TEST_F(InterpreterTest, divisionByZero) {
+  load("(/ 1 0)");
+  EXPECT_THROW(eval(), SyntaxError);
+  load("(% 100000000000000000000 0)");
+  EXPECT_THROW(eval(), SyntaxError);
+  load("(/ -9223372036854775808 -1)");
+  EXPECT_EQ("9223372036854775808", eval()->toString());
+  load("(% -9223372036854775808 -1)");
+  EXPECT_EQ("0", eval()->toString());
+}
+
+TEST_F(InterpreterTest, floats) {
+  load("(+ 1 2.5)");
+  auto res = eval();
+  ASSERT_EQ(AST::Type::FLOAT, res->type());
+  EXPECT_EQ(3.5, std::static_pointer_cast<ASTFloat>(res)->data());
+  load("(* 0.1 3)");
+  EXPECT_EQ("0.30000000000000004", eval()->toString());
+  load("(- 3.0 1)");
+  EXPECT_EQ("2.0", eval()->toString());
+  load("(% 7.5 2)");
+  EXPECT_EQ("1.5", eval()->toString());
+  load("(+ 100000000000000000000 0.5)");
+  EXPECT_EQ("1e+20", eval()->toString());
+  // IEEE division
+  load("(/ 1.0 0)");
+  EXPECT_EQ("inf", eval()->toString());
+  load("(/ 7 2.0)");
+  EXPECT_EQ("3.5", eval()->toString());
+  load("(+ 1.5 \"a\")");
+  EXPECT_THROW(eval(), SyntaxError);
+}
+
+TEST_F(InterpreterTest, floatComparison) {
+  load("(< 1 1.5 2)");
+  EXPECT_TRUE(std::static_pointer_cast<ASTBoolean>(eval())->data());
+  load("(= 1 1.0)");
+  EXPECT_TRUE(std::static_pointer_cast<ASTBoolean>(eval())->data());
+  load("(> 0.5 100000000000000000000)");
+  EXPECT_FALSE(std::static_pointer_cast<ASTBoolean>(eval())->data());
+  load("(if 0.0 1 2)");
+  EXPECT_EQ(2, std::static_pointer_cast<ASTInt>(eval())->data());
+}
+
+TEST_F(InterpreterTest, floatLoop) {
+  load("(define (sum n acc) (if (= n 0) acc (sum (- n 1) (+ acc 0.25))))");
+  eval();
+  load("(sum 100 0)");
+  EXPECT_EQ("25.0", eval()->toString());
+}
+
+TEST_F(InterpreterTest, arrays) {
+  load("(array 1 2 3)");
+  auto res = eval();
+  ASSERT_EQ(AST::Type::ARRAY, res->type());
+  EXPECT_EQ("(array 1 2 3)", res->toString());
+  load("(array 1 2.5)");
+  EXPECT_EQ("(array 1.0 2.5)", eval()->toString());
+  load("(array-get (make-array 5 7) 4)");
+  EXPECT_EQ(7, std::static_pointer_cast<ASTInt>(eval())->data());
+  load("(array-slice (array 1 2 3 4 5) 1 4)");
+  EXPECT_EQ("(array 2 3 4)", eval()->toString());
+  load("(array-length (array-slice (array 1 2 3) 3 3))");
+  EXPECT_EQ(0, std::static_pointer_cast<ASTInt>(eval())->data());
+  load("(array-get (array 1 2 3) 3)");
+  EXPECT_THROW(eval(), SyntaxError);
+  load("(array-slice (array 1 2 3) 2 1)");
+  EXPECT_THROW(eval(), SyntaxError);
+  load("(array 1 \"a\")");
+  EXPECT_THROW(eval(), SyntaxError);
+  load("(array-length (list 1 2))");
+  EXPECT_THROW(eval(), SyntaxError);
+}
+
+TEST_F(InterpreterTest, arrayArithmetic) {
+  load("(+ (array 1 2 3 4 5) (array 10 20 30 40 50) 1)");
+  EXPECT_EQ("(array 12 23 34 45 56)", eval()->toString());
+  load("(- 10 (array 1 2))");
+  EXPECT_EQ("(array 9 8)", eval()->toString());
+  load("(* (array 1 2) 0.5)");
+  EXPECT_EQ("(array 0.5 1.0)", eval()->toString());
+  load("(/ (array 1.0 -1.0) 0)");
+  EXPECT_EQ("(array inf -inf)", eval()->toString());
+  load("(% (array 7 8) 3)");
+  EXPECT_EQ("(array 1 2)", eval()->toString());
+  // integer arrays do not promote
+  load("(* (array 9223372036854775807) 2)");
+  EXPECT_THROW(eval(), SyntaxError);
+  load("(/ (array 1) 0)");
+  EXPECT_THROW(eval(), SyntaxError);
+  load("(+ (array 1 2) (array 1 2 3))");
+  EXPECT_THROW(eval(), SyntaxError);
+  load("(< (array 1) (array 2))");
+  EXPECT_THROW(eval(), SyntaxError);
+  load("(if (array) 1 2)");
+  EXPECT_EQ(2, std::static_pointer_cast<ASTInt>(eval())->data());
+}
+
+TEST_F(InterpreterTest, arraysInFunctions) {
+  load("(define (sum xs i acc) (if (= i (array-length xs)) acc "
+       "(sum xs (+ i 1) (+ acc (array-get xs i)))))");
+  eval();
+  load("(sum (* (make-array 100 3) (make-array 100 2.0)) 0 0)");
+  EXPECT_EQ("600.0", eval()->toString());
+  // the argument of a typed function may be an array
+  load("(define (twice x) (* x 2))");
+  eval();
+  load("(twice (array 1 2))");
+  EXPECT_EQ("(array 2 4)", eval()->toString());
+}
+
+TEST_F(InterpreterTest, hashMaps) {
+  load("(define (squares n m) (if (= n 0) m "
+       "(squares (- n 1) (hash-set m n (* n n)))))");
+  eval();
+  expectPrinted({
+      {"(hash-get (squares 100 (hash)) 12)", "144"},
+      {"(hash-size (squares 100 (hash)))", "100"},
+      {"(hash-get (hash \"a\" 1 2.5 (+ 1 1)) 2.5)", "2"},
+      {"(hash-get (hash 1 1) 2 false)", "false"},
+      {"(hash-size (hash-remove (squares 3 (hash)) 2))", "2"},
+      {"(hash-keys (hash-remove (hash 1 2) 1))", "(list)"},
+      {"(hash-values (hash 1 (list a)))", "(list (list a))"},
+      {"(hash-size (hash 1 1 1 2))", "1"},
+      {"(hash-get (hash (head (list a)) 1) (head (list a)))", "1"},
+  });
+  for (const auto code : {"(hash 1)", "(hash-get (hash 1 1) 2)",
+                          "(hash-get (list) 1)", "(hash (list) 1)",
+                          "(hash-set (hash) 1)"}) {
+    load(code);
+    EXPECT_THROW(eval(), SyntaxError) << code;
+  }
+}
+
+TEST_F(InterpreterTest, transientMaps) {
+  load("(define (fill n m) (if (= n 0) m (fill (- n 1) (hash-set m n n))))");
+  eval();
+  load("(hash-size (persistent (fill 1000 (transient (hash 0 0)))))");
+  EXPECT_EQ("1001", eval()->toString());
+  load("(hash-get (transient (hash 1 2)) 1)");
+  EXPECT_EQ("2", eval()->toString());
+  // a transient is changed in place, a persistent map is not
+  load("(define (sizes m) (+ (* 10 (hash-size (hash-remove (fill 5 m) 1))) "
+       "(hash-size m)))");
+  eval();
+  load("(sizes (transient (hash 1 1)))");
+  EXPECT_EQ("44", eval()->toString());
+  load("(sizes (hash 1 1))");
+  EXPECT_EQ("41", eval()->toString());
+}
+
+TEST_F(InterpreterTest, transientsAreNotStoredInTransients) {
+  load("(define (self t) (hash-set t 1 t))");
+  eval();
+  load("(self (transient (hash)))");
+  EXPECT_THROW(eval(), SyntaxError);
+  load("(hash-set (transient (hash)) 1 (transient (hash)))");
+  EXPECT_THROW(eval(), SyntaxError);
+  load("(hash-set (transient (hash)) (transient (hash)) 1)");
+  EXPECT_THROW(eval(), SyntaxError);
+}
+
+TEST_F(InterpreterTest, transientsAreNotNestedInTransients) {
+  for (const auto code : {
+           "(define (inMap t) (hash-set t 1 (hash 2 t)))",
+           "(define (inList t) (hash-set t 1 (cons t (list))))",
+           "(define (deeper t) (hash-set t 1 "
+           "(cons 1 (cons (hash 2 (cons (hash 3 t) (list))) (list)))))",
+           "(define (id x) x)",
+           "(define (inFuture t) (hash-set t 1 (spawn (id t))))",
+       }) {
+    load(code);
+    eval();
+  }
+  interpreter.setThreads(2);
+  for (const auto code :
+       {"(inMap (transient (hash)))", "(inList (transient (hash)))",
+        "(deeper (transient (hash)))", "(inFuture (transient (hash)))"}) {
+    load(code);
+    EXPECT_THROW(eval(), SyntaxError) << code;
+  }
+  // their persistent copies are values like any other
+  load("(hash-size (hash-get (hash-set (transient (hash)) 1 "
+       "(persistent (transient (hash 2 2)))) 1))");
+  EXPECT_EQ("1", eval()->toString());
+  load("(hash-get (hash-set (transient (hash)) 1 "
+       "(cons (hash 2 (cons 3 (list))) (list))) 1)");
+  EXPECT_EQ("(list (hash 2 (list 3)))", eval()->toString());
+}
+
+TEST_F(InterpreterTest, strings) {
+  load("(define (repeat s n acc) (if (= n 0) acc "
+       "(repeat s (- n 1) (concat acc s))))");
+  eval();
+  expectPrinted({
+      {"(concat \"ab\" \"\" \"cd\")", "\"abcd\""},
+      {"(string-length (repeat \"abc\" 1000 \"\"))", "3000"},
+      {"(substring (repeat \"abc\" 1000 \"\") 2998 3000)", "\"bc\""},
+      {"(substring \"abc\" 1 1)", "\"\""},
+      {"(string->list \"ab\")", "(list \"a\" \"b\")"},
+      {"(= (repeat \"ab\" 100 \"\") "
+       "(concat (repeat \"a\" 1 \"\") "
+       "(repeat \"ba\" 99 \"\") \"b\"))",
+       "true"},
+  });
+  for (const auto code : {"(concat \"a\" 1)", "(substring \"abc\" 2 1)",
+                          "(substring \"abc\" 0 4)", "(string-length 1)"}) {
+    load(code);
+    EXPECT_THROW(eval(), SyntaxError) << code;
+  }
+}
+
+TEST_F(InterpreterTest, parallelMapFilterReduce) {
+  for (const auto code : {
+           "(define (upto n acc) (if (= n 0) acc (upto (- n 1) (cons n acc))))",
+           "(define (square x) (* x x))",
+           "(define (odd x) (= 1 (% x 2)))",
+           "(define (single x) (cons x (list)))",
+       }) {
+    load(code);
+    eval();
+  }
+  interpreter.setSerialCutoff(0);
+  for (const unsigned threads : {1, 4}) {
+    interpreter.setThreads(threads);
+    SCOPED_TRACE(threads);
+    expectPrinted({
+        {"(pmap square (list 1 2 3))", "(list 1 4 9)"},
+        {"(pfilter odd (list 1 2 3))", "(list 1 3)"},
+        {"(pmap square (list))", "(list)"},
+        {"(preduce + 5 (list))", "5"},
+        {"(preduce + 0 (pmap square (upto 1000 (list))))", "333833500"},
+        {"(preduce + 0 (pfilter odd (upto 1000 (list))))", "250000"},
+        {"(preduce join (list) (pmap single (upto 100 (list))))",
+         "(list 1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16 17 18 19 20 "
+         "21 22 23 24 25 26 27 28 29 30 31 32 33 34 35 36 37 38 39 "
+         "40 41 42 43 44 45 46 47 48 49 50 51 52 53 54 55 56 57 58 "
+         "59 60 61 62 63 64 65 66 67 68 69 70 71 72 73 74 75 76 77 "
+         "78 79 80 81 82 83 84 85 86 87 88 89 90 91 92 93 94 95 96 "
+         "97 98 99 100)"},
+    });
+    for (const auto code : {"(pmap 1 (list 1))", "(pmap square 1)",
+                            "(pmap upto (list 1))",
+                            "(pmap square (list 1 (list 2)))"}) {
+      load(code);
+      EXPECT_THROW(eval(), SyntaxError) << code << threads;
+    }
+  }
+  // the workers see definitions made after they started
+  load("(define (square x) (+ x x))");
+  eval();
+  load("(pmap square (list 1 2 3))");
+  EXPECT_EQ("(list 2 4 6)", eval()->toString());
+  for (const auto code : {"(define (defines x) (define y x))",
+                          "(define (prints x) (pprint x))"}) {
+    load(code);
+    eval();
+  }
+  for (const auto code : {"(pmap defines (list 1 2))",
+                          "(pmap prints (list 1 2))"}) {
+    load(code);
+    EXPECT_THROW(eval(), SyntaxError) << code;
+  }
+}
+
+TEST_F(InterpreterTest, serialReduceIsALeftFold) {
+  load("(define (push acc x) (cons x acc))");
+  eval();
+  // below the serial cutoff with several threads too
+  for (const unsigned threads : {1, 4}) {
+    interpreter.setThreads(threads);
+    load("(preduce - 0 (list 1 2 3))");
+    EXPECT_EQ("-6", eval()->toString()) << threads;
+    load("(preduce push (list) (list 1 2 3))");
+    EXPECT_EQ("(list 3 2 1)", eval()->toString()) << threads;
+  }
+}
+
+TEST_F(InterpreterTest, spawnSync) {
+  for (const auto code : {
+           "(define (fib x) (if (< x 2) x (+ (fib (- x 1)) (fib (- x 2)))))",
+           "(define (join2 a b) (+ (sync a) b))",
+           "(define (pfib x) (if (< x 10) (fib x) "
+           "(join2 (spawn (pfib (- x 1))) (pfib (- x 2)))))",
+           "(define (twice f x) (f (f x)))",
+           "(define (inc x) (+ x 1))",
+           "(define (fails x) (+ x \"a\"))",
+       }) {
+    load(code);
+    eval();
+  }
+  for (const unsigned threads : {1, 4}) {
+    interpreter.setThreads(threads);
+    SCOPED_TRACE(threads);
+    expectPrinted({
+        {"(pfib 20)", "6765"},
+        {"(sync (spawn (fib 15)))", "610"},
+        {"(sync (spawn (twice inc 1)))", "3"},
+        {"(sync (spawn (+ 1 2)))", "3"},
+        {"(sync 5)", "5"},
+        {"(spawn 5)", "5"},
+    });
+    for (const auto code : {"(sync (spawn (fails 1)))",
+                            "(sync (spawn (fib 1 2)))",
+                            "(sync (spawn (1 2)))"}) {
+      load(code);
+      EXPECT_THROW(eval(), SyntaxError) << code << threads;
+    }
+  }
+  ASSERT_NE(nullptr, interpreter.scheduler());
+  EXPECT_EQ(4u, interpreter.scheduler()->threads());
+  EXPECT_GT(interpreter.scheduler()->stats().tasks, 0u);
+  // queued with no other task queued
+  load("(spawn (fib 1))");
+  EXPECT_EQ(AST::Type::FUTURE, eval()->type());
+  // the workers see definitions made after they started
+  load("(define (inc x) (+ x 2))");
+  eval();
+  load("(sync (spawn (twice inc 1)))");
+  EXPECT_EQ("5", eval()->toString());
+  for (const auto code : {"(define (defines x) (define y x))",
+                          "(define (prints x) (pprint x))"}) {
+    load(code);
+    eval();
+  }
+  for (const auto code : {"(sync (spawn (defines 1)))",
+                          "(sync (spawn (prints 1)))"}) {
+    load(code);
+    EXPECT_THROW(eval(), SyntaxError) << code;
+  }
+}
 
 int main(int argc, char **argv) {
   testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,129 @@
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "Interpreter.h"
+#include "Lexer.h"
+#include "Parser.h"
+#include "SyntaxError.h"
+
+// Compiled functions must give the results of the interpreter, the suite
+// runs on both engines with every function compiled on its first call
+class JitTest : public ::testing::TestWithParam<Interpreter::Engine> {
+
+protected:
+  void SetUp() override {
+    if (!Jit::supported())
+      GTEST_SKIP();
+    interpreter.setEngine(GetParam());
+    interpreter.enableJit(1);
+  }
+
+  std::shared_ptr<AST> eval(const char *code) {
+    Lexer l(code);
+    Parser p(l);
+    std::shared_ptr<AST> res;
+    for (const auto &e : p.read()) {
+      res = interpreter.eval(e);
+    }
+    return res;
+  }
+
+  int64_t integer(const char *code) {
+    const auto res = eval(code);
+    EXPECT_EQ(AST::Type::INTEGER, res->type());
+    return std::static_pointer_cast<ASTInt>(res)->data();
+  }
+
+  const Jit::Stats &stats() { return interpreter.jit()->stats(); }
+
+  Interpreter interpreter;
+};
+
+TEST_P(JitTest, recursiveFunction) {
+  eval("(define (fib x) (if (< x 2) x (+ (fib (- x 1)) (fib (- x 2)))))");
+  EXPECT_EQ(6765, integer("(fib 20)"));
+  EXPECT_EQ(1, stats().compiled);
+  EXPECT_EQ(1, stats().nativeCalls);
+}
+
+TEST_P(JitTest, arithmetic) {
+  eval("(define (f a b c) (- (* a (+ b c 1)) (/ a b) (% c 4) a))");
+  EXPECT_EQ(7 * 12 - 7 / 3 - 8 % 4 - 7, integer("(f 7 3 8)"));
+  EXPECT_EQ(-7 * 0 - -7 / -3 - 2 % 4 - -7, integer("(f -7 -3 2)"));
+  EXPECT_EQ(2, stats().nativeCalls);
+}
+
+TEST_P(JitTest, comparisons) {
+  eval("(define (f a b) (if (< a b 10) 1 (if (>= a b b) 2 (if (= a b) 3 4))))");
+  EXPECT_EQ(1, integer("(f 1 2)"));
+  EXPECT_EQ(2, integer("(f 5 2)"));
+  EXPECT_EQ(4, integer("(f 9 10)"));
+  eval("(define (lt a b) (< a b))");
+  const auto res = eval("(lt 1 2)");
+  ASSERT_EQ(AST::Type::BOOLEAN, res->type());
+  EXPECT_TRUE(std::static_pointer_cast<ASTBoolean>(res)->data());
+}
+
+TEST_P(JitTest, tailCallsRunInConstantStack) {
+  eval("(define (loop n acc) (if (= n 0) acc (loop (- n 1) (+ acc 1))))");
+  EXPECT_EQ(2000000, integer("(loop 2000000 0)"));
+  EXPECT_EQ(0, stats().bailouts);
+}
+
+TEST_P(JitTest, callsOtherFunctions) {
+  eval("(define (sq x) (* x x))"
+       "(define (even n) (if (= n 0) true (odd (- n 1))))"
+       "(define (odd n) (if (= n 0) false (even (- n 1))))"
+       "(define (f x) (if (even x) (sq x) 0))");
+  EXPECT_EQ(100, integer("(f 10)"));
+  EXPECT_EQ(0, integer("(f 9)"));
+}
+
+TEST_P(JitTest, otherTypesAreLeftToTheInterpreter) {
+  eval("(define (f x) (+ x 1))");
+  EXPECT_THROW(eval("(f true)"), SyntaxError);
+  eval("(define (g x) (head x))");
+  EXPECT_EQ(1, integer("(g (list 1 2))"));
+  EXPECT_EQ(1, stats().rejected);
+}
+
+TEST_P(JitTest, bailsOutOfDeepRecursion) {
+  eval("(define (deep n) (if (= n 0) 0 (+ 1 (deep (- n 1)))))");
+  EXPECT_EQ(20000, integer("(deep 20000)"));
+  EXPECT_LE(1, stats().bailouts);
+  EXPECT_GE(5, stats().bailouts);
+}
+
+TEST_P(JitTest, overflowBailsOut) {
+  eval("(define (sq x) (* x x))");
+  EXPECT_EQ(int64_t(1) << 62, integer("(sq 2147483648)"));
+  EXPECT_EQ(0, stats().bailouts);
+  const auto res = eval("(sq 4294967296)");
+  ASSERT_EQ(AST::Type::BIGNUM, res->type());
+  EXPECT_EQ("18446744073709551616", res->toString());
+  EXPECT_EQ(1, stats().bailouts);
+}
+
+TEST_P(JitTest, divisionByZeroBailsOut) {
+  eval("(define (f a b) (/ a b))");
+  EXPECT_EQ(-3, integer("(f -7 2)"));
+  EXPECT_THROW(eval("(f 1 0)"), SyntaxError);
+  EXPECT_EQ(1, stats().bailouts);
+}
+
+TEST_P(JitTest, redefinitionDropsCode) {
+  eval("(define (g) 1)(define (f) (g))");
+  EXPECT_EQ(1, integer("(f)"));
+  eval("(define (g) 2)");
+  EXPECT_EQ(2, integer("(f)"));
+  EXPECT_EQ(1, stats().flushes);
+}
+
+INSTANTIATE_TEST_CASE_P(Engines, JitTest,
+                        ::testing::Values(Interpreter::Engine::TREE,
+                                          Interpreter::Engine::BYTECODE));
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -70,6 +70,15 @@ TEST(lexer, SymbolList) {
   ASSERT_EQ(Lexer::TokenType::TOKEN_EOF, l.nextToken());
 }
 
+TEST(lexer, symbolIsInterned) {
+  Lexer l("hest hest");
+  ASSERT_EQ(Lexer::TokenType::SYMBOL, l.nextToken());
+  const auto first = l.symbol();
+  ASSERT_EQ(Lexer::TokenType::SYMBOL, l.nextToken());
+  EXPECT_EQ(first, l.symbol());
+  EXPECT_STREQ("hest", SymbolTable::name(first));
+}
+
 TEST(lexer, integer) {
   const auto str = "123";
   Lexer l(str);
@@ -88,6 +97,19 @@ TEST(lexer, negativeInteger) {
   ASSERT_EQ(Lexer::TokenType::TOKEN_EOF, l.nextToken());
 }
 
+TEST(lexer, floating) {
+  const auto str = "1.5 -2e3 .5";
+  Lexer l(str);
+  ASSERT_EQ(Lexer::TokenType::FLOAT, l.nextToken());
+  ASSERT_STREQ(l.string(), "1.5");
+  ASSERT_EQ(l.floating(), 1.5);
+  ASSERT_EQ(Lexer::TokenType::FLOAT, l.nextToken());
+  ASSERT_EQ(l.floating(), -2000.0);
+  // a number starts with a digit
+  ASSERT_EQ(Lexer::TokenType::SYMBOL, l.nextToken());
+  ASSERT_EQ(Lexer::TokenType::TOKEN_EOF, l.nextToken());
+}
+
 TEST(lexer, location) {
   const auto str = "1";
   Lexer l(str);
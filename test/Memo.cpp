@@ -0,0 +1,57 @@
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "Memo.h"
+
+TEST(MemoTest, findsInsertedResult) {
+  Memo memo;
+  memo.insert({Value::integer(1), Value::boolean(true)}, Value::integer(3));
+  Value res;
+  ASSERT_TRUE(memo.find({Value::integer(1), Value::boolean(true)}, res));
+  EXPECT_EQ(3, res.integer());
+  EXPECT_FALSE(memo.find({Value::integer(1), Value::boolean(false)}, res));
+  EXPECT_FALSE(memo.find({Value::integer(1)}, res));
+}
+
+TEST(MemoTest, comparesStringsByValue) {
+  Memo memo;
+  memo.insert({std::make_shared<ASTString>("abc")}, Value::integer(1));
+  Value res;
+  EXPECT_TRUE(memo.find({std::make_shared<ASTString>("abc")}, res));
+  EXPECT_FALSE(memo.find({std::make_shared<ASTString>("abd")}, res));
+}
+
+TEST(MemoTest, evictsLeastRecentlyUsed) {
+  Memo memo(2);
+  EXPECT_FALSE(memo.insert({Value::integer(1)}, Value::integer(1)));
+  EXPECT_FALSE(memo.insert({Value::integer(2)}, Value::integer(2)));
+  Value res;
+  EXPECT_TRUE(memo.find({Value::integer(1)}, res));
+  EXPECT_TRUE(memo.insert({Value::integer(3)}, Value::integer(3)));
+  EXPECT_EQ(2, memo.size());
+  EXPECT_TRUE(memo.find({Value::integer(1)}, res));
+  EXPECT_FALSE(memo.find({Value::integer(2)}, res));
+  EXPECT_TRUE(memo.find({Value::integer(3)}, res));
+}
+
+TEST(MemoTest, onlyAtomsAreCacheable) {
+  const Value atoms[] = {Value::integer(1), Value::boolean(false),
+                         std::make_shared<ASTString>("a")};
+  EXPECT_TRUE(Memo::cacheable(atoms, 3));
+  const Value list[] = {std::make_shared<ASTBuiltin>(Builtin::LIST)};
+  EXPECT_FALSE(Memo::cacheable(list, 1));
+}
+
+TEST(MemoTest, transientMapsAreNotCached) {
+  Memo memo;
+  EXPECT_FALSE(memo.insert({Value::integer(1)},
+                           std::make_shared<ASTTransientMap>(HashMap())));
+  Value res;
+  EXPECT_FALSE(memo.find({Value::integer(1)}, res));
+  EXPECT_EQ(0u, memo.size());
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,94 @@
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "Lexer.h"
+#include "Optimizer.h"
+#include "Parser.h"
+
+class OptimizerTest : public ::testing::Test {
+
+protected:
+  AST::List optimize(const char *code) {
+    Lexer l(code);
+    Parser p(l);
+    program = p.read();
+    return optimizer.optimize(program);
+  }
+
+  static int integer(const std::shared_ptr<AST> &node) {
+    EXPECT_EQ(AST::Type::INTEGER, node->type());
+    return std::static_pointer_cast<ASTInt>(node)->data();
+  }
+
+  AST::List program;
+  Optimizer optimizer;
+};
+
+TEST_F(OptimizerTest, foldsArithmetic) {
+  const auto res = optimize("(* 10 (+ 1 2 (/ 10 3)) (% 10 6))");
+  ASSERT_EQ(1, res.size());
+  EXPECT_EQ(240, integer(res[0]));
+  EXPECT_EQ(4, optimizer.stats().folded);
+}
+
+TEST_F(OptimizerTest, foldsLeadingOperands) {
+  const auto res = optimize("(- 10 2 3 x 4)");
+  const auto &ls = res[0]->children();
+  ASSERT_EQ(4, ls.size());
+  EXPECT_TRUE(ls[0]->isBuiltin(Builtin::SUB));
+  EXPECT_EQ(5, integer(ls[1]));
+  EXPECT_EQ(AST::Type::SYMBOL, ls[2]->type());
+  EXPECT_EQ(4, integer(ls[3]));
+}
+
+TEST_F(OptimizerTest, divisionByZeroIsLeftToRuntime) {
+  const auto res = optimize("(/ 1 0)");
+  EXPECT_EQ(program[0], res[0]);
+}
+
+TEST_F(OptimizerTest, foldsComparisons) {
+  const auto res = optimize("(< 1 2 3)");
+  ASSERT_EQ(AST::Type::BOOLEAN, res[0]->type());
+  EXPECT_TRUE(std::static_pointer_cast<ASTBoolean>(res[0])->data());
+}
+
+TEST_F(OptimizerTest, prunesIfWithLiteralPredicate) {
+  const auto res = optimize("(if (> 1 2) x (+ y 1))");
+  ASSERT_EQ(3, res[0]->children().size());
+  EXPECT_EQ(1, optimizer.stats().pruned);
+}
+
+TEST_F(OptimizerTest, propagatesConstants) {
+  const auto res = optimize("(define x 5)(define (f y) (+ x y))(+ x 1)");
+  EXPECT_EQ(program[0], res[0]);
+  EXPECT_EQ(5, integer(res[1]->children()[2]->children()[1]));
+  EXPECT_EQ(6, integer(res[2]));
+  EXPECT_EQ(2, optimizer.stats().propagated);
+}
+
+TEST_F(OptimizerTest, argumentsShadowConstants) {
+  const auto res = optimize("(define x 5)(define (f x) (+ x 1))");
+  EXPECT_EQ(program[1], res[1]);
+}
+
+TEST_F(OptimizerTest, redefinedNamesAreNotConstants) {
+  auto res = optimize("(define x 5)(define (f) (define x 6))(+ x 1)");
+  EXPECT_EQ(program[2], res[2]);
+  res = optimize("(define x 5)(eval (list define x 6))(+ x 1)");
+  EXPECT_EQ(program[2], res[2]);
+}
+
+TEST_F(OptimizerTest, constantsAreNotSeenBeforeTheirDefinition) {
+  const auto res = optimize("(+ x 1)(define x 5)");
+  EXPECT_EQ(program[0], res[0]);
+}
+
+TEST_F(OptimizerTest, leavesDataAndPrintedFormsAsWritten) {
+  const auto res = optimize("(list + 1 2)(pprint (+ 1 2))(define y (+ 1 2))");
+  EXPECT_EQ(program, res);
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -30,6 +30,25 @@ TEST_F(ParserTest, symbol) {
   ASSERT_EQ(ast->children().size(), 0);
 }
 
+TEST_F(ParserTest, symbolsAreInterned) {
+  const auto ast = readFirst("(hest hest fisk)");
+  const auto a = std::static_pointer_cast<ASTSymbol>((*ast)[0]);
+  const auto b = std::static_pointer_cast<ASTSymbol>((*ast)[1]);
+  const auto c = std::static_pointer_cast<ASTSymbol>((*ast)[2]);
+  EXPECT_EQ(a->data(), b->data());
+  EXPECT_NE(a->data(), c->data());
+  EXPECT_STREQ("hest", a->name());
+}
+
+TEST_F(ParserTest, builtinSymbolsAreTheirOp) {
+  for (int op = 0; op < static_cast<int>(Builtin::UNKNOWN); op++) {
+    const auto builtin = static_cast<Builtin>(op);
+    const auto symbol = SymbolTable::intern(builtinToCString(builtin));
+    EXPECT_EQ(builtin, builtinFromSymbol(symbol)) << builtinToCString(builtin);
+  }
+  EXPECT_EQ(Builtin::UNKNOWN, builtinFromSymbol(SymbolTable::intern("hest")));
+}
+
 TEST_F(ParserTest, String) {
   const auto ast = readFirst("\"hest\"");
   ASSERT_EQ(AST::Type::STRING, ast->type());
@@ -137,17 +156,17 @@ TEST_F(ParserTest, builtinArgs) {
 
 TEST_F(ParserTest, toStringInteger) {
   const auto ast = readFirst("12");
-  EXPECT_STREQ("12", ast->toString());
+  EXPECT_EQ("12", ast->toString());
 }
 
 TEST_F(ParserTest, toStringSymbol) {
   const auto ast = readFirst("hest");
-  EXPECT_STREQ("hest", ast->toString());
+  EXPECT_EQ("hest", ast->toString());
 }
 
 TEST_F(ParserTest, toStringString) {
   const auto ast = readFirst("\"hest\"");
-  EXPECT_STREQ("\"hest\"", ast->toString());
+  EXPECT_EQ("\"hest\"", ast->toString());
 }
 
 TEST_F(ParserTest, listBuiltin) {
@@ -0,0 +1,147 @@
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "AST.h"
+#include "PersistentList.h"
+
+#include <cmath>
+#include <vector>
+
+namespace {
+
+PersistentList::Elements ints(int from, int to) {
+  PersistentList::Elements res;
+  for (int i = from; i < to; i++) {
+    res.push_back(std::make_shared<ASTInt>(i));
+  }
+  return res;
+}
+
+PersistentList list(const PersistentList::Elements &xs) {
+  return PersistentList(xs.begin(), xs.end());
+}
+
+std::vector<int64_t> values(const PersistentList &xs) {
+  std::vector<int64_t> res;
+  xs.forEach([&res](const PersistentList::Element &x) {
+    res.push_back(std::static_pointer_cast<ASTInt>(x)->data());
+  });
+  return res;
+}
+
+int64_t value(const PersistentList::Element &x) {
+  return std::static_pointer_cast<ASTInt>(x)->data();
+}
+
+/// The height of a balanced tree of n elements in full chunks
+unsigned int balancedHeight(size_t n) {
+  const double chunks = std::ceil(double(n) / PersistentList::CHUNK);
+  return static_cast<unsigned int>(1.45 * std::log2(chunks + 2));
+}
+
+} // namespace
+
+TEST(PersistentList, build) {
+  EXPECT_TRUE(PersistentList().empty());
+  for (const int n : {1, 31, 32, 33, 100, 1000}) {
+    const auto xs = list(ints(0, n));
+    ASSERT_EQ(size_t(n), xs.size());
+    EXPECT_EQ(0, value(xs.front()));
+    EXPECT_EQ(n - 1, value(xs.back()));
+    for (int i = 0; i < n; i++) {
+      EXPECT_EQ(i, value(xs[i]));
+    }
+    EXPECT_LE(xs.height(), balancedHeight(n));
+  }
+}
+
+TEST(PersistentList, joinKeepsOperands) {
+  const auto a = list(ints(0, 100));
+  const auto b = list(ints(100, 105));
+  const auto ab = PersistentList::join(a, b);
+  EXPECT_EQ(100u, a.size());
+  EXPECT_EQ(5u, b.size());
+  std::vector<int64_t> expected;
+  for (int i = 0; i < 105; i++) {
+    expected.push_back(i);
+  }
+  EXPECT_EQ(expected, values(ab));
+  EXPECT_EQ(expected, values(PersistentList::join(PersistentList(), ab)));
+  EXPECT_EQ(104, value(PersistentList::join(ab, PersistentList()).back()));
+}
+
+TEST(PersistentList, appendingStaysBalanced) {
+  PersistentList xs;
+  const int n = 100000;
+  for (int i = 0; i < n; i++) {
+    xs = PersistentList::join(xs, list(ints(i, i + 1)));
+  }
+  ASSERT_EQ(size_t(n), xs.size());
+  EXPECT_LE(xs.height(), balancedHeight(n));
+  for (int i = 0; i < n; i += 997) {
+    EXPECT_EQ(i, value(xs[i]));
+  }
+}
+
+TEST(PersistentList, consAndRest) {
+  PersistentList xs;
+  const int n = 10000;
+  for (int i = 0; i < n; i++) {
+    xs = xs.cons(std::make_shared<ASTInt>(i));
+  }
+  EXPECT_LE(xs.height(), balancedHeight(n));
+  const auto all = xs;
+  for (int i = n - 1; i >= 0; i--) {
+    ASSERT_EQ(i, value(xs.front()));
+    xs = xs.rest();
+    ASSERT_EQ(size_t(i), xs.size());
+  }
+  EXPECT_TRUE(xs.empty());
+  EXPECT_EQ(size_t(n), all.size());
+  EXPECT_EQ(0, value(all.back()));
+}
+
+TEST(PersistentList, joinTreesOfDifferentHeights) {
+  for (const int small : {1, 40, 700}) {
+    const auto a = list(ints(0, 50000));
+    const auto b = list(ints(50000, 50000 + small));
+    for (const auto &xs :
+         {PersistentList::join(a, b), PersistentList::join(b, a)}) {
+      EXPECT_EQ(size_t(50000 + small), xs.size());
+      EXPECT_LE(xs.height(), balancedHeight(xs.size()));
+    }
+    const auto ab = values(PersistentList::join(a, b));
+    for (int i = 0; i < 50000 + small; i++) {
+      ASSERT_EQ(i, ab[i]);
+    }
+  }
+}
+
+TEST(PersistentList, deepNestingIsDestroyed) {
+  std::shared_ptr<AST> kept;
+  {
+    // (((... (0) ...) 1) 2), as cons builds it in a loop
+    auto nested = std::make_shared<ASTList>(list(ints(0, 1)));
+    for (int i = 1; i < 200000; i++) {
+      nested = std::make_shared<ASTList>(
+          PersistentList().cons(std::make_shared<ASTInt>(i)).cons(nested));
+      if (100000 == i)
+        kept = nested;
+    }
+  }
+  // a list still held elsewhere is left as it was
+  int depth = 0;
+  for (auto x = kept; AST::Type::LIST == x->type(); depth++) {
+    const auto &xs = std::static_pointer_cast<ASTList>(x)->data();
+    if (1 == xs.size())
+      break;
+    ASSERT_EQ(100000 - depth, value(xs.back()));
+    x = xs.front();
+  }
+  EXPECT_EQ(100000, depth);
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
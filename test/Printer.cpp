@@ -0,0 +1,115 @@
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "AST.h"
+#include "Printer.h"
+
+#include <cstdio>
+#include <limits>
+#include <string>
+#include <unistd.h>
+
+namespace {
+
+std::string printed(const AST &node) {
+  std::string res;
+  Printer(res).print(node);
+  return res;
+}
+
+std::shared_ptr<AST> sexpr(AST::List children) {
+  auto res = std::make_shared<ASTSexpr>();
+  res->setChildren(std::move(children));
+  return res;
+}
+
+std::shared_ptr<AST> integer(int64_t i) { return std::make_shared<ASTInt>(i); }
+
+} // namespace
+
+TEST(Printer, atoms) {
+  EXPECT_EQ("0", printed(ASTInt(0)));
+  EXPECT_EQ("-42", printed(ASTInt(-42)));
+  EXPECT_EQ("-9223372036854775808",
+            printed(ASTInt(std::numeric_limits<int64_t>::min())));
+  EXPECT_EQ("9223372036854775807",
+            printed(ASTInt(std::numeric_limits<int64_t>::max())));
+  EXPECT_EQ("0.5", printed(ASTFloat(0.5)));
+  EXPECT_EQ("2.0", printed(ASTFloat(2)));
+  EXPECT_EQ("true", printed(ASTBoolean(true)));
+  EXPECT_EQ("name", printed(ASTSymbol("name")));
+  EXPECT_EQ("+", printed(ASTBuiltin(Builtin::ADD)));
+  EXPECT_EQ("\"text\"", printed(ASTString("text")));
+  const std::string piece(Rope::LEAF, 'x');
+  const Rope rope = Rope::concat(Rope(piece.c_str()), Rope(piece.c_str()));
+  EXPECT_EQ('"' + piece + piece + '"', printed(ASTString(rope)));
+}
+
+TEST(Printer, nestedValues) {
+  const auto form = sexpr({std::make_shared<ASTSymbol>("f"), sexpr({}),
+                           sexpr({integer(1), integer(2)})});
+  EXPECT_EQ("(f () (1 2))", printed(*form));
+  const PersistentList::Elements elements{integer(1), form};
+  const ASTList list(PersistentList(elements.begin(), elements.end()));
+  EXPECT_EQ("(list 1 (f () (1 2)))", printed(list));
+  EXPECT_EQ("(list)", printed(ASTList(PersistentList())));
+  const ASTMap map(PersistentMap().set(integer(1), form));
+  EXPECT_EQ("(hash 1 (f () (1 2)))", printed(map));
+  EXPECT_EQ("(hash 1 (f () (1 2)))", ASTMap(map).toString());
+}
+
+TEST(Printer, deepNestingDoesNotRecurse) {
+  const int depth = 1000000;
+  auto node = sexpr({});
+  for (int i = 1; i < depth; i++) {
+    node = sexpr({node});
+  }
+  const auto res = printed(*node);
+  ASSERT_EQ(2u * depth, res.size());
+  EXPECT_EQ(std::string(depth, '('), res.substr(0, depth));
+  EXPECT_EQ(std::string(depth, ')'), res.substr(depth));
+  // released from the top, the destructors would recurse as deep
+  while (!node->children().empty()) {
+    const auto child = node->children().front();
+    node->setChildren({});
+    node = child;
+  }
+}
+
+TEST(Printer, longList) {
+  const int n = 1000000;
+  PersistentList::Elements elements;
+  std::string expected = "(list";
+  for (int i = 0; i < n; i++) {
+    elements.push_back(integer(i));
+    expected += ' ' + std::to_string(i);
+  }
+  expected += ')';
+  const ASTList list(PersistentList(elements.begin(), elements.end()));
+  EXPECT_EQ(expected, printed(list));
+}
+
+TEST(Printer, writesToFileDescriptor) {
+  FILE *file = tmpfile();
+  ASSERT_NE(nullptr, file);
+  std::string expected;
+  {
+    Printer printer(fileno(file));
+    // more than the buffer holds, so some is written before the end
+    for (size_t i = 0; expected.size() < 3 * Printer::BUFFER; i++) {
+      printer.print(ASTInt(i));
+      printer.write('\n');
+      expected += std::to_string(i) + '\n';
+    }
+  }
+  std::string res(expected.size() + 1, '\0');
+  ASSERT_EQ(0, fseek(file, 0, SEEK_SET));
+  res.resize(fread(&res[0], 1, res.size(), file));
+  fclose(file);
+  EXPECT_EQ(expected, res);
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
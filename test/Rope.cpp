@@ -0,0 +1,83 @@
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "Rope.h"
+
+#include <cmath>
+#include <string>
+
+TEST(Rope, shortStringsAreInline) {
+  const Rope empty;
+  EXPECT_TRUE(empty.empty());
+  EXPECT_EQ("", empty.str());
+  const Rope hello("hello");
+  EXPECT_TRUE(hello.isInline());
+  EXPECT_EQ(5u, hello.size());
+  EXPECT_EQ('e', hello[1]);
+  const auto twice = Rope::concat(hello, hello);
+  EXPECT_TRUE(twice.isInline());
+  EXPECT_EQ("hellohello", twice.str());
+  const std::string longer(Rope::INLINE + 1, 'x');
+  EXPECT_FALSE(Rope(longer.c_str()).isInline());
+  EXPECT_EQ(longer, Rope(longer.c_str()).str());
+}
+
+TEST(Rope, appendingStaysBalanced) {
+  Rope res;
+  std::string expected;
+  const int n = 100000;
+  for (int i = 0; i < n; i++) {
+    const auto piece = std::to_string(i) + ",";
+    res = Rope::concat(res, Rope(piece.c_str()));
+    expected += piece;
+  }
+  ASSERT_EQ(expected.size(), res.size());
+  EXPECT_EQ(expected, res.str());
+  // about LEAF chars per piece
+  const double pieces = double(expected.size()) / (Rope::LEAF / 2);
+  EXPECT_LE(res.height(), 1.45 * std::log2(pieces + 2));
+  for (size_t i = 0; i < expected.size(); i += 1009) {
+    ASSERT_EQ(expected[i], res[i]) << i;
+  }
+}
+
+TEST(Rope, substringSharesTheRope) {
+  std::string expected;
+  Rope res;
+  for (int i = 0; i < 5000; i++) {
+    const auto piece = "<" + std::to_string(i) + ">";
+    res = Rope::concat(res, Rope(piece.c_str()));
+    expected += piece;
+  }
+  for (const auto &range : {std::make_pair(0ul, expected.size()),
+                            std::make_pair(3ul, 3ul), std::make_pair(5ul, 9ul),
+                            std::make_pair(100ul, 20000ul),
+                            std::make_pair(511ul, 1537ul)}) {
+    const auto sub = res.substring(range.first, range.second);
+    EXPECT_EQ(expected.substr(range.first, range.second - range.first),
+              sub.str());
+    EXPECT_EQ(sub.size() <= Rope::INLINE, sub.isInline());
+  }
+}
+
+TEST(Rope, equalityAndHashIgnoreTheShape) {
+  std::string flat;
+  Rope rope;
+  for (int i = 0; i < 300; i++) {
+    rope = Rope::concat(rope, Rope("abc"));
+    flat += "abc";
+  }
+  const Rope single(flat.c_str());
+  EXPECT_TRUE(rope == single);
+  EXPECT_EQ(rope.hash(), single.hash());
+  EXPECT_TRUE(rope.substring(3, 600) == single.substring(0, 597));
+  EXPECT_FALSE(rope.substring(0, 899) ==
+               Rope::concat(single.substring(0, 898), Rope("x")));
+  EXPECT_EQ(Rope("ab").hash(),
+            Rope::concat(Rope("a"), Rope("b")).hash());
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
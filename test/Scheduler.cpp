@@ -0,0 +1,201 @@
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "Scheduler.h"
+
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <thread>
+#include <vector>
+
+namespace {
+
+/// Counts its runs
+struct Counted : Task {
+  void run(unsigned) override { runs++; }
+  std::atomic<int> runs{0};
+};
+
+/// Sleeps for a while once it started
+struct Slow : Task {
+  void run(unsigned) override {
+    started = true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  }
+  std::atomic<bool> started{false};
+};
+
+/// CPU time of the calling thread in milliseconds
+double cpuMs() {
+  timespec t;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t);
+  return t.tv_sec * 1e3 + t.tv_nsec / 1e6;
+}
+
+/// fib of n, spawning the first of the two calls below cutoff
+struct Fib : Task {
+  Fib(Scheduler &scheduler, int n) : scheduler(scheduler), n(n) {}
+
+  void run(unsigned worker) override { result = fib(worker, n); }
+
+  int fib(unsigned worker, int x) {
+    if (x < 2)
+      return x;
+    if (x < 10 || scheduler.inlines(worker))
+      return fib(worker, x - 1) + fib(worker, x - 2);
+    const auto first = std::make_shared<Fib>(scheduler, x - 1);
+    scheduler.spawn(worker, first);
+    const auto second = fib(worker, x - 2);
+    scheduler.wait(worker, *first);
+    return first->result + second;
+  }
+
+  Scheduler &scheduler;
+  int n;
+  int result = 0;
+};
+
+} // namespace
+
+TEST(TaskDeque, takesNewestAndStealsOldest) {
+  TaskDeque deque;
+  std::vector<Counted> tasks(200);
+  EXPECT_EQ(nullptr, deque.take());
+  EXPECT_EQ(nullptr, deque.steal());
+  // past the initial buffer
+  for (auto &task : tasks) {
+    deque.push(&task);
+  }
+  EXPECT_EQ(tasks.size(), deque.size());
+  EXPECT_EQ(&tasks.back(), deque.take());
+  EXPECT_EQ(&tasks.front(), deque.steal());
+  EXPECT_EQ(&tasks[1], deque.steal());
+  EXPECT_EQ(&tasks[tasks.size() - 2], deque.take());
+  EXPECT_EQ(tasks.size() - 4, deque.size());
+  while (deque.take()) {
+  }
+  EXPECT_EQ(0u, deque.size());
+  EXPECT_EQ(nullptr, deque.steal());
+}
+
+TEST(TaskDeque, eachTaskIsTakenOnce) {
+  TaskDeque deque;
+  std::vector<Counted> tasks(100000);
+  std::atomic<bool> pushed{false};
+  std::vector<std::thread> thieves;
+  for (int i = 0; i < 3; i++) {
+    thieves.emplace_back([&deque, &pushed] {
+      for (;;) {
+        const bool last = pushed;
+        auto *task = deque.steal();
+        if (task)
+          static_cast<Counted *>(task)->run(1);
+        else if (last && !deque.size())
+          return;
+      }
+    });
+  }
+  // the owner takes some of its tasks back, racing the thieves
+  for (size_t i = 0; i < tasks.size(); i++) {
+    deque.push(&tasks[i]);
+    if (i % 3 == 0) {
+      auto *task = deque.take();
+      if (task)
+        static_cast<Counted *>(task)->run(0);
+    }
+  }
+  pushed = true;
+  while (auto *task = deque.take()) {
+    static_cast<Counted *>(task)->run(0);
+  }
+  for (auto &thief : thieves) {
+    thief.join();
+  }
+  for (size_t i = 0; i < tasks.size(); i++) {
+    ASSERT_EQ(1, tasks[i].runs) << i;
+  }
+}
+
+TEST(Scheduler, runsRecursiveTasks) {
+  for (const unsigned threads : {1, 2, 4}) {
+    Scheduler scheduler(threads);
+    EXPECT_EQ(threads, scheduler.threads());
+    const auto task = std::make_shared<Fib>(scheduler, 25);
+    scheduler.spawn(0, task);
+    scheduler.wait(0, *task);
+    EXPECT_TRUE(task->done());
+    EXPECT_EQ(75025, task->result) << threads;
+    EXPECT_EQ(0u, scheduler.pending());
+    const auto stats = scheduler.stats();
+    EXPECT_GT(stats.tasks, 1u);
+    EXPECT_GT(stats.inlined, 0u);
+    EXPECT_LE(stats.steals, stats.tasks);
+    if (1 == threads) {
+      EXPECT_EQ(0u, stats.steals);
+    }
+  }
+}
+
+TEST(Scheduler, inlinesWithATaskQueuedAndNoThief) {
+  Scheduler scheduler(1, 2);
+  std::vector<std::shared_ptr<Counted>> tasks;
+  for (int i = 0; i < 3; i++) {
+    EXPECT_EQ(i > 0, scheduler.inlines(0)) << i;
+    tasks.push_back(std::make_shared<Counted>());
+    scheduler.spawn(0, tasks.back());
+  }
+  EXPECT_EQ(3u, scheduler.pending());
+  scheduler.wait(0, *tasks.front());
+  EXPECT_EQ(0u, scheduler.pending());
+  for (const auto &task : tasks) {
+    EXPECT_EQ(1, task->runs);
+  }
+  EXPECT_EQ(2u, scheduler.stats().inlined);
+}
+
+TEST(Scheduler, waitingForAnotherWorkerBlocks) {
+  Scheduler scheduler(2);
+  const auto task = std::make_shared<Slow>();
+  scheduler.spawn(0, task);
+  // stolen by worker 1
+  while (!task->started) {
+    std::this_thread::yield();
+  }
+  const auto before = cpuMs();
+  scheduler.wait(0, *task);
+  EXPECT_TRUE(task->done());
+  EXPECT_LT(cpuMs() - before, 50);
+  EXPECT_EQ(0u, scheduler.pending());
+}
+
+TEST(Scheduler, awaitFromAnotherThread) {
+  Scheduler scheduler(2);
+  const auto task = std::make_shared<Slow>();
+  scheduler.spawn(0, task);
+  double cpu = 0;
+  std::thread([&scheduler, &task, &cpu] {
+    const auto before = cpuMs();
+    scheduler.await(*task);
+    cpu = cpuMs() - before;
+  }).join();
+  EXPECT_TRUE(task->done());
+  EXPECT_LT(cpu, 50);
+}
+
+TEST(Scheduler, destroyingRunsQueuedTasks) {
+  const auto task = std::make_shared<Counted>();
+  {
+    // the caller, worker 0, runs tasks only while waiting
+    Scheduler scheduler(1);
+    scheduler.spawn(0, task);
+    EXPECT_FALSE(task->done());
+  }
+  EXPECT_TRUE(task->done());
+  EXPECT_EQ(1, task->runs);
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
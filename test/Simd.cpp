@@ -0,0 +1,148 @@
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "Simd.h"
+#include "TypedArray.h"
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+using simd::Isa;
+
+namespace {
+
+/// The instruction sets the CPU running the tests supports
+std::vector<Isa> isas() {
+  std::vector<Isa> res{Isa::SCALAR};
+  const auto best = simd::isa();
+  if (simd::setIsa(Isa::AVX2))
+    res.push_back(Isa::AVX2);
+  simd::setIsa(best);
+  return res;
+}
+
+simd::Operand<int64_t> array(const std::vector<int64_t> &xs) {
+  return {xs.data(), false};
+}
+simd::Operand<double> array(const std::vector<double> &xs) {
+  return {xs.data(), false};
+}
+
+} // namespace
+
+TEST(Simd, intArithmetic) {
+  // lengths that leave a tail after the full vectors
+  std::vector<int64_t> a, b;
+  for (int64_t i = 0; i < 11; i++) {
+    a.push_back(i * 7 - 30);
+    b.push_back(i + 1);
+  }
+  for (const auto isa : isas()) {
+    simd::setIsa(isa);
+    for (const auto op : {Builtin::ADD, Builtin::SUB, Builtin::MUL,
+                          Builtin::DIV, Builtin::MOD}) {
+      std::vector<int64_t> res(a.size());
+      ASSERT_TRUE(simd::apply(op, array(a), array(b), res.data(), a.size()));
+      for (size_t i = 0; i < a.size(); i++) {
+        int64_t expected = 0;
+        switch (op) {
+        case Builtin::ADD:
+          expected = a[i] + b[i];
+          break;
+        case Builtin::SUB:
+          expected = a[i] - b[i];
+          break;
+        case Builtin::MUL:
+          expected = a[i] * b[i];
+          break;
+        case Builtin::DIV:
+          expected = a[i] / b[i];
+          break;
+        default:
+          expected = a[i] % b[i];
+          break;
+        }
+        EXPECT_EQ(expected, res[i])
+            << simd::isaToCString(isa) << " " << builtinToCString(op)
+            << " at " << i;
+      }
+    }
+  }
+}
+
+TEST(Simd, floatArithmetic) {
+  std::vector<double> a, b;
+  for (int i = 0; i < 9; i++) {
+    a.push_back(i * 1.5 - 4);
+    b.push_back(i - 2.0);
+  }
+  for (const auto isa : isas()) {
+    simd::setIsa(isa);
+    std::vector<double> res(a.size());
+    simd::apply(Builtin::DIV, array(a), array(b), res.data(), a.size());
+    for (size_t i = 0; i < a.size(); i++) {
+      EXPECT_EQ(a[i] / b[i], res[i]) << simd::isaToCString(isa) << " " << i;
+    }
+    simd::apply(Builtin::MOD, array(a), array(b), res.data(), a.size());
+    EXPECT_EQ(std::fmod(a[8], b[8]), res[8]);
+  }
+}
+
+TEST(Simd, scalarOperands) {
+  const std::vector<double> a{1, 2, 3, 4, 5};
+  const double two = 2;
+  for (const auto isa : isas()) {
+    simd::setIsa(isa);
+    std::vector<double> res(a.size());
+    simd::apply(Builtin::SUB, {&two, true}, array(a), res.data(), a.size());
+    EXPECT_THAT(res, testing::ElementsAre(1, 0, -1, -2, -3));
+    simd::apply(Builtin::MUL, array(a), {&two, true}, res.data(), a.size());
+    EXPECT_THAT(res, testing::ElementsAre(2, 4, 6, 8, 10));
+  }
+}
+
+TEST(Simd, intOverflowIsReported) {
+  const auto max = std::numeric_limits<int64_t>::max();
+  const auto min = std::numeric_limits<int64_t>::min();
+  const int64_t one = 1;
+  for (const auto isa : isas()) {
+    simd::setIsa(isa);
+    // in a full vector and in the tail
+    for (const size_t at : {2, 5}) {
+      std::vector<int64_t> a(6, 0);
+      std::vector<int64_t> res(a.size());
+      a[at] = max;
+      EXPECT_FALSE(
+          simd::apply(Builtin::ADD, array(a), {&one, true}, res.data(), 6));
+      a[at] = min;
+      EXPECT_FALSE(
+          simd::apply(Builtin::SUB, array(a), {&one, true}, res.data(), 6));
+      EXPECT_TRUE(
+          simd::apply(Builtin::ADD, array(a), {&one, true}, res.data(), 6));
+      EXPECT_EQ(min + 1, res[at]);
+    }
+    std::vector<int64_t> res(2);
+    const std::vector<int64_t> zeros{1, 0};
+    EXPECT_FALSE(simd::apply(Builtin::DIV, {&one, true}, array(zeros),
+                             res.data(), 2));
+  }
+}
+
+TEST(TypedArray, sliceSharesElements) {
+  TypedArray array(TypedArray::Element::INT, 10);
+  for (int i = 0; i < 10; i++) {
+    array.ints()[i] = i;
+  }
+  const auto slice = array.slice(3, 7);
+  EXPECT_EQ(4u, slice.size());
+  EXPECT_EQ(array.ints() + 3, slice.ints());
+  EXPECT_EQ(0u, array.slice(10, 10).size());
+  EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(array.ints()) %
+                    TypedArray::ALIGNMENT);
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,42 @@
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "ThreadPool.h"
+
+#include <atomic>
+#include <vector>
+
+TEST(ThreadPool, runsEachTaskOnce) {
+  ThreadPool pool(4);
+  EXPECT_EQ(4u, pool.threads());
+  for (const size_t count : {0, 1, 3, 1000}) {
+    std::vector<std::atomic<int>> runs(count);
+    std::atomic<unsigned> workers{0};
+    pool.run(count, [&runs, &workers](unsigned worker, size_t task) {
+      runs[task]++;
+      workers |= 1u << worker;
+    });
+    for (size_t task = 0; task < count; task++) {
+      EXPECT_EQ(1, runs[task]) << task;
+    }
+    EXPECT_EQ(0u, workers & ~0xfu);
+  }
+}
+
+TEST(ThreadPool, oneThreadRunsOnTheCaller) {
+  ThreadPool pool(0);
+  EXPECT_EQ(1u, pool.threads());
+  const auto caller = std::this_thread::get_id();
+  size_t tasks = 0;
+  pool.run(10, [&](unsigned worker, size_t) {
+    EXPECT_EQ(0u, worker);
+    EXPECT_EQ(caller, std::this_thread::get_id());
+    tasks++;
+  });
+  EXPECT_EQ(10u, tasks);
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,120 @@
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "Interpreter.h"
+#include "Lexer.h"
+#include "Parser.h"
+#include "SyntaxError.h"
+#include "Translator.h"
+#include "Util.h"
+#include "translated.h"
+
+class TranslatorTest : public ::testing::Test {
+
+protected:
+  Translator::Output translate(const char *code) {
+    Lexer l(code);
+    Parser p(l);
+    program = p.read();
+    return translator.translate(program, "test.ls", "test", "test.h");
+  }
+
+  AST::List program;
+  Translator translator;
+};
+
+TEST_F(TranslatorTest, identifiers) {
+  EXPECT_EQ("fib_iter", Translator::identifier("fib-iter"));
+  EXPECT_EQ("and_", Translator::identifier("and"));
+  EXPECT_EQ("empty_x3f", Translator::identifier("empty?"));
+  EXPECT_EQ("x1st", Translator::identifier("1st"));
+  EXPECT_EQ("x_t0", Translator::identifier("_t0"));
+}
+
+TEST_F(TranslatorTest, declaresFunctions) {
+  const auto res = translate("(define (fib-iter a b count) a)"
+                             "(define (one) 1)(one)");
+  EXPECT_THAT(res.header,
+              ::testing::HasSubstr(
+                  "Value fib_iter(Value a, Value b, Value count);\n"));
+  EXPECT_THAT(res.header, ::testing::HasSubstr("Value one();\n"));
+  EXPECT_THAT(res.source, ::testing::HasSubstr("#include \"test.h\""));
+  EXPECT_THAT(res.source,
+              ::testing::HasSubstr("const Value _t0 = ::test::one();\n"
+                                   "  results.push_back(_t0);"));
+}
+
+TEST_F(TranslatorTest, arithmeticTakesTheFixnumPath) {
+  const auto res = translate("(define (f x) (+ x (* 2 x) 1))");
+  // x is checked once, before the other operands are evaluated
+  EXPECT_THAT(res.source,
+              ::testing::HasSubstr("  runtime::checkNumber(x);\n"
+                                   "  const Value _t0 = runtime::arithmetic<"
+                                   "Builtin::MUL>(Value::integer(2), x);\n"));
+  EXPECT_THAT(res.source,
+              ::testing::HasSubstr(
+                  "runtime::arithmetic<Builtin::ADD>(_t1, Value::integer(1))"));
+}
+
+TEST_F(TranslatorTest, selfTailCallsLoop) {
+  const auto res = translate("(define (f n acc) (if (= n 0) acc "
+                             "(f (- n 1) acc)))");
+  EXPECT_THAT(res.source, ::testing::HasSubstr("for (;;) {"));
+  EXPECT_THAT(res.source, ::testing::HasSubstr("continue;"));
+  EXPECT_THAT(res.source, ::testing::Not(::testing::HasSubstr("acc = ")));
+}
+
+TEST_F(TranslatorTest, rejectsDynamicCode) {
+  EXPECT_THROW(translate("(eval (list + 1 2))"), SyntaxError);
+  EXPECT_THROW(translate("(define (f x) (pprint x))"), SyntaxError);
+  EXPECT_THROW(translate("(define (f x) (define y x))"), SyntaxError);
+  EXPECT_THROW(translate("(define (f g) (g 1))"), SyntaxError);
+  EXPECT_THROW(translate("(define x (+ 1 2))"), SyntaxError);
+  EXPECT_THROW(translate("(define (f) 1)(define (f) 2)"), SyntaxError);
+}
+
+TEST_F(TranslatorTest, rejectsUnknownNames) {
+  EXPECT_THROW(translate("(define (f) (g))"), SyntaxError);
+  EXPECT_THROW(translate("(f)(define (f) 1)"), SyntaxError);
+  EXPECT_THROW(translate("(define (f x) x)(f 1 2)"), SyntaxError);
+}
+
+// translated.ls is translated by the build, its top-level forms must
+// evaluate to what the interpreter evaluates them to
+TEST_F(TranslatorTest, translatedScriptMatchesInterpreter) {
+  const auto code = util::readFile(SCRIPT);
+  Lexer l(code.c_str());
+  Parser p(l);
+  Interpreter interpreter;
+  std::vector<std::shared_ptr<AST>> expected;
+  for (const auto &form : p.read()) {
+    const auto res = interpreter.eval(form);
+    if (!form->children().empty() &&
+        (form->head()->isBuiltin(Builtin::DEFINE) ||
+         form->head()->isBuiltin(Builtin::DEFINE_MEMO)))
+      continue;
+    expected.push_back(res);
+  }
+
+  const auto results = translated::run();
+  ASSERT_EQ(expected.size(), results.size());
+  for (size_t i = 0; i < results.size(); i++) {
+    const auto res = results[i].toAST();
+    ASSERT_EQ(expected[i]->type(), res->type()) << "form " << i;
+    EXPECT_EQ(expected[i]->toString(), res->toString()) << "form " << i;
+    EXPECT_EQ(expected[i]->children().size(), res->children().size());
+  }
+}
+
+TEST_F(TranslatorTest, translatedFunctionsFailLikeTheInterpreter) {
+  EXPECT_EQ(610, translated::fib(Value::integer(15)).integer());
+  EXPECT_THROW(translated::fib(Value::boolean(true)), SyntaxError);
+  EXPECT_THROW(translated::first(Value::integer(1)), SyntaxError);
+  EXPECT_THROW(translated::same(Value::integer(1), Value::boolean(true)),
+               SyntaxError);
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
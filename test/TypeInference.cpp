@@ -0,0 +1,109 @@
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "Interpreter.h"
+#include "Lexer.h"
+#include "Parser.h"
+#include "SyntaxError.h"
+
+class TypeInferenceTest : public ::testing::Test {
+
+protected:
+  std::shared_ptr<AST> eval(const char *code) {
+    Lexer l(code);
+    Parser p(l);
+    program = p.read();
+    std::shared_ptr<AST> res;
+    for (const auto &e : program) {
+      res = interpreter.eval(e);
+    }
+    return res;
+  }
+
+  int integer(const char *code) {
+    const auto res = eval(code);
+    EXPECT_EQ(AST::Type::INTEGER, res->type());
+    return std::static_pointer_cast<ASTInt>(res)->data();
+  }
+
+  const TypeInference::Stats &stats() {
+    return interpreter.typeInferenceStats();
+  }
+
+  AST::List program;
+  Interpreter interpreter;
+};
+
+TEST_F(TypeInferenceTest, integerArgumentsAreAssumed) {
+  eval("(define (fib x) (if (< x 2) x (+ (fib (- x 1)) (fib (- x 2)))))");
+  const auto &fun = program[0]->children();
+  const auto &params = fun[1];
+  EXPECT_TRUE(params->proven());
+  EXPECT_TRUE(params->children()[1]->proven());
+
+  const auto &body = fun[2]->children();
+  // (< x 2)
+  EXPECT_TRUE(body[1]->proven());
+  // the operands of + are results of calls
+  EXPECT_FALSE(body[3]->proven());
+  EXPECT_TRUE(body[3]->children()[1]->children()[1]->proven());
+
+  EXPECT_EQ(1, stats().functions);
+  EXPECT_EQ(1, stats().typed);
+  EXPECT_EQ(8, stats().checks);
+  EXPECT_EQ(6, stats().eliminated);
+  EXPECT_EQ(6765, integer("(fib 20)"));
+}
+
+TEST_F(TypeInferenceTest, otherArgumentsAreChecked) {
+  eval("(define (f x y) (+ x 1))");
+  EXPECT_TRUE(program[0]->children()[1]->children()[1]->proven());
+  EXPECT_FALSE(program[0]->children()[1]->children()[2]->proven());
+  EXPECT_EQ(3, integer("(f 2 (list))"));
+  EXPECT_THROW(eval("(f true 1)"), SyntaxError);
+  EXPECT_THROW(eval("(f (list 1) 1)"), SyntaxError);
+}
+
+TEST_F(TypeInferenceTest, stringComparisonsAreNotTyped) {
+  eval("(define (same a b) (= a b))");
+  EXPECT_TRUE(eval("(same 1 1)")->type() == AST::Type::BOOLEAN);
+  const auto res = eval("(same \"a\" \"a\")");
+  ASSERT_EQ(AST::Type::BOOLEAN, res->type());
+  EXPECT_TRUE(std::static_pointer_cast<ASTBoolean>(res)->data());
+  EXPECT_THROW(eval("(same 1 \"a\")"), SyntaxError);
+}
+
+TEST_F(TypeInferenceTest, listsAreProven) {
+  eval("(define (f) (head (join (list 1 2) (list 3))))");
+  EXPECT_TRUE(program[0]->children()[2]->proven());
+  EXPECT_EQ(1, integer("(f)"));
+  eval("(define (g) (head (list)))");
+  EXPECT_THROW(eval("(g)"), SyntaxError);
+}
+
+TEST_F(TypeInferenceTest, comparisonsNeedTwoOperands) {
+  eval("(define (g x) (< x))");
+  EXPECT_FALSE(program[0]->children()[2]->proven());
+  EXPECT_THROW(eval("(g 1)"), SyntaxError);
+}
+
+TEST_F(TypeInferenceTest, nothingIsProvenWithoutKnownOperands) {
+  eval("(define y 2)(define (f x) (head x))(define (g) (+ y 1))");
+  EXPECT_EQ(2, stats().functions);
+  EXPECT_EQ(0, stats().typed);
+  EXPECT_EQ(0, stats().eliminated);
+  EXPECT_FALSE(program[1]->children()[1]->proven());
+}
+
+TEST_F(TypeInferenceTest, canBeDisabled) {
+  interpreter.setTypeInference(false);
+  eval("(define (f x) (+ x 1))");
+  EXPECT_FALSE(program[0]->children()[1]->proven());
+  EXPECT_EQ(0, stats().functions);
+  EXPECT_EQ(2, integer("(f 1)"));
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,67 @@
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+#include "Value.h"
+
+TEST(value, defaultIsNull) {
+  const Value v;
+  EXPECT_FALSE(v);
+  EXPECT_FALSE(Value(nullptr));
+}
+
+TEST(value, integerIsImmediate) {
+  const auto v = Value::integer(42);
+  ASSERT_TRUE(v);
+  EXPECT_TRUE(v.isInteger());
+  EXPECT_EQ(AST::Type::INTEGER, v.type());
+  EXPECT_EQ(42, v.integer());
+}
+
+TEST(value, booleanIsImmediate) {
+  const auto v = Value::boolean(false);
+  ASSERT_TRUE(v);
+  EXPECT_TRUE(v.isBoolean());
+  EXPECT_EQ(AST::Type::BOOLEAN, v.type());
+  EXPECT_FALSE(v.boolean());
+}
+
+TEST(value, integerNodeIsUnboxed) {
+  const Value v(std::make_shared<ASTInt>(7));
+  ASSERT_TRUE(v.isInteger());
+  EXPECT_EQ(7, v.integer());
+}
+
+TEST(value, booleanNodeIsUnboxed) {
+  const Value v(std::make_shared<ASTBoolean>(true));
+  ASSERT_TRUE(v.isBoolean());
+  EXPECT_TRUE(v.boolean());
+}
+
+TEST(value, otherNodesAreKept) {
+  const auto node = std::make_shared<ASTString>("hello");
+  const Value v(node);
+  EXPECT_EQ(AST::Type::STRING, v.type());
+  EXPECT_EQ(node, v.node());
+  EXPECT_EQ(node, v.toAST());
+}
+
+TEST(value, isBuiltin) {
+  const Value v(std::make_shared<ASTBuiltin>(Builtin::LIST));
+  EXPECT_TRUE(v.isBuiltin(Builtin::LIST));
+  EXPECT_FALSE(v.isBuiltin(Builtin::ADD));
+  EXPECT_FALSE(Value::integer(1).isBuiltin(Builtin::LIST));
+}
+
+TEST(value, immediatesAreBoxed) {
+  const auto i = Value::integer(-3).toAST();
+  ASSERT_EQ(AST::Type::INTEGER, i->type());
+  EXPECT_EQ(-3, std::static_pointer_cast<ASTInt>(i)->data());
+  const auto b = Value::boolean(true).toAST();
+  ASSERT_EQ(AST::Type::BOOLEAN, b->type());
+  EXPECT_TRUE(std::static_pointer_cast<ASTBoolean>(b)->data());
+}
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}